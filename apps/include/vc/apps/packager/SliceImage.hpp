@@ -19,9 +19,13 @@ public:
     bool operator<(const SliceImage& b) const;
 
     bool analyze();
+    void analyze(const cv::Mat& image);
+    cv::Mat image() const;
     cv::Mat conformedImage();
+    cv::Mat conform(cv::Mat image, bool scale = true) const;
     int width() { return w_; }
     int height() { return h_; }
+    int type() { return type_; }
     double min() { return min_; }
     double max() { return max_; }
     bool needsConvert() { return needsConvert_; }
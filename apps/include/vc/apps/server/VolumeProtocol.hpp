@@ -17,8 +17,33 @@ constexpr std::uint32_t VOLPKG_SZ = 64;
 /** Size of a volume identifier. */
 constexpr std::uint32_t VOLUME_SZ = 64;
 
-/** Enumeration of protocol versions. */
-enum Version : std::uint8_t { V1 = 1 };
+/**
+ * Enumeration of protocol versions.
+ *
+ * V1: The client sends one RequestHdr followed by its RequestArgs. The server
+ * sends one ResponseArgs and its data for each request, in request order, and
+ * then closes the connection.
+ *
+ * V2: The connection stays open. The client can send any number of
+ * RequestHdr packets, each followed by its RequestArgsV2, without waiting for
+ * responses. Requests are resolved concurrently, and the server sends one
+ * ResponseArgsV2 and its data for each request as soon as it is resolved, so
+ * responses can arrive in any order. Clients match them to requests by ID.
+ * Every RequestHdr on a connection must use the same version.
+ */
+enum Version : std::uint8_t { V1 = 1, V2 = 2 };
+
+/** Enumeration of V2 response statuses. */
+enum Status : std::uint8_t {
+    /** The subvolume follows the response */
+    Success = 0,
+    /** The volpkg or volume could not be loaded */
+    VolumeNotFound = 1,
+    /** The request arguments are invalid (e.g. an unknown level) */
+    InvalidRequest = 2,
+    /** The subvolume could not be generated */
+    InternalError = 3
+};
 
 // TODO: Add a request/response flag so that we can share a uniform prefix
 // header for all packets.
@@ -65,4 +90,34 @@ struct ResponseArgs {
     std::uint32_t size;
 };
 
+/** V2 packet structure for arguments to a given request. */
+struct RequestArgsV2 {
+    /** Client-chosen ID, echoed in the response */
+    std::uint64_t id;
+    /** Volume resolution level to sample. See Volume::level(). */
+    std::uint32_t level;
+    std::uint8_t pad[4];
+    /** The V1 request arguments */
+    RequestArgs args;
+};
+
+/** V2 packet structure for a response to a request. */
+struct ResponseArgsV2 {
+    /** ID of the request */
+    std::uint64_t id;
+    std::uint32_t extentX;
+    std::uint32_t extentY;
+    std::uint32_t extentZ;
+    /** Size of the subvolume data which follows, in bytes */
+    std::uint32_t size;
+    Status status;
+    std::uint8_t pad[7];
+};
+
+// Packets are copied to and from the wire as-is
+static_assert(sizeof(RequestHdr) == 12);
+static_assert(sizeof(RequestArgs) == 192);
+static_assert(sizeof(RequestArgsV2) == 208);
+static_assert(sizeof(ResponseArgsV2) == 32);
+
 }  // namespace volcart::protocol
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QByteArray>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "vc/apps/server/VolumeProtocol.hpp"
+#include "vc/core/neighborhood/NeighborhoodGenerator.hpp"
+
+namespace volcart::protocol
+{
+
+/** A request read from a connection. */
+struct Request {
+    /** Number of requests read from the connection before this one */
+    std::uint32_t index{0};
+    /** Arguments. The ID and level of V1 requests are 0. */
+    RequestArgsV2 args;
+};
+
+/**
+ * Parser for the stream of requests sent on one connection.
+ *
+ * The reader never buffers data itself. The caller reads bytesNeeded() bytes
+ * from the connection and passes them to read(), which parses the next packet
+ * header or request.
+ */
+class RequestReader
+{
+public:
+    /** Maximum number of requests in one packet. */
+    static constexpr std::uint32_t MAX_REQUESTS{1U << 16};
+
+    /** Number of bytes needed to parse the next header or request. */
+    auto bytesNeeded() const -> std::size_t;
+
+    /**
+     * Parse bytesNeeded() bytes of `data`.
+     *
+     * Returns the request, if the bytes were a request rather than a packet
+     * header.
+     *
+     * @throws std::runtime_error if the header has the wrong magic value, an
+     * unsupported version, a different version than the previous headers, or
+     * more than MAX_REQUESTS requests
+     * @throws std::logic_error if done()
+     */
+    auto read(const char* data) -> std::optional<Request>;
+
+    /** Protocol version of the connection, once a header has been read. */
+    auto version() const -> std::optional<Version>;
+
+    /** Number of requests left in the current packet. */
+    auto remaining() const -> std::uint32_t;
+
+    /**
+     * Whether the connection can't send more requests. V1 connections only
+     * carry one packet.
+     */
+    auto done() const -> bool;
+
+private:
+    /** Protocol version, set by the first header */
+    std::optional<Version> version_;
+    /** Number of requests left in the current packet */
+    std::uint32_t remaining_{0};
+    /** Number of requests read */
+    std::uint32_t numRequests_{0};
+};
+
+/**
+ * Orders the responses written on one connection.
+ *
+ * V2 responses are written as soon as they are ready, in any order. V1
+ * responses are written in request order, so a response is held until every
+ * response before it is ready.
+ */
+class ResponseQueue
+{
+public:
+    /** Construct an empty queue. */
+    ResponseQueue() = default;
+
+    /**
+     * Construct for a connection with the given version. `batchSize` is the
+     * number of V1 requests.
+     */
+    ResponseQueue(Version version, std::uint32_t batchSize);
+
+    /**
+     * Add the response to the request with the given Request::index. Returns
+     * the responses which can be written now, in order.
+     *
+     * @throws std::out_of_range if a V1 `index` isn't in the batch
+     */
+    auto add(std::uint32_t index, QByteArray response)
+        -> std::vector<QByteArray>;
+
+    /** V1: Whether every response of the batch has been returned by add(). */
+    auto complete() const -> bool;
+
+    /** V1: Number of responses which are ready but not returned by add(). */
+    auto held() const -> std::size_t;
+
+    /** V1: Size in bytes of the held responses. */
+    auto heldBytes() const -> std::size_t;
+
+private:
+    /** Protocol version */
+    Version version_{V2};
+    /** V1: Number of requests in the batch */
+    std::uint32_t batchSize_{0};
+    /** V1: Index of the next response to return */
+    std::uint32_t next_{0};
+    /** V1: Ready responses after next_, by index */
+    std::map<std::uint32_t, QByteArray> held_;
+    /** V1: Size in bytes of held_ */
+    std::size_t heldBytes_{0};
+};
+
+/** Serialize a response to a V1 request. `neighborhood` may be null. */
+auto SerializeResponse(
+    const RequestArgs& args, const Neighborhood* neighborhood) -> QByteArray;
+
+/** Serialize a response to a V2 request. `neighborhood` may be null. */
+auto SerializeResponse(
+    std::uint64_t id, Status status, const Neighborhood* neighborhood)
+    -> QByteArray;
+
+}  // namespace volcart::protocol
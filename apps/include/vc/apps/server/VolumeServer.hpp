@@ -1,20 +1,38 @@
 #pragma once
 
-#include <QDataStream>
+#include <QByteArray>
 #include <QObject>
+#include <QPointer>
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <cstddef>
-#include <map>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
 
 #include "vc/apps/server/VolumeProtocol.hpp"
+#include "vc/apps/server/VolumeProtocolIO.hpp"
 #include "vc/core/types/Volume.hpp"
 #include "vc/core/types/VolumePkg.hpp"
+#include "vc/core/util/ThreadPool.hpp"
 
 namespace volcart
 {
 
-/** Class for implementing the VolumeServer. */
+/**
+ * Class for implementing the VolumeServer.
+ *
+ * The Qt event loop only reads requests and writes responses. Subvolumes are
+ * generated by a pool of worker threads, and each response is written as soon
+ * as it is ready. See protocol::Version for how each protocol version orders
+ * its responses.
+ *
+ * A connection stops being read while it has MAX_OUTSTANDING_REQUESTS
+ * unresolved requests or more than MAX_UNSENT_BYTES of unsent responses.
+ * V1 responses which are held until earlier responses are ready count
+ * towards both limits.
+ * Unread requests then fill the socket buffers, which makes the client wait.
+ */
 class VolumeServer : public QObject
 {
     Q_OBJECT
@@ -26,11 +44,28 @@ public:
     /** Convenience type for a map of strings to Volume pointers. */
     using VolumeMap = std::unordered_map<std::string, Volume::Pointer>;
 
-    /** Construct a new VolumeServer object. */
+    /** Maximum number of unresolved requests per connection. */
+    static constexpr std::uint32_t MAX_OUTSTANDING_REQUESTS{256};
+
+    /** Maximum number of unsent response bytes per connection. */
+    static constexpr qint64 MAX_UNSENT_BYTES{qint64{256} << 20};
+
+    /** Size of the read buffer of each socket. */
+    static constexpr qint64 READ_BUFFER_BYTES{qint64{64} << 10};
+
+    /**
+     * Construct a new VolumeServer object.
+     *
+     * `memory` is split evenly between all volumes in `volpkgs`, and each
+     * volume's share is split between its levels in proportion to their
+     * sizes. Subvolumes are generated by `numThreads` worker threads
+     * (default: the number of hardware threads).
+     */
     explicit VolumeServer(
         VolumePkgMap volpkgs,
         quint16 port,
         std::size_t memory,
+        std::optional<std::uint32_t> numThreads = std::nullopt,
         QObject* parent = nullptr);
 
 private slots:
@@ -38,13 +73,25 @@ private slots:
     void acceptConnection();
 
     /** Called when a socket is ready to be read from. */
-    void socketReadyRead(QDataStream* dataStream);
+    void socketReadyRead(QTcpSocket* socket);
 
 signals:
     /** Called when it's time to exit the application. */
     void finished();
 
 private:
+    /** State of a client connection. */
+    struct Connection {
+        /** Parses the requests */
+        protocol::RequestReader reader;
+        /** Orders the responses */
+        protocol::ResponseQueue responses;
+        /** Number of requests which have been read but not resolved */
+        std::uint32_t outstanding{0};
+        /** Whether reading stopped because of the limits on the connection */
+        bool paused{false};
+    };
+
     /** A pointer to the TCP server object. */
     QTcpServer* server_;
 
@@ -54,14 +101,44 @@ private:
     /** A map of cached/loaded volumes identified by string key. */
     VolumeMap volumes_;
 
-    /** How much memory the server should use for caching volumes. */
-    std::size_t memory_;
+    /** How much memory the server should use for caching each volume. */
+    std::size_t memoryPerVolume_{0};
+
+    /** State of each open connection. */
+    std::unordered_map<QTcpSocket*, Connection> connections_;
+
+    /**
+     * Workers which generate subvolumes. Declared last so that running tasks
+     * finish before the rest of the server is destroyed.
+     */
+    ThreadPool pool_;
 
     /** Generate a string for representing a socket. */
     auto socketStr_(QTcpSocket* socket) -> std::string;
 
-    /** Resolve a single sub-volume request. */
-    void resolveRequest_(QTcpSocket* socket, protocol::RequestArgs* args);
+    /** Get a volume, loading it on first use. Returns nullptr on failure. */
+    auto volume_(QTcpSocket* socket, const protocol::RequestArgs& args)
+        -> Volume::Pointer;
+
+    /**
+     * Queue a single sub-volume request. `index` is the protocol::Request
+     * index, which orders V1 responses. V2 requests are identified by their
+     * ID.
+     */
+    void submitRequest_(
+        QTcpSocket* socket,
+        std::uint32_t index,
+        const protocol::RequestArgsV2& args,
+        protocol::Version version);
+
+    /** Write or store a resolved request. Called on the event loop. */
+    void sendResponse_(
+        const QPointer<QTcpSocket>& socket,
+        std::uint32_t index,
+        const QByteArray& response);
+
+    /** Continue reading from a connection which was paused by its limits. */
+    void resume_(QTcpSocket* socket);
 };
 
 }  // namespace volcart
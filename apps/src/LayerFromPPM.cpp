@@ -1,4 +1,5 @@
 #include <cstddef>
+#include <cstdint>
 #include <sstream>
 
 #include <boost/program_options.hpp>
@@ -9,6 +10,7 @@
 #include "vc/app_support/ProgressIndicator.hpp"
 #include "vc/core/filesystem.hpp"
 #include "vc/core/io/ImageIO.hpp"
+#include "vc/core/io/TiledPPMIO.hpp"
 #include "vc/core/neighborhood/LineGenerator.hpp"
 #include "vc/core/types/PerPixelMap.hpp"
 #include "vc/core/types/Transforms.hpp"
@@ -59,7 +61,8 @@ auto main(int argc, char* argv[]) -> int
         ("output-dir,o", po::value<std::string>()->required(),
             "Output directory for layer images.")
         ("output-ppm", po::value<std::string>(), "Create and save a new PPM "
-            "that maps to the layer volume.")
+            "that maps to the layer volume. If the input PPM is tiled, the new "
+            "PPM is also tiled.")
         ("image-format,f", po::value<std::string>()->default_value("png"),
             "Image format for layer images. Default: png")
         ("compression", po::value<int>(), "Image compression level");
@@ -74,7 +77,9 @@ auto main(int argc, char* argv[]) -> int
             "Sample Direction:\n"
                 " -1 = Negative\n"
                 "  0 = Omni\n"
-                "  1 = Positive");
+                "  1 = Positive")
+        ("threads", po::value<std::uint32_t>(), "Maximum number of threads "
+            "used to generate the layers. Default: All hardware threads.");
 
     po::options_description ppmOptions("PPM Generation Options");
     ppmOptions.add_options()
@@ -195,15 +200,10 @@ auto main(int argc, char* argv[]) -> int
     auto interval = parsed["interval"].as<double>();
     auto direction = static_cast<Direction>(parsed["direction"].as<int>());
 
-    // Read the ppm
-    Logger()->info("Loading PPM...");
-    auto ppm = PerPixelMap::New(PerPixelMap::ReadPPM(inputPPMPath));
-
-    ///// Transform the PPM /////
+    ///// Load the transform /////
+    Transform3D::Pointer tfm;
     if (parsed.count("transform") > 0) {
-        // load the transform
         auto tfmId = parsed.at("transform").as<std::string>();
-        Transform3D::Pointer tfm;
         if (vpkg.hasTransform(tfmId)) {
             tfm = vpkg.transform(tfmId);
         } else {
@@ -217,9 +217,21 @@ auto main(int argc, char* argv[]) -> int
                 Logger()->warn("Cannot invert transform. Using original.");
             }
         }
+    }
 
-        Logger()->info("Applying transform...");
-        ppm = ApplyTransform(ppm, tfm);
+    // Read the ppm. Tiled PPMs are processed one tile at a time.
+    PerPixelMap::Pointer ppm;
+    io::TiledPPMReader::Pointer tiledPPM;
+    if (io::IsTiledPPM(inputPPMPath)) {
+        Logger()->info("Opening tiled PPM...");
+        tiledPPM = io::TiledPPMReader::New(inputPPMPath);
+    } else {
+        Logger()->info("Loading PPM...");
+        ppm = PerPixelMap::New(PerPixelMap::ReadPPM(inputPPMPath));
+        if (tfm) {
+            Logger()->info("Applying transform...");
+            ppm = ApplyTransform(ppm, tfm);
+        }
     }
 
     // Setup line generator
@@ -233,6 +245,9 @@ auto main(int argc, char* argv[]) -> int
     layerGen.setVolume(volume);
     layerGen.setPerPixelMap(ppm);
     layerGen.setGenerator(line);
+    if (parsed.count("threads") > 0) {
+        layerGen.setMaxThreads(parsed["threads"].as<std::uint32_t>());
+    }
 
     // Progress reporting
     auto enableProgress = parsed["progress"].as<bool>();
@@ -242,14 +257,52 @@ auto main(int argc, char* argv[]) -> int
             DurationFromString(parsed["progress-interval"].as<std::string>());
     }
 
-    if (enableProgress) {
-        ReportProgress(layerGen, "Generating layers:", cfg);
-        Logger()->debug("Generating layers...");
+    texturing::LayerTexture::Texture texture;
+    if (tiledPPM) {
+        // Generate the layers for each tile and copy them into the output
+        auto layerTile = [&](std::size_t tile) {
+            const auto rect = tiledPPM->tileRect(tile);
+            auto tilePPM = PerPixelMap::New(tiledPPM->readTile(tile));
+            if (tfm) {
+                tilePPM = ApplyTransform(tilePPM, tfm);
+            }
+            layerGen.setPerPixelMap(tilePPM);
+            const auto layers = layerGen.compute();
+            if (texture.empty()) {
+                for (const auto& layer : layers) {
+                    texture.emplace_back(cv::Mat::zeros(
+                        static_cast<int>(tiledPPM->height()),
+                        static_cast<int>(tiledPPM->width()), layer.type()));
+                }
+            }
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                layers[i].copyTo(texture[i](rect));
+            }
+        };
+
+        const auto tiles = range(tiledPPM->numTiles());
+        if (enableProgress) {
+            Logger()->debug("Generating layers...");
+            auto progIt = ProgressWrap(tiles, "Generating layers:", cfg);
+            for (const auto tile : progIt) {
+                layerTile(tile);
+            }
+        } else {
+            Logger()->info("Generating layers...");
+            for (const auto tile : tiles) {
+                layerTile(tile);
+            }
+        }
     } else {
-        Logger()->info("Generating layers...");
-    }
+        if (enableProgress) {
+            ReportProgress(layerGen, "Generating layers:", cfg);
+            Logger()->debug("Generating layers...");
+        } else {
+            Logger()->info("Generating layers...");
+        }
 
-    auto texture = layerGen.compute();
+        texture = layerGen.compute();
+    }
 
     // Write the image sequence
     const fs::path filepath = outDir / ("{}." + imgFmt);
@@ -266,31 +319,50 @@ auto main(int argc, char* argv[]) -> int
         Logger()->info("Generating new PPM...");
         const fs::path outputPPMPath = parsed["output-ppm"].as<std::string>();
 
-        // Setup new PPM
-        auto height = ppm->height();
-        auto width = ppm->width();
-        PerPixelMap newPPM(height, width);
-        newPPM.setMask(ppm->mask());
-        newPPM.setCellMap(ppm->cellMap());
-
-        // Fill new PPM
+        // Generate the new PPM for a region of the input PPM
         auto z = static_cast<double>(texture.size() - 1) / 2.0;
         auto normal = (parsed.count("negative-normal") > 0) ? -1.0 : 1.0;
-        for (auto [y, x] : range2D(height, width)) {
-            if (!newPPM.hasMapping(y, x)) {
-                continue;
+        auto layerPPM = [&](const PerPixelMap& src, const cv::Rect& rect) {
+            // Setup new PPM
+            auto height = src.height();
+            auto width = src.width();
+            PerPixelMap newPPM(height, width);
+            newPPM.setMask(src.mask());
+            newPPM.setCellMap(src.cellMap());
+
+            // Fill new PPM
+            for (auto [y, x] : range2D(height, width)) {
+                if (!newPPM.hasMapping(y, x)) {
+                    continue;
+                }
+                newPPM(y, x) = {static_cast<double>(rect.x + x),
+                                static_cast<double>(rect.y + y),
+                                z,
+                                0.0,
+                                0.0,
+                                normal};
             }
-            newPPM(y, x) = {static_cast<double>(x),
-                            static_cast<double>(y),
-                            z,
-                            0.0,
-                            0.0,
-                            normal};
-        }
+            return newPPM;
+        };
 
         // Write the new PPM
         Logger()->info("Writing new PPM...");
-        PerPixelMap::WritePPM(outputPPMPath, newPPM);
+        if (tiledPPM) {
+            io::TiledPPMWriter writer(
+                outputPPMPath, tiledPPM->height(), tiledPPM->width(),
+                tiledPPM->options());
+            for (const auto tile : range(tiledPPM->numTiles())) {
+                const auto rect = tiledPPM->tileRect(tile);
+                const auto src = tiledPPM->readTile(tile);
+                writer.writeTile(tile, layerPPM(src, rect));
+            }
+            writer.close();
+        } else {
+            const cv::Rect rect(
+                0, 0, static_cast<int>(ppm->width()),
+                static_cast<int>(ppm->height()));
+            PerPixelMap::WritePPM(outputPPMPath, layerPPM(*ppm, rect));
+        }
     }
     Logger()->info("Done.");
 }
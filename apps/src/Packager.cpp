@@ -2,8 +2,12 @@
 #include <cstdint>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <optional>
 #include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/program_options.hpp>
@@ -13,11 +17,12 @@
 #include "vc/core/filesystem.hpp"
 #include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/SkyscanMetadataIO.hpp"
+#include "vc/core/io/TIFFIO.hpp"
 #include "vc/core/types/Metadata.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/core/util/FormatStrToRegexStr.hpp"
-#include "vc/core/util/Iteration.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/core/util/String.hpp"
 
 using StringList = std::vector<std::string>;
@@ -27,6 +32,7 @@ namespace fs = volcart::filesystem;
 namespace po = boost::program_options;
 namespace vc = volcart;
 namespace vci = volcart::io;
+namespace tio = volcart::tiffio;
 
 enum class Flip { None, Horizontal, Vertical, ZFlip, Both, All };
 
@@ -47,9 +53,23 @@ struct VolumeInfo {
     Flip flipOption{Flip::None};
     vc::Metadata meta;
     bool compress{false};
+    std::optional<tio::Compression> compression;
+    bool predictor{true};
 };
 
 static bool DoAnalyze{true};
+static std::optional<std::uint32_t> NumWorkers;
+
+// Call fn(i) for every slice index i on numThreads threads, with a progress
+// bar
+template <typename Fn>
+static void RunPass(
+    std::size_t size, std::uint32_t numThreads, const std::string& label, Fn fn)
+{
+    vc::ParallelPass pass(size);
+    auto bar = vc::ReportProgress(pass, label);
+    pass.run(numThreads, fn);
+}
 
 auto ExtractVolumeOptions(
     po::parsed_options& parsed, const po::options_description& volOptDesc)
@@ -92,10 +112,25 @@ auto main(int argc, char* argv[]) -> int
         ("flip,f", po::value<StringList>(),
             "Flip options: Vertical flip (vf), horizontal flip (hf), both, "
             "z-flip (zf), all, [none].")
-        ("compress,c", "Compress slice images");
+        ("compress,c", "Compress slice images. Without --compression, uses "
+            "LZW without a predictor.")
+        ("compression", po::value<StringList>(),
+            "Compression scheme for slice images: lzw, deflate, zstd, lzma. "
+            "Implies --compress. A predictor is applied before compressing "
+            "unless --no-predictor is given. Default: lzw")
+        ("no-predictor", "Do not apply a predictor before compressing with "
+            "--compression. Predictors usually make CT slices smaller, but "
+            "slower to decode.");
+
+    po::options_description performance("Performance");
+    performance.add_options()
+        ("threads,t", po::value<std::uint32_t>(),
+            "Maximum number of slices which are read, converted, and written "
+            "in parallel. Default: The number of hardware threads.");
     
     po::options_description helpOpts("Usage");
-    helpOpts.add(options).add(volpkg_metadata).add(volume_options);
+    helpOpts.add(options).add(volpkg_metadata).add(volume_options).add(
+        performance);
 
     po::options_description all("Usage");
     all.add(helpOpts).add_options()(
@@ -137,6 +172,9 @@ auto main(int argc, char* argv[]) -> int
 
     // Set global opt
     DoAnalyze = args["analyze"].as<bool>();
+    if (args.count("threads") > 0) {
+        NumWorkers = args["threads"].as<std::uint32_t>();
+    }
 
     ///// New VolumePkg /////
     // Get the output volpkg path
@@ -326,8 +364,24 @@ auto GetVolumeInfo(const po::variables_map& parsed) -> VolumeInfo
         }
     }
 
-    // Whether to compress
+    // Whether to compress, and how
     info.compress = parsed.count("compress") != 0;
+    if (parsed.count("compression") != 0) {
+        const auto name = parsed["compression"].as<StringList>().back();
+        try {
+            info.compression = tio::CompressionFromName(name);
+        } catch (const std::invalid_argument&) {
+            std::cerr << "ERROR: Unrecognized compression: " << name << '\n';
+            exit(EXIT_FAILURE);
+        }
+        if (not tio::IsCompressionSupported(*info.compression)) {
+            std::cerr << "ERROR: Compression not supported by libtiff: "
+                      << name << '\n';
+            exit(EXIT_FAILURE);
+        }
+        info.compress = true;
+    }
+    info.predictor = parsed.count("no-predictor") == 0;
 
     return info;
 }
@@ -385,44 +439,143 @@ void AddVolume(vc::VolumePkg::Pointer& volpkg, const VolumeInfo& info)
     // Report the number of slices
     std::cout << "Slice images found: " << slices.size() << std::endl;
 
-    ///// Analyze the slices /////
+    // Slices are processed in parallel, roughly in sorted order
+    const auto numSlices = slices.size();
+    const auto numThreads = vc::NumThreads(NumWorkers);
+    std::cout << "Worker threads: " << numThreads << std::endl;
+
+    ///// Analyze the first slice /////
+    // All other slices are compared to the properties of the first slice
+    auto& first = slices.front();
+    auto firstImage = first.image();
+    if (firstImage.empty()) {
+        std::cerr << "ERROR: Could not read the first slice: " << first.path
+                  << std::endl;
+        return;
+    }
+    first.analyze(firstImage);
+
+    // Slices which need to be scaled are mapped from the range of the whole
+    // volume, which is only known once every slice has been read. 8-bit slices
+    // fit in the output without scaling, so they are written as soon as they
+    // are read and rescaled in place afterwards. Any other type is read a
+    // second time once the range is known.
+    const auto deferScale =
+        DoAnalyze and first.needsScale() and first.type() == CV_8UC1;
+    const auto scaleLater =
+        DoAnalyze and first.needsScale() and not deferScale;
+
+    // Do we need to flip?
+    auto needsFlip = info.flipOption == Flip::Horizontal ||
+                     info.flipOption == Flip::Vertical ||
+                     info.flipOption == Flip::Both ||
+                     info.flipOption == Flip::All;
+    const auto zFlip =
+        info.flipOption == Flip::ZFlip or info.flipOption == Flip::All;
+
+    ///// Add the volume /////
+    // Metadata
+    auto volume = volpkg->newVolume(info.name);
+    volume->setNumberOfSlices(numSlices);
+    volume->setSliceWidth(first.width());
+    volume->setSliceHeight(first.height());
+    volume->setVoxelSize(info.voxelsize);
+    if (info.compression) {
+        volume->setSliceCompression(*info.compression, info.predictor);
+    }
+    volume->saveMetadata();
+
+    // Position of a slice in the volume
+    auto sliceIndex = [&](std::size_t i) {
+        return static_cast<int>(zFlip ? numSlices - 1 - i : i);
+    };
+
+    // Convert, flip, and write a slice
+    auto writeSlice = [&](vc::SliceImage& slice, std::size_t i, cv::Mat tmp) {
+        // Just copy to the volume
+        if (not(slice.needsConvert() || slice.needsScale() || needsFlip ||
+                info.compress)) {
+            fs::copy_file(slice.path, volume->getSlicePath(sliceIndex(i)));
+            return;
+        }
+
+        // Get slice
+        if (tmp.empty()) {
+            tmp = slice.image();
+        }
+        tmp = slice.conform(tmp, not deferScale);
+
+        // Apply flips
+        switch (info.flipOption) {
+            case Flip::All:
+            case Flip::Both:
+                cv::flip(tmp, tmp, -1);
+                break;
+            case Flip::Vertical:
+                cv::flip(tmp, tmp, 0);
+                break;
+            case Flip::Horizontal:
+                cv::flip(tmp, tmp, 1);
+                break;
+            case Flip::ZFlip:
+            case Flip::None:
+                // Do nothing
+                break;
+        }
+
+        // Add to volume. Slices which are rescaled later are compressed then.
+        volume->setSliceData(
+            sliceIndex(i), tmp, info.compress and not deferScale);
+    };
+
+    ///// Read, analyze, and write the slices /////
+    // Each worker handles one slice at a time from reading to writing, so at
+    // most one decoded slice per worker is held in memory
     auto consistent = true;
     auto volMin = std::numeric_limits<double>::max();
     auto volMax = std::numeric_limits<double>::lowest();
+    if (not DoAnalyze) {
+        volMin = MIN_16BPC;
+        volMax = MAX_16BPC;
+        first.setScale(volMax, volMin);
+    }
     std::vector<fs::path> mismatches;
-    if (DoAnalyze) {
-        for (auto& slice : vc::ProgressWrap(slices, "Analyzing slices")) {
-            // Skip if we can't analyze
-            if (!slice.analyze()) {
-                continue;
-            }
+    std::mutex analysisMutex;
+    const auto* label = scaleLater ? "Analyzing slices" : "Saving to volpkg";
+    RunPass(numSlices, numThreads, label, [&](std::size_t i) {
+        auto& slice = slices[i];
+        cv::Mat image;
+        if (i == 0) {
+            image = std::move(firstImage);
+        } else if (DoAnalyze) {
+            image = slice.image();
+            slice.analyze(image);
+        }
 
+        if (DoAnalyze) {
             // Compare all slices to the properties of the first slice
             // Don't quit yet so we can get a list of the problematic files
-            if (slice != *slices.begin()) {
+            std::unique_lock lock(analysisMutex);
+            if (slice != first) {
                 consistent = false;
                 mismatches.push_back(slice.path.filename());
-                continue;
+                return;
             }
 
             // Update the volume's min and max
-            if (slice.min() < volMin) {
-                volMin = slice.min();
-            }
+            volMin = std::min(volMin, slice.min());
+            volMax = std::max(volMax, slice.max());
+        }
 
-            if (slice.max() > volMax) {
-                volMax = slice.max();
-            }
+        if (not scaleLater) {
+            writeSlice(slice, i, std::move(image));
         }
-    } else {
-        // Make sure the first slice is analyzed
-        slices.front().analyze();
-        volMin = MIN_16BPC;
-        volMax = MAX_16BPC;
-    }
+    });
+    firstImage.release();
 
     // Report mismatched slices
     if (not mismatches.empty()) {
+        std::sort(mismatches.begin(), mismatches.end());
         std::cerr << "Found " << mismatches.size();
         std::cerr << " files which did not match the initial slice:";
         std::cerr << std::endl;
@@ -431,24 +584,18 @@ void AddVolume(vc::VolumePkg::Pointer& volpkg, const VolumeInfo& info)
         }
     }
 
-    // Quit if the volume isn't consistent
+    // Quit if the volume isn't consistent, removing any slices which have
+    // already been written
     if (!consistent) {
         std::cerr << "ERROR: Slices in slice directory do not have matching "
                      "properties (width/height/depth)."
                   << std::endl;
+        volpkg->removeVolume(volume->id());
         return;
     }
 
-    ///// Add data to the volume /////
-    // Metadata
-    auto volume = volpkg->newVolume(info.name);
-    volume->setNumberOfSlices(slices.size());
-    volume->setSliceWidth(slices.front().width());
-    volume->setSliceHeight(slices.front().height());
-    volume->setVoxelSize(info.voxelsize);
-
     // Scale min/max values
-    if (slices.begin()->needsScale()) {
+    if (first.needsScale()) {
         volume->setMin(MIN_16BPC);
         volume->setMax(MAX_16BPC);
     } else {
@@ -457,58 +604,26 @@ void AddVolume(vc::VolumePkg::Pointer& volpkg, const VolumeInfo& info)
     }
     volume->saveMetadata();
 
-    if (info.flipOption == Flip::ZFlip or info.flipOption == Flip::All) {
-        std::reverse(slices.begin(), slices.end());
-    }
-
-    // Do we need to flip?
-    auto needsFlip = info.flipOption == Flip::Horizontal ||
-                     info.flipOption == Flip::Vertical ||
-                     info.flipOption == Flip::Both ||
-                     info.flipOption == Flip::All;
-
-    // Move the slices into the VolPkg
-    using vc::enumerate;
-    using vc::ProgressWrap;
-    for (auto pair : ProgressWrap(enumerate(slices), "Saving to volpkg")) {
-        const auto& idx = pair.first;
-        auto& slice = pair.second;
-        // Convert or flip
-        if (slice.needsConvert() || slice.needsScale() || needsFlip ||
-            info.compress) {
-            // Override slice min/max with volume min/max
-            if (slice.needsScale()) {
-                slice.setScale(volMax, volMin);
-            }
-
-            // Get slice
-            auto tmp = slice.conformedImage();
-
-            // Apply flips
-            switch (info.flipOption) {
-                case Flip::All:
-                case Flip::Both:
-                    cv::flip(tmp, tmp, -1);
-                    break;
-                case Flip::Vertical:
-                    cv::flip(tmp, tmp, 0);
-                    break;
-                case Flip::Horizontal:
-                    cv::flip(tmp, tmp, 1);
-                    break;
-                case Flip::ZFlip:
-                case Flip::None:
-                    // Do nothing
-                    break;
-            }
-
-            // Add to volume
-            volume->setSliceData(idx, tmp, info.compress);
-        }
-
-        // Just copy to the volume
-        else {
-            fs::copy_file(slice.path, volume->getSlicePath(idx));
-        }
+    ///// Scale the slices /////
+    if (scaleLater) {
+        // Override slice min/max with volume min/max
+        RunPass(numSlices, numThreads, "Saving to volpkg", [&](auto i) {
+            auto& slice = slices[i];
+            slice.setScale(volMax, volMin);
+            writeSlice(slice, i, {});
+        });
+    } else if (deferScale) {
+        // Same mapping as SliceImage::conform(), applied to the written values
+        const auto alpha = MAX_16BPC / (volMax - volMin);
+        const auto beta = -volMin * alpha;
+        RunPass(numSlices, numThreads, "Scaling slices", [&](auto i) {
+            // Read without the Volume cache, which may memory map the file
+            // that is about to be replaced
+            const auto idx = sliceIndex(i);
+            const auto tmp = tio::ReadTIFF(volume->getSlicePath(idx));
+            cv::Mat scaled;
+            tmp.convertTo(scaled, CV_16U, alpha, beta);
+            volume->setSliceData(idx, scaled, info.compress);
+        });
     }
 }
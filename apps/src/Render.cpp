@@ -209,7 +209,9 @@ auto GetFilteringOpts() -> po::options_description
         ("shading", po::value<int>()->default_value(1),
             "Surface Normal Shading:\n"
                 "  0 = Flat\n"
-                "  1 = Smooth");
+                "  1 = Smooth")
+        ("threads", po::value<std::uint32_t>(), "Maximum number of threads "
+            "used to generate the texture. Default: All hardware threads.");
     // clang-format on
 
     return opts;
@@ -269,7 +271,7 @@ auto GetThicknessOpts() -> po::options_description
     po::options_description opts("Thickness Texture Options");
     opts.add_options()
         ("volume-mask", po::value<std::string>(),
-            "Path to volumetric mask point set")
+            "Path to volumetric mask (.vcmask) or mask point set (.vcps)")
         ("normalize-output", po::value<bool>()->default_value(true),
             "Normalize the output image between [0, 1]");
     // clang-format on
@@ -911,9 +913,15 @@ auto main(int argc, char* argv[]) -> int
     // Setup texturing method
     smgl::Node::Pointer texturing;
     bool textureIsSeq = false;
+    auto setMaxThreads = [&parsed](auto& t) {
+        if (parsed.count("threads") > 0) {
+            t->maxThreads = parsed["threads"].as<std::uint32_t>();
+        }
+    };
     if (method == Method::Intersection) {
         Logger()->debug("Adding intersection texture node");
         auto t = graph->insertNode<IntersectionTextureNode>();
+        setMaxThreads(t);
         texturing = t;
     }
 
@@ -924,6 +932,7 @@ auto main(int argc, char* argv[]) -> int
         auto t = graph->insertNode<CompositeTextureNode>();
         t->generator = *results["generator"];
         t->filter = filter;
+        setMaxThreads(t);
         texturing = t;
     }
 
@@ -953,6 +962,7 @@ auto main(int argc, char* argv[]) -> int
         if (clampToMax) {
             t->clampMax = parsed["clamp-to-max"].as<std::uint16_t>();
         }
+        setMaxThreads(t);
         texturing = t;
     }
 
@@ -981,6 +991,7 @@ auto main(int argc, char* argv[]) -> int
         Logger()->debug("Adding layer texture node");
         auto t = graph->insertNode<LayerTextureNode>();
         t->generator = *results["generator"];
+        setMaxThreads(t);
         texturing = t;
         textureIsSeq = true;
     }
@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <sstream>
 
 #include <boost/program_options.hpp>
@@ -11,14 +18,19 @@
 #include "vc/app_support/ProgressIndicator.hpp"
 #include "vc/apps/render/RenderTexturing.hpp"
 #include "vc/core/filesystem.hpp"
+#include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/ImageIO.hpp"
-#include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/io/TIFFIO.hpp"
+#include "vc/core/io/TiledPPMIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
 #include "vc/core/neighborhood/CuboidGenerator.hpp"
 #include "vc/core/neighborhood/LineGenerator.hpp"
+#include "vc/core/types/Exceptions.hpp"
 #include "vc/core/types/PerPixelMap.hpp"
 #include "vc/core/types/Transforms.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/core/util/DateTime.hpp"
+#include "vc/core/util/Iteration.hpp"
 #include "vc/core/util/Logging.hpp"
 #include "vc/core/util/MemorySizeStringParser.hpp"
 #include "vc/texturing/CompositeTexture.hpp"
@@ -49,6 +61,177 @@ auto GetTransformOpts() -> po::options_description
 
     return opts;
 }
+
+// Memory per pixel of a PPM: the mapping, the mask, and the cell map
+constexpr std::size_t BYTES_PER_PPM_PIXEL{
+    sizeof(cv::Vec6d) + sizeof(std::uint8_t) + sizeof(std::int32_t)};
+
+// Peak memory per pixel of a render tile: the PPM region and its transformed
+// copy, the mapping coordinates (two std::size_t), and the float texture and
+// its copy in the output
+constexpr std::size_t BYTES_PER_TILE_PIXEL{
+    2 * BYTES_PER_PPM_PIXEL + 2 * sizeof(std::size_t) + 2 * sizeof(float)};
+
+// Edge length of the tiles in streamed TIFF output
+constexpr int OUTPUT_TIFF_TILE_SIZE{256};
+
+// Largest render tile which fits in the memory budget. Always a multiple of
+// the output TIFF tile size.
+auto RenderTileSize(std::size_t budget) -> int
+{
+    const auto pixels = static_cast<double>(budget / BYTES_PER_TILE_PIXEL);
+    auto edge = static_cast<int>(std::sqrt(pixels));
+    edge = edge / OUTPUT_TIFF_TILE_SIZE * OUTPUT_TIFF_TILE_SIZE;
+    return std::max(edge, OUTPUT_TIFF_TILE_SIZE);
+}
+
+// Receives the textured tiles of a render. The tiles are either assembled in
+// memory and written on close() or, when streaming, written directly to a
+// tiled TIFF. Streamed outputs which must be normalized are first written to a
+// scratch file and normalized on close(), once the global range is known.
+class TiledOutput
+{
+public:
+    TiledOutput(
+        fs::path path, cv::Size size, int tileSize, bool stream, bool normalize)
+        : path_{std::move(path)}
+        , size_{size}
+        , tileSize_{tileSize}
+        , stream_{stream}
+        , normalize_{normalize}
+    {
+    }
+
+    // Write a textured tile. rect must be a tile of the render grid.
+    void write(const cv::Rect& rect, const cv::Mat& tile)
+    {
+        // Assemble in memory
+        if (not stream_) {
+            if (image_.empty()) {
+                image_ = cv::Mat::zeros(size_, tile.type());
+            }
+            tile.copyTo(image_(rect));
+            return;
+        }
+
+        // Stream to the TIFF
+        type_ = tile.type();
+        if (not normalize_) {
+            if (not writer_) {
+                writer_ = std::make_unique<tiffio::TiledTIFFWriter>(
+                    path_, size_.width, size_.height, type_,
+                    OUTPUT_TIFF_TILE_SIZE);
+            }
+            writer_->write(tile, rect.x, rect.y);
+            return;
+        }
+
+        // Stream to the scratch file and track the range
+        if (not scratch_.is_open()) {
+            scratch_.open(
+                scratch_path_().string(),
+                std::ios::binary | std::ios::in | std::ios::out |
+                    std::ios::trunc);
+            if (not scratch_.is_open()) {
+                throw IOException(
+                    "Failed to open scratch file: " + scratch_path_().string());
+            }
+        }
+        double tileMin{0};
+        double tileMax{0};
+        cv::minMaxLoc(tile, &tileMin, &tileMax);
+        min_ = std::min(min_, tileMin);
+        max_ = std::max(max_, tileMax);
+        const auto continuous = tile.clone();
+        scratch_.seekp(scratch_offset_(rect));
+        scratch_.write(
+            reinterpret_cast<const char*>(continuous.data),
+            static_cast<std::streamsize>(
+                continuous.total() * continuous.elemSize()));
+        if (scratch_.fail()) {
+            throw IOException("Failed to write scratch file");
+        }
+    }
+
+    // Write the remaining output
+    void close()
+    {
+        // Write the in-memory image
+        if (not stream_) {
+            if (normalize_) {
+                cv::normalize(image_, image_, 0.0, 1.0, cv::NORM_MINMAX);
+            }
+            WriteImage(path_, image_);
+            return;
+        }
+
+        // Normalize the scratch tiles into the TIFF. Matches cv::normalize.
+        if (scratch_.is_open()) {
+            const auto range = max_ - min_;
+            const auto scale = range > DBL_EPSILON ? 1.0 / range : 0.0;
+            const auto shift = -min_ * scale;
+            writer_ = std::make_unique<tiffio::TiledTIFFWriter>(
+                path_, size_.width, size_.height, type_,
+                OUTPUT_TIFF_TILE_SIZE);
+            for (auto y = 0; y < size_.height; y += tileSize_) {
+                for (auto x = 0; x < size_.width; x += tileSize_) {
+                    const cv::Rect rect(
+                        x, y, std::min(tileSize_, size_.width - x),
+                        std::min(tileSize_, size_.height - y));
+                    cv::Mat tile(rect.size(), type_);
+                    scratch_.seekg(scratch_offset_(rect));
+                    scratch_.read(
+                        reinterpret_cast<char*>(tile.data),
+                        static_cast<std::streamsize>(
+                            tile.total() * tile.elemSize()));
+                    if (scratch_.fail()) {
+                        throw IOException("Failed to read scratch file");
+                    }
+                    tile.convertTo(tile, -1, scale, shift);
+                    writer_->write(tile, x, y);
+                }
+            }
+            scratch_.close();
+            fs::remove(scratch_path_());
+        }
+
+        if (writer_) {
+            writer_->close();
+        }
+    }
+
+private:
+    // Scratch file path
+    [[nodiscard]] auto scratch_path_() const -> fs::path
+    {
+        return path_.string() + ".scratch";
+    }
+
+    // Offset of a tile in the scratch file. Every tile has a full-sized slot.
+    [[nodiscard]] auto scratch_offset_(const cv::Rect& rect) const
+        -> std::streamoff
+    {
+        const auto cols = (size_.width + tileSize_ - 1) / tileSize_;
+        const auto tile = static_cast<std::streamoff>(rect.y / tileSize_) *
+                              cols +
+                          rect.x / tileSize_;
+        const auto slot = static_cast<std::streamoff>(tileSize_) * tileSize_ *
+                          static_cast<std::streamoff>(CV_ELEM_SIZE(type_));
+        return tile * slot;
+    }
+
+    fs::path path_;
+    cv::Size size_;
+    int tileSize_;
+    bool stream_;
+    bool normalize_;
+    int type_{0};
+    cv::Mat image_;
+    std::unique_ptr<tiffio::TiledTIFFWriter> writer_;
+    std::fstream scratch_;
+    double min_{std::numeric_limits<double>::max()};
+    double max_{std::numeric_limits<double>::lowest()};
+};
 }  // namespace
 
 auto main(int argc, char* argv[]) -> int
@@ -64,9 +247,17 @@ auto main(int argc, char* argv[]) -> int
         ("output-file,o", po::value<std::string>()->required(),
             "Output image file path.")
         ("output-ppm", po::value<std::string>(), "Save a new PPM to the given "
-            "path.")
+            "path. If the input PPM is tiled or --memory-budget is set, the "
+            "new PPM is also tiled.")
         ("tiff-floating-point", "When outputting to the TIFF format, save a "
-            "floating-point image.");
+            "floating-point image.")
+        ("memory-budget", po::value<std::string>(), "Render in streaming "
+            "mode. The PPM is textured in tiles sized to fit the given memory "
+            "budget (e.g. 8G) and each tile is written to the output image as "
+            "soon as it is textured. If --cache-memory-limit is not set, or "
+            "does not fit in the budget, half of the budget is used for the "
+            "volume cache. Requires a TIFF "
+            "output file and works best with a tiled PPM (.tppm).");
 
     po::options_description all("Usage");
     all.add(GetGeneralOpts())
@@ -133,11 +324,32 @@ auto main(int argc, char* argv[]) -> int
         return EXIT_FAILURE;
     }
 
+    // Get the streaming memory budget
+    std::optional<std::size_t> memoryBudget;
+    if (parsed.count("memory-budget") > 0) {
+        auto budgetOpt = parsed["memory-budget"].as<std::string>();
+        memoryBudget = MemorySizeStringParser(budgetOpt);
+        if (not IsFileType(outputPath, {"tif", "tiff"})) {
+            Logger()->error("Streaming mode requires a TIFF output file");
+            return EXIT_FAILURE;
+        }
+    }
+
     // Set the cache size
     std::size_t cacheBytes{SystemMemorySize() / 2};
     if (parsed.count("cache-memory-limit") > 0) {
         auto cacheSizeOpt = parsed["cache-memory-limit"].as<std::string>();
         cacheBytes = MemorySizeStringParser(cacheSizeOpt);
+    } else if (memoryBudget) {
+        cacheBytes = *memoryBudget / 2;
+    }
+    if (memoryBudget and cacheBytes >= *memoryBudget) {
+        Logger()->warn(
+            "Cache memory limit ({}) does not fit in the memory budget ({}). "
+            "Limiting the cache to half of the budget.",
+            BytesToMemorySizeString(cacheBytes),
+            BytesToMemorySizeString(*memoryBudget));
+        cacheBytes = *memoryBudget / 2;
     }
     volume->setCacheMemoryInBytes(cacheBytes);
     Logger()->info(
@@ -191,15 +403,10 @@ auto main(int argc, char* argv[]) -> int
     }
     auto normalize = parsed["normalize-output"].as<bool>();
 
-    // Read the ppm
-    Logger()->info("Loading PPM...");
-    auto ppm = PerPixelMap::New(std::move(PerPixelMap::ReadPPM(inputPPMPath)));
-
-    ///// Transform the PPM /////
+    ///// Load the transform /////
+    Transform3D::Pointer tfm;
     if (parsed.count("transform") > 0) {
-        // load the transform
         auto tfmId = parsed.at("transform").as<std::string>();
-        Transform3D::Pointer tfm;
         if (vpkg->hasTransform(tfmId)) {
             tfm = vpkg->transform(tfmId);
         } else {
@@ -213,10 +420,30 @@ auto main(int argc, char* argv[]) -> int
                 Logger()->warn("Cannot invert transform. Using original.");
             }
         }
+    }
 
-        Logger()->info("Applying transform...");
-        ppm = ApplyTransform(ppm, tfm);
+    // Read the ppm. Tiled PPMs and streamed renders are textured one tile at a
+    // time.
+    const auto streamed = memoryBudget.has_value();
+    PerPixelMap::Pointer ppm;
+    io::TiledPPMReader::Pointer tiledPPM;
+    if (io::IsTiledPPM(inputPPMPath)) {
+        Logger()->info("Opening tiled PPM...");
+        tiledPPM = io::TiledPPMReader::New(inputPPMPath);
+    } else {
+        if (streamed) {
+            Logger()->warn(
+                "PPM is not tiled and will be loaded into memory. Convert it "
+                "to a tiled PPM with vc_ppm_tool to limit memory use.");
+        }
+        Logger()->info("Loading PPM...");
+        ppm = PerPixelMap::New(PerPixelMap::ReadPPM(inputPPMPath));
+        if (tfm and not streamed) {
+            Logger()->info("Applying transform...");
+            ppm = ApplyTransform(ppm, tfm);
+        }
     }
+    const auto tiled = tiledPPM or streamed;
 
     ///// Setup Neighborhood /////
     Logger()->debug("Setting up generator...");
@@ -293,6 +520,8 @@ auto main(int argc, char* argv[]) -> int
         integral->setExponentialDiffBaseMethod(expoDiffBaseMethod);
         integral->setExponentialDiffBaseValue(expoDiffBase);
         integral->setClampValuesToMax(clampToMax);
+        // Tiles are normalized together after texturing
+        integral->setNormalizeOutput(not tiled);
         if (clampToMax) {
             integral->setClampMax(parsed["clamp-to-max"].as<std::uint16_t>());
         }
@@ -308,40 +537,137 @@ auto main(int argc, char* argv[]) -> int
             std::exit(EXIT_FAILURE);
         }
         Logger()->info("Loading volume mask...");
-        auto pts = PointSetIO<cv::Vec3i>::ReadPointSet(maskPath);
-        auto mask = VolumetricMask::New(pts);
+        auto mask = io::LoadVolumetricMask(maskPath);
 
         auto thickness = vct::ThicknessTexture::New();
         thickness->setPerPixelMap(ppm);
         thickness->setVolumetricMask(mask);
-        thickness->setNormalizeOutput(normalize);
+        thickness->setNormalizeOutput(normalize and not tiled);
         textureGen = thickness;
     }
 
-    if (parsed["progress"].as<bool>()) {
-        ProgressConfig cfg;
-        if (parsed.count("progress-interval") > 0) {
-            cfg.interval = DurationFromString(
-                parsed["progress-interval"].as<std::string>());
+    if (parsed.count("threads") > 0) {
+        textureGen->setMaxThreads(parsed["threads"].as<std::uint32_t>());
+    }
+
+    auto enableProgress = parsed["progress"].as<bool>();
+    ProgressConfig cfg;
+    if (parsed.count("progress-interval") > 0) {
+        cfg.interval =
+            DurationFromString(parsed["progress-interval"].as<std::string>());
+    }
+
+    if (tiled) {
+        // Setup the render grid
+        const auto height = static_cast<int>(
+            tiledPPM ? tiledPPM->height() : ppm->height());
+        const auto width =
+            static_cast<int>(tiledPPM ? tiledPPM->width() : ppm->width());
+        auto tileSize = static_cast<int>(
+            tiledPPM ? tiledPPM->options().tileSize : width);
+        if (streamed) {
+            tileSize = ::RenderTileSize(*memoryBudget - cacheBytes);
+        }
+        const auto tileCols = (width + tileSize - 1) / tileSize;
+        const auto tileRows = (height + tileSize - 1) / tileSize;
+        Logger()->info(
+            "Rendering {} tiles of {}x{} pixels", tileCols * tileRows,
+            tileSize, tileSize);
+
+        // Get a region of the input PPM
+        auto readRegion = [&](const cv::Rect& r) {
+            if (tiledPPM) {
+                return tiledPPM->readRegion(r);
+            }
+            return PerPixelMap::Crop(*ppm, r.y, r.x, r.height, r.width);
+        };
+
+        // Optionally write the transformed tiles to a new tiled PPM
+        std::unique_ptr<io::TiledPPMWriter> ppmWriter;
+        if (parsed.count("output-ppm") > 0) {
+            const fs::path outputPPMPath =
+                parsed["output-ppm"].as<std::string>();
+            io::TiledPPMOptions opts;
+            if (tiledPPM) {
+                opts = tiledPPM->options();
+            } else {
+                opts.mask = not ppm->mask().empty();
+                opts.cellMap = not ppm->cellMap().empty();
+            }
+            opts.tileSize = static_cast<std::size_t>(tileSize);
+            ppmWriter = std::make_unique<io::TiledPPMWriter>(
+                outputPPMPath, height, width, opts);
+        }
+
+        // Texture each tile and send it to the output
+        const auto normalizeOutput =
+            method == Method::Integral or
+            (method == Method::Thickness and normalize);
+        ::TiledOutput output(
+            outputPath, {width, height}, tileSize, streamed, normalizeOutput);
+        auto renderTile = [&](std::size_t tile) {
+            const auto x = static_cast<int>(tile % tileCols) * tileSize;
+            const auto y = static_cast<int>(tile / tileCols) * tileSize;
+            const cv::Rect rect(
+                x, y, std::min(tileSize, width - x),
+                std::min(tileSize, height - y));
+            auto tilePPM = PerPixelMap::New(readRegion(rect));
+            if (tfm) {
+                tilePPM = ApplyTransform(tilePPM, tfm);
+            }
+            textureGen->setPerPixelMap(tilePPM);
+            output.write(rect, textureGen->compute()[0]);
+            if (ppmWriter) {
+                ppmWriter->writeTile(tile, *tilePPM);
+            }
+        };
+
+        const auto tiles = range(tileCols * tileRows);
+        if (enableProgress) {
+            Logger()->debug("Texturing...");
+            for (const auto tile : ProgressWrap(tiles, "Texturing:", cfg)) {
+                renderTile(tile);
+            }
+        } else {
+            Logger()->info("Texturing...");
+            for (const auto tile : tiles) {
+                renderTile(tile);
+            }
+        }
+
+        // Write the output
+        Logger()->info("Writing output image...");
+        output.close();
+
+        if (ppmWriter) {
+            Logger()->info("Writing output PPM...");
+            ppmWriter->close();
         }
-        ReportProgress(*textureGen, "Texturing:", cfg);
-        Logger()->debug("Texturing...");
     } else {
-        Logger()->info("Texturing...");
-    }
+        if (enableProgress) {
+            ReportProgress(*textureGen, "Texturing:", cfg);
+            Logger()->debug("Texturing...");
+        } else {
+            Logger()->info("Texturing...");
+        }
 
-    Logger()->debug("Starting texturing algorithm...");
-    auto texture = textureGen->compute();
+        Logger()->debug("Starting texturing algorithm...");
+        auto texture = textureGen->compute();
 
-    // Write the output
-    Logger()->info("Writing output image...");
-    WriteImage(outputPath, texture[0]);
+        // Write the output
+        Logger()->info("Writing output image...");
+        WriteImage(outputPath, texture[0]);
 
-    if (parsed.count("output-ppm") > 0) {
-        Logger()->info("Writing output PPM...");
-        const fs::path outputPPMPath = parsed["output-ppm"].as<std::string>();
-        PerPixelMap::WritePPM(outputPPMPath, *ppm);
+        if (parsed.count("output-ppm") > 0) {
+            Logger()->info("Writing output PPM...");
+            const fs::path outputPPMPath =
+                parsed["output-ppm"].as<std::string>();
+            PerPixelMap::WritePPM(outputPPMPath, *ppm);
+        }
     }
 
+    Logger()->debug(
+        "Memory mapped slices: {} hits, {} misses", volume->getMemoryMapHits(),
+        volume->getMemoryMapMisses());
     Logger()->info("Done.");
 }  // end main
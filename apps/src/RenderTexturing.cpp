@@ -69,7 +69,9 @@ auto GetFilteringOpts() -> po::options_description
         ("shading", po::value<int>()->default_value(1),
             "Surface Normal Shading:\n"
                 "  0 = Flat\n"
-                "  1 = Smooth");
+                "  1 = Smooth")
+        ("threads", po::value<std::uint32_t>(), "Maximum number of threads "
+            "used to generate the texture. Default: All hardware threads.");
     // clang-format on
 
     return opts;
@@ -129,7 +131,7 @@ auto GetThicknessOpts() -> po::options_description
     po::options_description opts("Thickness Texture Options");
     opts.add_options()
         ("volume-mask", po::value<std::string>(),
-            "Path to volumetric mask point set")
+            "Path to volumetric mask (.vcmask) or mask point set (.vcps)")
         ("normalize-output", po::value<bool>()->default_value(true),
             "Normalize the output image between [0, 1]. If enabled "
             "(default), the output file should be a TIFF file and the "
@@ -10,6 +10,8 @@
 #include "vc/app_support/ProgressIndicator.hpp"
 #include "vc/core/filesystem.hpp"
 #include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
+#include "vc/core/math/StructureTensorField.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/core/util/DateTime.hpp"
 #include "vc/core/util/Logging.hpp"
@@ -50,7 +52,7 @@ using VoxelMask = vs::ThinnedFloodFillSegmentation::VoxelMask;
 
 static void WritePointset(const PointSet& pointset);
 static void WriteIntermediatePointset(const PointSet& pointset);
-static void WriteMaskPointset(const VoxelMask& pointset);
+static void WriteMask(const VoxelMask& mask);
 
 auto main(int argc, char* argv[]) -> int
 {
@@ -101,6 +103,10 @@ auto main(int argc, char* argv[]) -> int
             po::value<bool>()->default_value(kDefaultConsiderPrevious),
             "Consider propagation of a point's previous XY position as a "
             "candidate when optimizing each iteration")
+        ("structure-tensors", po::value<std::string>(),
+            "Directory of a precomputed structure tensor field, as created by "
+            "vc_compute_structure_tensors. If provided, normals are looked up "
+            "in the field instead of being computed for every particle.")
         ("visualize", "Display curve visualization as algorithm runs");
 
     // TFF options
@@ -122,7 +128,8 @@ auto main(int argc, char* argv[]) -> int
             "from each seed point (measures horizontally by default)")
         ("save-interval", po::value<int>(),
             "Save the segmentation after a specified number of slices.")
-        ("save-mask","Save the mask created by the segmentation algorithm.");
+        ("save-mask","Save the mask created by the segmentation algorithm to "
+            "mask.vcmask.");
     // clang-format on
     po::options_description all("Usage");
     all.add(GetGeneralOpts()).add(required).add(lrpsOptions).add(tffOptions);
@@ -349,6 +356,17 @@ auto main(int argc, char* argv[]) -> int
         segmenter.setDelta(parsed["delta"].as<double>());
         segmenter.setDistanceWeightFactor(parsed["distance-weight"].as<int>());
         segmenter.setConsiderPrevious(parsed["consider-previous"].as<bool>());
+        if (parsed.count("structure-tensors") > 0) {
+            auto field = vc::StructureTensorField::New(
+                parsed["structure-tensors"].as<std::string>());
+            if (field->volumeID() != volume->id()) {
+                vc::Logger()->warn(
+                    "Structure tensor field was computed for volume {}, not "
+                    "{}",
+                    field->volumeID(), volume->id());
+            }
+            segmenter.setStructureTensorField(field);
+        }
         segmenter.setVisualize(parsed.count("visualize") > 0);
         segmenter.setDumpVis(parsed.count("dump-vis") > 0);
         if (enableProgress) {
@@ -387,7 +405,7 @@ auto main(int argc, char* argv[]) -> int
             }
         }
         if (parsed.count("save-mask") > 0) {
-            segmenter.maskUpdated.connect(WriteMaskPointset);
+            segmenter.maskUpdated.connect(WriteMask);
         }
         if (enableProgress) {
             vc::ReportProgress(segmenter, "Segmenting", cfg);
@@ -421,7 +439,7 @@ static void WriteIntermediatePointset(const PointSet& pointset)
     }
 }
 
-static void WriteMaskPointset(const VoxelMask& pointset)
+static void WriteMask(const VoxelMask& mask)
 {
-    vc::PointSetIO<cv::Vec3i>::WritePointSet("mask_pointset.vcps", pointset);
+    vc::io::WriteVolumetricMask("mask.vcmask", mask);
 }
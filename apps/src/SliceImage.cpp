@@ -42,12 +42,15 @@ auto SliceImage::analyze() -> bool
         return false;
     }
 
+    analyze(image());
+    return true;
+}
+
+void SliceImage::analyze(const cv::Mat& image)
+{
     // Set needsConvert_ if it's not a tif
     needsConvert_ = !io::FileExtensionFilter(path, {"tif", "tiff"});
 
-    auto image =
-        cv::imread(path.string(), cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
-
     w_ = image.cols;
     h_ = image.rows;
 
@@ -60,22 +63,29 @@ auto SliceImage::analyze() -> bool
         needsScale_ = true;
     }
 
-    cv::minMaxLoc(image, &min_, &max_);
-
-    return true;
+    // Unreadable images are reported by the size and type check
+    if (not image.empty()) {
+        cv::minMaxLoc(image, &min_, &max_);
+    }
 }
 
-auto SliceImage::conformedImage() -> cv::Mat
+auto SliceImage::image() const -> cv::Mat
 {
-    // Load the image
-    auto image =
-        cv::imread(path.string(), cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
+    return cv::imread(
+        path.string(), cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
+}
 
+auto SliceImage::conformedImage() -> cv::Mat { return conform(image()); }
+
+auto SliceImage::conform(cv::Mat image, const bool scale) const -> cv::Mat
+{
     // Remap values to 16 bit
-    if (needsScale_) {
+    if (needsScale_ and scale) {
         image.convertTo(
             image, CV_16U, MAX_16BPC / (max_ - min_),
             -min_ * MAX_16BPC / (max_ - min_));
+    } else if (needsScale_) {
+        image.convertTo(image, CV_16U);
     }
 
     // Convert colorspace to grayscale
@@ -37,66 +37,70 @@ void vc::VolumeClient::newConnection()
     // 20180509123106
     // 20180509123119
     vc::Logger()->info("Connection established.");
-    protocol::RequestHdr requestHdr;
-    requestHdr.numRequests = 2;
-    client_->write(
-        reinterpret_cast<char*>(&requestHdr), sizeof(protocol::RequestHdr));
-    client_->flush();
-    for (std::uint32_t i = 0; i < requestHdr.numRequests; i++) {
-        // Neighborhood should be 27 with these settings
-        protocol::RequestArgs requestArgs;
-        std::memset(&requestArgs, 0, sizeof(requestArgs));
-        std::strncpy(requestArgs.volpkg, "CarbonSquares", protocol::VOLPKG_SZ);
-        std::strncpy(requestArgs.volume, "20180509123106", protocol::VOLUME_SZ);
-        requestArgs.centerX = 100.0f;
-        requestArgs.centerY = 50.0f;
-        requestArgs.centerZ = 100.0f;
-        requestArgs.basis0X = 1.0f;
-        requestArgs.basis1Y = 1.0f;
-        requestArgs.basis2Z = 1.0f;
-        requestArgs.samplingRX = 40.0f;
-        requestArgs.samplingRY = 20.0f;
-        requestArgs.samplingRZ = 40.0f;
-        requestArgs.samplingInterval = 1.0f / (i + 1);
+
+    // V2 connections stay open, so the requests are sent as two packets
+    // without waiting for responses
+    constexpr std::uint32_t numPackets = 2;
+    constexpr std::uint32_t requestsPerPacket = 2;
+    std::uint64_t id{0};
+    for (std::uint32_t p = 0; p < numPackets; p++) {
+        protocol::RequestHdr requestHdr;
+        requestHdr.version = protocol::V2;
+        requestHdr.numRequests = requestsPerPacket;
         client_->write(
-            reinterpret_cast<char*>(&requestArgs),
-            sizeof(protocol::RequestArgs));
-        client_->flush();
+            reinterpret_cast<char*>(&requestHdr), sizeof(protocol::RequestHdr));
+        for (std::uint32_t i = 0; i < requestHdr.numRequests; i++) {
+            // Neighborhood should be 27 with these settings
+            protocol::RequestArgsV2 requestArgs;
+            std::memset(&requestArgs, 0, sizeof(requestArgs));
+            requestArgs.id = id++;
+            auto& args = requestArgs.args;
+            std::strncpy(args.volpkg, "CarbonSquares", protocol::VOLPKG_SZ);
+            std::strncpy(args.volume, "20180509123106", protocol::VOLUME_SZ);
+            args.centerX = 100.0f;
+            args.centerY = 50.0f;
+            args.centerZ = 100.0f;
+            args.basis0X = 1.0f;
+            args.basis1Y = 1.0f;
+            args.basis2Z = 1.0f;
+            args.samplingRX = 40.0f;
+            args.samplingRY = 20.0f;
+            args.samplingRZ = 40.0f;
+            args.samplingInterval = 1.0f / (i + 1);
+            client_->write(
+                reinterpret_cast<char*>(&requestArgs),
+                sizeof(protocol::RequestArgsV2));
+        }
     }
-    // Read response from server
-    auto* responseArgs = new protocol::ResponseArgs[requestHdr.numRequests];
+    client_->flush();
+
+    // Read responses from the server. They may arrive in any order.
+    std::uint64_t numResponses{0};
     QDataStream* dataStream = new QDataStream(client_);
-    while (client_->waitForReadyRead()) {
-        dataStream->startTransaction();
-        bool abort = false;
-        for (std::uint32_t i = 0; i < requestHdr.numRequests; i++) {
+    while (numResponses < id and client_->waitForReadyRead()) {
+        while (numResponses < id) {
+            dataStream->startTransaction();
+            protocol::ResponseArgsV2 responseArgs;
             int bytesArgs = dataStream->readRawData(
-                reinterpret_cast<char*>(&responseArgs[i]),
-                sizeof(protocol::ResponseArgs));
-            if (bytesArgs != sizeof(protocol::ResponseArgs)) {
-                dataStream->rollbackTransaction();
-                abort = true;
-                break;
-            }
-            vc::Logger()->info("Skipping {} bytes.", responseArgs[i].size);
-            int bytesSkipped = dataStream->skipRawData(responseArgs[i].size);
-            if (bytesSkipped != responseArgs[i].size) {
+                reinterpret_cast<char*>(&responseArgs),
+                sizeof(protocol::ResponseArgsV2));
+            if (bytesArgs != sizeof(protocol::ResponseArgsV2) or
+                dataStream->skipRawData(static_cast<int>(responseArgs.size)) !=
+                    static_cast<int>(responseArgs.size)) {
                 dataStream->rollbackTransaction();
-                abort = true;
                 break;
             }
+            dataStream->commitTransaction();
+            numResponses++;
+            vc::Logger()->info("=== Response: #{} ===", responseArgs.id);
+            vc::Logger()->info(
+                "Status: {}", static_cast<std::uint32_t>(responseArgs.status));
+            vc::Logger()->info(
+                "Extents: {}x{}x{}", responseArgs.extentX,
+                responseArgs.extentY, responseArgs.extentZ);
         }
-        if (!abort && dataStream->commitTransaction()) {
-            break;
-        }
-    }
-    for (std::uint32_t i = 0; i < requestHdr.numRequests; i++) {
-        vc::Logger()->info("=== Response: #{} ===", i);
-        vc::Logger()->info("Volume Package: {}", responseArgs[i].volpkg);
-        vc::Logger()->info("Volume: {}", responseArgs[i].volume);
     }
     delete dataStream;
-    delete[] responseArgs;
     client_->disconnectFromHost();
     emit finished();
 }
@@ -0,0 +1,174 @@
+#include "vc/apps/server/VolumeProtocolIO.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace vc = volcart;
+namespace protocol = volcart::protocol;
+
+namespace
+{
+// Serialize a response header followed by the subvolume, if there is one
+template <typename Hdr>
+auto Serialize(Hdr hdr, const vc::Neighborhood* neighborhood) -> QByteArray
+{
+    std::size_t dataSize{0};
+    if (neighborhood != nullptr) {
+        dataSize = sizeof(std::uint16_t) * neighborhood->size();
+        const auto extents = neighborhood->extents();
+        hdr.size = static_cast<std::uint32_t>(dataSize);
+        hdr.extentX = static_cast<std::uint32_t>(extents[2]);
+        hdr.extentY = static_cast<std::uint32_t>(extents[1]);
+        hdr.extentZ = static_cast<std::uint32_t>(extents[0]);
+    }
+    QByteArray bytes(static_cast<qsizetype>(sizeof(Hdr) + dataSize), 0);
+    std::memcpy(bytes.data(), &hdr, sizeof(Hdr));
+    if (dataSize > 0) {
+        std::memcpy(bytes.data() + sizeof(Hdr), neighborhood->data(), dataSize);
+    }
+    return bytes;
+}
+}  // namespace
+
+auto protocol::RequestReader::bytesNeeded() const -> std::size_t
+{
+    if (done()) {
+        return 0;
+    }
+    if (remaining_ == 0) {
+        return sizeof(RequestHdr);
+    }
+    return version_ == V1 ? sizeof(RequestArgs) : sizeof(RequestArgsV2);
+}
+
+auto protocol::RequestReader::read(const char* data) -> std::optional<Request>
+{
+    if (done()) {
+        throw std::logic_error("Connection does not accept more requests");
+    }
+
+    // Packet header
+    if (remaining_ == 0) {
+        RequestHdr hdr;
+        std::memcpy(&hdr, data, sizeof(RequestHdr));
+        if (hdr.magic != MAGIC) {
+            throw std::runtime_error(
+                "magic value is incorrect: " + std::to_string(hdr.magic));
+        }
+        if ((hdr.version != V1 and hdr.version != V2) or
+            version_.value_or(hdr.version) != hdr.version) {
+            throw std::runtime_error(
+                "version is unsupported: " +
+                std::to_string(static_cast<std::uint32_t>(hdr.version)));
+        }
+        if (hdr.numRequests > MAX_REQUESTS) {
+            throw std::runtime_error(
+                "too many requests: " + std::to_string(hdr.numRequests));
+        }
+        version_ = hdr.version;
+        remaining_ = hdr.numRequests;
+        return std::nullopt;
+    }
+
+    // Request arguments
+    Request request;
+    std::memset(&request.args, 0, sizeof(RequestArgsV2));
+    if (version_ == V1) {
+        std::memcpy(&request.args.args, data, sizeof(RequestArgs));
+    } else {
+        std::memcpy(&request.args, data, sizeof(RequestArgsV2));
+    }
+    request.index = numRequests_++;
+    remaining_--;
+    return request;
+}
+
+auto protocol::RequestReader::version() const -> std::optional<Version>
+{
+    return version_;
+}
+
+auto protocol::RequestReader::remaining() const -> std::uint32_t
+{
+    return remaining_;
+}
+
+auto protocol::RequestReader::done() const -> bool
+{
+    return version_ == V1 and remaining_ == 0;
+}
+
+protocol::ResponseQueue::ResponseQueue(
+    const Version version, const std::uint32_t batchSize)
+    : version_{version}, batchSize_{version == V1 ? batchSize : 0}
+{
+}
+
+auto protocol::ResponseQueue::add(
+    const std::uint32_t index, QByteArray response) -> std::vector<QByteArray>
+{
+    // V2 responses are sent as soon as they're ready
+    if (version_ == V2) {
+        return {std::move(response)};
+    }
+
+    // V1 responses are sent in request order, as soon as every earlier
+    // response has been sent
+    if (index < next_ or index >= batchSize_ or held_.count(index) > 0) {
+        throw std::out_of_range(
+            "Response index out of range: " + std::to_string(index));
+    }
+    if (index > next_) {
+        heldBytes_ += static_cast<std::size_t>(response.size());
+        held_.emplace(index, std::move(response));
+        return {};
+    }
+    std::vector<QByteArray> ready{std::move(response)};
+    next_++;
+    for (auto it = held_.begin(); it != held_.end() and it->first == next_;
+         it = held_.erase(it)) {
+        heldBytes_ -= static_cast<std::size_t>(it->second.size());
+        ready.push_back(std::move(it->second));
+        next_++;
+    }
+    return ready;
+}
+
+auto protocol::ResponseQueue::complete() const -> bool
+{
+    return version_ == V1 and next_ == batchSize_;
+}
+
+auto protocol::ResponseQueue::held() const -> std::size_t
+{
+    return held_.size();
+}
+
+auto protocol::ResponseQueue::heldBytes() const -> std::size_t
+{
+    return heldBytes_;
+}
+
+auto protocol::SerializeResponse(
+    const RequestArgs& args, const Neighborhood* neighborhood) -> QByteArray
+{
+    ResponseArgs hdr;
+    std::memset(&hdr, 0, sizeof(ResponseArgs));
+    std::strncpy(hdr.volpkg, args.volpkg, VOLPKG_SZ);
+    std::strncpy(hdr.volume, args.volume, VOLUME_SZ);
+    return ::Serialize(hdr, neighborhood);
+}
+
+auto protocol::SerializeResponse(
+    const std::uint64_t id,
+    const Status status,
+    const Neighborhood* neighborhood) -> QByteArray
+{
+    ResponseArgsV2 hdr;
+    std::memset(&hdr, 0, sizeof(ResponseArgsV2));
+    hdr.id = id;
+    hdr.status = status;
+    return ::Serialize(hdr, neighborhood);
+}
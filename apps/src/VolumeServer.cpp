@@ -1,16 +1,54 @@
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
 
 #include <QCoreApplication>
-#include <QSignalMapper>
+#include <QMetaObject>
 
 #include "vc/app_support/GetMemorySize.hpp"
 #include "vc/apps/server/VolumeServer.hpp"
 #include "vc/core/neighborhood/CuboidGenerator.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
 
 namespace vc = volcart;
+namespace protocol = volcart::protocol;
+
+namespace
+{
+// Generate the subvolume for a request
+auto Subvolume(
+    const vc::Volume::Pointer& volume, const protocol::RequestArgsV2& req)
+    -> vc::Neighborhood
+{
+    const auto& args = req.args;
+    vc::CuboidGenerator subvolume;
+    // This must be in x/y/z order.
+    cv::Vec3d center{args.centerX, args.centerY, args.centerZ};
+    cv::Vec3d xvec{args.basis0X, args.basis0Y, args.basis0Z};
+    cv::Vec3d yvec{args.basis1X, args.basis1Y, args.basis1Z};
+    cv::Vec3d zvec{args.basis2X, args.basis2Y, args.basis2Z};
+    // This must be in z/y/x order.
+    subvolume.setSamplingRadius(
+        args.samplingRZ, args.samplingRY, args.samplingRX);
+    subvolume.setSamplingInterval(args.samplingInterval);
+    subvolume.setSamplingLevel(static_cast<int>(req.level));
+    // This must be in z/y/x order.
+    return subvolume.compute(volume, center, {zvec, yvec, xvec});
+}
+
+// Identifiers may fill their buffers without a null terminator
+auto Identifier(const char* id, std::size_t size) -> std::string
+{
+    return {id, std::find(id, id + size, '\0')};
+}
+}  // namespace
 
 auto vc::VolumeServer::socketStr_(QTcpSocket* socket) -> std::string
 {
@@ -19,9 +57,24 @@ auto vc::VolumeServer::socketStr_(QTcpSocket* socket) -> std::string
 }
 
 vc::VolumeServer::VolumeServer(
-    VolumePkgMap volpkgs, quint16 port, std::size_t memory, QObject* parent)
-    : QObject{parent}, volpkgs_{volpkgs}, memory_{memory}
+    VolumePkgMap volpkgs,
+    quint16 port,
+    std::size_t memory,
+    std::optional<std::uint32_t> numThreads,
+    QObject* parent)
+    : QObject{parent}, volpkgs_{volpkgs}, pool_{NumThreads(numThreads)}
 {
+    // Split the memory between every volume which can be requested, so that
+    // loading a volume never shrinks the caches of the others
+    std::size_t numVolumes{0};
+    for (const auto& pair : volpkgs_) {
+        numVolumes += pair.second.numberOfVolumes();
+    }
+    memoryPerVolume_ = memory / std::max<std::size_t>(numVolumes, 1);
+    vc::Logger()->info(
+        "Memory per volume: {} bytes. Worker threads: {}", memoryPerVolume_,
+        pool_.numThreads());
+
     server_ = new QTcpServer(this);
     connect(
         server_, &QTcpServer::newConnection, this,
@@ -33,147 +86,219 @@ vc::VolumeServer::VolumeServer(
     }
 }
 
-void vc::VolumeServer::socketReadyRead(QDataStream* dataStream)
+void vc::VolumeServer::socketReadyRead(QTcpSocket* socket)
 {
-    QTcpSocket* socket = reinterpret_cast<QTcpSocket*>(dataStream->device());
-    // Read all data from the socket
-    dataStream->startTransaction();
-    protocol::RequestHdr requestHdr;
-    int bytesHdr = dataStream->readRawData(
-        reinterpret_cast<char*>(&requestHdr), sizeof(requestHdr));
-    if (bytesHdr != sizeof(protocol::RequestHdr)) {
-        dataStream->rollbackTransaction();
-        return;
-    }
-    if (requestHdr.magic != protocol::MAGIC) {
-        vc::Logger()->error(
-            "{}: magic value is incorrect: {}", socketStr_(socket),
-            requestHdr.magic);
-        // TODO: actually exit
-    }
-    if (requestHdr.version != protocol::V1) {
-        vc::Logger()->error(
-            "{}: version is unsupported: {}", socketStr_(socket),
-            static_cast<std::uint32_t>(requestHdr.version));
-        // TODO: actually exit
-    }
-    vc::Logger()->info(
-        "{}: Need to resolve {} requests.", socketStr_(socket),
-        requestHdr.numRequests);
-    protocol::RequestArgs* requestArgs =
-        new protocol::RequestArgs[requestHdr.numRequests];
-
-    dataStream->startTransaction();
-    int bytesArgs = dataStream->readRawData(
-        reinterpret_cast<char*>(requestArgs),
-        sizeof(protocol::RequestArgs) * requestHdr.numRequests);
-    if (bytesArgs !=
-        static_cast<int>(
-            sizeof(protocol::RequestArgs) * requestHdr.numRequests)) {
-        dataStream->rollbackTransaction();
-    } else {
-        dataStream->commitTransaction();
-    }
-    if (!dataStream->commitTransaction()) {
-        delete[] requestArgs;
+    auto it = connections_.find(socket);
+    if (it == connections_.end()) {
         return;
     }
-    // Resolve requests
-    for (std::uint32_t i = 0; i < requestHdr.numRequests; i++) {
-        resolveRequest_(socket, &requestArgs[i]);
+    auto& conn = it->second;
+
+    std::array<char, sizeof(protocol::RequestArgsV2)> buffer;
+    while (true) {
+        // A V1 connection only carries one batch of requests
+        if (conn.reader.done()) {
+            socket->readAll();
+            return;
+        }
+
+        // Leave requests unread until the connection catches up. V1
+        // responses held for ordering count as unresolved and unsent.
+        const auto held = conn.responses.held();
+        const auto unsent = socket->bytesToWrite() +
+                            static_cast<qint64>(conn.responses.heldBytes());
+        conn.paused = conn.outstanding + held >= MAX_OUTSTANDING_REQUESTS or
+                      unsent > MAX_UNSENT_BYTES;
+        if (conn.paused) {
+            return;
+        }
+
+        // Read a packet header or the arguments of the next request
+        const auto needed = conn.reader.bytesNeeded();
+        if (socket->bytesAvailable() < static_cast<qint64>(needed)) {
+            return;
+        }
+        socket->read(buffer.data(), static_cast<qint64>(needed));
+        std::optional<protocol::Request> request;
+        try {
+            request = conn.reader.read(buffer.data());
+        } catch (const std::exception& e) {
+            vc::Logger()->error("{}: {}", socketStr_(socket), e.what());
+            socket->abort();
+            return;
+        }
+
+        if (not request) {
+            const auto version = *conn.reader.version();
+            vc::Logger()->info(
+                "{}: Need to resolve {} requests.", socketStr_(socket),
+                conn.reader.remaining());
+            if (version == protocol::V1) {
+                conn.responses = {version, conn.reader.remaining()};
+                if (conn.responses.complete()) {
+                    socket->disconnectFromHost();
+                    return;
+                }
+            } else {
+                conn.responses = {version, 0};
+            }
+            continue;
+        }
+
+        conn.outstanding++;
+        submitRequest_(
+            socket, request->index, request->args, *conn.reader.version());
+
+        // A failed V1 request can complete the batch and close the socket
+        if (connections_.count(socket) == 0) {
+            return;
+        }
     }
-    // Clean up
-    vc::Logger()->info("{}: Closing connection...", socketStr_(socket));
-    delete[] requestArgs;
-    delete dataStream;
-    socket->disconnectFromHost();
 }
 
 void vc::VolumeServer::acceptConnection()
 {
     QTcpSocket* socket = server_->nextPendingConnection();
-    connect(
-        socket, &QAbstractSocket::disconnected, socket, &QObject::deleteLater);
+    connections_.emplace(socket, Connection{});
+    // Limit how much Qt reads ahead of the requests which have been parsed
+    socket->setReadBufferSize(READ_BUFFER_BYTES);
+    connect(socket, &QAbstractSocket::disconnected, this, [this, socket] {
+        vc::Logger()->info("{}: Connection closed.", socketStr_(socket));
+        connections_.erase(socket);
+        socket->deleteLater();
+    });
     vc::Logger()->info("{}: Accepted connection...", socketStr_(socket));
-    QDataStream* dataStream = new QDataStream(socket);
-    connect(socket, &QTcpSocket::readyRead, [this, dataStream] {
-        socketReadyRead(dataStream);
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket] {
+        socketReadyRead(socket);
+    });
+    connect(socket, &QTcpSocket::bytesWritten, this, [this, socket] {
+        resume_(socket);
     });
 }
 
-void vc::VolumeServer::resolveRequest_(
-    QTcpSocket* socket, protocol::RequestArgs* args)
+auto vc::VolumeServer::volume_(
+    QTcpSocket* socket, const protocol::RequestArgs& args) -> Volume::Pointer
 {
-    Volume::Pointer volume = nullptr;
-    protocol::ResponseArgs responseArgs;
-    std::memset(&responseArgs, 0, sizeof(protocol::ResponseArgs));
-    std::strncpy(responseArgs.volpkg, args->volpkg, protocol::VOLPKG_SZ);
-    std::strncpy(responseArgs.volume, args->volume, protocol::VOLUME_SZ);
-    if (!volumes_.count(args->volume)) {
-        vc::Logger()->info(
-            "{}: Request for volume ({}, {}): need to load for the first "
-            "time",
-            socketStr_(socket), args->volpkg, args->volume);
+    const auto volpkgID = ::Identifier(args.volpkg, protocol::VOLPKG_SZ);
+    const auto volumeID = ::Identifier(args.volume, protocol::VOLUME_SZ);
+    const auto key = volpkgID + "/" + volumeID;
+    if (auto it = volumes_.find(key); it != volumes_.end()) {
+        return it->second;
+    }
+
+    vc::Logger()->info(
+        "{}: Request for volume ({}, {}): need to load for the first time",
+        socketStr_(socket), volpkgID, volumeID);
+    try {
+        auto volume = volpkgs_.at(volpkgID).volume(volumeID);
+        // The volume shares the budget with its levels
+        volume->setCacheMemoryInBytes(memoryPerVolume_);
+        if (volume->getCacheCapacity() < 1) {
+            throw std::runtime_error("Cache capacity is 0");
+        }
+        volumes_.insert({key, volume});
+        return volume;
+    } catch (const std::exception& e) {
+        vc::Logger()->error("Unable to load volume: {}", e.what());
+        return nullptr;
+    }
+}
+
+void vc::VolumeServer::submitRequest_(
+    QTcpSocket* socket,
+    const std::uint32_t index,
+    const protocol::RequestArgsV2& args,
+    const protocol::Version version)
+{
+    // Volumes are loaded here, so the workers only share loaded volumes
+    const auto volume = volume_(socket, args.args);
+    auto status = protocol::Success;
+    if (not volume) {
+        status = protocol::VolumeNotFound;
+    } else if (
+        args.level >= static_cast<std::uint32_t>(volume->numLevels())) {
+        status = protocol::InvalidRequest;
+    }
+    if (status != protocol::Success) {
+        sendResponse_(
+            socket, index,
+            version == protocol::V1
+                ? protocol::SerializeResponse(args.args, nullptr)
+                : protocol::SerializeResponse(args.id, status, nullptr));
+        return;
+    }
+
+    // Generate the subvolume on a worker, then hand the response back to the
+    // event loop, which owns the socket
+    QPointer<QTcpSocket> target{socket};
+    pool_.submit([this, target, index, args, version, volume]() {
+        QByteArray response;
         try {
-            volume = volpkgs_.at(args->volpkg).volume(args->volume);
-            volumes_.insert({args->volume, volume});
-            // Update memory allocation distribution for all loaded volumes
-            std::size_t memPerVolume = static_cast<std::size_t>(
-                static_cast<double>(memory_) /
-                static_cast<double>(volumes_.size()));
-            vc::Logger()->info(
-                "Reallocating memory per loaded volume to {} bytes.",
-                memPerVolume);
-            for (auto& pair : volumes_) {
-                try {
-                    pair.second->setCacheMemoryInBytes(memPerVolume);
-                    if (pair.second->getCacheCapacity() < 1) {
-                        throw std::runtime_error("Cache capacity is 0");
-                    }
-                } catch (const std::exception& e) {
-                    vc::Logger()->error("{}", e.what());
-                    // TODO: exit or something
-                }
-            }
-        } catch (std::exception& e) {
-            // TODO: solve this
-            vc::Logger()->error("Unable to load volume: {}", e.what());
-            socket->write(
-                reinterpret_cast<char*>(&responseArgs),
-                sizeof(protocol::ResponseArgs));
-            return;
+            const auto neighborhood = ::Subvolume(volume, args);
+            response = version == protocol::V1
+                           ? protocol::SerializeResponse(
+                                 args.args, &neighborhood)
+                           : protocol::SerializeResponse(
+                                 args.id, protocol::Success, &neighborhood);
+        } catch (const std::exception& e) {
+            vc::Logger()->error("Unable to generate subvolume: {}", e.what());
+            response = version == protocol::V1
+                           ? protocol::SerializeResponse(args.args, nullptr)
+                           : protocol::SerializeResponse(
+                                 args.id, protocol::InternalError, nullptr);
         }
-    } else {
-        volume = volumes_.at(args->volume);
+        QMetaObject::invokeMethod(
+            this,
+            [this, target, index, response]() {
+                sendResponse_(target, index, response);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void vc::VolumeServer::sendResponse_(
+    const QPointer<QTcpSocket>& socket,
+    const std::uint32_t index,
+    const QByteArray& response)
+{
+    // The client may have disconnected while the request was being resolved
+    if (socket.isNull()) {
+        return;
+    }
+    auto it = connections_.find(socket.data());
+    if (it == connections_.end()) {
+        return;
+    }
+    auto& conn = it->second;
+    conn.outstanding--;
+    for (const auto& r : conn.responses.add(index, response)) {
+        socket->write(r);
+    }
+    if (conn.responses.complete()) {
         vc::Logger()->info(
-            "{}: Request for volume ({}, {}): found in cache",
-            socketStr_(socket), args->volpkg, args->volume);
+            "{}: Closing connection...", socketStr_(socket.data()));
+        socket->disconnectFromHost();
+        return;
     }
-    // Generate subvolume for this request
-    vc::CuboidGenerator subvolume;
-    // This must be in x/y/z order.
-    cv::Vec3d center{args->centerX, args->centerY, args->centerZ};
-    cv::Vec3d xvec{args->basis0X, args->basis0Y, args->basis0Z};
-    cv::Vec3d yvec{args->basis1X, args->basis1Y, args->basis0Z};
-    cv::Vec3d zvec{args->basis2X, args->basis2Y, args->basis2Z};
-    // This must be in z/y/x order.
-    subvolume.setSamplingRadius(
-        args->samplingRZ, args->samplingRY, args->samplingRX);
-    subvolume.setSamplingInterval(args->samplingInterval);
-    // This must be in z/y/x order.
-    vc::Neighborhood neighborhood =
-        subvolume.compute(volume, center, {zvec, yvec, xvec});
-    vc::Logger()->info("{}: Subvolume generated...", socketStr_(socket));
-    responseArgs.size =
-        static_cast<std::uint32_t>(neighborhood.size() * sizeof(uint16_t));
-    auto extents = neighborhood.extents();
-    responseArgs.extentX = static_cast<std::uint32_t>(extents[2]);
-    responseArgs.extentY = static_cast<std::uint32_t>(extents[1]);
-    responseArgs.extentZ = static_cast<std::uint32_t>(extents[0]);
-    socket->write(
-        reinterpret_cast<char*>(&responseArgs), sizeof(protocol::ResponseArgs));
-    socket->write(
-        reinterpret_cast<char*>(neighborhood.data()),
-        sizeof(std::uint16_t) * neighborhood.size());
-    socket->flush();
+    resume_(socket.data());
+}
+
+void vc::VolumeServer::resume_(QTcpSocket* socket)
+{
+    auto it = connections_.find(socket);
+    if (it == connections_.end() or not it->second.paused) {
+        return;
+    }
+    // Read on a later pass of the event loop, since responses to invalid
+    // requests are sent while reading
+    it->second.paused = false;
+    QPointer<QTcpSocket> target{socket};
+    QMetaObject::invokeMethod(
+        this,
+        [this, target]() {
+            if (not target.isNull()) {
+                socketReadyRead(target.data());
+            }
+        },
+        Qt::QueuedConnection);
 }
@@ -1,5 +1,7 @@
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <optional>
 
 #include <boost/program_options.hpp>
 
@@ -30,7 +32,8 @@ auto main(int argc, char* argv[]) -> int
         ("help,h", "Show this message")
         ("port,p", po::value<quint16>()->default_value(8087), "Port to listen on")
         ("memory,m", po::value<std::string>()->required(), "Memory to reserve for the server in bytes (accepts K, M, G, T suffixes)")
-        ("volpkg,v", po::value(&volpkgPaths)->multitoken()->required(), "VolumePkg path (required, repeatable option)");
+        ("volpkg,v", po::value(&volpkgPaths)->multitoken()->required(), "VolumePkg path (required, repeatable option)")
+        ("threads,t", po::value<std::uint32_t>(), "Number of worker threads which generate subvolumes. Default: The number of hardware threads.");
 
     po::options_description all("Usage");
     all.add(required);
@@ -75,6 +78,12 @@ auto main(int argc, char* argv[]) -> int
     vc::Logger()->info(
         "Server will use no more than {} bytes of memory for volumes.", memory);
 
+    // Get the number of worker threads
+    std::optional<std::uint32_t> threads;
+    if (parsed.count("threads")) {
+        threads = parsed["threads"].as<std::uint32_t>();
+    }
+
     // Load the volume packages
     vc::VolumeServer::VolumePkgMap volpkgs;
     for (auto volpkgPath : volpkgPaths) {
@@ -105,7 +114,7 @@ auto main(int argc, char* argv[]) -> int
 
     // Start the QtCoreApplication
     QCoreApplication application(argc, argv);
-    vc::VolumeServer server(volpkgs, port, memory);
+    vc::VolumeServer server(volpkgs, port, memory, threads);
     QObject::connect(
         &server, &vc::VolumeServer::finished, &application,
         &QCoreApplication::quit);
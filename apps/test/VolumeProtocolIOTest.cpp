@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "vc/apps/server/VolumeProtocolIO.hpp"
+
+using namespace volcart;
+using namespace volcart::protocol;
+
+namespace
+{
+// Serialize a packet header
+auto Header(Version version, std::uint32_t numRequests) -> std::vector<char>
+{
+    RequestHdr hdr;
+    std::memset(&hdr, 0, sizeof(RequestHdr));
+    hdr.magic = MAGIC;
+    hdr.version = version;
+    hdr.numRequests = numRequests;
+    std::vector<char> bytes(sizeof(RequestHdr));
+    std::memcpy(bytes.data(), &hdr, sizeof(RequestHdr));
+    return bytes;
+}
+
+// Serialize V2 request arguments
+auto ArgsV2(std::uint64_t id, std::uint32_t level) -> std::vector<char>
+{
+    RequestArgsV2 args;
+    std::memset(&args, 0, sizeof(RequestArgsV2));
+    args.id = id;
+    args.level = level;
+    std::strncpy(args.args.volpkg, "pkg", VOLPKG_SZ);
+    std::strncpy(args.args.volume, "vol", VOLUME_SZ);
+    args.args.centerX = 1;
+    std::vector<char> bytes(sizeof(RequestArgsV2));
+    std::memcpy(bytes.data(), &args, sizeof(RequestArgsV2));
+    return bytes;
+}
+
+// Serialize V1 request arguments
+auto ArgsV1(float centerX) -> std::vector<char>
+{
+    RequestArgs args;
+    std::memset(&args, 0, sizeof(RequestArgs));
+    std::strncpy(args.volpkg, "pkg", VOLPKG_SZ);
+    std::strncpy(args.volume, "vol", VOLUME_SZ);
+    args.centerX = centerX;
+    std::vector<char> bytes(sizeof(RequestArgs));
+    std::memcpy(bytes.data(), &args, sizeof(RequestArgs));
+    return bytes;
+}
+
+// Pass bytes to the reader, which must need exactly that many
+auto Read(RequestReader& reader, const std::vector<char>& bytes)
+    -> std::optional<Request>
+{
+    EXPECT_EQ(reader.bytesNeeded(), bytes.size());
+    return reader.read(bytes.data());
+}
+}  // namespace
+
+TEST(VolumeProtocolIO, ReadV2)
+{
+    RequestReader reader;
+    EXPECT_FALSE(reader.version().has_value());
+    EXPECT_FALSE(reader.done());
+
+    // Packets of any size follow each other on the same connection
+    EXPECT_FALSE(::Read(reader, ::Header(V2, 2)).has_value());
+    ASSERT_TRUE(reader.version().has_value());
+    EXPECT_EQ(*reader.version(), V2);
+    EXPECT_EQ(reader.remaining(), 2);
+    auto request = ::Read(reader, ::ArgsV2(7, 1));
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->index, 0);
+    EXPECT_EQ(request->args.id, 7);
+    EXPECT_EQ(request->args.level, 1);
+    EXPECT_STREQ(request->args.args.volpkg, "pkg");
+    EXPECT_EQ(request->args.args.centerX, 1);
+    request = ::Read(reader, ::ArgsV2(3, 0));
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->index, 1);
+    EXPECT_EQ(request->args.id, 3);
+
+    // Empty packets are allowed
+    EXPECT_FALSE(::Read(reader, ::Header(V2, 0)).has_value());
+    EXPECT_FALSE(reader.done());
+    EXPECT_FALSE(::Read(reader, ::Header(V2, 1)).has_value());
+    request = ::Read(reader, ::ArgsV2(9, 0));
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->index, 2);
+    EXPECT_EQ(reader.bytesNeeded(), sizeof(RequestHdr));
+}
+
+TEST(VolumeProtocolIO, ReadV1)
+{
+    RequestReader reader;
+    EXPECT_FALSE(::Read(reader, ::Header(V1, 2)).has_value());
+    ASSERT_TRUE(reader.version().has_value());
+    EXPECT_EQ(*reader.version(), V1);
+
+    // V1 arguments have no ID or level
+    auto request = ::Read(reader, ::ArgsV1(4));
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->index, 0);
+    EXPECT_EQ(request->args.id, 0);
+    EXPECT_EQ(request->args.level, 0);
+    EXPECT_STREQ(request->args.args.volume, "vol");
+    EXPECT_EQ(request->args.args.centerX, 4);
+    EXPECT_FALSE(reader.done());
+    request = ::Read(reader, ::ArgsV1(5));
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->index, 1);
+
+    // The connection only carries one packet
+    EXPECT_TRUE(reader.done());
+    EXPECT_EQ(reader.bytesNeeded(), 0);
+    const auto hdr = ::Header(V1, 1);
+    EXPECT_THROW(reader.read(hdr.data()), std::logic_error);
+
+    // Including empty ones
+    RequestReader empty;
+    EXPECT_FALSE(::Read(empty, ::Header(V1, 0)).has_value());
+    EXPECT_TRUE(empty.done());
+}
+
+TEST(VolumeProtocolIO, ReadInvalidHeaders)
+{
+    auto badMagic = ::Header(V2, 1);
+    badMagic[0] ^= 1;
+    RequestReader reader;
+    EXPECT_THROW(reader.read(badMagic.data()), std::runtime_error);
+
+    auto badVersion = ::Header(V2, 1);
+    badVersion[sizeof(std::uint32_t)] = 3;
+    EXPECT_THROW(reader.read(badVersion.data()), std::runtime_error);
+
+    // Client-supplied request counts are limited
+    const auto tooMany = ::Header(V2, RequestReader::MAX_REQUESTS + 1);
+    EXPECT_THROW(reader.read(tooMany.data()), std::runtime_error);
+    EXPECT_FALSE(reader.version().has_value());
+
+    // Versions can't be mixed on a connection
+    EXPECT_FALSE(::Read(reader, ::Header(V2, 0)).has_value());
+    const auto v1 = ::Header(V1, 1);
+    EXPECT_THROW(reader.read(v1.data()), std::runtime_error);
+}
+
+TEST(VolumeProtocolIO, ResponseQueueV2)
+{
+    // Responses are returned in the order they're ready
+    ResponseQueue queue(V2, 0);
+    for (const std::uint32_t index : {2, 0, 1}) {
+        const auto ready = queue.add(index, QByteArray(1, char('a' + index)));
+        ASSERT_EQ(ready.size(), 1);
+        EXPECT_EQ(ready[0], QByteArray(1, char('a' + index)));
+        EXPECT_FALSE(queue.complete());
+    }
+}
+
+TEST(VolumeProtocolIO, ResponseQueueV1)
+{
+    // Responses are held until every earlier response is ready
+    ResponseQueue queue(V1, 3);
+    EXPECT_TRUE(queue.add(2, "c").empty());
+    EXPECT_EQ(queue.held(), 1U);
+    EXPECT_EQ(queue.heldBytes(), 1U);
+    const auto first = queue.add(0, "a");
+    ASSERT_EQ(first.size(), 1U);
+    EXPECT_EQ(first[0], "a");
+    EXPECT_FALSE(queue.complete());
+    const auto rest = queue.add(1, "b");
+    ASSERT_EQ(rest.size(), 2U);
+    EXPECT_EQ(rest[0], "b");
+    EXPECT_EQ(rest[1], "c");
+    EXPECT_EQ(queue.held(), 0U);
+    EXPECT_EQ(queue.heldBytes(), 0U);
+    EXPECT_TRUE(queue.complete());
+    EXPECT_THROW(queue.add(0, "a"), std::out_of_range);
+
+    EXPECT_TRUE(ResponseQueue(V1, 0).complete());
+    EXPECT_THROW(ResponseQueue(V1, 1).add(1, "a"), std::out_of_range);
+}
+
+TEST(VolumeProtocolIO, ResponseQueueV1Prefix)
+{
+    // Each ready prefix is returned as soon as it's contiguous
+    ResponseQueue queue(V1, 6);
+    EXPECT_TRUE(queue.add(1, "b").empty());
+    EXPECT_TRUE(queue.add(4, "e").empty());
+    EXPECT_TRUE(queue.add(3, "d").empty());
+    EXPECT_THROW(queue.add(3, "d"), std::out_of_range);
+    EXPECT_EQ(queue.held(), 3U);
+
+    auto ready = queue.add(0, "a");
+    ASSERT_EQ(ready.size(), 2U);
+    EXPECT_EQ(ready[0], "a");
+    EXPECT_EQ(ready[1], "b");
+    EXPECT_EQ(queue.held(), 2U);
+    EXPECT_THROW(queue.add(1, "b"), std::out_of_range);
+
+    ready = queue.add(2, "c");
+    ASSERT_EQ(ready.size(), 3U);
+    EXPECT_EQ(ready[0], "c");
+    EXPECT_EQ(ready[1], "d");
+    EXPECT_EQ(ready[2], "e");
+    EXPECT_EQ(queue.held(), 0U);
+    EXPECT_FALSE(queue.complete());
+
+    ready = queue.add(5, "f");
+    ASSERT_EQ(ready.size(), 1U);
+    EXPECT_EQ(ready[0], "f");
+    EXPECT_TRUE(queue.complete());
+}
+
+TEST(VolumeProtocolIO, SerializeResponseV2)
+{
+    Neighborhood neighborhood(3, 2, 3, 4);
+    for (std::size_t i = 0; i < neighborhood.size(); i++) {
+        neighborhood.data()[i] = static_cast<std::uint16_t>(i);
+    }
+
+    const auto bytes = SerializeResponse(42, Success, &neighborhood);
+    ASSERT_EQ(
+        bytes.size(),
+        sizeof(ResponseArgsV2) + neighborhood.size() * sizeof(std::uint16_t));
+    ResponseArgsV2 hdr;
+    std::memcpy(&hdr, bytes.data(), sizeof(ResponseArgsV2));
+    EXPECT_EQ(hdr.id, 42);
+    EXPECT_EQ(hdr.status, Success);
+    EXPECT_EQ(hdr.extentX, 4);
+    EXPECT_EQ(hdr.extentY, 3);
+    EXPECT_EQ(hdr.extentZ, 2);
+    EXPECT_EQ(hdr.size, neighborhood.size() * sizeof(std::uint16_t));
+    EXPECT_EQ(
+        std::memcmp(
+            bytes.data() + sizeof(ResponseArgsV2), neighborhood.data(),
+            hdr.size),
+        0);
+
+    // Errors have a status and no data
+    for (const auto status : {VolumeNotFound, InvalidRequest, InternalError}) {
+        const auto err = SerializeResponse(7, status, nullptr);
+        ASSERT_EQ(err.size(), sizeof(ResponseArgsV2));
+        std::memcpy(&hdr, err.data(), sizeof(ResponseArgsV2));
+        EXPECT_EQ(hdr.id, 7);
+        EXPECT_EQ(hdr.status, status);
+        EXPECT_EQ(hdr.size, 0);
+        EXPECT_EQ(hdr.extentX, 0);
+    }
+}
+
+TEST(VolumeProtocolIO, SerializeResponseV1)
+{
+    RequestArgs args;
+    std::memset(&args, 0, sizeof(RequestArgs));
+    std::strncpy(args.volpkg, "pkg", VOLPKG_SZ);
+    std::strncpy(args.volume, "vol", VOLUME_SZ);
+
+    // Failed V1 requests echo the IDs with no data
+    auto bytes = SerializeResponse(args, nullptr);
+    ASSERT_EQ(bytes.size(), sizeof(ResponseArgs));
+    ResponseArgs hdr;
+    std::memcpy(&hdr, bytes.data(), sizeof(ResponseArgs));
+    EXPECT_STREQ(hdr.volpkg, "pkg");
+    EXPECT_STREQ(hdr.volume, "vol");
+    EXPECT_EQ(hdr.size, 0);
+
+    Neighborhood neighborhood(3, 1, 1, 5);
+    bytes = SerializeResponse(args, &neighborhood);
+    ASSERT_EQ(bytes.size(), sizeof(ResponseArgs) + 5 * sizeof(std::uint16_t));
+    std::memcpy(&hdr, bytes.data(), sizeof(ResponseArgs));
+    EXPECT_EQ(hdr.extentX, 5);
+    EXPECT_EQ(hdr.size, 5 * sizeof(std::uint16_t));
+}
@@ -0,0 +1,48 @@
+/**
+ * @file
+ *
+ * @brief IO Utilities for Volume chunk files
+ *
+ * @ingroup IO
+ */
+
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+
+namespace volcart::chunkio
+{
+
+/**
+ * @brief Read a Volume chunk file
+ *
+ * Chunk files store a single cubic block of voxels as a headerless, row-major
+ * array of elements in native byte order. Volume chunks store 16-bit unsigned
+ * integers. The extents and element type of the chunk are not stored in the
+ * file and must be provided by the caller. The returned cv::Mat is a
+ * 3-dimensional matrix with extents `{chunkSize, chunkSize, chunkSize}`,
+ * indexed by `(z, y, x)`.
+ *
+ * @param path Path to the chunk file
+ * @param chunkSize Edge length of the chunk in voxels
+ * @param type OpenCV type of the chunk elements
+ * @throws volcart::IOException Unrecoverable read errors
+ */
+auto ReadChunk(
+    const filesystem::path& path, int chunkSize, int type = CV_16UC1)
+    -> cv::Mat;
+
+/**
+ * @brief Write a Volume chunk file
+ *
+ * The provided chunk must be a continuous, 3-dimensional matrix with equal
+ * extents along every axis. Volume chunks must be single channel, 16-bit
+ * unsigned matrices.
+ *
+ * @throws volcart::IOException All writing errors
+ */
+void WriteChunk(const filesystem::path& path, const cv::Mat& chunk);
+
+}  // namespace volcart::chunkio
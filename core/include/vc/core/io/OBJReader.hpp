@@ -2,7 +2,12 @@
 
 /** @file */
 
-#include <fstream>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
@@ -21,8 +26,10 @@ namespace volcart::io
  * @brief Read an OBJ file into a volcart::ITKMesh
  *
  * Supports image mapped meshes. Image path is parsed from the OBJ's mtl
- * include. Other material properties are currently ignored. Throws
- * volcart::IOException on error.
+ * include. Other material properties are currently ignored. Only triangular
+ * faces are supported. Throws volcart::IOException on error.
+ *
+ * Large files are parsed in parallel.
  *
  * @ingroup IO
  */
@@ -53,6 +60,16 @@ public:
      */
     auto getTextureMat() -> cv::Mat;
 
+    /**
+     * @brief Set the maximum number of threads used to parse the file
+     *
+     * Default: The number of hardware threads
+     */
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
+
 private:
     /**
      * @brief 3-Tuple linking a vertex to its position, UV, and normal
@@ -65,36 +82,26 @@ private:
      * VertexRefs { v, vt, vn }
      */
     using VertexRefs = cv::Vec3i;
-    /** @brief A list of at least three OBJReader::VertexRefs comprise a face */
-    using Face = std::vector<VertexRefs>;
-
-    /** @brief Validation enumeration to ensure proper parsing of
-     * OBJReader::VertexRefs */
-    enum class RefType {
-        Invalid,
-        Vertex,
-        VertexWithTexture,
-        VertexWithNormal,
-        VertexWithTextureAndNormal
-    };
+    /** @brief Three OBJReader::VertexRefs comprise a (triangular) face */
+    using Face = std::array<VertexRefs, 3>;
+
+    /** Parsed contents of a range of lines in the OBJ file */
+    struct Chunk;
 
     /** Clear all temporary data structures */
     void reset_();
 
-    /** Parse the mesh */
+    /**
+     * Parse the mesh
+     *
+     * The file is memory mapped and split into line-aligned chunks, which are
+     * parsed in parallel and then appended in file order.
+     */
     void parse_();
-    /** Handle parsed vertex lines */
-    void parse_vertex_(const std::vector<std::string>& strs);
-    /** Handle parsed vertex normal lines */
-    void parse_normal_(const std::vector<std::string>& strs);
-    /** Handle parsed vertex UV coordinate lines */
-    void parse_tcoord_(const std::vector<std::string>& strs);
-    /** Handle parsed face lines */
-    void parse_face_(const std::vector<std::string>& strs);
+    /** Parse the lines in `text` */
+    static void parse_chunk_(std::string_view text, Chunk& chunk);
     /** Handle parsed mtllib lines */
-    void parse_mtllib_(const std::vector<std::string>& strs);
-    /** Classify a OBJReader::VertexRefs as an OBJReader::RefType */
-    auto classify_vertref_(const std::string& ref) -> RefType;
+    void parse_mtllib_(const std::string& mtllib);
 
     /** Construct a mesh from the parsed information */
     void build_mesh_();
@@ -118,6 +125,8 @@ private:
     std::vector<cv::Vec2d> uvs_;
     /** List of parsed faces */
     std::vector<OBJReader::Face> faces_;
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 };
 
 }  // namespace volcart::io
@@ -2,8 +2,10 @@
 
 /** @file */
 
-#include <fstream>
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 #include "vc/core/filesystem.hpp"
 #include "vc/core/types/ITKMesh.hpp"
@@ -19,7 +21,10 @@ namespace volcart::io
  *
  * @brief Read a PLY file to an ITKMesh
  *
- * Only supports vertices, vertex normals, and faces.
+ * Only supports vertices, vertex normals, and triangular faces. Reads ASCII
+ * and binary (little and big endian) files. Other elements and properties are
+ * skipped. Large files are parsed in parallel. Throws volcart::IOException on
+ * error.
  *
  * @ingroup IO
  */
@@ -47,56 +52,33 @@ public:
     auto read() -> ITKMesh::Pointer;
     /**@}*/
 
+    /**@{*/
+    /**
+     * @brief Set the maximum number of threads used to parse the file
+     *
+     * Default: The number of hardware threads
+     */
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
+    /**@}*/
+
 private:
     /** Input file path */
     filesystem::path inputPath_;
-    /** Input file stream */
-    std::ifstream plyFile_;
     /** Output mesh */
     ITKMesh::Pointer outMesh_;
-    /** Line currently being parsed */
-    std::string line_;
     /** Temporary face list */
     std::vector<SimpleMesh::Cell> faceList_;
     /** Temporary vertex list */
     std::vector<SimpleMesh::Vertex> pointList_;
-    /** List of elements parsed from the header */
-    std::vector<std::string> elementsList_;
-    /** Number of vertices expected in the parsed mesh */
-    int numVertices_;
-    /** Number of faces expected in the parsed mesh */
-    int numFaces_;
-    /** Number of lines used by the elements we can't handle */
-    std::vector<int> skippedLine_;
-    /** Maps positions in a string to a particular attribute */
-    std::map<std::string, int> properties_;
-
-    /**
-     * Tracks if there is a leading character in front of each face line. This
-     * character tells how many vertices are in that face.
-     */
-    bool hasLeadingChar_ = true;
-
     /** Track if there are vertex normals */
     bool hasPointNorm_ = false;
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 
     /** @brief Construct outMesh_ from the temporary vertices and faces */
     void create_mesh_();
-
-    /**
-     * @brief Parse the PLY header
-     *
-     * The header defines the expected layout for the body of the PLY file,
-     * including the count for each element (e.g. vertices, faces, etc). This
-     * information is stored in elementsList_ and used when reading in faces
-     * and vertices.
-     */
-    void parse_header_();
-
-    /** @brief Fill the temporary face list with parsed face information */
-    void read_faces_();
-
-    /** @brief Fill the temporary vertex list with parsed vertex information */
-    void read_points_();
 };
 }  // namespace volcart::io
@@ -5,16 +5,21 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <regex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "vc/core/filesystem.hpp"
 #include "vc/core/types/Exceptions.hpp"
 #include "vc/core/types/OrderedPointSet.hpp"
 #include "vc/core/types/PointSet.hpp"
+#include "vc/core/util/MemMap.hpp"
 #include "vc/core/util/String.hpp"
 
 namespace volcart
@@ -26,6 +31,17 @@ namespace volcart
  */
 enum class IOMode { ASCII = 0, BINARY };
 
+/**
+ * @brief Scalar type used to store points in binary files
+ *
+ * `Native` stores points using their own value type. `Float32` stores
+ * floating-point points as 32-bit floats, halving the size of double
+ * precision files at the cost of precision.
+ *
+ * @ingroup IO
+ */
+enum class PointStorage { Native = 0, Float32 };
+
 /**
  * @class PointSetIO
  * @author Sean Karlage
@@ -35,6 +51,11 @@ enum class IOMode { ASCII = 0, BINARY };
  * information is then encoded in either ASCII or binary, as determined at
  * time of write.
  *
+ * Binary files are memory mapped and their point payload is copied or
+ * converted in bulk. Writers align the payload of binary files to 8 bytes, so
+ * MappedPointSet can usually expose the payload of a mapped file directly.
+ * Files storing float points can be read as double points and vice versa.
+ *
  * @ingroup IO
  *
  * @see volcart::PointSet
@@ -44,6 +65,9 @@ template <typename T>
 class PointSetIO
 {
 public:
+    /** Point scalar type */
+    using Scalar = typename T::value_type;
+
     /** @brief PointSet file header information */
     struct Header {
         std::size_t width{0};
@@ -54,6 +78,91 @@ public:
         std::string type;
     };
 
+    /**
+     * @brief Memory mapped binary PointSet or OrderedPointSet file
+     *
+     * Parses the header of a binary file and provides access to its point
+     * payload without first loading it into a PointSet. If the file stores
+     * points with the same scalar type as T and the payload is suitably
+     * aligned, data() returns a pointer directly into the mapped file.
+     * Otherwise, points can be converted on access with at() or copy().
+     *
+     * The payload is only valid for the lifetime of this object.
+     */
+    class MappedPointSet
+    {
+    public:
+        /**
+         * @brief Map the file at `path`
+         *
+         * @copydetails PointSetIO::ParseHeader()
+         */
+        explicit MappedPointSet(
+            const volcart::filesystem::path& path, bool ordered = true)
+            : file_{path}
+        {
+            auto contents = file_.view();
+            header_ = ParseHeader(contents, ordered);
+            payload_ = PayloadView(header_, contents);
+        }
+
+        /** @brief Get the file header */
+        auto header() const -> const Header& { return header_; }
+
+        /** @brief Get the number of points in the file */
+        auto size() const -> std::size_t { return NumPoints(header_); }
+
+        /** @brief Get the raw bytes of the point payload */
+        auto payload() const -> std::string_view { return payload_; }
+
+        /**
+         * @brief Get the points stored in the mapped file
+         *
+         * Returns `nullptr` if the points cannot be used in place, i.e. if
+         * the file's scalar type does not match T or the payload is not
+         * aligned for T.
+         */
+        auto data() const -> const T*
+        {
+            const auto addr = reinterpret_cast<std::uintptr_t>(payload_.data());
+            if (header_.type != TypeName<Scalar>() or
+                addr % alignof(T) != 0) {
+                return nullptr;
+            }
+            return reinterpret_cast<const T*>(payload_.data());
+        }
+
+        /** @brief Get the point at index `i`, converted to T */
+        auto at(std::size_t i) const -> T
+        {
+            if (i >= size()) {
+                throw std::out_of_range("point index out of range");
+            }
+            T t;
+            Decode(header_, payload_.data() + i * PointBytes(header_), 1, &t);
+            return t;
+        }
+
+        /** @brief Copy points [begin, end) into `out`, converted to T */
+        void copy(std::size_t begin, std::size_t end, T* out) const
+        {
+            if (begin > end or end > size()) {
+                throw std::out_of_range("point range out of range");
+            }
+            Decode(
+                header_, payload_.data() + begin * PointBytes(header_),
+                end - begin, out);
+        }
+
+    private:
+        /** Mapped file */
+        FileContents file_;
+        /** Parsed header */
+        Header header_;
+        /** Point payload */
+        std::string_view payload_;
+    };
+
     /**@{*/
     /**
      * @brief Read OrderedPointSet from file
@@ -94,29 +203,40 @@ public:
     /**@}*/
 
     /**@{*/
-    /** @brief Write an OrderedPointSet to disk */
+    /**
+     * @brief Write an OrderedPointSet to disk
+     *
+     * `storage` selects the scalar type of binary files and is ignored by
+     * ASCII files.
+     */
     static void WriteOrderedPointSet(
         const volcart::filesystem::path& path,
         const OrderedPointSet<T>& ps,
-        IOMode mode = IOMode::BINARY)
+        IOMode mode = IOMode::BINARY,
+        PointStorage storage = PointStorage::Native)
     {
         switch (mode) {
             case IOMode::BINARY:
-                return WriteOrderedPointSetBinary(path, ps);
+                return WriteOrderedPointSetBinary(path, ps, storage);
             case IOMode::ASCII:
                 return WriteOrderedPointSetAscii(path, ps);
         }
     }
 
-    /** @brief Write a PointSet to disk */
+    /**
+     * @brief Write a PointSet to disk
+     *
+     * @copydetails PointSetIO::WriteOrderedPointSet()
+     */
     static void WritePointSet(
         const volcart::filesystem::path& path,
         const PointSet<T>& ps,
-        IOMode mode = IOMode::BINARY)
+        IOMode mode = IOMode::BINARY,
+        PointStorage storage = PointStorage::Native)
     {
         switch (mode) {
             case IOMode::BINARY:
-                return WritePointSetBinary(path, ps);
+                return WritePointSetBinary(path, ps, storage);
             case IOMode::ASCII:
                 return WritePointSetAscii(path, ps);
         }
@@ -125,53 +245,30 @@ public:
 
     /**@{*/
     /** @brief Generate a PointSet header string */
-    static std::string MakeHeader(PointSet<T> ps)
+    static std::string MakeHeader(
+        const PointSet<T>& ps, PointStorage storage = PointStorage::Native)
     {
         std::stringstream ss;
         ss << "size: " << ps.size() << std::endl;
         ss << "dim: " << T::channels << std::endl;
         ss << "ordered: false" << std::endl;
-
-        // Output type information
-        ss << "type: ";
-        if (std::is_same<typename T::value_type, int>::value) {
-            ss << "int" << std::endl;
-        } else if (std::is_same<typename T::value_type, float>::value) {
-            ss << "float" << std::endl;
-        } else if (std::is_same<typename T::value_type, double>::value) {
-            ss << "double" << std::endl;
-        } else {
-            auto msg = "unsupported type";
-            throw IOException(msg);
-        }
-
+        ss << "type: " << StorageTypeName(storage) << std::endl;
         ss << "version: " << PointSet<T>::FORMAT_VERSION << std::endl;
         ss << PointSet<T>::HEADER_TERMINATOR << std::endl;
 
         return ss.str();
     }
     /** @brief Generate an OrderedPointSet header string */
-    static std::string MakeOrderedHeader(OrderedPointSet<T> ps)
+    static std::string MakeOrderedHeader(
+        const OrderedPointSet<T>& ps,
+        PointStorage storage = PointStorage::Native)
     {
         std::stringstream ss;
         ss << "width: " << ps.width() << std::endl;
         ss << "height: " << ps.height() << std::endl;
         ss << "dim: " << T::channels << std::endl;
         ss << "ordered: true" << std::endl;
-
-        // Output type information
-        ss << "type: ";
-        if (std::is_same<typename T::value_type, int>::value) {
-            ss << "int" << std::endl;
-        } else if (std::is_same<typename T::value_type, float>::value) {
-            ss << "float" << std::endl;
-        } else if (std::is_same<typename T::value_type, double>::value) {
-            ss << "double" << std::endl;
-        } else {
-            auto msg = "unsupported type";
-            throw IOException(msg);
-        }
-
+        ss << "type: " << StorageTypeName(storage) << std::endl;
         ss << "version: " << PointSet<T>::FORMAT_VERSION << std::endl;
         ss << PointSet<T>::HEADER_TERMINATOR << std::endl;
 
@@ -187,126 +284,217 @@ public:
      */
     static Header ParseHeader(std::ifstream& infile, bool ordered = true)
     {
-        // Regexes
-        std::regex comments{"^#"};
-        std::regex width{"^width"};
-        std::regex height{"^height"};
-        std::regex dim{"^dim"};
-        std::regex ordering{"^ordered"};
-        std::regex type{"^type"};
-        std::regex size{"^size"};
-        std::regex version{"^version"};
-        std::regex validTypes{"^(float)|(double)|(int)"};
-        std::regex headerTerminator{PointSet<T>::HEADER_TERMINATOR_REGEX};
-
         Header h;
         std::string line;
-        std::vector<std::string> strs;
-
         while (std::getline(infile, line)) {
-            trim(line);
-            strs = split(line, ':');
-            std::for_each(
-                std::begin(strs), std::end(strs), [](auto& s) { trim(s); });
-
-            // Comments: look like:
-            // # This is a comment
-            //    # This is another comment
-            if (std::regex_match(strs[0], comments)) {
-                continue;
+            if (ParseHeaderLine(h, line)) {
+                break;
             }
+        }
+        return ValidateHeader(h, ordered);
+    }
 
-            // Width
-            else if (std::regex_match(strs[0], width)) {
-                h.width = std::stoul(strs[1]);
+    /**
+     * @copybrief ParseHeader(std::ifstream&, bool)
+     *
+     * Parses the header at the beginning of `contents`. On return, `contents`
+     * starts at the first byte after the header.
+     */
+    static Header ParseHeader(std::string_view& contents, bool ordered = true)
+    {
+        Header h;
+        while (not contents.empty()) {
+            const auto eol = std::min(contents.find('\n'), contents.size());
+            const auto line = contents.substr(0, eol);
+            contents.remove_prefix(std::min(eol + 1, contents.size()));
+            if (ParseHeaderLine(h, std::string(line))) {
+                break;
             }
+        }
+        return ValidateHeader(h, ordered);
+    }
+    /**@}*/
 
-            // Height
-            else if (std::regex_match(strs[0], height)) {
-                h.height = std::stoul(strs[1]);
-            }
+private:
+    /** Number of bytes written to disk at a time */
+    static constexpr std::size_t WRITE_CHUNK_BYTES = 1 << 24;
 
-            // Size
-            else if (std::regex_match(strs[0], size)) {
-                h.size = std::stoul(strs[1]);
-            }
+    /** Alignment of the binary payload */
+    static constexpr std::size_t PAYLOAD_ALIGNMENT = 8;
 
-            // Dim
-            else if (std::regex_match(strs[0], dim)) {
-                auto parsedDim = std::stoul(strs[1]);
-                if (parsedDim != T::channels) {
-                    auto msg =
-                        "Incorrect dimension read for template specification";
-                    throw IOException(msg);
-                }
-                h.dim = parsedDim;
-            }
+    /**@{*/
+    /** @brief Header name of a scalar type */
+    template <typename V>
+    static std::string TypeName()
+    {
+        if constexpr (std::is_same_v<V, int>) {
+            return "int";
+        } else if constexpr (std::is_same_v<V, float>) {
+            return "float";
+        } else if constexpr (std::is_same_v<V, double>) {
+            return "double";
+        } else {
+            throw IOException("unsupported type");
+        }
+    }
 
-            // Ordering
-            else if (std::regex_match(strs[0], ordering)) {
-                to_lower(strs[1]);
-                if (strs[1] == "true") {
-                    h.ordered = true;
-                } else if (strs[1] == "false") {
-                    h.ordered = false;
-                } else {
-                    auto msg = "'ordered' key must have value 'true'/'false'";
-                    throw IOException(msg);
-                }
+    /** @brief Header name of the scalar type used for `storage` */
+    static std::string StorageTypeName(PointStorage storage)
+    {
+        if (storage == PointStorage::Float32) {
+            if (not std::is_floating_point_v<Scalar>) {
+                throw IOException("Float32 storage requires floating points");
             }
+            return TypeName<float>();
+        }
+        return TypeName<Scalar>();
+    }
 
-            // Type
-            else if (std::regex_match(strs[0], type)) {
-                if (!std::regex_match(strs[1], validTypes)) {
-                    auto msg = "Valid types are int, float, double. Got: '" +
-                               strs[1] + "'";
-                    throw IOException(msg);
-                }
+    /** @brief Size of a scalar type from its header name */
+    static std::size_t TypeBytes(const std::string& type)
+    {
+        if (type == "float") {
+            return sizeof(float);
+        } else if (type == "double") {
+            return sizeof(double);
+        } else if (type == "int") {
+            return sizeof(int);
+        }
+        auto msg = "Unrecognized type: " + type;
+        throw IOException(msg);
+    }
 
-                // type validation
-                std::string readerType;
-                if (std::is_same_v<typename T::value_type, int>) {
-                    readerType = "int";
-                } else if (std::is_same_v<typename T::value_type, float>) {
-                    readerType = "float";
-                } else if (std::is_same_v<typename T::value_type, double>) {
-                    readerType = "double";
-                } else {
-                    throw IOException("unsupported reader type");
-                }
-                if (strs[1] != readerType) {
-                    auto msg = "Type mismatch: vcps filetype '" + strs[1] +
-                               "' not compatible with reader type '" +
-                               readerType + "'";
-                    throw IOException(msg);
-                }
-                h.type = strs[1];
+    /** @brief Number of points described by a header */
+    static std::size_t NumPoints(const Header& h)
+    {
+        return h.ordered ? h.width * h.height : h.size;
+    }
+
+    /** @brief Size of a stored point in bytes */
+    static std::size_t PointBytes(const Header& h)
+    {
+        return h.dim * TypeBytes(h.type);
+    }
+
+    /** @brief Parse a header value as an unsigned integer */
+    static std::size_t ParseSize(std::string_view key, std::string_view val)
+    {
+        try {
+            return to_numeric<std::size_t>(val);
+        } catch (const std::exception&) {
+            auto msg = "Invalid value for '" + std::string(key) +
+                       "': " + std::string(val);
+            throw IOException(msg);
+        }
+    }
+
+    /**
+     * @brief Parse a single header line into `h`
+     *
+     * Returns true if the line is the header terminator. Comments, blank
+     * lines, and unrecognized keys are ignored.
+     */
+    static bool ParseHeaderLine(Header& h, std::string line)
+    {
+        trim(line);
+
+        // End of the header
+        if (line == PointSet<T>::HEADER_TERMINATOR) {
+            return true;
+        }
+
+        // Comments: look like:
+        // # This is a comment
+        //    # This is another comment
+        if (line.empty() or line.front() == '#') {
+            return false;
+        }
+
+        const auto sep = line.find(':');
+        const auto key = trim_copy(line.substr(0, sep));
+        const auto val = sep == std::string::npos
+                             ? std::string()
+                             : trim_copy(line.substr(sep + 1));
+
+        // Width
+        if (key == "width") {
+            h.width = ParseSize(key, val);
+        }
+
+        // Height
+        else if (key == "height") {
+            h.height = ParseSize(key, val);
+        }
+
+        // Size
+        else if (key == "size") {
+            h.size = ParseSize(key, val);
+        }
+
+        // Dim
+        else if (key == "dim") {
+            auto parsedDim = ParseSize(key, val);
+            if (parsedDim != T::channels) {
+                auto msg =
+                    "Incorrect dimension read for template specification";
+                throw IOException(msg);
             }
+            h.dim = parsedDim;
+        }
 
-            // Version
-            else if (std::regex_match(strs[0], version)) {
-                auto fileVersion = std::stoi(strs[1]);
-                if (fileVersion != PointSet<T>::FORMAT_VERSION) {
-                    auto msg = "Version mismatch. VCPS file version is " +
-                               strs[1] + ", processing version is " +
-                               std::to_string(PointSet<T>::FORMAT_VERSION) +
-                               ".";
-                    throw IOException(msg);
-                }
+        // Ordering
+        else if (key == "ordered") {
+            auto ordering = to_lower_copy(std::string(val));
+            if (ordering == "true") {
+                h.ordered = true;
+            } else if (ordering == "false") {
+                h.ordered = false;
+            } else {
+                auto msg = "'ordered' key must have value 'true'/'false'";
+                throw IOException(msg);
             }
+        }
 
-            // End of the header
-            else if (std::regex_match(line, headerTerminator)) {
-                break;
+        // Type
+        else if (key == "type") {
+            std::string type(val);
+            if (type != "int" and type != "float" and type != "double") {
+                auto msg =
+                    "Valid types are int, float, double. Got: '" + type + "'";
+                throw IOException(msg);
             }
 
-            // Ignore everything else
-            else {
-                continue;
+            // Floating-point files can be converted to either floating-point
+            // type. Integer files must be read as integers.
+            const auto readerType = TypeName<Scalar>();
+            const auto isFloat = type != "int";
+            if (type != readerType and
+                (not isFloat or not std::is_floating_point_v<Scalar>)) {
+                auto msg = "Type mismatch: vcps filetype '" + type +
+                           "' not compatible with reader type '" + readerType +
+                           "'";
+                throw IOException(msg);
+            }
+            h.type = type;
+        }
+
+        // Version
+        else if (key == "version") {
+            if (ParseSize(key, val) != PointSet<T>::FORMAT_VERSION) {
+                auto msg = "Version mismatch. VCPS file version is " +
+                           std::string(val) + ", processing version is " +
+                           std::to_string(PointSet<T>::FORMAT_VERSION) + ".";
+                throw IOException(msg);
             }
-            strs.clear();
         }
 
+        // Ignore everything else
+        return false;
+    }
+
+    /** @brief Check that a parsed header is complete and consistent */
+    static Header ValidateHeader(Header h, bool ordered)
+    {
         // Set size
         if (!ordered && h.width > 0 && h.height > 0) {
             h.size = h.width * h.height;
@@ -334,9 +522,60 @@ public:
 
         return h;
     }
+
+    /**
+     * @brief Get the point payload following a header
+     *
+     * Throws if `contents` is too small to hold every point in the header.
+     */
+    static std::string_view PayloadView(
+        const Header& h, std::string_view contents)
+    {
+        const auto nbytes = NumPoints(h) * PointBytes(h);
+        if (contents.size() < nbytes) {
+            auto msg = "Unexpected end of file: expected " +
+                       std::to_string(nbytes) + " bytes of point data, got " +
+                       std::to_string(contents.size());
+            throw IOException(msg);
+        }
+        return contents.substr(0, nbytes);
+    }
+
+    /** @brief Convert `n` stored points of scalar type V to T */
+    template <typename V>
+    static void Convert(const char* src, std::size_t n, T* dst)
+    {
+        V v;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (int c = 0; c < T::channels; ++c) {
+                std::memcpy(&v, src, sizeof(V));
+                dst[i][c] = static_cast<Scalar>(v);
+                src += sizeof(V);
+            }
+        }
+    }
+
+    /** @brief Decode `n` stored points into `dst` */
+    static void Decode(const Header& h, const char* src, std::size_t n, T* dst)
+    {
+        static_assert(
+            sizeof(T) == T::channels * sizeof(Scalar),
+            "Point type must be tightly packed");
+        if (n == 0) {
+            return;
+        }
+        if (h.type == TypeName<Scalar>()) {
+            std::memcpy(static_cast<void*>(dst), src, n * sizeof(T));
+        } else if (h.type == "float") {
+            Convert<float>(src, n, dst);
+        } else if (h.type == "double") {
+            Convert<double>(src, n, dst);
+        } else {
+            Convert<int>(src, n, dst);
+        }
+    }
     /**@}*/
 
-private:
     /**@{*/
     /** @brief Read an ASCII PointSet */
     static PointSet<T> ReadPointSetAscii(const volcart::filesystem::path& path)
@@ -352,7 +591,7 @@ private:
         PointSet<T> ps{header.size};
 
         for (std::size_t i = 0; i < header.size; ++i) {
-            std::array<typename T::value_type, T::channels> values;
+            std::array<Scalar, T::channels> values;
             for (std::size_t d = 0; d < header.dim; ++d) {
                 infile >> values[d];
             }
@@ -380,7 +619,7 @@ private:
         points.reserve(header.width);
         for (std::size_t h = 0; h < header.height; ++h) {
             for (std::size_t w = 0; w < header.width; ++w) {
-                std::array<typename T::value_type, T::channels> values;
+                std::array<Scalar, T::channels> values;
                 for (std::size_t d = 0; d < header.dim; ++d) {
                     infile >> values.at(d);
                 }
@@ -396,32 +635,9 @@ private:
     /** @brief Read a binary PointSet */
     static PointSet<T> ReadPointSetBinary(const volcart::filesystem::path& path)
     {
-        std::ifstream infile{path.string(), std::ios::binary};
-        if (!infile.is_open()) {
-            auto msg = "could not open file '" + path.string() + "'";
-            throw IOException(msg);
-        }
-        auto header = PointSetIO<T>::ParseHeader(infile, false);
-        PointSet<T> ps{header.size};
-
-        // Size of binary elements to read
-        std::size_t typeBytes{};
-        if (header.type == "float") {
-            typeBytes = sizeof(float);
-        } else if (header.type == "double") {
-            typeBytes = sizeof(double);
-        } else if (header.type == "int") {
-            typeBytes = sizeof(int);
-        }
-
-        // Read data
-        T t;
-        for (std::size_t i = 0; i < header.size; ++i) {
-            auto nbytes = header.dim * typeBytes;
-            infile.read(reinterpret_cast<char*>(t.val), nbytes);
-            ps.push_back(t);
-        }
-
+        const MappedPointSet file(path, false);
+        PointSet<T> ps(file.size(), T());
+        file.copy(0, file.size(), &ps[0]);
         return ps;
     }
 
@@ -429,45 +645,73 @@ private:
     static OrderedPointSet<T> ReadOrderedPointSetBinary(
         const volcart::filesystem::path& path)
     {
-        std::ifstream infile{path.string(), std::ios::binary};
-        if (!infile.is_open()) {
-            auto msg = "could not open file '" + path.string() + "'";
-            throw IOException(msg);
-        }
-        auto header = PointSetIO<T>::ParseHeader(infile, true);
-        OrderedPointSet<T> ps{header.width};
+        const MappedPointSet file(path, true);
+        const auto& header = file.header();
+        auto ps = OrderedPointSet<T>::Fill(header.width, header.height, T());
+        file.copy(0, file.size(), &ps(0, 0));
+        return ps;
+    }
+    /**@}*/
 
-        // Size of binary elements to read
-        std::size_t typeBytes = sizeof(int);
-        if (header.type == "float") {
-            typeBytes = sizeof(float);
-        } else if (header.type == "double") {
-            typeBytes = sizeof(double);
-        } else if (header.type == "int") {
-            typeBytes = sizeof(int);
-        } else {
-            auto msg = "Unrecognized type: " + header.type;
-            throw IOException(msg);
+    /**@{*/
+    /**
+     * @brief Pad a binary header so that the payload is aligned
+     *
+     * Inserts a comment line before the header terminator.
+     */
+    static std::string AlignHeader(std::string header)
+    {
+        auto pad = (PAYLOAD_ALIGNMENT - header.size() % PAYLOAD_ALIGNMENT) %
+                   PAYLOAD_ALIGNMENT;
+        if (pad == 0) {
+            return header;
         }
+        // A comment line needs at least "#\n"
+        if (pad < 2) {
+            pad += PAYLOAD_ALIGNMENT;
+        }
+        const auto terminator = header.rfind(PointSet<T>::HEADER_TERMINATOR);
+        header.insert(terminator, "#" + std::string(pad - 2, ' ') + "\n");
+        return header;
+    }
 
-        // Read data
-        T t;
-        std::size_t nbytes = header.width * header.dim * typeBytes;
-        std::vector<T> points(header.width, 0);
-        points.reserve(header.width);
-        for (std::size_t h = 0; h < header.height; ++h) {
-            infile.read(reinterpret_cast<char*>(points.data()), nbytes);
-            ps.pushRow(points);
+    /** @brief Write `n` points to a binary file in fixed-size chunks */
+    static void WritePayload(
+        std::ofstream& outfile, const T* data, std::size_t n, PointStorage s)
+    {
+        if (s == PointStorage::Native or std::is_same_v<Scalar, float>) {
+            const auto* bytes = reinterpret_cast<const char*>(data);
+            auto remaining = n * sizeof(T);
+            while (remaining > 0) {
+                const auto nbytes = std::min(remaining, WRITE_CHUNK_BYTES);
+                outfile.write(bytes, nbytes);
+                bytes += nbytes;
+                remaining -= nbytes;
+            }
+            return;
         }
 
-        return ps;
+        // Convert to float a chunk at a time
+        const auto chunkPts = WRITE_CHUNK_BYTES / (T::channels * sizeof(float));
+        std::vector<float> buffer;
+        buffer.reserve(chunkPts * T::channels);
+        for (std::size_t begin = 0; begin < n; begin += chunkPts) {
+            const auto end = std::min(begin + chunkPts, n);
+            buffer.clear();
+            for (auto i = begin; i < end; ++i) {
+                for (int c = 0; c < T::channels; ++c) {
+                    buffer.push_back(static_cast<float>(data[i][c]));
+                }
+            }
+            outfile.write(
+                reinterpret_cast<const char*>(buffer.data()),
+                buffer.size() * sizeof(float));
+        }
     }
-    /**@}*/
 
-    /**@{*/
     /** @brief Write an ASCII PointSet */
     static void WritePointSetAscii(
-        const volcart::filesystem::path& path, PointSet<T> ps)
+        const volcart::filesystem::path& path, const PointSet<T>& ps)
     {
         std::ofstream outfile{path.string()};
         if (!outfile.is_open()) {
@@ -494,20 +738,20 @@ private:
 
     /** @brief Write a binary PointSet */
     static void WritePointSetBinary(
-        const volcart::filesystem::path& path, PointSet<T> ps)
+        const volcart::filesystem::path& path,
+        const PointSet<T>& ps,
+        PointStorage storage)
     {
+        auto header = AlignHeader(PointSetIO<T>::MakeHeader(ps, storage));
         std::ofstream outfile{path.string(), std::ios::binary};
         if (!outfile.is_open()) {
             auto msg = "could not open file '" + path.string() + "'";
             throw IOException(msg);
         }
 
-        auto header = PointSetIO<T>::MakeHeader(ps);
         outfile.write(header.c_str(), header.size());
-
-        for (const auto& p : ps) {
-            auto nbytes = T::channels * sizeof(typename T::value_type);
-            outfile.write(reinterpret_cast<const char*>(p.val), nbytes);
+        if (not ps.empty()) {
+            WritePayload(outfile, &ps[0], ps.size(), storage);
         }
 
         outfile.flush();
@@ -520,7 +764,7 @@ private:
 
     /** @brief Write an ASCII OrderedPointSet */
     static void WriteOrderedPointSetAscii(
-        const volcart::filesystem::path& path, OrderedPointSet<T> ps)
+        const volcart::filesystem::path& path, const OrderedPointSet<T>& ps)
     {
         std::ofstream outfile{path.string()};
         if (!outfile.is_open()) {
@@ -547,20 +791,21 @@ private:
 
     /** @brief Write a binary OrderedPointSet */
     static void WriteOrderedPointSetBinary(
-        const volcart::filesystem::path& path, OrderedPointSet<T> ps)
+        const volcart::filesystem::path& path,
+        const OrderedPointSet<T>& ps,
+        PointStorage storage)
     {
+        auto header =
+            AlignHeader(PointSetIO<T>::MakeOrderedHeader(ps, storage));
         std::ofstream outfile{path.string(), std::ios::binary};
         if (!outfile.is_open()) {
             auto msg = "could not open file '" + path.string() + "'";
             throw IOException(msg);
         }
 
-        auto header = PointSetIO<T>::MakeOrderedHeader(ps);
         outfile.write(header.c_str(), header.size());
-
-        for (const auto& p : ps) {
-            auto nbytes = T::channels * sizeof(typename T::value_type);
-            outfile.write(reinterpret_cast<const char*>(p.val), nbytes);
+        if (not ps.empty()) {
+            WritePayload(outfile, &ps(0, 0), ps.size(), storage);
         }
 
         outfile.flush();
@@ -11,6 +11,10 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
@@ -47,9 +51,51 @@ enum class Compression : std::uint16_t {
     JBIG = 34661,
     SGILOG = 34676,
     SGILOG24 = 34677,
-    JP2000 = 34712
+    JP2000 = 34712,
+    LZMA = 34925,
+    ZSTD = 50000
 };
 
+/**
+ * @brief TIFF predictor schemes
+ *
+ * A predictor transforms each row of the image before it is compressed so
+ * that it compresses better. Horizontal differencing stores the difference
+ * between neighboring samples, which are small for smooth images such as CT
+ * slices. Predictors only apply to the LZW, Deflate, ZSTD, and LZMA schemes.
+ */
+enum class Predictor : std::uint16_t {
+    NONE = 1,
+    HORIZONTAL = 2,
+    FLOATINGPOINT = 3
+};
+
+/**
+ * @brief Whether a compression scheme can be written and read
+ *
+ * Some compression schemes, such as ZSTD and LZMA, are optional features of
+ * libtiff and may not be available.
+ */
+auto IsCompressionSupported(Compression compression) -> bool;
+
+/**
+ * @brief Get the short name of a compression scheme
+ *
+ * Short names are used in settings such as the Volume metadata and command
+ * line options. Only these schemes have one: `none`, `lzw`, `deflate`
+ * (ADOBE_DEFLATE), `zstd`, and `lzma`.
+ *
+ * @throws std::invalid_argument If the scheme does not have a short name
+ */
+auto CompressionName(Compression compression) -> std::string;
+
+/**
+ * @brief Get a compression scheme by its short name
+ *
+ * @throws std::invalid_argument If the name is unknown
+ */
+auto CompressionFromName(const std::string& name) -> Compression;
+
 /**
  * @brief Read a TIFF file
  *
@@ -58,17 +104,22 @@ enum class Compression : std::uint16_t {
  * will be returned with a BGR channel order, except for 8-bit and 16-bit
  * signed integer types which will be returned with an RGB channel order.
  *
- * Only supports single image TIFF files with scanline encoding and a
- * contiguous planar configuration (this matches the format written by
- * WriteTIFF). Unless you need to read some obscure image type (e.g. 32-bit
- * float or signed integer images), it's generally preferable to use cv::imread.
+ * Only supports single image TIFF files. Strip and tile encoded images are
+ * supported with either a contiguous or separate planar configuration. The
+ * strips or tiles of large, compressed images are decoded in parallel, unless
+ * the calling thread is already a parallel worker (see IsParallelWorker()).
+ * Unless you need to read some obscure image type (e.g. 32-bit float or
+ * signed integer images), it's generally preferable to use cv::imread.
  *
  * If `mmap_info` is provided, this function will attempt to memory map the
- * TIFF file rather than reading it into memory. If successful, `mmap_info` will
- * contain the address and size required to unmap the file with UnmapFile. If
- * memory mapping fails for any reason, this function will fallback to loading
- * the image into memory, and `mmap_info` will be empty. This can be checked
- * with `mmap_info::operator bool()`:
+ * TIFF file rather than reading it into memory. Uncompressed, 1 or 2 channel
+ * images in native byte order whose strips are stored back to back (including
+ * all single-strip images written by WriteTIFF) are mapped, and the returned
+ * cv::Mat wraps the mapped pixels without copying them. If successful,
+ * `mmap_info` will contain the address and size required to unmap the file
+ * with UnmapFile. If memory mapping fails for any reason, this function will
+ * fallback to loading the image into memory, and `mmap_info` will be empty.
+ * This can be checked with `mmap_info::operator bool()`:
  *
  * ```{.cpp}
  * tiffio::mmap_info info;
@@ -91,6 +142,21 @@ enum class Compression : std::uint16_t {
 auto ReadTIFF(const filesystem::path& path, mmap_info* mmap_info = nullptr)
     -> cv::Mat;
 
+/**
+ * @brief Read a region of a TIFF file
+ *
+ * Only decodes the strips or tiles of the TIFF which overlap `roi`, so reading
+ * a small region of a large image is much cheaper than reading the full image.
+ * Supports the same images as ReadTIFF(const filesystem::path&, mmap_info*),
+ * but never memory maps the file. `roi` is clipped to the bounds of the image.
+ *
+ * @param path Path to TIFF file
+ * @param roi Region of the image to read
+ * @throws volcart::IOException Unrecoverable read errors or if `roi` does not
+ * overlap the image
+ */
+auto ReadTIFF(const filesystem::path& path, const cv::Rect& roi) -> cv::Mat;
+
 /**
  * @brief Write a TIFF image to file
  *
@@ -103,10 +169,122 @@ auto ReadTIFF(const filesystem::path& path, mmap_info* mmap_info = nullptr)
  * is >= 4GB, the TIFF will be written using the BigTIFF extension to the TIFF
  * format.
  *
- * @throws volcart::IOException All writing errors
+ * By default, images are strip encoded. Uncompressed images are written as a
+ * single strip so that they can be memory mapped by ReadTIFF. Compressed
+ * images are split into strips of roughly 256KB so that they can be decoded
+ * in parallel and read by region. If `tileSize` is greater than 0, the image
+ * is instead tile encoded with square tiles of the given edge length, which
+ * must be a multiple of 16.
+ *
+ * If a `predictor` is provided, it's applied before compression. Use
+ * Predictor::HORIZONTAL for integer images and Predictor::FLOATINGPOINT for
+ * floating-point images. Predictors are ignored if `compression` is
+ * Compression::NONE.
+ *
+ * @throws volcart::IOException All writing errors, including compression
+ * schemes which are not supported (see IsCompressionSupported())
  */
 void WriteTIFF(
     const filesystem::path& path,
     const cv::Mat& img,
-    Compression compression = Compression::LZW);
+    Compression compression = Compression::LZW,
+    int tileSize = 0,
+    Predictor predictor = Predictor::NONE);
+
+/**
+ * @class TiledTIFFWriter
+ * @brief Write a tiled TIFF image one region at a time
+ *
+ * Creates a tiled TIFF with the given dimensions and pixel type, then accepts
+ * the image in pieces, so the full image never needs to be held in memory.
+ * Supports the same pixel types as WriteTIFF. If the raw size of the image is
+ * >= 4GB, the TIFF is written using the BigTIFF extension.
+ *
+ * Regions can be written in any order, but each tile of the TIFF should only
+ * be written once. The TIFF is finalized by close(), which is called
+ * automatically on destruction. Tiles which were never written are filled with
+ * zeros when the TIFF is closed.
+ *
+ * write() is thread safe.
+ *
+ * @code{.cpp}
+ * tiffio::TiledTIFFWriter writer("out.tif", 4096, 4096, CV_16UC1);
+ * for (int y = 0; y < 4096; y += 1024) {
+ *     for (int x = 0; x < 4096; x += 1024) {
+ *         writer.write(RenderRegion(x, y, 1024, 1024), x, y);
+ *     }
+ * }
+ * writer.close();
+ * @endcode
+ */
+class TiledTIFFWriter
+{
+public:
+    /**
+     * @brief Create a tiled TIFF
+     *
+     * @param path Output file path. Must have a `.tif` or `.tiff` extension.
+     * @param width Image width
+     * @param height Image height
+     * @param cvType OpenCV type of the image (e.g. `CV_16UC1`)
+     * @param tileSize Edge length of the TIFF's tiles. Must be a multiple of
+     * 16.
+     * @param compression Tile compression scheme
+     * @param predictor Tile predictor scheme. See WriteTIFF().
+     * @throws volcart::IOException If the file cannot be created
+     */
+    TiledTIFFWriter(
+        const filesystem::path& path,
+        int width,
+        int height,
+        int cvType,
+        int tileSize = 256,
+        Compression compression = Compression::LZW,
+        Predictor predictor = Predictor::NONE);
+
+    /** @brief Calls close() */
+    ~TiledTIFFWriter();
+
+    /** @brief Get the edge length of the TIFF's tiles */
+    [[nodiscard]] auto tileSize() const -> int;
+
+    /**
+     * @brief Write a region of the image
+     *
+     * The origin `(x, y)` of the region must lie on the tile grid. The width
+     * and height of `img` must be multiples of tileSize(), unless the region
+     * reaches the right or bottom edge of the image, respectively.
+     *
+     * @throws volcart::IOException If the region is invalid or cannot be
+     * written
+     */
+    void write(const cv::Mat& img, int x, int y);
+
+    /**
+     * @brief Finalize and close the TIFF
+     *
+     * @throws volcart::IOException If the TIFF cannot be finalized
+     */
+    void close();
+
+private:
+    /** libtiff handle */
+    struct Handle;
+    /** Output file path */
+    filesystem::path path_;
+    /** Image width */
+    int width_{0};
+    /** Image height */
+    int height_{0};
+    /** Image type */
+    int cvType_{0};
+    /** Tile edge length */
+    int tileSize_{0};
+    /** libtiff handle */
+    std::unique_ptr<Handle> tif_;
+    /** Whether each tile has been written */
+    std::vector<bool> written_;
+    /** Serializes access to the libtiff handle */
+    std::mutex mutex_;
+};
 }  // namespace volcart::tiffio
@@ -0,0 +1,273 @@
+#pragma once
+
+/** @file */
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/PerPixelMap.hpp"
+#include "vc/core/util/MemMap.hpp"
+
+namespace volcart::io
+{
+
+/**
+ * @brief Options for writing a tiled PerPixelMap file
+ *
+ * @ingroup IO
+ */
+struct TiledPPMOptions {
+    /** Edge length of the square tiles in pixels */
+    std::size_t tileSize{1024};
+    /**
+     * Store the mappings as 32-bit floats instead of doubles. Halves the size
+     * of the file at the cost of precision.
+     */
+    bool float32{false};
+    /** Store the pixel mask */
+    bool mask{true};
+    /** Store the cell map */
+    bool cellMap{true};
+};
+
+/**
+ * @brief Returns whether the file at `path` is a tiled PerPixelMap file
+ *
+ * Checks the file's magic bytes, not its extension.
+ *
+ * @ingroup IO
+ */
+auto IsTiledPPM(const filesystem::path& path) -> bool;
+
+/**
+ * @class TiledPPMReader
+ * @brief Read a tiled PerPixelMap file one region at a time
+ *
+ * A tiled PPM stores the mappings, pixel mask, and cell map of a PerPixelMap
+ * in a single binary file. The map is divided into square tiles which are
+ * stored contiguously in row-major tile order, and an index at the front of
+ * the file records the byte offset and number of valid mappings of every
+ * tile. Mappings may be stored as doubles or 32-bit floats. All values are in
+ * native byte order.
+ *
+ * The file is memory mapped when the platform supports it, so only the tiles
+ * which are read are ever paged into memory. Otherwise, tiles are read from a
+ * file stream on demand. Either way, opening a file only reads its header and
+ * index.
+ *
+ * All read functions are thread safe.
+ *
+ * @code{.cpp}
+ * auto reader = TiledPPMReader::New("map.tppm");
+ * for (std::size_t t = 0; t < reader->numTiles(); t++) {
+ *     auto rect = reader->tileRect(t);
+ *     auto tile = reader->readTile(t);
+ *     // tile(y, x) is the mapping for pixel (rect.y + y, rect.x + x)
+ * }
+ * @endcode
+ *
+ * @see TiledPPMWriter
+ * @ingroup IO
+ */
+class TiledPPMReader
+{
+public:
+    /** Pointer type */
+    using Pointer = std::shared_ptr<TiledPPMReader>;
+
+    /**
+     * @brief Open a tiled PPM file
+     *
+     * @throws volcart::IOException If the file cannot be opened or is not a
+     * valid tiled PPM
+     */
+    explicit TiledPPMReader(const filesystem::path& path);
+
+    /** @copydoc TiledPPMReader(const filesystem::path&) */
+    static auto New(const filesystem::path& path) -> Pointer;
+
+    /**@{*/
+    /** @brief Get the height of the map */
+    [[nodiscard]] auto height() const -> std::size_t;
+
+    /** @brief Get the width of the map */
+    [[nodiscard]] auto width() const -> std::size_t;
+
+    /** @brief Get the number of valid mappings in the map */
+    [[nodiscard]] auto numMappings() const -> std::size_t;
+
+    /** @brief Get the options the file was written with */
+    [[nodiscard]] auto options() const -> TiledPPMOptions;
+    /**@}*/
+
+    /**@{*/
+    /** @brief Get the number of tiles */
+    [[nodiscard]] auto numTiles() const -> std::size_t;
+
+    /** @brief Get the region of the map covered by a tile */
+    [[nodiscard]] auto tileRect(std::size_t tile) const -> cv::Rect;
+
+    /** @brief Get the number of valid mappings in a tile */
+    [[nodiscard]] auto tileMappings(std::size_t tile) const -> std::size_t;
+
+    /**
+     * @brief Read a tile
+     *
+     * Returns a PerPixelMap with the dimensions of tileRect(). Pixel (y, x)
+     * of the returned map is pixel `(rect.y + y, rect.x + x)` of the full map.
+     */
+    [[nodiscard]] auto readTile(std::size_t tile) const -> PerPixelMap;
+
+    /**
+     * @brief Read an arbitrary region of the map
+     *
+     * Only the tiles which overlap `roi` are read. The region is clipped to
+     * the bounds of the map.
+     */
+    [[nodiscard]] auto readRegion(const cv::Rect& roi) const -> PerPixelMap;
+    /**@}*/
+
+private:
+    /** Entry in the tile index */
+    struct TileEntry {
+        /** Byte offset of the tile data */
+        std::uint64_t offset;
+        /** Number of valid mappings in the tile */
+        std::uint64_t mappings;
+    };
+
+    /** Read `size` bytes at `offset` into `dst` */
+    void read_(std::uint64_t offset, std::size_t size, void* dst) const;
+
+    /**
+     * Copy the part of a tile which overlaps `roi` into a map of the region.
+     * The mask and cell map are only written if the file stores them.
+     */
+    void copy_tile_(
+        std::size_t tile,
+        const cv::Rect& roi,
+        PerPixelMap& ppm,
+        cv::Mat& mask,
+        cv::Mat& cellMap) const;
+
+    /** File path */
+    filesystem::path path_;
+    /** Map height */
+    std::size_t height_{0};
+    /** Map width */
+    std::size_t width_{0};
+    /** Number of valid mappings */
+    std::size_t numMappings_{0};
+    /** Write options */
+    TiledPPMOptions opts_;
+    /** Number of tile columns */
+    std::size_t tileCols_{0};
+    /** Tile index */
+    std::vector<TileEntry> index_;
+    /** Memory mapped file */
+    auto_mmap_info mmap_;
+    /** Fallback file stream */
+    mutable std::ifstream ifs_;
+    /** Serializes access to the file stream */
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @class TiledPPMWriter
+ * @brief Write a tiled PerPixelMap file one tile at a time
+ *
+ * The size of every tile is known up front, so tiles can be written in any
+ * order and the full map never needs to be held in memory. Tiles which are
+ * never written are filled with zeros, so they have no valid mappings if the
+ * file stores a mask. The header and index are written by close(), which is
+ * called automatically on destruction.
+ *
+ * writeTile() is thread safe.
+ *
+ * @see TiledPPMReader
+ * @ingroup IO
+ */
+class TiledPPMWriter
+{
+public:
+    /**
+     * @brief Create a tiled PPM file with the given dimensions
+     *
+     * @throws volcart::IOException If the file cannot be opened
+     */
+    TiledPPMWriter(
+        const filesystem::path& path,
+        std::size_t height,
+        std::size_t width,
+        TiledPPMOptions opts = {});
+
+    /** @brief Calls close() */
+    ~TiledPPMWriter();
+
+    /** @brief Get the number of tiles */
+    [[nodiscard]] auto numTiles() const -> std::size_t;
+
+    /** @brief Get the region of the map covered by a tile */
+    [[nodiscard]] auto tileRect(std::size_t tile) const -> cv::Rect;
+
+    /**
+     * @brief Write a tile
+     *
+     * `ppm` must have the dimensions of tileRect(). If the file stores a mask
+     * or cell map and `ppm` does not have one, every pixel is treated as
+     * mapped and every cell as unassigned (-1), respectively.
+     *
+     * @throws volcart::IOException If the tile has the wrong dimensions or
+     * cannot be written
+     */
+    void writeTile(std::size_t tile, const PerPixelMap& ppm);
+
+    /**
+     * @brief Write the header and index and close the file
+     *
+     * @throws volcart::IOException If the file cannot be written
+     */
+    void close();
+
+private:
+    /** File path */
+    filesystem::path path_;
+    /** Map height */
+    std::size_t height_{0};
+    /** Map width */
+    std::size_t width_{0};
+    /** Write options */
+    TiledPPMOptions opts_;
+    /** Number of tile columns */
+    std::size_t tileCols_{0};
+    /** Byte offset of every tile */
+    std::vector<std::uint64_t> offsets_;
+    /** Number of valid mappings in every tile */
+    std::vector<std::uint64_t> mappings_;
+    /** Output file stream */
+    std::ofstream ofs_;
+    /** Serializes access to the file stream */
+    std::mutex mutex_;
+};
+
+/**
+ * @brief Write a PerPixelMap to a tiled PPM file
+ *
+ * The mask and cell map are only stored if `ppm` has them, regardless of
+ * `opts`.
+ *
+ * @ingroup IO
+ */
+void WriteTiledPPM(
+    const filesystem::path& path,
+    const PerPixelMap& ppm,
+    TiledPPMOptions opts = {});
+
+}  // namespace volcart::io
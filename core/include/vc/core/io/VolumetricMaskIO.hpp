@@ -0,0 +1,60 @@
+#pragma once
+
+/** @file */
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/VolumetricMask.hpp"
+
+namespace volcart::io
+{
+
+/**
+ * @brief Returns whether the file at `path` is a binary VolumetricMask file
+ *
+ * Checks the file's magic bytes, not its extension.
+ *
+ * @ingroup IO
+ */
+auto IsVolumetricMask(const filesystem::path& path) -> bool;
+
+/**
+ * @brief Write a VolumetricMask to a binary file
+ *
+ * The file stores the mask's blocks directly: a fixed-size header followed by
+ * one record per allocated block, containing the block index and the
+ * block's bits. Records are sorted by block index in z, y, x order, so the
+ * same mask always produces the same file. All values are in native byte
+ * order. By convention, these files use the `.vcmask` extension.
+ *
+ * A densely masked region costs roughly one bit per voxel, compared to 12
+ * bytes per voxel when the mask is written as a `PointSet<cv::Vec3i>`.
+ *
+ * @throws volcart::IOException If the file cannot be written
+ * @ingroup IO
+ */
+void WriteVolumetricMask(
+    const filesystem::path& path, const VolumetricMask& mask);
+
+/**
+ * @brief Read a binary VolumetricMask file
+ *
+ * @throws volcart::IOException If the file cannot be read or is not a binary
+ * VolumetricMask file
+ * @ingroup IO
+ */
+auto ReadVolumetricMask(const filesystem::path& path)
+    -> VolumetricMask::Pointer;
+
+/**
+ * @brief Read a VolumetricMask from a binary mask file or a point set
+ *
+ * Reads `path` with ReadVolumetricMask() if it is a binary VolumetricMask
+ * file. Otherwise, reads it as a `PointSet<cv::Vec3i>` file (`.vcps`).
+ *
+ * @throws volcart::IOException If the file cannot be read
+ * @ingroup IO
+ */
+auto LoadVolumetricMask(const filesystem::path& path)
+    -> VolumetricMask::Pointer;
+
+}  // namespace volcart::io
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
@@ -131,6 +133,83 @@ EigenPairs ComputeSubvoxelEigenPairs(
     int radius = 1,
     int kernelSize = 3);
 
+/**
+ * @brief Compute the eigenvalues and eigenvectors of a structure tensor
+ *
+ * Eigen pairs are sorted by descending eigenvalue.
+ */
+EigenPairs ComputeEigenPairs(const StructureTensor& st);
+
+/**
+ * @class StructureTensorWorkspace
+ * @brief Reusable state for computing many subvoxel structure tensors
+ *
+ * Computes the same values as ComputeSubvoxelStructureTensor() and
+ * ComputeSubvoxelEigenPairs(), but the Gaussian weighting field is computed
+ * once at construction and the neighborhood and gradient fields are kept in
+ * buffers which are reused by every call. Neighborhoods are sampled with a
+ * single batched Volume::interpolateAt() call. After construction, computing a
+ * structure tensor does not allocate memory.
+ *
+ * A workspace is not thread safe. Use one workspace per thread.
+ *
+ * @code{.cpp}
+ * StructureTensorWorkspace ws(radius);
+ * for (const auto& p : points) {
+ *     auto ep = ws.subvoxelEigenPairs(volume, p);
+ * }
+ * @endcode
+ */
+class StructureTensorWorkspace
+{
+public:
+    /**
+     * @brief Construct for a subvolume radius and gradient kernel size
+     *
+     * @throws std::invalid_argument If kernelSize is less than 3
+     */
+    explicit StructureTensorWorkspace(int radius = 1, int kernelSize = 3);
+
+    /** @brief Get the subvolume radius */
+    [[nodiscard]] auto radius() const -> int;
+
+    /** @brief Get the gradient kernel size */
+    [[nodiscard]] auto kernelSize() const -> int;
+
+    /** @copydoc ComputeSubvoxelStructureTensor() */
+    auto subvoxelStructureTensor(
+        const Volume::Pointer& volume, const cv::Vec3d& center)
+        -> StructureTensor;
+
+    /** @copydoc ComputeSubvoxelEigenPairs() */
+    auto subvoxelEigenPairs(
+        const Volume::Pointer& volume, const cv::Vec3d& center) -> EigenPairs;
+
+private:
+    /** Subvolume radius */
+    int radius_;
+    /** Gradient kernel size */
+    int kernelSize_;
+    /** Subvolume edge length */
+    int side_;
+    /** Gaussian weighting field */
+    std::vector<double> gaussian_;
+    /** Sample offsets from the subvolume center */
+    std::vector<cv::Vec3d> offsets_;
+    /** Sample positions */
+    std::vector<cv::Vec3d> positions_;
+    /** Sampled intensities */
+    std::vector<std::uint16_t> intensities_;
+    /** Subvolume values */
+    std::vector<double> values_;
+    /** X gradient field */
+    std::vector<double> gx_;
+    /** Y gradient field */
+    std::vector<double> gy_;
+    /** Z gradient field */
+    std::vector<double> gz_;
+};
+
 /**
  * @brief Get an axis-aligned cuboid subvolume centered on a voxel
  * @param center Center position of the subvolume
@@ -0,0 +1,247 @@
+/**
+ * @file
+ *
+ * @ingroup Math
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/math/StructureTensor.hpp"
+#include "vc/core/types/Cache.hpp"
+#include "vc/core/types/ClockCache.hpp"
+#include "vc/core/types/Volume.hpp"
+#include "vc/core/util/HashFunctions.hpp"
+
+namespace volcart
+{
+/**
+ * @class StructureTensorField
+ * @brief A precomputed, chunked field of structure tensors
+ *
+ * Stores the structure tensor of every voxel in a region of a Volume so that
+ * algorithms which repeatedly estimate the local surface orientation (e.g.
+ * StructureTensorParticleSim and LocalResliceSegmentation) can look the
+ * tensors up instead of recomputing them for every query. Tensors are
+ * trilinearly interpolated between voxels, and eigen pairs are computed from
+ * the interpolated tensor. Interpolating the tensors rather than their
+ * eigenvectors avoids the sign ambiguity of eigenvectors.
+ *
+ * Tensors are computed for a subvolume `radius` with the same weighting as
+ * ComputeSubvoxelStructureTensor() with a gradient kernel size of 3. Because
+ * the gradients are computed over the whole Volume rather than over each
+ * subvolume, tensors near the edge of a subvolume differ slightly from those
+ * of ComputeSubvoxelStructureTensor(), but the dominant orientations match.
+ *
+ * The field is stored in a directory, usually inside the Volume's directory
+ * (see DefaultPath()). The directory contains a `meta.json` file and the
+ * chunk files, which are written with chunkio::WriteChunk(). Each chunk stores
+ * the 6 unique elements `(xx, xy, xz, yy, yz, zz)` of the symmetric tensors as
+ * 32-bit floats. Chunks are loaded on demand and cached, and all lookups are
+ * thread safe.
+ *
+ * @see ComputeStructureTensorField()
+ * @ingroup Math
+ */
+class StructureTensorField
+{
+public:
+    /** Shared pointer type */
+    using Pointer = std::shared_ptr<StructureTensorField>;
+
+    /** Chunk index type */
+    using ChunkIndex = cv::Vec3i;
+
+    /** Chunk cache type */
+    using ChunkCache = Cache<ChunkIndex, cv::Mat>;
+
+    /** Default chunk cache type */
+    using DefaultChunkCache = ClockCache<ChunkIndex, cv::Mat, Vec3iHash>;
+
+    /** Default chunk edge length */
+    static constexpr int DEFAULT_CHUNK_SIZE = 64;
+
+    /**
+     * Default chunk cache capacity in bytes. Holds 16 chunks of the default
+     * size, each of which is 6 MB.
+     */
+    static constexpr std::size_t DEFAULT_CACHE_BYTES = std::size_t{100} << 20;
+
+    /** OpenCV type of the chunks */
+    static constexpr int CHUNK_TYPE = CV_32FC(6);
+
+    /**
+     * @brief Load a field from a directory
+     *
+     * @throws volcart::IOException If the directory does not contain a
+     * structure tensor field
+     */
+    explicit StructureTensorField(filesystem::path path);
+
+    /** @copydoc StructureTensorField(filesystem::path) */
+    static auto New(filesystem::path path) -> Pointer;
+
+    /**
+     * @brief Create an empty field for a region of a Volume
+     *
+     * Writes the field metadata to `path`. Use computeChunk() to fill the
+     * field.
+     *
+     * @param path Output directory
+     * @param volume Source Volume
+     * @param radius Subvolume radius of the structure tensors
+     * @param min Inclusive minimum voxel of the region
+     * @param max Exclusive maximum voxel of the region
+     * @param chunkSize Chunk edge length
+     */
+    static auto Create(
+        const filesystem::path& path,
+        const Volume::Pointer& volume,
+        int radius,
+        const cv::Vec3i& min,
+        const cv::Vec3i& max,
+        int chunkSize = DEFAULT_CHUNK_SIZE) -> Pointer;
+
+    /**
+     * @brief Get the default location of a field for a Volume
+     *
+     * Returns `<volume>/structure_tensors/r<radius>`.
+     */
+    static auto DefaultPath(const Volume::Pointer& volume, int radius)
+        -> filesystem::path;
+
+    /**@{*/
+    /** @brief Get the field directory */
+    [[nodiscard]] auto path() const -> filesystem::path;
+
+    /** @brief Get the ID of the source Volume */
+    [[nodiscard]] auto volumeID() const -> std::string;
+
+    /** @brief Get the subvolume radius of the structure tensors */
+    [[nodiscard]] auto radius() const -> int;
+
+    /** @brief Get the chunk edge length */
+    [[nodiscard]] auto chunkSize() const -> int;
+
+    /** @brief Get the inclusive minimum voxel of the region */
+    [[nodiscard]] auto min() const -> cv::Vec3i;
+
+    /** @brief Get the exclusive maximum voxel of the region */
+    [[nodiscard]] auto max() const -> cv::Vec3i;
+
+    /** @brief Get the number of chunks along each axis */
+    [[nodiscard]] auto chunkGridExtents() const -> cv::Vec3i;
+
+    /**
+     * @brief Whether a position can be looked up in the field
+     *
+     * True if every voxel used to interpolate `p` is inside the region.
+     */
+    [[nodiscard]] auto isInBounds(const cv::Vec3d& p) const -> bool;
+    /**@}*/
+
+    /**@{*/
+    /**
+     * @brief Get the structure tensor of a voxel
+     *
+     * Positions outside of the region are clamped to the region.
+     */
+    auto tensorAt(int x, int y, int z) const -> StructureTensor;
+
+    /**
+     * @brief Get the trilinearly interpolated structure tensor at a subvoxel
+     * position
+     *
+     * Positions outside of the region are clamped to the region.
+     */
+    auto interpolateAt(const cv::Vec3d& p) const -> StructureTensor;
+
+    /**
+     * @brief Get the eigen pairs of the structure tensor at a subvoxel
+     * position
+     *
+     * Eigen pairs are sorted by descending eigenvalue, like those returned by
+     * ComputeSubvoxelEigenPairs().
+     */
+    auto eigenPairsAt(const cv::Vec3d& p) const -> EigenPairs;
+    /**@}*/
+
+    /**@{*/
+    /**
+     * @brief Compute and write a chunk of the field
+     *
+     * Thread safe, as long as each chunk is only computed by one thread.
+     */
+    void computeChunk(const Volume::Pointer& volume, const ChunkIndex& index);
+
+    /** @brief Get the path of a chunk file */
+    [[nodiscard]] auto chunkPath(const ChunkIndex& index) const
+        -> filesystem::path;
+    /**@}*/
+
+    /**@{*/
+    /** @brief Set the maximum number of bytes held by the chunk cache */
+    void setCacheMemoryInBytes(std::size_t nbytes) const;
+
+    /** @brief Purge the chunk cache */
+    void cachePurge() const;
+    /**@}*/
+
+private:
+    /** Default constructor for Create() */
+    StructureTensorField() = default;
+    /** Create a chunk cache which weighs chunks by bytes */
+    static auto NewCache_() -> ChunkCache::Pointer;
+    /** Get a chunk from the cache or disk */
+    auto chunk_(const ChunkIndex& index) const -> cv::Mat;
+    /** Get the packed tensor elements of a voxel in the region */
+    auto elements_(int x, int y, int z) const -> cv::Vec6f;
+
+    /** Field directory */
+    filesystem::path path_;
+    /** Source volume ID */
+    std::string volumeID_;
+    /** Subvolume radius */
+    int radius_{1};
+    /** Chunk edge length */
+    int chunkSize_{DEFAULT_CHUNK_SIZE};
+    /** Inclusive region minimum */
+    cv::Vec3i min_{0, 0, 0};
+    /** Exclusive region maximum */
+    cv::Vec3i max_{0, 0, 0};
+    /** Chunk cache */
+    mutable ChunkCache::Pointer cache_{NewCache_()};
+};
+
+/**
+ * @brief Compute the structure tensor field for a region of a Volume
+ *
+ * Convenience function which creates a field with
+ * StructureTensorField::Create() and computes all of its chunks in parallel.
+ * If `min` and `max` are not provided, the field covers the whole Volume.
+ *
+ * Each chunk is computed in a single streaming pass over the Volume: the
+ * gradients are computed with separable Scharr filters and the Gaussian
+ * weighting is applied with separable 1D filters, so the cost per voxel is
+ * O(radius) rather than the O(radius^3) of computing every tensor separately.
+ *
+ * @ingroup Math
+ */
+auto ComputeStructureTensorField(
+    const filesystem::path& path,
+    const Volume::Pointer& volume,
+    int radius,
+    std::optional<cv::Vec3i> min = std::nullopt,
+    std::optional<cv::Vec3i> max = std::nullopt,
+    int chunkSize = StructureTensorField::DEFAULT_CHUNK_SIZE,
+    std::optional<std::uint32_t> maxThreads = std::nullopt)
+    -> StructureTensorField::Pointer;
+}  // namespace volcart
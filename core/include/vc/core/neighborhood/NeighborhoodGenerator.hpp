@@ -85,6 +85,21 @@ public:
      */
     void setSamplingDirection(Direction d) { direction_ = d; }
 
+    /**
+     * @brief Set the Volume resolution level which samples are read from
+     *
+     * Sampling positions, radii, and intervals are always in full-resolution
+     * Volume units, so a generator produces neighborhoods of the same extents
+     * at every level. Coarse levels read far less data, which makes them
+     * suitable for previews. See Volume::level().
+     *
+     * Default: 0 (full resolution)
+     */
+    void setSamplingLevel(int level) { level_ = level; }
+
+    /** @brief Get the Volume resolution level which samples are read from */
+    int samplingLevel() const { return level_; }
+
     /**
      * @brief Enable/Disable auto-generation of missing axes
      *
@@ -119,6 +134,9 @@ protected:
     /** Filtering direction */
     Direction direction_{Direction::Bidirectional};
 
+    /** Volume resolution level */
+    int level_{0};
+
     /** Auto-generate Axes flag */
     bool autoGenAxes_{true};
 };
@@ -4,12 +4,20 @@
 
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <optional>
 
 namespace volcart
 {
 /**
  * @brief Abstract Base Class for Key-Value Caches
  *
+ * The capacity of a cache is measured in weight units. By default, every item
+ * has a weight of 1, so the capacity is the maximum number of items in the
+ * cache. If a weighing function is provided with setWeigher(), the capacity is
+ * instead the maximum total weight of all items in the cache (e.g. the
+ * maximum number of bytes held by the cache).
+ *
  * @tparam TKey Key type
  * @tparam TValue Value type
  */
@@ -24,20 +32,41 @@ public:
     using Pointer = std::shared_ptr<Cache>;
 
     /**@{*/
-    /** @brief Set the maximum number of elements in the cache */
+    /** @brief Set the maximum total weight of the elements in the cache */
     virtual void setCapacity(std::size_t newCapacity) = 0;
 
-    /** @brief Get the maximum number of elements in the cache */
+    /** @brief Get the maximum total weight of the elements in the cache */
     [[nodiscard]] virtual auto capacity() const -> std::size_t = 0;
 
     /** @brief Get the current number of elements in the cache */
     [[nodiscard]] virtual auto size() const -> std::size_t = 0;
+
+    /** @brief Get the current total weight of the elements in the cache */
+    [[nodiscard]] virtual auto weight() const -> std::size_t = 0;
+
+    /**
+     * @brief Set a function which returns the weight of a cache item
+     *
+     * Existing items are reweighed using the new function.
+     */
+    virtual void setWeigher(std::function<std::size_t(const TValue&)> fn) = 0;
+
+    /** @brief Remove the weighing function. All items have a weight of 1. */
+    virtual void resetWeigher() = 0;
     /**@}*/
 
     /**@{*/
     /** @brief Get an item from the cache by key */
     virtual auto get(const TKey& k) -> TValue = 0;
 
+    /**
+     * @brief Get an item from the cache by key if it is in the cache
+     *
+     * Unlike calling contains() followed by get(), the lookup is atomic with
+     * respect to concurrent evictions in thread-safe implementations.
+     */
+    virtual auto tryGet(const TKey& k) -> std::optional<TValue> = 0;
+
     /** @brief Put an item into the cache */
     virtual auto put(const TKey& k, const TValue& v) -> void = 0;
 
@@ -69,5 +98,14 @@ protected:
 
     /** Callback to verify if an entry can be ejected */
     std::function<bool(TKey&, TValue&)> on_eject_;
+
+    /** Function which returns the weight of an item */
+    std::function<std::size_t(const TValue&)> weigher_;
+
+    /** Get the weight of an item */
+    auto weigh_(const TValue& v) const -> std::size_t
+    {
+        return weigher_ ? weigher_(v) : 1;
+    }
 };
 }  // namespace volcart
@@ -0,0 +1,400 @@
+#pragma once
+
+/** @file */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "vc/core/types/Cache.hpp"
+
+namespace volcart
+{
+
+/**
+ * @class ClockCache
+ * @brief Concurrent, sharded cache with a CLOCK (second chance) replacement
+ * policy
+ *
+ * Items are distributed across a fixed number of shards by the hash of their
+ * key. Each shard has its own lock, so operations on different shards never
+ * block each other. Cache hits only take a shared lock on the item's shard and
+ * set the item's reference bit, so concurrent reads of the same item do not
+ * serialize. This makes the cache well suited to workloads where many threads
+ * repeatedly read a small set of hot items, such as parallel texturing.
+ *
+ * When the total weight of the cache exceeds its capacity, a single global
+ * clock hand sweeps the shards in order. Items whose reference bit is set are
+ * given a second chance (the bit is cleared), and items whose bit is clear
+ * are evicted. This approximates least recently used replacement without
+ * reordering any data structure on a cache hit.
+ *
+ * If a function is provided to onEvict(), cache entries are only removed if
+ * the function returns `true` for the given entry. See LRUCache::onEvict() for
+ * more details.
+ *
+ * @tparam TKey Key type
+ * @tparam TValue Value type
+ * @tparam THash Hash function for TKey
+ *
+ * @ingroup Types
+ */
+template <typename TKey, typename TValue, class THash = std::hash<TKey>>
+class ClockCache final : public Cache<TKey, TValue>
+{
+public:
+    using BaseClass = Cache<TKey, TValue>;
+    using BaseClass::capacity_;
+
+    /** Number of shards */
+    static constexpr std::size_t NUM_SHARDS = 64;
+
+    /** Shared pointer type */
+    using Pointer = std::shared_ptr<ClockCache<TKey, TValue, THash>>;
+
+    /**@{*/
+    /** @brief Default constructor */
+    ClockCache() : BaseClass(), capacity_hint_{capacity_} {}
+
+    /** @brief Constructor with cache capacity parameter */
+    explicit ClockCache(std::size_t capacity)
+        : BaseClass(capacity), capacity_hint_{capacity}
+    {
+    }
+
+    /** @overload ClockCache() */
+    static auto New() -> Pointer
+    {
+        return std::make_shared<ClockCache<TKey, TValue, THash>>();
+    }
+
+    /** @overload ClockCache(std::size_t) */
+    static auto New(std::size_t capacity) -> Pointer
+    {
+        return std::make_shared<ClockCache<TKey, TValue, THash>>(capacity);
+    }
+    /**@}*/
+
+    /**@{*/
+    /** @brief Set the maximum total weight of the elements in the cache */
+    void setCapacity(std::size_t capacity) override
+    {
+        if (capacity <= 0) {
+            throw std::invalid_argument(
+                "Cannot create cache with capacity <= 0");
+        }
+        {
+            std::unique_lock lock(evict_mutex_);
+            capacity_ = capacity;
+            capacity_hint_ = capacity;
+        }
+        evict();
+    }
+
+    /** @brief Get the maximum total weight of the elements in the cache */
+    auto capacity() const -> std::size_t override
+    {
+        std::unique_lock lock(evict_mutex_);
+        return capacity_;
+    }
+
+    /** @brief Get the current number of elements in the cache */
+    auto size() const -> std::size_t override { return size_; }
+
+    /** @brief Get the current total weight of the elements in the cache */
+    auto weight() const -> std::size_t override { return weight_; }
+
+    /** @copydoc Cache::setWeigher() */
+    void setWeigher(std::function<std::size_t(const TValue&)> fn) override
+    {
+        {
+            std::unique_lock lock(evict_mutex_);
+            auto locks = lock_all_shards_();
+            BaseClass::weigher_ = fn;
+            reweigh_();
+        }
+        evict();
+    }
+
+    /** @copydoc Cache::resetWeigher() */
+    void resetWeigher() override
+    {
+        {
+            std::unique_lock lock(evict_mutex_);
+            auto locks = lock_all_shards_();
+            BaseClass::weigher_ = {};
+            reweigh_();
+        }
+        evict();
+    }
+    /**@}*/
+
+    /**@{*/
+    /** @brief Get an item from the cache by key */
+    auto get(const TKey& k) -> TValue override
+    {
+        auto v = tryGet(k);
+        if (not v) {
+            throw std::invalid_argument("Key not in cache");
+        }
+        return std::move(v.value());
+    }
+
+    /** @copydoc Cache::tryGet() */
+    auto tryGet(const TKey& k) -> std::optional<TValue> override
+    {
+        auto& shard = shard_(k);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.lookup.find(k);
+        if (it == std::end(shard.lookup)) {
+            return std::nullopt;
+        }
+        auto& entry = *it->second;
+        // Avoid dirtying the cache line when the bit is already set
+        if (not entry.referenced.load(std::memory_order_relaxed)) {
+            entry.referenced.store(true, std::memory_order_relaxed);
+        }
+        return entry.value;
+    }
+
+    /** @brief Put an item into the cache */
+    void put(const TKey& k, const TValue& v) override
+    {
+        {
+            auto& shard = shard_(k);
+            std::unique_lock lock(shard.mutex);
+            const auto w = BaseClass::weigh_(v);
+
+            // If already in cache, need to refresh it
+            auto it = shard.lookup.find(k);
+            if (it != std::end(shard.lookup)) {
+                auto& entry = *it->second;
+                if (BaseClass::on_eject_) {
+                    BaseClass::on_eject_(entry.key, entry.value);
+                }
+                weight_ -= entry.weight;
+                entry.value = v;
+                entry.weight = w;
+                entry.referenced = true;
+                weight_ += w;
+            }
+
+            // Insert behind the clock hand so it's the last to be checked
+            else {
+                auto pos = shard.items.emplace(shard.hand, k, v, w);
+                shard.lookup[k] = pos;
+                weight_ += w;
+                ++size_;
+            }
+        }
+        evict();
+    }
+
+    /** @brief Check if an item is already in the cache */
+    auto contains(const TKey& k) -> bool override
+    {
+        auto& shard = shard_(k);
+        std::shared_lock lock(shard.mutex);
+        return shard.lookup.find(k) != std::end(shard.lookup);
+    }
+
+    /** @copydoc LRUCache::onEvict() */
+    void onEvict(std::function<bool(TKey&, TValue&)> fn) override
+    {
+        std::unique_lock lock(evict_mutex_);
+        auto locks = lock_all_shards_();
+        BaseClass::on_eject_ = fn;
+    }
+
+    /** @copydoc LRUCache::resetOnEvict() */
+    void resetOnEvict() override
+    {
+        std::unique_lock lock(evict_mutex_);
+        auto locks = lock_all_shards_();
+        BaseClass::on_eject_ = {};
+    }
+
+    /**
+     * @brief Evict items following the cache policy
+     *
+     * Automatically called whenever the cache weight is expected to exceed
+     * the current capacity. Only one thread evicts at a time, and the evicting
+     * thread only holds the lock of the shard it is currently sweeping.
+     */
+    void evict() override
+    {
+        // Quick check without any lock
+        if (weight_ <= capacity_hint_) {
+            return;
+        }
+
+        std::unique_lock evictLock(evict_mutex_);
+        // Give up after two full sweeps without progress: the first clears
+        // every reference bit, so the second can only fail because every
+        // remaining item was rejected by on_eject_
+        std::size_t idleShards{0};
+        while (weight_ > capacity_ and idleShards < 2 * NUM_SHARDS) {
+            auto& shard = shards_[hand_shard_];
+            hand_shard_ = (hand_shard_ + 1) % NUM_SHARDS;
+
+            std::unique_lock lock(shard.mutex);
+            if (sweep_shard_(shard)) {
+                idleShards = 0;
+            } else {
+                ++idleShards;
+            }
+        }
+    }
+
+    /** @brief Evict all items ignoring cache policy */
+    void purge() override
+    {
+        std::unique_lock evictLock(evict_mutex_);
+        for (auto& shard : shards_) {
+            std::unique_lock lock(shard.mutex);
+            for (auto it = shard.items.begin(); it != shard.items.end();) {
+                if (not BaseClass::on_eject_ or
+                    BaseClass::on_eject_(it->key, it->value)) {
+                    it = erase_(shard, it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+    /**@}*/
+
+private:
+    /** Cache entry */
+    struct Entry {
+        /** Constructor */
+        Entry(const TKey& k, const TValue& v, std::size_t w)
+            : key{k}, value{v}, weight{w}
+        {
+        }
+        /** Key */
+        TKey key;
+        /** Value */
+        TValue value;
+        /** Weight */
+        std::size_t weight{1};
+        /** Reference bit */
+        std::atomic<bool> referenced{true};
+    };
+
+    /** Entry list iterator */
+    using EntryIterator = typename std::list<Entry>::iterator;
+
+    /** Independently locked subset of the cache */
+    struct Shard {
+        /** Entries in clock order */
+        std::list<Entry> items;
+        /** Key lookup */
+        std::unordered_map<TKey, EntryIterator, THash> lookup;
+        /** Clock hand */
+        EntryIterator hand{items.end()};
+        /** Shard mutex */
+        std::shared_mutex mutex;
+    };
+
+    /** Get the shard for a key */
+    auto shard_(const TKey& k) -> Shard&
+    {
+        // Mix the bits since std::hash is often the identity for integers
+        auto h = static_cast<std::uint64_t>(THash{}(k));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return shards_[h % NUM_SHARDS];
+    }
+
+    /** Lock every shard for writing */
+    auto lock_all_shards_()
+        -> std::array<std::unique_lock<std::shared_mutex>, NUM_SHARDS>
+    {
+        std::array<std::unique_lock<std::shared_mutex>, NUM_SHARDS> locks;
+        for (std::size_t i = 0; i < NUM_SHARDS; i++) {
+            locks[i] = std::unique_lock(shards_[i].mutex);
+        }
+        return locks;
+    }
+
+    /** Recompute the total weight of all items. Requires all shard locks. */
+    void reweigh_()
+    {
+        std::size_t w{0};
+        for (auto& shard : shards_) {
+            for (auto& entry : shard.items) {
+                entry.weight = BaseClass::weigh_(entry.value);
+                w += entry.weight;
+            }
+        }
+        weight_ = w;
+    }
+
+    /** Remove an entry from a shard, keeping the clock hand valid */
+    auto erase_(Shard& shard, EntryIterator it) -> EntryIterator
+    {
+        weight_ -= it->weight;
+        --size_;
+        shard.lookup.erase(it->key);
+        const auto atHand = shard.hand == it;
+        auto next = shard.items.erase(it);
+        if (atHand) {
+            shard.hand = next;
+        }
+        return next;
+    }
+
+    /**
+     * Advance the shard's clock hand through at most one revolution, evicting
+     * unreferenced items until the cache is within capacity. Returns whether
+     * any item was evicted or had its reference bit cleared.
+     */
+    auto sweep_shard_(Shard& shard) -> bool
+    {
+        bool progress{false};
+        auto remaining = shard.items.size();
+        while (remaining-- > 0 and weight_ > capacity_) {
+            if (shard.hand == std::end(shard.items)) {
+                shard.hand = std::begin(shard.items);
+            }
+            auto& entry = *shard.hand;
+            if (entry.referenced.exchange(false)) {
+                progress = true;
+                ++shard.hand;
+            } else if (
+                not BaseClass::on_eject_ or
+                BaseClass::on_eject_(entry.key, entry.value)) {
+                progress = true;
+                shard.hand = erase_(shard, shard.hand);
+            } else {
+                ++shard.hand;
+            }
+        }
+        return progress;
+    }
+
+    /** Cache shards */
+    std::array<Shard, NUM_SHARDS> shards_;
+    /** Serializes eviction and policy changes */
+    mutable std::mutex evict_mutex_;
+    /** Shard visited next by the clock hand */
+    std::size_t hand_shard_{0};
+    /** Current number of elements */
+    std::atomic<std::size_t> size_{0};
+    /** Current total weight */
+    std::atomic<std::size_t> weight_{0};
+    /** Copy of the capacity which can be read without locking */
+    std::atomic<std::size_t> capacity_hint_;
+};
+}  // namespace volcart
@@ -3,9 +3,11 @@
 /** @file */
 
 #include <cstddef>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <unordered_map>
 
@@ -16,6 +18,14 @@ namespace volcart
 
 /** No-op mutex */
 struct NoOpMutex {
+    /** Does nothing */
+    void lock() {}
+    /** Does nothing */
+    void unlock() {}
+    /** Does nothing */
+    void lock_shared() {}
+    /** Does nothing */
+    void unlock_shared() {}
 };
 
 /**
@@ -24,9 +34,10 @@ struct NoOpMutex {
  * @author Sean Karlage
  *
  * A cache using a least recently used replacement policy. As elements are used,
- * they are moved to the front of the cache. When the cache exceeds capacity,
- * elements are popped from the end of the cache and replacement elements are
- * added to the front.
+ * they are moved to the front of the cache. When the total weight of the
+ * elements exceeds the capacity, elements are popped from the end of the cache
+ * and replacement elements are added to the front. See Cache for a description
+ * of element weights.
  *
  * Data elements are stored in a std::list, ordered from most to least recently
  * used. A key-value map into this list is stored in a std::unordered_map.
@@ -38,9 +49,18 @@ struct NoOpMutex {
  * Design mostly taken from
  * <a href = "https://github.com/lamerman/cpp-lru-cache">here</a>.
  *
+ * @tparam TKey Key type
+ * @tparam TValue Value type
+ * @tparam TMutex Mutex type used to guard the cache
+ * @tparam THash Hash function for TKey
+ *
  * @ingroup Types
  */
-template <typename TKey, typename TValue, class TMutex = std::shared_mutex>
+template <
+    typename TKey,
+    typename TValue,
+    class TMutex = std::shared_mutex,
+    class THash = std::hash<TKey>>
 class LRUCache final : public Cache<TKey, TValue>
 {
 public:
@@ -62,7 +82,7 @@ public:
     using TListIterator = typename std::list<TPair>::iterator;
 
     /** Shared pointer type */
-    using Pointer = std::shared_ptr<LRUCache<TKey, TValue>>;
+    using Pointer = std::shared_ptr<LRUCache<TKey, TValue, TMutex, THash>>;
 
     /**@{*/
     /** @brief Default constructor */
@@ -74,18 +94,19 @@ public:
     /** @overload LRUCache() */
     static auto New() -> Pointer
     {
-        return std::make_shared<LRUCache<TKey, TValue>>();
+        return std::make_shared<LRUCache<TKey, TValue, TMutex, THash>>();
     }
 
     /** @overload LRUCache(std::size_t) */
     static auto New(std::size_t capacity) -> Pointer
     {
-        return std::make_shared<LRUCache<TKey, TValue>>(capacity);
+        return std::make_shared<LRUCache<TKey, TValue, TMutex, THash>>(
+            capacity);
     }
     /**@}*/
 
     /**@{*/
-    /** @brief Set the maximum number of elements in the cache */
+    /** @brief Set the maximum total weight of the elements in the cache */
     void setCapacity(std::size_t capacity) override
     {
         std::unique_lock lock(cache_mutex_);
@@ -97,11 +118,32 @@ public:
         evict();
     }
 
-    /** @brief Get the maximum number of elements in the cache */
+    /** @brief Get the maximum total weight of the elements in the cache */
     auto capacity() const -> std::size_t override { return capacity_; }
 
     /** @brief Get the current number of elements in the cache */
     auto size() const -> std::size_t override { return lookup_.size(); }
+
+    /** @brief Get the current total weight of the elements in the cache */
+    auto weight() const -> std::size_t override { return weight_; }
+
+    /** @copydoc Cache::setWeigher() */
+    void setWeigher(std::function<std::size_t(const TValue&)> fn) override
+    {
+        std::unique_lock lock(cache_mutex_);
+        BaseClass::weigher_ = fn;
+        reweigh_();
+        evict();
+    }
+
+    /** @copydoc Cache::resetWeigher() */
+    void resetWeigher() override
+    {
+        std::unique_lock lock(cache_mutex_);
+        BaseClass::weigher_ = {};
+        reweigh_();
+        evict();
+    }
     /**@}*/
 
     /**@{*/
@@ -118,6 +160,19 @@ public:
         return lookupIter->second->second;
     }
 
+    /** @copydoc Cache::tryGet() */
+    auto tryGet(const TKey& k) -> std::optional<TValue> override
+    {
+        std::unique_lock lock(cache_mutex_);
+        auto lookupIter = lookup_.find(k);
+        if (lookupIter == std::end(lookup_)) {
+            return std::nullopt;
+        }
+
+        items_.splice(std::begin(items_), items_, lookupIter->second);
+        return lookupIter->second->second;
+    }
+
     /** @brief Put an item into the cache */
     void put(const TKey& k, const TValue& v) override
     {
@@ -129,12 +184,14 @@ public:
             if (BaseClass::on_eject_) {
                 BaseClass::on_eject_(key, val);
             }
+            weight_ -= BaseClass::weigh_(val);
             items_.erase(lookupIter->second);
             lookup_.erase(lookupIter);
         }
 
         items_.push_front(TPair(k, v));
         lookup_[k] = std::begin(items_);
+        weight_ += BaseClass::weigh_(v);
         evict();
     }
 
@@ -180,14 +237,15 @@ public:
      */
     void evict() override
     {  // Already below capacity
-        if (lookup_.size() <= capacity_) {
+        if (weight_ <= capacity_) {
             return;
         }
 
         // If we don't have an onEject callback, fast remove the last element
         if (not BaseClass::on_eject_) {
-            while (lookup_.size() > capacity_) {
-                auto& [key, _] = items_.back();
+            while (weight_ > capacity_ and not items_.empty()) {
+                auto& [key, value] = items_.back();
+                weight_ -= BaseClass::weigh_(value);
                 lookup_.erase(key);
                 items_.pop_back();
             }
@@ -201,6 +259,7 @@ public:
 
             // Eject this item
             if (BaseClass::on_eject_(key, value)) {
+                weight_ -= BaseClass::weigh_(value);
                 lookup_.erase(key);
                 it = std::next(it);
                 it = std::reverse_iterator(items_.erase(it.base()));
@@ -209,7 +268,7 @@ public:
             }
 
             // Stop when we've reset to capacity
-            if (lookup_.size() <= capacity_) {
+            if (weight_ <= capacity_) {
                 break;
             }
         }
@@ -224,6 +283,7 @@ public:
             for (auto it = items_.begin(); it != items_.end();) {
                 auto& [key, value] = *it;
                 if (BaseClass::on_eject_(key, value)) {
+                    weight_ -= BaseClass::weigh_(value);
                     lookup_.erase(key);
                     it = items_.erase(it);
                 } else {
@@ -236,15 +296,27 @@ public:
         else {
             lookup_.clear();
             items_.clear();
+            weight_ = 0;
         }
     }
     /**@}*/
 
 private:
+    /** Recompute the total weight of all items */
+    void reweigh_()
+    {
+        weight_ = 0;
+        for (const auto& [key, value] : items_) {
+            weight_ += BaseClass::weigh_(value);
+        }
+    }
+
+    /** Current total weight of all items */
+    std::size_t weight_{0};
     /** Cache data storage */
     std::list<TPair> items_;
     /** Cache usage information */
-    std::unordered_map<TKey, TListIterator> lookup_;
+    std::unordered_map<TKey, TListIterator, THash> lookup_;
     /** Shared mutex for thread-safe access */
     mutable TMutex cache_mutex_;
 };
@@ -233,10 +233,23 @@ public:
     /**@}*/
 
     /**@{*/
-    /** @brief Write a PerPixelMap to disk */
+    /**
+     * @brief Write a PerPixelMap to disk
+     *
+     * If `path` has the `.tppm` extension, the map is written as a single
+     * tiled PPM file with the default io::TiledPPMOptions. Otherwise, the
+     * mappings are written as an ordered point set and the mask and cell map
+     * are written to `<stem>_mask.png` and `<stem>_cellmap.tif`.
+     */
     static void WritePPM(const filesystem::path& path, const PerPixelMap& map);
 
-    /** @brief Read a PerPixelMap from disk */
+    /**
+     * @brief Read a PerPixelMap from disk
+     *
+     * Reads both tiled and ordered point set PPM files. Tiled PPMs are
+     * detected by their contents, not their extension. To read a large tiled
+     * PPM one region at a time, use io::TiledPPMReader.
+     */
     static auto ReadPPM(const filesystem::path& path) -> PerPixelMap;
     /**@}*/
 
@@ -0,0 +1,141 @@
+#pragma once
+
+/** @file */
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/types/ITKMesh.hpp"
+#include "vc/core/types/UVMap.hpp"
+
+namespace volcart
+{
+
+/**
+ * @class TriangleMesh
+ * @brief Triangle mesh stored as flat, per-attribute arrays
+ *
+ * A structure-of-arrays alternative to ITKMesh for algorithms which visit
+ * every vertex or face. Vertex positions, vertex normals, vertex UVs, and
+ * face indices are each stored in one contiguous array, so iterating the mesh
+ * is a linear scan with no per-face allocations, virtual calls, or point-ID
+ * container copies. A face costs 24 bytes, compared to a separately allocated
+ * cell object per face in an ITKMesh.
+ *
+ * Normals and UVs are optional. When present, there is exactly one per
+ * vertex.
+ *
+ * Const member functions are thread safe. Modifying the mesh is not.
+ *
+ * @ingroup Types
+ */
+class TriangleMesh
+{
+public:
+    /** Vertex position type */
+    using Vertex = cv::Vec3d;
+    /** Vertex normal type */
+    using Normal = cv::Vec3d;
+    /** Vertex UV type */
+    using UV = cv::Vec2d;
+    /** Face type. The indices of the face's three vertices. */
+    using Face = std::array<std::size_t, 3>;
+
+    /** Pointer type */
+    using Pointer = std::shared_ptr<TriangleMesh>;
+
+    /** Static New function for all constructors of T */
+    template <typename... Args>
+    static auto New(Args... args) -> Pointer
+    {
+        return std::make_shared<TriangleMesh>(std::forward<Args>(args)...);
+    }
+
+    /**@{*/
+    /** @brief Default constructor */
+    TriangleMesh() = default;
+
+    /** @brief Construct from vertices and faces */
+    TriangleMesh(std::vector<Vertex> vertices, std::vector<Face> faces);
+    /**@}*/
+
+    /**@{*/
+    /**
+     * @brief Copy an ITKMesh
+     *
+     * Normals are copied if every vertex has point data. If `uvMap` is
+     * provided, UVs are copied relative to the UV map's current origin.
+     * Vertices without a UV mapping are assigned NULL_MAPPING.
+     *
+     * @throws std::invalid_argument If the mesh contains non-triangular faces
+     */
+    static auto FromITKMesh(
+        const ITKMesh::Pointer& mesh, const UVMap::Pointer& uvMap = nullptr)
+        -> Pointer;
+
+    /**
+     * @brief Copy this mesh to an ITKMesh
+     *
+     * Normals are copied to the vertex point data if the mesh has normals.
+     */
+    [[nodiscard]] auto toITKMesh() const -> ITKMesh::Pointer;
+    /**@}*/
+
+    /**@{*/
+    /** @brief Get the number of vertices */
+    [[nodiscard]] auto numVertices() const -> std::size_t;
+
+    /** @brief Get the number of faces */
+    [[nodiscard]] auto numFaces() const -> std::size_t;
+
+    /** @brief Whether the mesh has no vertices */
+    [[nodiscard]] auto empty() const -> bool;
+
+    /** @brief Whether every vertex has a normal */
+    [[nodiscard]] auto hasNormals() const -> bool;
+
+    /** @brief Whether every vertex has a UV */
+    [[nodiscard]] auto hasUVs() const -> bool;
+
+    /** @brief Remove all vertices, faces, and attributes */
+    void clear();
+    /**@}*/
+
+    /**@{*/
+    /** @brief Get the vertex positions */
+    auto vertices() -> std::vector<Vertex>&;
+    /** @copydoc vertices() */
+    [[nodiscard]] auto vertices() const -> const std::vector<Vertex>&;
+
+    /** @brief Get the vertex normals */
+    auto normals() -> std::vector<Normal>&;
+    /** @copydoc normals() */
+    [[nodiscard]] auto normals() const -> const std::vector<Normal>&;
+
+    /** @brief Get the vertex UVs */
+    auto uvs() -> std::vector<UV>&;
+    /** @copydoc uvs() */
+    [[nodiscard]] auto uvs() const -> const std::vector<UV>&;
+
+    /** @brief Get the faces */
+    auto faces() -> std::vector<Face>&;
+    /** @copydoc faces() */
+    [[nodiscard]] auto faces() const -> const std::vector<Face>&;
+    /**@}*/
+
+private:
+    /** Vertex positions */
+    std::vector<Vertex> vertices_;
+    /** Vertex normals */
+    std::vector<Normal> normals_;
+    /** Vertex UVs */
+    std::vector<UV> uvs_;
+    /** Faces */
+    std::vector<Face> faces_;
+};
+
+}  // namespace volcart
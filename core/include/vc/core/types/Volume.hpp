@@ -2,19 +2,29 @@
 
 /** @file */
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "vc/core/filesystem.hpp"
+#include "vc/core/io/TIFFIO.hpp"
 #include "vc/core/types/BoundingBox.hpp"
 #include "vc/core/types/Cache.hpp"
+#include "vc/core/types/ClockCache.hpp"
 #include "vc/core/types/DiskBasedObjectBaseClass.hpp"
 #include "vc/core/types/LRUCache.hpp"
 #include "vc/core/types/Reslice.hpp"
+#include "vc/core/util/HashFunctions.hpp"
 #include "vc/core/util/MemMap.hpp"
+#include "vc/core/util/ThreadPool.hpp"
 
 namespace volcart
 {
@@ -25,7 +35,28 @@ namespace volcart
  * @brief Volumetric image data
  *
  * Provides access to a volumetric dataset, such as a CT scan. By default,
- * slices are cached in memory using volcart::LRUCache.
+ * slices are cached in memory using volcart::ClockCache, which allows cache
+ * hits from many threads to proceed concurrently.
+ *
+ * Volume data is stored on disk using one of two layouts, as selected by the
+ * `format` key of the Volume metadata:
+ *  - StorageFormat::Slices (default): One TIFF image per slice.
+ *  - StorageFormat::Chunks: Fixed-size, cubic blocks of voxels (see
+ *    chunkSize()), stored in the `chunks/` subdirectory. Voxel accesses like
+ *    intensityAt() and interpolateAt() only load the chunks which contain the
+ *    requested positions. Chunks are cached separately from slices.
+ *
+ * Slices (or chunks) can be loaded into the cache ahead of time by a small
+ * pool of background threads, either on request with prefetch() or
+ * automatically when the Volume is read in slice order. See
+ * setPrefetchDepth().
+ *
+ * A Volume may also store downsampled copies of itself, built with
+ * buildLevels(). Level `n` is downsampled by a factor of `2^n` along every
+ * axis and is stored as a chunked Volume in the `levels/<n>/` subdirectory.
+ * Coarse levels are much cheaper to read for previews and interactive
+ * navigation: the voxels of a level 2 region cost 1/64th of the I/O of the
+ * same region at full resolution. See level().
  *
  * @ingroup Types
  */
@@ -48,11 +79,38 @@ public:
     using SliceCache = Cache<int, SliceItem>;
 
     /** Default slice cache type */
-    using DefaultCache = LRUCache<int, SliceItem, NoOpMutex>;
+    using DefaultCache = ClockCache<int, SliceItem>;
 
     /** Default slice cache capacity */
     static constexpr std::size_t DEFAULT_CAPACITY = 200;
 
+    /** On-disk storage layout */
+    enum class StorageFormat { Slices = 0, Chunks };
+
+    /** Chunk index type: (x, y, z) position in the chunk grid */
+    using ChunkIndex = cv::Vec3i;
+
+    /** Chunk cache type */
+    using ChunkCache = Cache<ChunkIndex, cv::Mat>;
+
+    /** Default chunk cache type */
+    using DefaultChunkCache = ClockCache<ChunkIndex, cv::Mat, Vec3iHash>;
+
+    /** Default chunk edge length */
+    static constexpr int DEFAULT_CHUNK_SIZE = 64;
+
+    /** Default chunk cache capacity */
+    static constexpr std::size_t DEFAULT_CHUNK_CAPACITY = 4096;
+
+    /** Default number of background prefetch threads */
+    static constexpr std::uint32_t DEFAULT_PREFETCH_THREADS = 2;
+
+    /** Default number of slices prefetched ahead of sequential reads */
+    static constexpr int DEFAULT_PREFETCH_DEPTH = 8;
+
+    /** Default number of resolution levels built by buildLevels() */
+    static constexpr int DEFAULT_NUM_LEVELS = 4;
+
     /**@{*/
     /** Default constructor. Cannot be constructed without path. */
     Volume() = delete;
@@ -124,9 +182,59 @@ public:
      */
     void setMemoryMapSlices(bool b);
 
+    /**
+     * @brief Override the access pattern advice for memory mapped slices
+     *
+     * By default, the advice passed to AdviseMemory() is chosen from the
+     * direction of recent slice reads: MemoryAdvice::Sequential for slices
+     * read in order, MemoryAdvice::WillNeed for slices prefetched ahead of
+     * those reads, and MemoryAdvice::Random otherwise. After this call,
+     * `advice` is used for every slice which is memory mapped instead.
+     */
+    void setMemoryMapAdvice(MemoryAdvice advice);
+
+    /** @brief Choose the memory mapped slice advice automatically */
+    void resetMemoryMapAdvice();
+
+    /**
+     * @brief Get the memory mapped slice advice override
+     *
+     * Empty if the advice is chosen automatically.
+     */
+    auto memoryMapAdvice() const -> std::optional<MemoryAdvice>;
+
+    /**
+     * @brief Get the advice applied to the most recently mapped slice
+     *
+     * MemoryAdvice::Normal if no slice has been memory mapped.
+     */
+    auto getLastMemoryMapAdvice() const -> MemoryAdvice;
+
+    /**
+     * @brief Get the number of slice loads which were memory mapped
+     *
+     * Only counts loads made while memory mapping is enabled.
+     */
+    auto getMemoryMapHits() const -> std::size_t;
+
+    /**
+     * @brief Get the number of slice loads which could not be memory mapped
+     *
+     * These slices were decoded into memory instead, usually because they are
+     * compressed or otherwise not stored in a mappable layout.
+     */
+    auto getMemoryMapMisses() const -> std::size_t;
+
     /**
      * @brief Get a slice by index number
      *
+     * Slices of a chunked Volume are not cached. Every call allocates a new
+     * slice and copies it from every chunk in the slice's layer of the chunk
+     * grid, which loads any of those chunks that aren't cached. Callers which
+     * read a chunked slice more than once should keep the returned slice, and
+     * callers which only need some of its voxels should use intensityAt(),
+     * interpolateAt() or getChunkData() instead.
+     *
      * @warning Because cv::Mat is essentially a pointer to a matrix, modifying
      * the slice returned by getSliceData() will modify the cached slice as
      * well. Use getSliceDataCopy() if the slice is to be modified.
@@ -139,17 +247,96 @@ public:
     /**
      * @brief Set a slice by index number
      *
-     * Index must be less than the number of slices in the volume.
+     * Index must be less than the number of slices in the volume. If
+     * `compress` is true, the slice is compressed with the scheme selected by
+     * setSliceCompression(). The slice is written to a temporary file which
+     * then replaces the slice file, so a failed write leaves the old slice
+     * intact.
      *
      * @warning This will overwrite any existing slice data on disk.
      */
     void setSliceData(
         int index, const cv::Mat& slice, bool compress = true) const;
 
+    /**
+     * @brief Set how setSliceData() compresses slices
+     *
+     * Stored in the `compression` and `predictor` keys of the Volume
+     * metadata. Volumes without these keys use LZW without a predictor.
+     * Volumes with an unknown `compression` use LZW and log a warning.
+     *
+     * Compared to LZW, ZSTD with a predictor typically makes 16-bit CT slices
+     * smaller and decodes several times faster, but it's an optional feature
+     * of libtiff (see tiffio::IsCompressionSupported()). Slices which are
+     * already on disk are not changed. Use `vc_recompress_volume` to convert
+     * them.
+     *
+     * @param c Compression scheme. One of NONE, LZW, ADOBE_DEFLATE, ZSTD, or
+     * LZMA.
+     * @param predictor Apply horizontal differencing before compression
+     * @throws std::invalid_argument If the compression scheme is not supported
+     */
+    void setSliceCompression(tiffio::Compression c, bool predictor = true);
+
+    /** @brief Get the compression scheme used by setSliceData() */
+    auto sliceCompression() const -> tiffio::Compression;
+
+    /** @brief Get whether setSliceData() applies a predictor */
+    auto slicePredictor() const -> bool;
+
     /** @brief Get the file path of a slice by index */
     auto getSlicePath(int index) const -> filesystem::path;
     /**@}*/
 
+    /**@{*/
+    /** @brief Get the on-disk storage layout */
+    auto storageFormat() const -> StorageFormat;
+
+    /**
+     * @brief Set the on-disk storage layout
+     *
+     * This only changes how the Volume reads its data. Use setSliceData() or
+     * setChunkData() to populate the Volume in the selected layout.
+     */
+    void setStorageFormat(StorageFormat f);
+
+    /** @brief Get the chunk edge length (in voxels) */
+    auto chunkSize() const -> int;
+
+    /** @brief Set the chunk edge length (in voxels) */
+    void setChunkSize(int s);
+
+    /** @brief Get the number of chunks along each axis: (x, y, z) */
+    auto chunkGridExtents() const -> cv::Vec3i;
+
+    /** @brief Get the chunk which contains a voxel position */
+    auto chunkIndexAt(int x, int y, int z) const -> ChunkIndex;
+
+    /**
+     * @brief Get a chunk by chunk index
+     *
+     * Returns a 3-dimensional, 16-bit cv::Mat indexed by `(z, y, x)` relative
+     * to the origin of the chunk. Chunks on the upper boundaries of the Volume
+     * are zero-padded to the full chunk size.
+     *
+     * @warning As with getSliceData(), the returned chunk shares memory with
+     * the cached chunk.
+     */
+    auto getChunkData(const ChunkIndex& index) const -> cv::Mat;
+
+    /**
+     * @brief Set a chunk by chunk index
+     *
+     * @throws std::invalid_argument If the chunk is not a CV_16UC1 cube with
+     * extents chunkSize()
+     * @warning This will overwrite any existing chunk data on disk.
+     */
+    void setChunkData(const ChunkIndex& index, const cv::Mat& chunk) const;
+
+    /** @brief Get the file path of a chunk by chunk index */
+    auto getChunkPath(const ChunkIndex& index) const -> filesystem::path;
+    /**@}*/
+
     /**@{*/
     /** @brief Get the intensity value at a voxel position */
     auto intensityAt(int x, int y, int z) const -> std::uint16_t;
@@ -170,6 +357,32 @@ public:
     /** @copydoc interpolateAt(double, double, double) const */
     auto interpolateAt(const cv::Vec3d& v) const -> std::uint16_t;
 
+    /**
+     * @brief Get the intensity values at many subvoxel positions
+     *
+     * Equivalent to calling interpolateAt(const cv::Vec3d&) for each of the
+     * `n` positions in `pts` and storing the results in `out`, which must have
+     * room for `n` values. The slices (or chunks) touched by a group of
+     * positions are fetched from the cache once rather than once per voxel
+     * read, so this is much faster for nearby positions such as
+     * neighborhoods. Fetched slices are held for at most a few thousand
+     * positions and a few tens of MB, so large batches don't push the cache
+     * far past its capacity.
+     *
+     * If `lvl` is greater than 0, the values are interpolated from that
+     * resolution level instead. Positions are still given in full-resolution
+     * voxel coordinates. See level().
+     */
+    void interpolateAt(
+        const cv::Vec3d* pts,
+        std::size_t n,
+        std::uint16_t* out,
+        int lvl = 0) const;
+
+    /** @overload */
+    auto interpolateAt(const std::vector<cv::Vec3d>& pts, int lvl = 0) const
+        -> std::vector<std::uint16_t>;
+
     /**
      * @brief Create a Reslice image by intersecting the volume with a plane
      *
@@ -182,36 +395,198 @@ public:
      * @param yvec Y-axis of the Reslice plane
      * @param height Height of the Reslice image
      * @param width Width of the Reslice image
+     * @param lvl Resolution level to sample. The Reslice is still specified
+     * and sampled in full-resolution voxel coordinates.
      */
     auto reslice(
         const cv::Vec3d& center,
         const cv::Vec3d& xvec,
         const cv::Vec3d& yvec,
         int width = 64,
-        int height = 64) const -> Reslice;
+        int height = 64,
+        int lvl = 0) const -> Reslice;
+    /**@}*/
+
+    /**@{*/
+    /**
+     * @brief Get the number of resolution levels
+     *
+     * Includes the full-resolution Volume, so a Volume without downsampled
+     * levels has 1 level.
+     */
+    auto numLevels() const -> int;
+
+    /**
+     * @brief Get a resolution level of the Volume
+     *
+     * Level 0 is this Volume. Level `n` is a chunked Volume in which each
+     * voxel is the mean of a `2^n` voxel cube of this Volume, so its extents
+     * are this Volume's extents divided by `2^n` and rounded up. The center
+     * of level voxel `q` is at full-resolution position `2^n * q + (2^n -
+     * 1) / 2`.
+     *
+     * Levels are loaded on first use and have their own caches, which can be
+     * configured through the returned pointer. If a memory budget has been set
+     * with setCacheMemoryInBytes(), each level is given its share of the
+     * budget when it is loaded.
+     *
+     * @throws std::out_of_range If `n` is not in [0, numLevels())
+     */
+    auto level(int n) const -> Pointer;
+
+    /**
+     * @brief Build and save the downsampled resolution levels
+     *
+     * Writes levels 1 to `numLevels - 1` to the `levels/` subdirectory,
+     * replacing any existing levels, and saves this Volume's metadata. Each
+     * level is computed from the one before it in a single streaming pass
+     * over its layers of chunks, so peak memory use is roughly chunkSize()
+     * slices of level 1. Slices within a layer are downsampled in parallel
+     * using up to `maxThreads` threads.
+     *
+     * Levels use this Volume's chunkSize(). Passing 1 removes all levels.
+     *
+     * The levels are rebuilt in place, so levels returned by level() must not
+     * be held while this function runs.
+     *
+     * @throws std::invalid_argument If `numLevels` is less than 1
+     * @throws std::runtime_error If a level returned by level() is still in
+     * use
+     */
+    void buildLevels(
+        int numLevels = DEFAULT_NUM_LEVELS,
+        std::optional<std::uint32_t> maxThreads = std::nullopt);
     /**@}*/
 
     /**@{*/
     /** @brief Enable slice caching */
     void setCacheSlices(bool b);
 
-    /** @brief Set the slice cache */
+    /**
+     * @brief Set the slice cache
+     *
+     * Cache lookups do not lock the Volume, so the cache must be safe for
+     * concurrent access if the Volume is shared between threads.
+     *
+     * @warning Must not be called while other threads are reading from the
+     * Volume.
+     */
     void setCache(SliceCache::Pointer c) const;
 
     /** @brief Set the maximum number of cached slices */
     void setCacheCapacity(std::size_t newCacheCapacity) const;
 
-    /** @brief Set the maximum size of the cache in bytes */
+    /**
+     * @brief Set the maximum size of the cache in bytes
+     *
+     * Cached slices and chunks are weighed by the number of bytes they
+     * hold rather than by count, and entries are evicted whenever the total
+     * exceeds `nbytes`. The default caches evict with the CLOCK
+     * (second-chance) policy. Slices of chunked Volumes are assembled from
+     * cached chunks and are not cached themselves, so the budget applies to
+     * whichever cache is used by the storage format.
+     *
+     * The budget is shared with the resolution levels (see level()), in
+     * proportion to the number of voxels in each level. Levels which are
+     * loaded later, or rebuilt by buildLevels(), are given their share when
+     * they are loaded.
+     *
+     * After calling this function, getCacheCapacity() reports the capacity in
+     * bytes. Calling setCacheCapacity() or setChunkCacheCapacity() restores
+     * count-based capacities and stops sharing the budget with levels which
+     * are loaded later.
+     */
     void setCacheMemoryInBytes(std::size_t nbytes) const;
 
-    /** @brief Get the maximum number of cached slices */
+    /**
+     * @brief Get the capacity of the cache used by the storage format
+     *
+     * The capacity is a number of items or a number of bytes. See
+     * setCacheMemoryInBytes().
+     */
     auto getCacheCapacity() const -> std::size_t;
 
-    /** @brief Get the current number of cached slices */
+    /** @brief Get the current number of cached slices or chunks */
     auto getCacheSize() const -> std::size_t;
 
-    /** @brief Purge the slice cache */
+    /**
+     * @brief Get the current total weight of the cache
+     *
+     * When a memory budget has been set with setCacheMemoryInBytes(), this is
+     * the number of bytes currently held by the cache.
+     */
+    auto getCacheMemoryUsage() const -> std::size_t;
+
+    /** @brief Purge the slice and chunk caches */
     void cachePurge() const;
+
+    /**
+     * @brief Set the chunk cache
+     *
+     * @copydetails setCache()
+     */
+    void setChunkCache(ChunkCache::Pointer c) const;
+
+    /** @brief Set the maximum number of cached chunks */
+    void setChunkCacheCapacity(std::size_t newCacheCapacity) const;
+
+    /** @brief Get the maximum number of cached chunks */
+    auto getChunkCacheCapacity() const -> std::size_t;
+
+    /** @brief Get the current number of cached chunks */
+    auto getChunkCacheSize() const -> std::size_t;
+    /**@}*/
+
+    /**@{*/
+    /**
+     * @brief Load a range of slices into the cache in the background
+     *
+     * Queues the slices in the range [zMin, zMax] to be loaded by the
+     * prefetch threads and returns immediately. For chunked Volumes, the
+     * chunks which intersect the range and the XY footprint of recent chunk
+     * reads are loaded, or every chunk in the range if there have been no
+     * reads. Chunk layers beyond what the cache can hold are skipped. Slices
+     * which are already cached or queued are skipped. Does nothing if slice
+     * caching or prefetching is disabled.
+     *
+     * Prefetched slices are ordinary cache entries, so requesting more slices
+     * than the cache can hold evicts the earliest ones again.
+     */
+    void prefetch(int zMin, int zMax) const;
+
+    /** @brief Block until all queued prefetches have finished */
+    void waitForPrefetch() const;
+
+    /** @brief Discard the queued prefetches which have not started */
+    void cancelPrefetch() const;
+
+    /**
+     * @brief Set the number of background prefetch threads
+     *
+     * Setting 0 disables prefetching. Queued prefetches are discarded.
+     * Default: DEFAULT_PREFETCH_THREADS
+     */
+    void setPrefetchThreads(std::uint32_t n);
+
+    /** @brief Get the number of background prefetch threads */
+    auto prefetchThreads() const -> std::uint32_t;
+
+    /**
+     * @brief Set how many slices to prefetch ahead of sequential reads
+     *
+     * When successive reads move through the Volume in one direction, such
+     * as when mappings are processed in Z order, the next `n` slices in that
+     * direction are prefetched automatically. Reads from several threads may
+     * interleave, as long as they move through the Volume together. Automatic
+     * prefetching never requests more than half of the cache's capacity.
+     *
+     * Setting 0 disables automatic prefetching. Default:
+     * DEFAULT_PREFETCH_DEPTH
+     */
+    void setPrefetchDepth(int n);
+
+    /** @brief Get how many slices are prefetched ahead of sequential reads */
+    auto prefetchDepth() const -> int;
     /**@}*/
 
 protected:
@@ -223,6 +598,10 @@ protected:
     int slices_{0};
     /** Slice file name padding */
     int numSliceCharacters_{0};
+    /** Slice compression scheme */
+    tiffio::Compression compression_{tiffio::Compression::LZW};
+    /** Whether to apply a predictor to compressed slices */
+    bool predictor_{false};
 
     /** Whether to use slice cache */
     bool cacheSlices_{true};
@@ -234,11 +613,114 @@ protected:
     // TODO: This seems excessive but I'll leave it until it can be tested
     mutable std::vector<std::mutex> sliceMutexes_;
 
+    /** Storage layout */
+    StorageFormat format_{StorageFormat::Slices};
+    /** Chunk edge length */
+    int chunkSize_{DEFAULT_CHUNK_SIZE};
+    /** Chunk cache */
+    mutable ChunkCache::Pointer chunkCache_{
+        DefaultChunkCache::New(DEFAULT_CHUNK_CAPACITY)};
+    /** Chunk cache mutex for thread-safe access */
+    mutable std::shared_mutex chunkCacheMutex_;
+
     /** Whether to memmap slices */
     bool memmap_{true};
+    /** Access pattern advice override for memmapped slices */
+    std::optional<MemoryAdvice> memmapAdvice_;
+    /** Advice applied to the most recently memmapped slice */
+    mutable std::atomic<MemoryAdvice> memmapLastAdvice_{MemoryAdvice::Normal};
+    /** Choose the access pattern advice for a memmapped slice */
+    auto memory_advice_(int index) const -> MemoryAdvice;
+    /** Number of slice loads which were memmapped */
+    mutable std::atomic<std::size_t> memmapHits_{0};
+    /** Number of slice loads which could not be memmapped */
+    mutable std::atomic<std::size_t> memmapMisses_{0};
     /** Load slice from disk */
     cv::Mat load_slice_(int index, mmap_info* mmap_info = nullptr) const;
     /** Load slice from cache */
     cv::Mat cache_slice_(int index) const;
+    /** Assemble a slice from chunks */
+    cv::Mat assemble_slice_(int index) const;
+    /** Load chunk from disk */
+    cv::Mat load_chunk_(const ChunkIndex& index) const;
+    /** Load chunk from cache */
+    cv::Mat cache_chunk_(const ChunkIndex& index) const;
+
+    /** Number of resolution levels, including this Volume */
+    int numLevels_{1};
+    /** Loaded resolution levels, starting at level 1 */
+    mutable std::vector<Pointer> levels_;
+    /** Guards the loaded resolution levels and cacheMemory_ */
+    mutable std::mutex levelsMutex_;
+    /** Cache memory budget shared by this Volume and its levels */
+    mutable std::optional<std::size_t> cacheMemory_;
+    /** Get the share of cacheMemory_ for level `n`. Requires levelsMutex_. */
+    auto cache_memory_share_(int n) const -> std::size_t;
+    /**
+     * Apply cacheMemory_ to this Volume and its loaded levels. Requires
+     * levelsMutex_.
+     */
+    void apply_cache_memory_() const;
+    /** Set the byte capacity of this Volume's caches */
+    void set_cache_memory_(std::size_t nbytes) const;
+    /** Build one resolution level from the level before it */
+    auto build_level_(
+        const Volume& src, int n, std::optional<std::uint32_t> maxThreads)
+        const -> Pointer;
+
+    /** Whether the slice cache capacity is measured in bytes */
+    mutable std::atomic<bool> cacheInBytes_{false};
+    /** Whether the chunk cache capacity is measured in bytes */
+    mutable std::atomic<bool> chunkCacheInBytes_{false};
+
+    /** Number of prefetch threads */
+    std::atomic<std::uint32_t> prefetchThreads_{DEFAULT_PREFETCH_THREADS};
+    /** Number of slices prefetched ahead of sequential reads */
+    std::atomic<int> prefetchDepth_{DEFAULT_PREFETCH_DEPTH};
+    /** Last slice (or chunk layer) read from the cache */
+    mutable std::atomic<int> lastRead_{-1};
+    /** Net number of recent forward (positive) or backward reads */
+    mutable int readTrend_{0};
+    /** Slices (or chunk layers) which are queued or being prefetched */
+    mutable std::unordered_set<int> prefetchQueued_;
+    /** XY bounds of the chunks read since the last change of chunk layer */
+    mutable std::atomic<int> readMinX_{std::numeric_limits<int>::max()};
+    /** See readMinX_ */
+    mutable std::atomic<int> readMinY_{std::numeric_limits<int>::max()};
+    /** See readMinX_ */
+    mutable std::atomic<int> readMaxX_{std::numeric_limits<int>::min()};
+    /** See readMinX_ */
+    mutable std::atomic<int> readMaxY_{std::numeric_limits<int>::min()};
+    /** XY chunk footprint of the reads from the previous chunk layer */
+    mutable cv::Rect lastFootprint_;
+    /** Guards the prefetch state */
+    mutable std::mutex prefetchMutex_;
+    /**
+     * Prefetch threads. Declared last so that the threads are joined before
+     * any state they use is destroyed.
+     */
+    mutable std::shared_ptr<ThreadPool> prefetchPool_;
+    /** Record a cache read and prefetch ahead of sequential reads */
+    void note_read_(int unit) const;
+    /** Record the XY position of a chunk read */
+    void note_chunk_read_(const ChunkIndex& index) const;
+    /**
+     * Start the footprint of a new chunk layer and return the footprint of
+     * recent reads. Requires prefetchMutex_.
+     */
+    auto roll_footprint_() const -> cv::Rect;
+    /** Get the XY chunk footprint of recent reads, which may be empty */
+    auto read_footprint_() const -> cv::Rect;
+    /** Clip a footprint to the chunk grid. Empty footprints cover the grid */
+    auto chunk_footprint_(const cv::Rect& footprint) const -> cv::Rect;
+    /**
+     * Queue slices (or chunk layers) in [begin, end) for prefetching. Only
+     * the chunks in `footprint` are loaded from each layer.
+     */
+    void queue_prefetch_(int begin, int end, const cv::Rect& footprint) const;
+    /** Load a slice (or the chunks of a layer) into the cache */
+    void prefetch_unit_(int unit, const cv::Rect& footprint) const;
+    /** Get the number of slices (or chunk layers) that fit in the cache */
+    auto prefetch_budget_(const cv::Rect& footprint) const -> std::size_t;
 };
 }  // namespace volcart
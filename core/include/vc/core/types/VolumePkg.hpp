@@ -166,6 +166,27 @@ public:
      */
     auto newVolume(std::string name = "") -> Volume::Pointer;
 
+    /**
+     * @brief Removes an existing Volume
+     *
+     * Deletes the Volume directory and removes the Volume from the internal
+     * list of volumes. Returns `false` and prints to Logger() if removal fails
+     * for any reason:
+     *  - Warning
+     *    - Empty ID
+     *    - ID not in internal map
+     *    - Volume directory does not exist
+     *  - Error
+     *    - Filesystem error when deleting the volume directory. Volume
+     *      directory may have been partially removed.
+     *
+     * Volume pointers which have already been handed out must not be used
+     * after the Volume is removed.
+     *
+     * @return If removal was successful
+     */
+    auto removeVolume(const Volume::Identifier& id) -> bool;
+
     /** @brief Get the first Volume */
     [[nodiscard]] auto volume() const -> Volume::Pointer;
 
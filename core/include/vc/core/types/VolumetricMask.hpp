@@ -2,8 +2,15 @@
 
 /** @file */
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
+
+#include <opencv2/core.hpp>
 
 #include "vc/core/types/PointSet.hpp"
 #include "vc/core/util/HashFunctions.hpp"
@@ -14,8 +21,18 @@ namespace volcart
 /**
  * @brief Stores per-voxel mask information for a volume
  *
- * @warning This container is built on std::unordered_set, so it's very fast
- * once built, but not very memory friendly.
+ * The mask is stored as a sparse set of cubic blocks of bits. Each block
+ * covers BLOCK_SIZE^3 voxels with one bit per voxel, and only blocks which
+ * contain at least one masked voxel are allocated. A densely masked region
+ * costs roughly one bit per voxel, and a lookup is a single hash of the
+ * block index followed by a bit test.
+ *
+ * Iteration visits every masked voxel exactly once, block by block. The order
+ * of the blocks is unspecified.
+ *
+ * Const member functions are thread safe. Modifying the mask is not.
+ *
+ * @see WriteVolumetricMask(), ReadVolumetricMask()
  */
 class VolumetricMask
 {
@@ -23,15 +40,91 @@ public:
     /** Voxel type */
     using Voxel = cv::Vec3i;
 
-private:
-    /** Custom set type */
-    using MaskSet = std::unordered_set<Voxel, Vec3iHash>;
+    /** Edge length of a block in voxels */
+    static constexpr int BLOCK_SIZE = 16;
 
-public:
-    /** Iterator type */
-    using iterator = MaskSet::iterator;
-    /** Const-iterator type */
-    using const_iterator = MaskSet::const_iterator;
+    /** Number of 64-bit words in a block */
+    static constexpr std::size_t BLOCK_WORDS =
+        BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE / 64;
+
+    /**
+     * @brief Block of voxel bits
+     *
+     * Bit `(z * BLOCK_SIZE + y) * BLOCK_SIZE + x` is the voxel at local
+     * position `(x, y, z)`. Bit `i` is bit `i % 64` of word `i / 64`.
+     */
+    using Block = std::array<std::uint64_t, BLOCK_WORDS>;
+
+    /** Block index type */
+    using BlockIndex = cv::Vec3i;
+
+    /** Block storage type */
+    using BlockMap = std::unordered_map<BlockIndex, Block, Vec3iHash>;
+
+    /** @brief Const forward iterator over the masked voxels */
+    class const_iterator
+    {
+    public:
+        /** Iterator category */
+        using iterator_category = std::forward_iterator_tag;
+        /** Value type */
+        using value_type = Voxel;
+        /** Difference type */
+        using difference_type = std::ptrdiff_t;
+        /** Pointer type */
+        using pointer = const Voxel*;
+        /** Reference type */
+        using reference = const Voxel&;
+
+        /** Default constructor */
+        const_iterator() = default;
+
+        /** @brief Get the current voxel */
+        auto operator*() const -> reference { return voxel_; }
+
+        /** @brief Get the current voxel */
+        auto operator->() const -> pointer { return &voxel_; }
+
+        /** @brief Advance to the next voxel */
+        auto operator++() -> const_iterator&;
+
+        /** @brief Advance to the next voxel */
+        auto operator++(int) -> const_iterator;
+
+        /** @brief Equality comparison */
+        friend auto operator==(const const_iterator& a, const const_iterator& b)
+            -> bool
+        {
+            return a.block_ == b.block_ and a.bit_ == b.bit_;
+        }
+
+        /** @brief Inequality comparison */
+        friend auto operator!=(const const_iterator& a, const const_iterator& b)
+            -> bool
+        {
+            return not(a == b);
+        }
+
+    private:
+        friend class VolumetricMask;
+        /** Iterator positioned at the first voxel at or after `block` */
+        const_iterator(
+            BlockMap::const_iterator block, BlockMap::const_iterator end);
+        /** Move to the first set bit at or after `bit` */
+        void find_next_(std::size_t bit);
+
+        /** Current block */
+        BlockMap::const_iterator block_;
+        /** End of the block map */
+        BlockMap::const_iterator end_;
+        /** Current bit in the block */
+        std::size_t bit_{0};
+        /** Current voxel */
+        Voxel voxel_;
+    };
+
+    /** Iterator type. Voxels are read-only. */
+    using iterator = const_iterator;
 
     /** Pointer type */
     using Pointer = std::shared_ptr<VolumetricMask>;
@@ -50,8 +143,7 @@ public:
     template <class Container>
     explicit VolumetricMask(const Container& ps)
     {
-        mask_.reserve(ps.size());
-        mask_.insert(std::begin(ps), std::end(ps));
+        setIn(ps);
     }
 
     /** @brief Add Voxel to mask */
@@ -63,8 +155,9 @@ public:
     template <class Container>
     void setIn(const Container& ps)
     {
-        mask_.reserve(mask_.size() + ps.size());
-        mask_.insert(std::begin(ps), std::end(ps));
+        for (const auto& p : ps) {
+            setIn(Voxel(p));
+        }
     }
 
     /** @brief Remove Voxels from the mask */
@@ -72,10 +165,26 @@ public:
     void setOut(const Container& ps)
     {
         for (const auto& p : ps) {
-            setOut(p);
+            setOut(Voxel(p));
         }
     }
 
+    /**
+     * @brief Add every non-zero pixel of a slice image to the mask
+     *
+     * Pixel `(y, x)` of `slice` is voxel `(x, y, z)`. `slice` must be a
+     * single channel, 8-bit image. Much faster than adding the pixels one at
+     * a time.
+     */
+    void setIn(const cv::Mat& slice, int z);
+
+    /**
+     * @brief Add every voxel of another mask to this mask
+     *
+     * Blocks are combined with a bitwise OR.
+     */
+    void merge(const VolumetricMask& other);
+
     /** @brief Check whether a Voxel is in the mask */
     [[nodiscard]] auto isIn(const Voxel& v) const -> bool;
     /** @brief Check whether a Voxel is not in the mask */
@@ -87,15 +196,11 @@ public:
     [[nodiscard]] auto isOut(const cv::Vec3d& v) const -> bool;
 
     /** @brief Get a const-iterator to the first element in the mask */
-    auto begin() noexcept -> iterator;
-    /** @copydoc begin() */
     [[nodiscard]] auto begin() const noexcept -> const_iterator;
     /** @copydoc begin() */
     [[nodiscard]] auto cbegin() const noexcept -> const_iterator;
 
     /** @brief Get a const-iterator to one past the last element in the mask */
-    auto end() noexcept -> iterator;
-    /** @copydoc end() */
     [[nodiscard]] auto end() const noexcept -> const_iterator;
     /** @copydoc end() */
     [[nodiscard]] auto cend() const noexcept -> const_iterator;
@@ -106,12 +211,35 @@ public:
     /** @brief Check if mask is empty */
     [[nodiscard]] auto empty() const -> bool;
 
+    /** @brief Get the number of voxels in the mask */
+    [[nodiscard]] auto size() const -> std::size_t;
+
     /** @brief Get the list of masked points as a vector */
     [[nodiscard]] auto as_vector() const -> std::vector<Voxel>;
 
+    /**@{*/
+    /** @brief Get the allocated blocks */
+    [[nodiscard]] auto blocks() const -> const BlockMap&;
+
+    /**
+     * @brief Replace a block
+     *
+     * Used to load a mask from disk. Empty blocks are not stored.
+     */
+    void setBlock(const BlockIndex& index, const Block& block);
+
+    /** @brief Get the index of the block containing a voxel */
+    static auto BlockIndexOf(const Voxel& v) -> BlockIndex;
+    /**@}*/
+
 private:
-    /** Mask storage container */
-    MaskSet mask_;
+    /** Get the block containing a voxel, allocating it if needed */
+    auto block_(const BlockIndex& index) -> Block&;
+
+    /** Block storage */
+    BlockMap blocks_;
+    /** Number of masked voxels */
+    std::size_t size_{0};
 };
 
 }  // namespace volcart
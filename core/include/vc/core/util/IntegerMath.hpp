@@ -0,0 +1,22 @@
+#pragma once
+
+/** @file */
+
+namespace volcart
+{
+
+/**
+ * @brief Integer division which rounds towards negative infinity
+ *
+ * Unlike the built-in division, which truncates towards zero, this maps every
+ * integer to the block of size `b` which contains it, e.g. `FloorDiv(-1, 4)`
+ * is `-1`. `b` must be positive.
+ *
+ * @ingroup Util
+ */
+constexpr auto FloorDiv(const int a, const int b) -> int
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+}  // namespace volcart
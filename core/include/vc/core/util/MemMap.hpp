@@ -2,7 +2,10 @@
 
 /** @file */
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <string_view>
 
 #include "vc/core/filesystem.hpp"
 
@@ -82,6 +85,83 @@ auto MemmapFile(const filesystem::path& path) -> mmap_info;
  */
 auto UnmapFile(mmap_info& mmap_info) -> int;
 
+/**
+ * @brief Expected access pattern of a memory mapped file
+ *
+ * @see AdviseMemory
+ */
+enum class MemoryAdvice {
+    /** No special treatment */
+    Normal = 0,
+    /** Pages will be accessed in order. Enables aggressive read-ahead. */
+    Sequential,
+    /** Pages will be accessed in random order. Disables read-ahead. */
+    Random,
+    /** Pages will be needed soon. Starts reading the file in. */
+    WillNeed,
+    /** Pages will not be needed soon. They may be released. */
+    DontNeed
+};
+
+/**
+ * @brief Advise the OS of how a memory mapped file will be accessed
+ *
+ * A hint which lets the OS tune read-ahead and paging for the mapping. On
+ * success, returns 0. If `mmap_info` is empty or memory mapping is
+ * unsupported by the platform, does nothing and returns -1. Otherwise, returns
+ * a platform-specific error code:
+ *  - (Linux/macOS) Returns errno set by madvise.
+ */
+auto AdviseMemory(const mmap_info& mmap_info, MemoryAdvice advice) -> int;
+
 /** Whether memory mapping is available on this platform */
 auto memmap_supported() -> bool;
+
+/**
+ * @brief Read-only contents of a file
+ *
+ * Memory maps the file when memory mapping is supported and succeeds.
+ * Otherwise, reads the whole file into memory. Either way, the contents are
+ * available as one contiguous range for the lifetime of the object. Useful for
+ * parsers which scan large files or process them in parallel chunks.
+ *
+ * ```{.cpp}
+ * FileContents file("mesh.obj");
+ * for (const auto c : file.view()) {
+ *   // parse
+ * }
+ * ```
+ */
+class FileContents
+{
+public:
+    /**
+     * @brief Map or read the file at `path`
+     *
+     * If the file is memory mapped, `advice` is passed to AdviseMemory().
+     *
+     * @throws volcart::IOException If the file cannot be read
+     */
+    explicit FileContents(
+        const filesystem::path& path,
+        MemoryAdvice advice = MemoryAdvice::Sequential);
+
+    /** @brief Get the file contents */
+    [[nodiscard]] auto view() const -> std::string_view;
+
+    /** @brief Get a pointer to the first byte of the file */
+    [[nodiscard]] auto data() const -> const char*;
+
+    /** @brief Get the size of the file in bytes */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /** @brief Whether the file is memory mapped */
+    [[nodiscard]] auto isMapped() const -> bool;
+
+private:
+    /** Memory mapping, if mapped */
+    auto_mmap_info mmap_;
+    /** File contents, if not mapped */
+    std::string buffer_;
+};
 }  // namespace volcart
@@ -11,6 +11,7 @@
  */
 
 #include "vc/core/types/ITKMesh.hpp"
+#include "vc/core/types/TriangleMesh.hpp"
 
 namespace volcart::meshmath
 {
@@ -40,4 +41,7 @@ T TriangleArea(T a, T b, T c)
 /** @brief Calculate the surface area of an ITKMesh */
 double SurfaceArea(const ITKMesh::Pointer& mesh);
 
+/** @brief Calculate the surface area of a TriangleMesh */
+double SurfaceArea(const TriangleMesh& mesh);
+
 }  // namespace volcart::meshmath
@@ -0,0 +1,254 @@
+#pragma once
+
+/** @file */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "vc/core/types/Mixins.hpp"
+#include "vc/core/util/Signals.hpp"
+
+namespace volcart
+{
+
+/**
+ * @brief Get the number of threads to use for a parallel algorithm
+ *
+ * Returns the number of hardware threads, limited to `maxThreads` if it is
+ * provided. Always returns at least 1.
+ *
+ * @ingroup Util
+ */
+inline auto NumThreads(std::optional<std::uint32_t> maxThreads = {})
+    -> std::uint32_t
+{
+    auto n = std::max(1U, std::thread::hardware_concurrency());
+    if (maxThreads.has_value()) {
+        n = std::min(n, maxThreads.value());
+    }
+    return std::max(1U, n);
+}
+
+namespace detail
+{
+/** Whether the current thread is a ParallelFor or ThreadPool worker */
+inline thread_local bool IN_PARALLEL_WORKER{false};
+}  // namespace detail
+
+/**
+ * @brief Whether the calling thread is a parallel worker
+ *
+ * Returns true on threads which are running the blocks of a multi-threaded
+ * ParallelFor or the tasks of a ThreadPool. Functions which can parallelize
+ * internally use this to avoid starting a new set of threads on every worker.
+ *
+ * @ingroup Util
+ */
+inline auto IsParallelWorker() -> bool { return detail::IN_PARALLEL_WORKER; }
+
+/**
+ * @brief Mark the calling thread as a parallel worker for the current scope
+ *
+ * The previous state is restored when the scope ends, so scopes may be nested.
+ *
+ * @ingroup Util
+ */
+class ParallelWorkerScope
+{
+public:
+    /** @brief Mark the calling thread as a worker */
+    ParallelWorkerScope() : previous_{detail::IN_PARALLEL_WORKER}
+    {
+        detail::IN_PARALLEL_WORKER = true;
+    }
+
+    /** @brief Restore the previous state */
+    ~ParallelWorkerScope() { detail::IN_PARALLEL_WORKER = previous_; }
+
+    ParallelWorkerScope(const ParallelWorkerScope&) = delete;
+    auto operator=(const ParallelWorkerScope&) -> ParallelWorkerScope& = delete;
+
+private:
+    /** State before this scope */
+    bool previous_;
+};
+
+/**
+ * @brief Process the index range [0, size) in blocks on multiple threads
+ *
+ * Calls `fn(begin, end)` for consecutive, non-overlapping blocks of at most
+ * `blockSize` indices. Blocks are handed out in increasing order from a shared
+ * counter, so a thread which finishes early simply takes the next block and
+ * the blocks being processed at any moment are always close together in the
+ * range. When the range is sorted by a spatial key (e.g. the Z position of
+ * PerPixelMap mappings), this keeps every thread working on the same region of
+ * a Volume and its slice cache.
+ *
+ * The calling thread is one of the `numThreads` workers. If `numThreads` is
+ * 1, all blocks are processed on the calling thread in order. Otherwise, every
+ * worker, including the calling thread, is marked as a parallel worker (see
+ * IsParallelWorker()) while it processes blocks. If `fn` throws,
+ * no new blocks are started and the first exception is rethrown on the calling
+ * thread once all workers have finished.
+ *
+ * If `fn` accepts three arguments, it is called as `fn(worker, begin, end)`,
+ * where `worker` is the index of the calling worker in [0, numThreads). The
+ * calling thread is worker 0. This lets `fn` use per-worker state, such as
+ * scratch buffers, without locking.
+ *
+ * @ingroup Util
+ */
+template <typename Fn>
+void ParallelFor(
+    std::size_t size, std::size_t blockSize, std::uint32_t numThreads, Fn fn)
+{
+    blockSize = std::max(blockSize, std::size_t{1});
+    const auto numBlocks = (size + blockSize - 1) / blockSize;
+    numThreads = static_cast<std::uint32_t>(
+        std::min<std::size_t>(std::max(1U, numThreads), numBlocks));
+
+    std::atomic<std::size_t> nextBlock{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](std::uint32_t index) {
+        std::optional<ParallelWorkerScope> scope;
+        if (numThreads > 1) {
+            scope.emplace();
+        }
+        while (not failed) {
+            const auto block = nextBlock++;
+            if (block >= numBlocks) {
+                return;
+            }
+            const auto begin = block * blockSize;
+            const auto end = std::min(begin + blockSize, size);
+            try {
+                if constexpr (std::is_invocable_v<
+                                  Fn&, std::uint32_t, std::size_t,
+                                  std::size_t>) {
+                    fn(index, begin, end);
+                } else {
+                    fn(begin, end);
+                }
+            } catch (...) {
+                std::unique_lock lock(errorMutex);
+                if (not error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::uint32_t i = 1; i < numThreads; i++) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief Forward the progress of parallel workers to a progress signal
+ *
+ * Workers call add() with the number of iterations they have just completed.
+ * The running total is sent to the signal by at most one thread at a time and
+ * the sent values never decrease. Updates which arrive while another thread is
+ * sending are skipped, since the next update includes them.
+ *
+ * @ingroup Util
+ */
+class ParallelProgress
+{
+public:
+    /** @brief Construct with the signal which receives the running total */
+    explicit ParallelProgress(Signal<std::size_t>& signal) : signal_{signal} {}
+
+    /** @brief Add completed iterations */
+    void add(std::size_t n)
+    {
+        const auto count = done_ += n;
+        std::unique_lock lock(mutex_, std::try_to_lock);
+        if (lock.owns_lock() and count > sent_) {
+            sent_ = count;
+            signal_.send(count);
+        }
+    }
+
+private:
+    /** Progress signal */
+    Signal<std::size_t>& signal_;
+    /** Completed iterations */
+    std::atomic<std::size_t> done_{0};
+    /** Last value sent to the signal */
+    std::size_t sent_{0};
+    /** Serializes access to the signal */
+    std::mutex mutex_;
+};
+
+/**
+ * @brief A parallel loop with a fixed number of iterations which reports its
+ * progress
+ *
+ * For loops which are not part of an algorithm class with its own progress
+ * signals. Connect the signals (e.g. with ReportProgress()), then call run():
+ *
+ * ```{.cpp}
+ * ParallelPass pass(numSlices);
+ * auto bar = ReportProgress(pass, "Processing:");
+ * pass.run(NumThreads(), [&](std::size_t i) { process(i); });
+ * ```
+ *
+ * @ingroup Util
+ */
+class ParallelPass : public IterationsProgress
+{
+public:
+    /** @brief Construct with the number of iterations */
+    explicit ParallelPass(std::size_t size) : size_{size} {}
+
+    /** @brief Get the number of iterations */
+    auto progressIterations() const -> std::size_t override { return size_; }
+
+    /**
+     * @brief Call `fn(i)` for every `i` in `[0, size)` on `numThreads`
+     * threads
+     *
+     * @see ParallelFor()
+     */
+    template <typename Fn>
+    void run(std::uint32_t numThreads, Fn fn)
+    {
+        ParallelProgress progress(progressUpdated);
+        progressStarted.send();
+        ParallelFor(
+            size_, 1, numThreads, [&](std::size_t begin, std::size_t end) {
+                for (auto i = begin; i < end; i++) {
+                    fn(i);
+                }
+                progress.add(end - begin);
+            });
+        progressComplete.send();
+    }
+
+private:
+    /** Number of iterations */
+    std::size_t size_{0};
+};
+
+}  // namespace volcart
@@ -3,13 +3,17 @@
 /** @file */
 
 #include <algorithm>
+#include <charconv>
 #include <iomanip>
 #include <locale>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace volcart
 {
@@ -240,6 +244,78 @@ static inline auto partition(std::string_view s, std::string_view sep)
     return {pre, mid, post};
 }
 
+/**
+ * @brief Remove and return the first token of a string view
+ *
+ * Tokens are separated by any number of spaces, tabs, and carriage returns.
+ * Returns an empty view and empties `s` if no tokens remain. Does not
+ * allocate, so it is suitable for tokenizing large files line by line.
+ */
+static inline auto next_token(std::string_view& s) -> std::string_view
+{
+    constexpr std::string_view ws{" \t\r"};
+    const auto begin = s.find_first_not_of(ws);
+    if (begin == std::string_view::npos) {
+        s = {};
+        return {};
+    }
+    const auto end = std::min(s.find_first_of(ws, begin), s.size());
+    const auto token = s.substr(begin, end - begin);
+    s.remove_prefix(end);
+    return token;
+}
+
+namespace detail
+{
+/** Whether std::from_chars supports floating-point types */
+#if defined(__cpp_lib_to_chars)
+inline constexpr bool FLOAT_FROM_CHARS{true};
+#else
+inline constexpr bool FLOAT_FROM_CHARS{false};
+#endif
+}  // namespace detail
+
+/**
+ * @brief Convert a string to a number
+ *
+ * The whole string must be a number of type T. A leading `+` is accepted.
+ * Uses std::from_chars, which is much faster than the std::sto* functions and
+ * does not depend on the current locale. Standard libraries without
+ * floating-point std::from_chars fall back to std::stod.
+ *
+ * @throws std::invalid_argument If the string is not a number of type T
+ * @throws std::out_of_range If the number is not representable by T
+ */
+template <
+    typename T,
+    std::enable_if_t<std::is_arithmetic_v<T>, bool> = true>
+auto to_numeric(std::string_view s) -> T
+{
+    if (not s.empty() and s.front() == '+') {
+        s.remove_prefix(1);
+    }
+
+    T val{};
+    if constexpr (std::is_integral_v<T> or detail::FLOAT_FROM_CHARS) {
+        const auto* last = s.data() + s.size();
+        const auto [ptr, ec] = std::from_chars(s.data(), last, val);
+        if (ec == std::errc::result_out_of_range) {
+            throw std::out_of_range("number out of range: " + std::string(s));
+        }
+        if (ec != std::errc() or ptr != last) {
+            throw std::invalid_argument("not a number: " + std::string(s));
+        }
+    } else {
+        const std::string str(s);
+        std::size_t idx{0};
+        val = static_cast<T>(std::stod(str, &idx));
+        if (idx != str.size()) {
+            throw std::invalid_argument("not a number: " + str);
+        }
+    }
+    return val;
+}
+
 /** @brief Convert an Integer to a padded string */
 template <
     typename Integer,
@@ -0,0 +1,83 @@
+#pragma once
+
+/** @file */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace volcart
+{
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size pool of worker threads which run queued tasks
+ *
+ * Tasks are started in the order they were submitted. Unlike ParallelFor(),
+ * submit() returns immediately, so the pool is suited to background work such
+ * as I/O which should overlap with the caller.
+ *
+ * Exceptions thrown by a task are logged and discarded. The destructor
+ * discards tasks which have not started and waits for running tasks to
+ * finish.
+ *
+ * All member functions are thread safe.
+ *
+ * @ingroup Util
+ */
+class ThreadPool
+{
+public:
+    /** Task type */
+    using Task = std::function<void()>;
+
+    /** @brief Start `numThreads` worker threads (at least 1) */
+    explicit ThreadPool(std::uint32_t numThreads);
+
+    /** @brief Discard queued tasks and join the worker threads */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+    /** @brief Get the number of worker threads */
+    [[nodiscard]] auto numThreads() const -> std::uint32_t;
+
+    /** @brief Queue a task */
+    void submit(Task task);
+
+    /** @brief Get the number of queued and running tasks */
+    [[nodiscard]] auto pending() const -> std::size_t;
+
+    /** @brief Discard the tasks which have not started */
+    void clear();
+
+    /** @brief Block until there are no queued or running tasks */
+    void wait();
+
+private:
+    /** Worker thread loop */
+    void run_();
+
+    /** Worker threads */
+    std::vector<std::thread> workers_;
+    /** Queued tasks */
+    std::deque<Task> tasks_;
+    /** Number of running tasks */
+    std::size_t running_{0};
+    /** Set when the workers should exit */
+    bool stop_{false};
+    /** Guards the queue and counters */
+    mutable std::mutex mutex_;
+    /** Signaled when a task is queued or the pool is stopping */
+    std::condition_variable taskReady_;
+    /** Signaled when the pool becomes idle */
+    std::condition_variable idle_;
+};
+
+}  // namespace volcart
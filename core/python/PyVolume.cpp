@@ -1,7 +1,9 @@
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 #include "vc/core/neighborhood/CuboidGenerator.hpp"
 #include "vc/core/types/Volume.hpp"
@@ -51,7 +53,41 @@ void init_Volume(py::module& m)
         "Get the current number of cached slices");
     c.def(
         "setCacheMemory", &vc::Volume::setCacheMemoryInBytes, py::arg("bytes"),
-        "Set the maximum cache size in bytes");
+        "Set the maximum cache size in bytes, shared with the resolution "
+        "levels");
+    c.def(
+        "getCacheMemoryUsage", &vc::Volume::getCacheMemoryUsage,
+        "Get the number of bytes held by the cache when a memory limit is set");
+
+    /** Prefetching */
+    c.def(
+        "prefetch", &vc::Volume::prefetch, py::arg("zmin"), py::arg("zmax"),
+        "Load the slices in [zmin, zmax] into the cache in the background");
+    c.def(
+        "waitForPrefetch", &vc::Volume::waitForPrefetch,
+        "Block until all queued prefetches have finished");
+    c.def(
+        "setPrefetchThreads", &vc::Volume::setPrefetchThreads,
+        py::arg("threads"),
+        "Set the number of background prefetch threads. 0 disables "
+        "prefetching");
+    c.def(
+        "setPrefetchDepth", &vc::Volume::setPrefetchDepth, py::arg("slices"),
+        "Set how many slices to prefetch ahead of sequential reads. 0 "
+        "disables automatic prefetching");
+
+    /** Resolution levels */
+    c.def(
+        "numLevels", &vc::Volume::numLevels,
+        "Number of resolution levels, including full resolution");
+    c.def(
+        "level", &vc::Volume::level, py::arg("n"),
+        "Get a resolution level, downsampled by 2^n along every axis");
+    c.def(
+        "buildLevels", &vc::Volume::buildLevels,
+        py::arg("levels") = vc::Volume::DEFAULT_NUM_LEVELS,
+        py::arg("threads") = std::nullopt,
+        "Build and save the downsampled resolution levels");
 
     /** Slice Data */
     c.def(
@@ -80,6 +116,7 @@ void init_Volume(py::module& m)
         py::arg_v("y_vec", cv::Vec3d{0, 1, 0}, "(0, 1, 0)"),
         py::arg("width") = 64,
         py::arg("height") = 64,
+        py::arg("level") = 0,
         "Generate an arbitrarily-oriented reslice image");
     // clang-format on
 
@@ -0,0 +1,69 @@
+#include "vc/core/io/ChunkIO.hpp"
+
+#include <array>
+#include <fstream>
+
+#include "vc/core/types/Exceptions.hpp"
+
+namespace cio = volcart::chunkio;
+namespace fs = volcart::filesystem;
+
+auto cio::ReadChunk(const fs::path& path, const int chunkSize, const int type)
+    -> cv::Mat
+{
+    // Make sure input file exists
+    if (not fs::exists(path)) {
+        throw IOException("File does not exist: " + path.string());
+    }
+
+    // Construct the chunk
+    const std::array<int, 3> extents{chunkSize, chunkSize, chunkSize};
+    cv::Mat chunk(3, extents.data(), type);
+    const auto nbytes = chunk.total() * chunk.elemSize();
+
+    // Check the file size
+    if (fs::file_size(path) != nbytes) {
+        throw IOException("Unexpected chunk size: " + path.string());
+    }
+
+    // Read the voxels
+    std::ifstream ifs(path.string(), std::ios::binary);
+    if (not ifs.is_open()) {
+        throw IOException("Failed to open chunk: " + path.string());
+    }
+    ifs.read(
+        reinterpret_cast<char*>(chunk.data),
+        static_cast<std::streamsize>(nbytes));
+    if (ifs.fail()) {
+        throw IOException("Failed to read chunk: " + path.string());
+    }
+
+    return chunk;
+}
+
+void cio::WriteChunk(const fs::path& path, const cv::Mat& chunk)
+{
+    // Safety checks
+    if (chunk.dims != 3) {
+        throw IOException("Unsupported chunk type");
+    }
+    if (chunk.size[0] != chunk.size[1] or chunk.size[0] != chunk.size[2]) {
+        throw IOException("Chunk extents must be equal");
+    }
+    if (not chunk.isContinuous()) {
+        throw IOException("Chunk data must be continuous");
+    }
+
+    // Write the voxels
+    std::ofstream ofs(path.string(), std::ios::binary | std::ios::trunc);
+    if (not ofs.is_open()) {
+        throw IOException("Failed to open file for writing: " + path.string());
+    }
+    const auto nbytes = chunk.total() * chunk.elemSize();
+    ofs.write(
+        reinterpret_cast<const char*>(chunk.data),
+        static_cast<std::streamsize>(nbytes));
+    if (ofs.fail()) {
+        throw IOException("Failed to write chunk: " + path.string());
+    }
+}
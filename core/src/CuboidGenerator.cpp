@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <exception>
+#include <vector>
 
 static const std::vector<cv::Vec3d> BASIS_VECTORS = {
     {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
@@ -56,7 +57,8 @@ auto CuboidGenerator::compute(
     auto extent = extents();
 
     // Iterate over the axes
-    Neighborhood output(3, extent);
+    std::vector<cv::Vec3d> pts;
+    pts.reserve(extent[0] * extent[1] * extent[2]);
     for (std::size_t z = 0; z < extent[0]; ++z) {
         for (std::size_t y = 0; y < extent[1]; ++y) {
             for (std::size_t x = 0; x < extent[2]; ++x) {
@@ -67,15 +69,18 @@ auto CuboidGenerator::compute(
                 auto xOffset = -radius[2] + (x * interval_);
 
                 // Current 3D position
-                auto p = center + (bases[2] * xOffset) + (bases[1] * yOffset) +
-                         (bases[0] * zOffset);
-
-                // Assign to the subvolume array
-                output(z, y, x) = v->interpolateAt(p);
+                pts.emplace_back(
+                    center + (bases[2] * xOffset) + (bases[1] * yOffset) +
+                    (bases[0] * zOffset));
             }
         }
     }
 
+    // Sample the subvolume in one batch. Points were generated in the
+    // row-major order of the output array.
+    Neighborhood output(3, extent);
+    v->interpolateAt(pts.data(), pts.size(), output.data(), level_);
+
     return output;
 }
 
@@ -1,6 +1,7 @@
 #include "vc/core/neighborhood/LineGenerator.hpp"
 
 #include <cstddef>
+#include <vector>
 
 #include "vc/core/util/FloatComparison.hpp"
 
@@ -49,12 +50,17 @@ auto LineGenerator::compute(
     // Iterate through range
     auto count =
         static_cast<std::size_t>(std::floor((max - min) / interval_) + 1);
-    Neighborhood n(1, count);
+    std::vector<cv::Vec3d> pts;
+    pts.reserve(count);
     for (std::size_t it = 0; it < count; it++) {
         auto offset = min + (it * interval_);
-        n(it) = v->interpolateAt(pt + (axes[0] * offset));
+        pts.emplace_back(pt + (axes[0] * offset));
     }
 
+    // Sample all points in one batch
+    Neighborhood n(1, count);
+    v->interpolateAt(pts.data(), pts.size(), n.data(), level_);
+
     return n;
 }
 
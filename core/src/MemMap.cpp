@@ -1,5 +1,9 @@
 #include "vc/core/util/MemMap.hpp"
 
+#include <fstream>
+#include <iterator>
+
+#include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/Logging.hpp"
 
 namespace vc = volcart;
@@ -46,6 +50,48 @@ vc::auto_mmap_info::~auto_mmap_info()
 
 auto vc::memmap_supported() -> bool { return VC_MEMMAP_SUPPORTED; }
 
+vc::FileContents::FileContents(const fs::path& path, MemoryAdvice advice)
+{
+    if (memmap_supported()) {
+        mmap_ = MemmapFile(path);
+    }
+    if (mmap_) {
+        AdviseMemory(mmap_, advice);
+        return;
+    }
+
+    // Fall back to reading the whole file
+    std::ifstream ifs(path.string(), std::ios::binary);
+    if (not ifs.is_open()) {
+        throw IOException("Failed to open file for reading: " + path.string());
+    }
+    buffer_.assign(
+        std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    if (ifs.bad()) {
+        throw IOException("Failed to read file: " + path.string());
+    }
+}
+
+auto vc::FileContents::view() const -> std::string_view
+{
+    return {data(), size()};
+}
+
+auto vc::FileContents::data() const -> const char*
+{
+    return mmap_ ? static_cast<const char*>(mmap_.addr) : buffer_.data();
+}
+
+auto vc::FileContents::size() const -> std::size_t
+{
+    return mmap_ ? static_cast<std::size_t>(mmap_.size) : buffer_.size();
+}
+
+auto vc::FileContents::isMapped() const -> bool
+{
+    return static_cast<bool>(mmap_);
+}
+
 ///// Platform-specific memory mapping /////
 // Linux/macOS
 #if defined(VC_MEMMAP_MMAP)
@@ -115,9 +161,47 @@ auto vc::UnmapFile(mmap_info& mmap_info) -> int
     return res;
 }
 
+auto vc::AdviseMemory(const mmap_info& mmap_info, const MemoryAdvice advice)
+    -> int
+{
+    if (not mmap_info) {
+        return -1;
+    }
+
+    int flag{MADV_NORMAL};
+    switch (advice) {
+        case MemoryAdvice::Normal:
+            flag = MADV_NORMAL;
+            break;
+        case MemoryAdvice::Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case MemoryAdvice::Random:
+            flag = MADV_RANDOM;
+            break;
+        case MemoryAdvice::WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        case MemoryAdvice::DontNeed:
+            flag = MADV_DONTNEED;
+            break;
+    }
+
+    if (madvise(mmap_info.addr, mmap_info.size, flag) == -1) {
+        const auto res = errno;
+        Logger()->debug("Failed to madvise: {}", std::strerror(res));
+        return res;
+    }
+    return 0;
+}
+
 #else
 // All unsupported platforms
 #pragma message("Memory mapping is not implemented on this plaform")
 auto vc::MemmapFile(const fs::path& path) -> mmap_info { return {}; }
 auto vc::UnmapFile(mmap_info& mmap_info) -> int { return -1; }
+auto vc::AdviseMemory(const mmap_info& mmap_info, MemoryAdvice advice) -> int
+{
+    return -1;
+}
 #endif
\ No newline at end of file
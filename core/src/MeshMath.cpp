@@ -40,4 +40,33 @@ auto SurfaceArea(const ITKMesh::Pointer& mesh) -> double
 
     return surfaceArea;
 }
+
+auto SurfaceArea(const TriangleMesh& mesh) -> double
+{
+    const auto& vs = mesh.vertices();
+    double surfaceArea{0};
+    for (std::size_t i = 0; i < mesh.numFaces(); i++) {
+        const auto& [v0, v1, v2] = mesh.faces()[i];
+
+        // Get the side lengths
+        auto a = cv::norm(vs[v0] - vs[v1]);
+        auto b = cv::norm(vs[v0] - vs[v2]);
+        auto c = cv::norm(vs[v1] - vs[v2]);
+
+        // Get cell surface area
+        auto sa = TriangleArea(a, b, c);
+
+        // Note: Can get NaN's when using std::math
+        if (std::isnan(sa)) {
+            Logger()->error(
+                "volcart::meshMath: Warning: NaN surface area for face[{}]. "
+                "Evaluating as 0.",
+                i);
+            sa = 0.0;
+        }
+        surfaceArea += sa;
+    }
+
+    return surfaceArea;
+}
 }  // namespace volcart::meshmath
@@ -1,12 +1,15 @@
 #include "vc/core/io/OBJReader.hpp"
 
+#include <algorithm>
 #include <cstddef>
-#include <regex>
+#include <fstream>
 #include <string>
 
 #include "vc/core/io/ImageIO.hpp"
 #include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/MemMap.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/core/util/String.hpp"
 
 using namespace volcart;
@@ -16,7 +19,84 @@ namespace fs = volcart::filesystem;
 
 // Constant for validating face values
 constexpr static int NOT_PRESENT = -1;
-constexpr static std::size_t VALID_FACE_SIZE = 3;
+
+// Files are split into at most CHUNKS_PER_THREAD chunks per thread, each of
+// which is at least MIN_CHUNK_SIZE bytes
+constexpr static std::size_t MIN_CHUNK_SIZE = 1 << 20;
+constexpr static std::size_t CHUNKS_PER_THREAD = 4;
+
+struct OBJReader::Chunk {
+    /** Vertex positions */
+    std::vector<cv::Vec3d> vertices;
+    /** Vertex normals */
+    std::vector<cv::Vec3d> normals;
+    /** Vertex UV coordinates */
+    std::vector<cv::Vec2d> uvs;
+    /** Faces */
+    std::vector<Face> faces;
+    /** mtllib file names */
+    std::vector<std::string> mtllibs;
+};
+
+namespace
+{
+auto ParseDouble(std::string_view s) -> double
+{
+    if (s.empty()) {
+        throw IOException("Missing value in obj file");
+    }
+    try {
+        return to_numeric<double>(s);
+    } catch (const std::exception&) {
+        throw IOException("Invalid value in obj file: " + std::string(s));
+    }
+}
+
+auto ParseIndex(std::string_view s) -> int
+{
+    try {
+        return to_numeric<int>(s);
+    } catch (const std::exception&) {
+        throw IOException("Invalid face in obj file");
+    }
+}
+
+// Parse a face's v, v/vt, v//vn, or v/vt/vn element references
+auto ParseVertexRefs(std::string_view ref) -> cv::Vec3i
+{
+    const char delimiter = '/';
+
+    // Invalid slash positions
+    if (ref.front() == delimiter || ref.back() == delimiter) {
+        throw IOException("Invalid face in obj file");
+    }
+
+    cv::Vec3i refs{NOT_PRESENT, NOT_PRESENT, NOT_PRESENT};
+    const auto pos0 = ref.find(delimiter);
+    if (pos0 == std::string_view::npos) {
+        refs[0] = ::ParseIndex(ref);
+        return refs;
+    }
+    refs[0] = ::ParseIndex(ref.substr(0, pos0));
+
+    const auto pos1 = ref.find(delimiter, pos0 + 1);
+    if (pos1 == std::string_view::npos) {
+        refs[1] = ::ParseIndex(ref.substr(pos0 + 1));
+        return refs;
+    }
+    if (ref.find(delimiter, pos1 + 1) != std::string_view::npos) {
+        throw IOException("Invalid face in obj file");
+    }
+
+    // If positions differ by 1, then v//vn
+    // else v/vt/vn
+    if (pos1 - pos0 > 1) {
+        refs[1] = ::ParseIndex(ref.substr(pos0 + 1, pos1 - pos0 - 1));
+    }
+    refs[2] = ::ParseIndex(ref.substr(pos1 + 1));
+    return refs;
+}
+}  // namespace
 
 void OBJReader::setPath(const filesystem::path& p) { path_ = p; }
 
@@ -27,6 +107,10 @@ auto OBJReader::getUVMap() -> UVMap::Pointer { return uvMap_; }
 // Get texture image
 auto OBJReader::getTextureMat() -> cv::Mat { return textureMat_; }
 
+void OBJReader::setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+void OBJReader::resetMaxThreads() { maxThreads_.reset(); }
+
 // Read the file
 auto OBJReader::read() -> ITKMesh::Pointer
 {
@@ -50,122 +134,125 @@ void OBJReader::reset_()
 // Parse the file
 void OBJReader::parse_()
 {
-    std::regex vertex{"^v"};
-    std::regex normal{"^vn"};
-    std::regex tcoord{"^vt"};
-    std::regex face{"^f"};
-    std::regex mtllib("^mtllib");
-
-    std::ifstream ifs(path_.string());
-    if (!ifs.good()) {
-        throw IOException("Failed to open file for reading");
+    const FileContents file(path_);
+    const auto text = file.view();
+
+    // Split the file into line-aligned chunks
+    const auto numThreads = NumThreads(maxThreads_);
+    const auto numChunks = std::clamp<std::size_t>(
+        text.size() / MIN_CHUNK_SIZE, 1, numThreads * CHUNKS_PER_THREAD);
+    std::vector<std::string_view> ranges;
+    std::size_t begin{0};
+    for (std::size_t i = 1; i <= numChunks and begin < text.size(); i++) {
+        auto end = text.size();
+        if (i < numChunks) {
+            end = text.find('\n', std::max(begin, text.size() * i / numChunks));
+            end = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        ranges.push_back(text.substr(begin, end - begin));
+        begin = end;
     }
 
-    std::string line;
-    std::vector<std::string> strs;
-    while (std::getline(ifs, line)) {
-        // Parse the line
-        trim(line);
-        strs = split(line, ' ');
-        std::for_each(
-            std::begin(strs), std::end(strs), [](auto& s) { trim(s); });
-        if (strs.empty()) {
-            continue;
+    // Parse the chunks
+    std::vector<Chunk> chunks(ranges.size());
+    ParallelFor(
+        ranges.size(), 1, numThreads, [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; i++) {
+                parse_chunk_(ranges[i], chunks[i]);
+            }
+        });
+
+    // Combine the chunks in file order. Element references are absolute, so
+    // they don't need to be adjusted.
+    std::size_t numVerts{0};
+    std::size_t numNormals{0};
+    std::size_t numUVs{0};
+    std::size_t numFaces{0};
+    for (const auto& c : chunks) {
+        numVerts += c.vertices.size();
+        numNormals += c.normals.size();
+        numUVs += c.uvs.size();
+        numFaces += c.faces.size();
+    }
+    vertices_.reserve(numVerts);
+    normals_.reserve(numNormals);
+    uvs_.reserve(numUVs);
+    faces_.reserve(numFaces);
+    for (auto& c : chunks) {
+        vertices_.insert(vertices_.end(), c.vertices.begin(), c.vertices.end());
+        normals_.insert(normals_.end(), c.normals.begin(), c.normals.end());
+        uvs_.insert(uvs_.end(), c.uvs.begin(), c.uvs.end());
+        faces_.insert(faces_.end(), c.faces.begin(), c.faces.end());
+        for (const auto& mtllib : c.mtllibs) {
+            parse_mtllib_(mtllib);
         }
+        c = Chunk();
+    }
+}
+
+void OBJReader::parse_chunk_(std::string_view text, Chunk& chunk)
+{
+    while (not text.empty()) {
+        // Get the next line
+        const auto end = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+
+        // Dispatch on the line's keyword
+        const auto keyword = next_token(line);
 
         // Handle vertices
-        if (std::regex_match(strs[0], vertex)) {
-            parse_vertex_(strs);
+        if (keyword == "v") {
+            const auto a = ::ParseDouble(next_token(line));
+            const auto b = ::ParseDouble(next_token(line));
+            const auto c = ::ParseDouble(next_token(line));
+            chunk.vertices.emplace_back(a, b, c);
         }
 
         // Handle normals
-        else if (std::regex_match(strs[0], normal)) {
-            parse_normal_(strs);
+        else if (keyword == "vn") {
+            const auto a = ::ParseDouble(next_token(line));
+            const auto b = ::ParseDouble(next_token(line));
+            const auto c = ::ParseDouble(next_token(line));
+            chunk.normals.emplace_back(a, b, c);
         }
 
         // Handle texture coordinates
-        else if (std::regex_match(strs[0], tcoord)) {
-            parse_tcoord_(strs);
+        else if (keyword == "vt") {
+            const auto u = ::ParseDouble(next_token(line));
+            const auto v = ::ParseDouble(next_token(line));
+            chunk.uvs.emplace_back(u, v);
         }
 
         // Handle faces
-        else if (std::regex_match(strs[0], face)) {
-            parse_face_(strs);
+        else if (keyword == "f") {
+            Face f;
+            std::size_t n{0};
+            for (auto ref = next_token(line); not ref.empty();
+                 ref = next_token(line)) {
+                if (n == f.size()) {
+                    n++;
+                    break;
+                }
+                f[n++] = ::ParseVertexRefs(ref);
+            }
+            if (n != f.size()) {
+                throw IOException("Parsed unsupported, non-triangular face");
+            }
+            chunk.faces.push_back(f);
         }
 
         // Handle mtllib
-        else if (std::regex_match(strs[0], mtllib)) {
-            parse_mtllib_(strs);
+        else if (keyword == "mtllib") {
+            chunk.mtllibs.emplace_back(next_token(line));
         }
-
-        // Otherwise clear and continue
-        strs.clear();
     }
-
-    ifs.close();
 }
 
-void OBJReader::parse_vertex_(const std::vector<std::string>& strs)
-{
-    auto a = std::stod(strs[1]);
-    auto b = std::stod(strs[2]);
-    auto c = std::stod(strs[3]);
-    vertices_.emplace_back(a, b, c);
-}
-
-void OBJReader::parse_normal_(const std::vector<std::string>& strs)
-{
-    auto a = std::stod(strs[1]);
-    auto b = std::stod(strs[2]);
-    auto c = std::stod(strs[3]);
-    normals_.emplace_back(a, b, c);
-}
-
-void OBJReader::parse_tcoord_(const std::vector<std::string>& strs)
-{
-    auto u = std::stod(strs[1]);
-    auto v = std::stod(strs[2]);
-    uvs_.emplace_back(u, v);
-}
-
-void OBJReader::parse_face_(const std::vector<std::string>& strs)
-{
-    OBJReader::Face f;
-    std::vector<std::string> vinfo;
-    std::vector<std::string> sub(std::begin(strs) + 1, std::end(strs));
-
-    for (const auto& s : sub) {
-        auto faceType = classify_vertref_(s);
-        vinfo = split(s, '/');
-        switch (faceType) {
-            case RefType::Vertex:
-                f.emplace_back(std::stoi(vinfo[0]), NOT_PRESENT, NOT_PRESENT);
-                break;
-            case RefType::VertexWithTexture:
-                f.emplace_back(
-                    std::stoi(vinfo[0]), std::stoi(vinfo[1]), NOT_PRESENT);
-                break;
-            case RefType::VertexWithNormal:
-                f.emplace_back(
-                    std::stoi(vinfo[0]), NOT_PRESENT, std::stoi(vinfo[1]));
-                break;
-            case RefType::VertexWithTextureAndNormal:
-                f.emplace_back(
-                    std::stoi(vinfo[0]), std::stoi(vinfo[1]),
-                    std::stoi(vinfo[2]));
-                break;
-            case RefType::Invalid:
-                throw IOException("Invalid face in obj file");
-        }
-        vinfo.clear();
-    }
-    faces_.push_back(f);
-}
-
-void OBJReader::parse_mtllib_(const std::vector<std::string>& strs)
+void OBJReader::parse_mtllib_(const std::string& mtllib)
 {
     // Get mtl path, relative to OBJ directory
-    fs::path mtlPath = path_.parent_path() / strs[1];
+    fs::path mtlPath = path_.parent_path() / mtllib;
 
     // Open the mtl file
     std::ifstream ifs(mtlPath.string());
@@ -173,67 +260,19 @@ void OBJReader::parse_mtllib_(const std::vector<std::string>& strs)
         throw IOException("Failed to open mtl file for reading");
     }
 
-    // Find the map_kd line
-    std::regex mapKd{"^map_Kd"};
-
     // Parse the file
     std::string line;
-    std::vector<std::string> mtlstrs;
     while (std::getline(ifs, line)) {
-        trim(line);
-        mtlstrs = split(line, ' ');
-        std::for_each(
-            std::begin(mtlstrs), std::end(mtlstrs), [](auto& s) { trim(s); });
-        if (mtlstrs.empty()) {
-            continue;
-        }
+        std::string_view strs{line};
 
         // Handle map_Kd
-        if (std::regex_match(mtlstrs[0], mapKd)) {
-            texturePath_ = path_.parent_path() / mtlstrs[1];
+        if (next_token(strs) == "map_Kd") {
+            texturePath_ = path_.parent_path() / std::string(next_token(strs));
         }
-        mtlstrs.clear();
     }
     ifs.close();
 }
 
-auto OBJReader::classify_vertref_(const std::string& ref) -> OBJReader::RefType
-{
-    const char delimiter = '/';
-    auto slashCount = std::count(ref.begin(), ref.end(), delimiter);
-
-    // Invalid slash positions
-    if (ref.front() == delimiter || ref.back() == delimiter) {
-        throw IOException("Invalid face in obj file");
-    }
-
-    // No slashes
-    if (slashCount == 0) {
-        return RefType::Vertex;
-    }
-
-    // One slash
-    else if (slashCount == 1) {
-        return RefType::VertexWithTexture;
-    }
-
-    // Two slashes
-    else if (slashCount == 2) {
-        // Get the two slash positions
-        auto pos0 = ref.find(delimiter, 0);
-        auto pos1 = ref.find(delimiter, pos0 + 1);
-
-        // If positions differ by 1, then v//vn
-        // else v/vt/vn
-        if ((pos1 - pos0) == 1) {
-            return RefType::VertexWithNormal;
-        } else {
-            return RefType::VertexWithTextureAndNormal;
-        }
-    }
-    return RefType::Invalid;
-}
-
 void OBJReader::build_mesh_()
 {
     // Reset output structures
@@ -256,13 +295,9 @@ void OBJReader::build_mesh_()
     ITKCell::CellAutoPointer cell;
     ITKMesh::CellIdentifier cid = 0;
     for (const auto& face : faces_) {
-        if (face.size() != VALID_FACE_SIZE) {
-            throw IOException("Parsed unsupported, non-triangular face");
-        }
-
         cell.TakeOwnership(new ITKTriangle);
         auto idInCell = 0;
-        for (auto vinfo : face) {
+        for (const auto& vinfo : face) {
             if (vinfo[0] - 1 < 0 ||
                 vinfo[0] - 1 >= static_cast<int>(vertices_.size())) {
                 throw IOException("Out-of-range vertex reference");
@@ -1,155 +1,472 @@
 #include "vc/core/io/PLYReader.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
 
 #include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/MemMap.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/core/util/String.hpp"
 
 using namespace volcart;
 using namespace volcart::io;
 namespace fs = volcart::filesystem;
 
-auto PLYReader::read() -> ITKMesh::Pointer
+namespace
 {
-    if (inputPath_.empty() || !fs::exists(inputPath_)) {
-        auto msg = "File not provided or does not exist.";
-        throw volcart::IOException(msg);
+// Number of element instances parsed per parallel block
+constexpr std::size_t BLOCK_SIZE{4096};
+
+// PLY file formats
+enum class Format { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+// PLY property value types
+enum class Type { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+// PLY element property
+struct Property {
+    std::string name;
+    // For lists, the type of the list items
+    Type type{Type::Float32};
+    bool isList{false};
+    // For lists, the type of the item count
+    Type countType{Type::UInt8};
+};
+
+// PLY element
+struct Element {
+    std::string name;
+    std::size_t count{0};
+    std::vector<Property> properties;
+};
+
+// Parsed PLY header
+struct Header {
+    Format format{Format::Ascii};
+    std::vector<Element> elements;
+};
+
+// Vertex properties which are read into SimpleMesh::Vertex
+enum VertexSlot { X, Y, Z, NX, NY, NZ, NUM_SLOTS };
+
+auto ParseType(std::string_view name) -> Type
+{
+    if (name == "char" or name == "int8") {
+        return Type::Int8;
+    }
+    if (name == "uchar" or name == "uint8") {
+        return Type::UInt8;
+    }
+    if (name == "short" or name == "int16") {
+        return Type::Int16;
+    }
+    if (name == "ushort" or name == "uint16") {
+        return Type::UInt16;
     }
+    if (name == "int" or name == "int32") {
+        return Type::Int32;
+    }
+    if (name == "uint" or name == "uint32") {
+        return Type::UInt32;
+    }
+    if (name == "float" or name == "float32") {
+        return Type::Float32;
+    }
+    if (name == "double" or name == "float64") {
+        return Type::Float64;
+    }
+    throw IOException("Unknown PLY property type: " + std::string(name));
+}
 
-    // Resets values of member variables in case of 2nd reading
-    pointList_.clear();
-    faceList_.clear();
-    properties_.clear();
-    elementsList_.clear();
-    outMesh_ = ITKMesh::New();
-    numVertices_ = 0;
-    numFaces_ = 0;
-    hasLeadingChar_ = true;
-    hasPointNorm_ = false;
+auto TypeSize(Type type) -> std::size_t
+{
+    switch (type) {
+        case Type::Int8:
+        case Type::UInt8:
+            return 1;
+        case Type::Int16:
+        case Type::UInt16:
+            return 2;
+        case Type::Int32:
+        case Type::UInt32:
+        case Type::Float32:
+            return 4;
+        case Type::Float64:
+            return 8;
+    }
+    return 0;
+}
 
-    int skippedElementCnt = 0;
+auto IsLittleEndian() -> bool
+{
+    const std::uint16_t value{1};
+    std::uint8_t firstByte{0};
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
 
-    plyFile_.open(inputPath_.string());
-    if (!plyFile_.is_open()) {
-        auto msg = "Open file " + inputPath_.string() + " failed.";
-        throw volcart::IOException(msg);
+// Remove and return the next line of text
+auto NextLine(std::string_view& text) -> std::string_view
+{
+    const auto end = std::min(text.find('\n'), text.size());
+    const auto line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    return line;
+}
+
+auto ParseHeader(std::string_view& text) -> Header
+{
+    auto magic = NextLine(text);
+    if (next_token(magic) != "ply") {
+        throw IOException("Not a PLY file");
     }
-    parse_header_();
-    for (auto& cur : elementsList_) {
-        if (cur == "vertex") {
-            read_points_();
-        } else if (cur == "face") {
-            read_faces_();
-        } else {
-            int curSkip = skippedLine_[skippedElementCnt];
-            for (int i = 0; i < curSkip; i++) {
-                std::getline(plyFile_, line_);
+
+    Header header;
+    bool foundEnd{false};
+    while (not foundEnd and not text.empty()) {
+        auto line = NextLine(text);
+        const auto keyword = next_token(line);
+        if (keyword == "format") {
+            const auto format = next_token(line);
+            if (format == "ascii") {
+                header.format = Format::Ascii;
+            } else if (format == "binary_little_endian") {
+                header.format = Format::BinaryLittleEndian;
+            } else if (format == "binary_big_endian") {
+                header.format = Format::BinaryBigEndian;
+            } else {
+                throw IOException(
+                    "Unknown PLY format: " + std::string(format));
+            }
+        } else if (keyword == "element") {
+            Element e;
+            e.name = next_token(line);
+            e.count = to_numeric<std::size_t>(next_token(line));
+            header.elements.push_back(e);
+        } else if (keyword == "property") {
+            if (header.elements.empty()) {
+                throw IOException("PLY property without element");
             }
-            skippedElementCnt++;
+            Property p;
+            auto type = next_token(line);
+            if (type == "list") {
+                p.isList = true;
+                p.countType = ParseType(next_token(line));
+                type = next_token(line);
+            }
+            p.type = ParseType(type);
+            p.name = next_token(line);
+            header.elements.back().properties.push_back(p);
+        } else if (keyword == "end_header") {
+            foundEnd = true;
         }
     }
-    plyFile_.close();
-    create_mesh_();
-
-    return outMesh_;
+    if (not foundEnd) {
+        throw IOException("PLY header has no end_header");
+    }
+    return header;
 }
 
-void PLYReader::parse_header_()
+// Reads the property values of element instances from an ASCII line
+class AsciiValues
 {
-    std::getline(plyFile_, line_);
-    while (line_ != "end_header") {
-        if (line_.find("element") != std::string::npos) {
-            auto splitLine = split(line_, ' ');
-            elementsList_.push_back(splitLine[1]);
-            if (splitLine[1] == "vertex") {
-                numVertices_ = std::stoi(splitLine[2]);
-            } else if (splitLine[1] == "face") {
-                numFaces_ = std::stoi(splitLine[2]);
-            } else {
-                skippedLine_.push_back(std::stoi(splitLine[2]));
+public:
+    explicit AsciiValues(std::string_view line) : line_{line} {}
+
+    auto read(Type /*type*/) -> double
+    {
+        const auto token = next_token(line_);
+        if (token.empty()) {
+            throw IOException("Unexpected end of line in PLY file");
+        }
+        try {
+            return to_numeric<double>(token);
+        } catch (const std::exception&) {
+            throw IOException(
+                "Invalid value in PLY file: " + std::string(token));
+        }
+    }
+
+private:
+    std::string_view line_;
+};
+
+// Reads the property values of element instances from binary data
+class BinaryValues
+{
+public:
+    BinaryValues(const char* pos, const char* end, bool swap)
+        : pos_{pos}, end_{end}, swap_{swap}
+    {
+    }
+
+    auto read(Type type) -> double
+    {
+        switch (type) {
+            case Type::Int8:
+                return load_<std::int8_t>();
+            case Type::UInt8:
+                return load_<std::uint8_t>();
+            case Type::Int16:
+                return load_<std::int16_t>();
+            case Type::UInt16:
+                return load_<std::uint16_t>();
+            case Type::Int32:
+                return load_<std::int32_t>();
+            case Type::UInt32:
+                return load_<std::uint32_t>();
+            case Type::Float32:
+                return load_<float>();
+            case Type::Float64:
+                return load_<double>();
+        }
+        return 0;
+    }
+
+    auto pos() const -> const char* { return pos_; }
+
+private:
+    template <typename T>
+    auto load_() -> double
+    {
+        if (static_cast<std::size_t>(end_ - pos_) < sizeof(T)) {
+            throw IOException("Unexpected end of PLY file");
+        }
+        std::array<char, sizeof(T)> bytes;
+        std::memcpy(bytes.data(), pos_, sizeof(T));
+        if (swap_) {
+            std::reverse(bytes.begin(), bytes.end());
+        }
+        T val;
+        std::memcpy(&val, bytes.data(), sizeof(T));
+        pos_ += sizeof(T);
+        return static_cast<double>(val);
+    }
+
+    const char* pos_;
+    const char* end_;
+    bool swap_;
+};
+
+// Reads element instances into the vertex and face lists
+class ElementReader
+{
+public:
+    ElementReader(
+        const Element& e,
+        std::size_t numVertices,
+        std::vector<SimpleMesh::Vertex>& vertices,
+        std::vector<SimpleMesh::Cell>& faces)
+        : e_{e}, numVertices_{numVertices}, vertices_{vertices}, faces_{faces}
+    {
+        if (e.name == "vertex") {
+            role_ = Role::Vertex;
+            slots_.assign(e.properties.size(), NUM_SLOTS);
+            constexpr std::array<std::string_view, NUM_SLOTS> names{
+                "x", "y", "z", "nx", "ny", "nz"};
+            for (std::size_t i = 0; i < e.properties.size(); i++) {
+                const auto& p = e.properties[i];
+                const auto it = std::find(names.begin(), names.end(), p.name);
+                if (not p.isList and it != names.end()) {
+                    slots_[i] = static_cast<int>(it - names.begin());
+                }
+            }
+            vertices_.resize(e.count);
+        } else if (e.name == "face") {
+            role_ = Role::Face;
+            const auto it = std::find_if(
+                e.properties.begin(), e.properties.end(), [](const auto& p) {
+                    return p.isList and
+                           (p.name == "vertex_indices" or
+                            p.name == "vertex_index");
+                });
+            if (it == e.properties.end()) {
+                throw IOException("PLY face element has no vertex index list");
             }
-            std::getline(plyFile_, line_);
-            splitLine = split(line_, ' ');
-            int currentLine{0};
-            while (splitLine[0] == "property") {
-                if (splitLine[1] == "list") {
-                    hasLeadingChar_ = line_.find("uchar") != std::string::npos;
+            indexList_ = it - e.properties.begin();
+            faces_.resize(e.count);
+        }
+    }
+
+    // Read instance `idx` of the element
+    template <class Values>
+    void read(Values& values, std::size_t idx) const
+    {
+        std::array<double, NUM_SLOTS> vertex{};
+        std::array<std::uint64_t, 3> face{};
+        for (std::size_t i = 0; i < e_.properties.size(); i++) {
+            const auto& p = e_.properties[i];
+            if (not p.isList) {
+                const auto val = values.read(p.type);
+                if (role_ == Role::Vertex and slots_[i] != NUM_SLOTS) {
+                    vertex[slots_[i]] = val;
                 }
-                // Not sure how to handle if it's not the vertices or faces
-                else {
-                    if (splitLine[2] == "nx") {
-                        hasPointNorm_ = true;
+                continue;
+            }
+
+            const auto n = static_cast<std::size_t>(values.read(p.countType));
+            const auto isIndices = role_ == Role::Face and i == indexList_;
+            if (isIndices and n != 3) {
+                throw IOException("Not a Triangular Mesh");
+            }
+            for (std::size_t j = 0; j < n; j++) {
+                const auto val = values.read(p.type);
+                if (isIndices) {
+                    if (val < 0 or val >= static_cast<double>(numVertices_)) {
+                        throw IOException("Out-of-range vertex reference");
                     }
-                    properties_[splitLine[2]] = currentLine;
+                    face[j] = static_cast<std::uint64_t>(val);
                 }
-                std::getline(plyFile_, line_);
-                currentLine++;
-                splitLine = split(line_, ' ');
             }
-        } else {
-            std::getline(plyFile_, line_);
+        }
+
+        if (role_ == Role::Vertex) {
+            auto& v = vertices_[idx];
+            v.x = vertex[X];
+            v.y = vertex[Y];
+            v.z = vertex[Z];
+            v.nx = vertex[NX];
+            v.ny = vertex[NY];
+            v.nz = vertex[NZ];
+        } else if (role_ == Role::Face) {
+            faces_[idx] = SimpleMesh::Cell(face[0], face[1], face[2]);
         }
     }
-    if (numFaces_ == 0) {
-        Logger()->warn("Warning: No face information found");
-    }
-    std::getline(plyFile_, line_);
 
-}  // ParseHeader
+    // Whether the element's instances are stored in the mesh
+    auto isStored() const -> bool { return role_ != Role::Other; }
+
+private:
+    enum class Role { Vertex, Face, Other };
 
-void PLYReader::read_points_()
+    const Element& e_;
+    std::size_t numVertices_;
+    std::vector<SimpleMesh::Vertex>& vertices_;
+    std::vector<SimpleMesh::Cell>& faces_;
+    Role role_{Role::Other};
+    // For vertices, the VertexSlot of each property
+    std::vector<int> slots_;
+    // For faces, the index of the vertex index list property
+    std::size_t indexList_{0};
+};
+
+// Size of an element instance in bytes, or 0 if it has list properties
+auto FixedSize(const Element& e) -> std::size_t
 {
-    for (int i = 0; i < numVertices_; i++) {
-        SimpleMesh::Vertex curPoint;
-        auto curLine = split(line_, ' ');
-        curPoint.x = std::stod(curLine[properties_["x"]]);
-        curPoint.y = std::stod(curLine[properties_["y"]]);
-        curPoint.z = std::stod(curLine[properties_["z"]]);
-        if (properties_.find("nx") != properties_.end()) {
-            curPoint.nx = std::stod(curLine[properties_["nx"]]);
-            curPoint.ny = std::stod(curLine[properties_["ny"]]);
-            curPoint.nz = std::stod(curLine[properties_["nz"]]);
-        }
-        if (properties_.find("r") != properties_.end()) {
-            curPoint.r = stoi(curLine[properties_["r"]]);
-            curPoint.g = stoi(curLine[properties_["g"]]);
-            curPoint.b = stoi(curLine[properties_["b"]]);
+    std::size_t size{0};
+    for (const auto& p : e.properties) {
+        if (p.isList) {
+            return 0;
         }
-        pointList_.push_back(curPoint);
-        std::getline(plyFile_, line_);
+        size += TypeSize(p.type);
     }
+    return size;
 }
+}  // namespace
 
-void PLYReader::read_faces_()
+auto PLYReader::read() -> ITKMesh::Pointer
 {
-    for (int i = 0; i < numFaces_; i++) {
-        SimpleMesh::Cell face;
-        auto curFace = split(line_, ' ');
-        if (hasLeadingChar_) {
-            int pointsPerFace = std::stoi(curFace[0]);
-            if (pointsPerFace != 3) {
-                auto msg = "Not a Triangular Mesh";
-                throw volcart::IOException(msg);
-            } else {
-                face = SimpleMesh::Cell(
-                    std::stoul(curFace[1]), std::stoul(curFace[2]),
-                    std::stoul(curFace[3]));
-                faceList_.push_back(face);
+    if (inputPath_.empty() || !fs::exists(inputPath_)) {
+        auto msg = "File not provided or does not exist.";
+        throw volcart::IOException(msg);
+    }
+
+    // Resets values of member variables in case of 2nd reading
+    pointList_.clear();
+    faceList_.clear();
+    outMesh_ = ITKMesh::New();
+    hasPointNorm_ = false;
+
+    // Memory map the file and parse the header
+    const FileContents file(inputPath_);
+    auto text = file.view();
+    const auto header = ::ParseHeader(text);
+
+    // Find the vertex and face elements
+    std::size_t numVertices{0};
+    bool hasFaces{false};
+    for (const auto& e : header.elements) {
+        if (e.name == "vertex") {
+            numVertices = e.count;
+            hasPointNorm_ = std::any_of(
+                e.properties.begin(), e.properties.end(),
+                [](const auto& p) { return p.name == "nx"; });
+        } else if (e.name == "face") {
+            hasFaces = e.count > 0;
+        }
+    }
+    if (not hasFaces) {
+        Logger()->warn("Warning: No face information found");
+    }
+
+    // Parse the elements in file order
+    const auto numThreads = NumThreads(maxThreads_);
+    const auto swap = (header.format == ::Format::BinaryLittleEndian) !=
+                      ::IsLittleEndian();
+    for (const auto& e : header.elements) {
+        const ::ElementReader reader(e, numVertices, pointList_, faceList_);
+
+        // ASCII: One instance per line
+        if (header.format == ::Format::Ascii) {
+            std::vector<std::string_view> lines(e.count);
+            for (auto& line : lines) {
+                if (text.empty()) {
+                    throw IOException("Unexpected end of PLY file");
+                }
+                line = ::NextLine(text);
             }
-        } else {
-            if (curFace.size() != 3) {
-                auto msg = "Not a Triangular Mesh";
-                throw volcart::IOException(msg);
-            } else {
-                face = SimpleMesh::Cell(
-                    std::stoul(curFace[1]), std::stoul(curFace[2]),
-                    std::stoul(curFace[3]));
-                faceList_.push_back(face);
+            if (not reader.isStored()) {
+                continue;
             }
+            ParallelFor(
+                lines.size(), ::BLOCK_SIZE, numThreads,
+                [&](std::size_t begin, std::size_t end) {
+                    for (auto i = begin; i < end; i++) {
+                        ::AsciiValues values(lines[i]);
+                        reader.read(values, i);
+                    }
+                });
+        }
+
+        // Binary with fixed size instances: Parse in parallel
+        else if (const auto size = ::FixedSize(e); size > 0) {
+            if (text.size() / size < e.count) {
+                throw IOException("Unexpected end of PLY file");
+            }
+            const auto* data = text.data();
+            if (reader.isStored()) {
+                ParallelFor(
+                    e.count, ::BLOCK_SIZE, numThreads,
+                    [&](std::size_t begin, std::size_t end) {
+                        ::BinaryValues values(
+                            data + begin * size, data + end * size, swap);
+                        for (auto i = begin; i < end; i++) {
+                            reader.read(values, i);
+                        }
+                    });
+            }
+            text.remove_prefix(e.count * size);
+        }
+
+        // Binary with variable size instances
+        else {
+            ::BinaryValues values(text.data(), text.data() + text.size(), swap);
+            for (std::size_t i = 0; i < e.count; i++) {
+                reader.read(values, i);
+            }
+            text.remove_prefix(
+                static_cast<std::size_t>(values.pos() - text.data()));
         }
-        std::getline(plyFile_, line_);
     }
+
+    create_mesh_();
+
+    return outMesh_;
 }
 
 void PLYReader::create_mesh_()
@@ -188,3 +505,7 @@ PLYReader::PLYReader(fs::path path) : inputPath_{std::move(path)} {}
 void PLYReader::setPath(fs::path path) { inputPath_ = std::move(path); }
 
 auto PLYReader::getMesh() -> ITKMesh::Pointer { return outMesh_; }
+
+void PLYReader::setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+void PLYReader::resetMaxThreads() { maxThreads_.reset(); }
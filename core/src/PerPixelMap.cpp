@@ -2,8 +2,10 @@
 
 #include <opencv2/imgcodecs.hpp>
 
+#include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/PointSetIO.hpp"
 #include "vc/core/io/TIFFIO.hpp"
+#include "vc/core/io/TiledPPMIO.hpp"
 #include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/Iteration.hpp"
 #include "vc/core/util/Logging.hpp"
@@ -105,6 +107,11 @@ void PerPixelMap::initialize_map_()
 ///// Disk IO /////
 void PerPixelMap::WritePPM(const fs::path& path, const PerPixelMap& map)
 {
+    if (IsFileType(path, {"tppm"})) {
+        io::WriteTiledPPM(path, map);
+        return;
+    }
+
     volcart::PointSetIO<cv::Vec6d>::WriteOrderedPointSet(path, map.map_);
 
     if (!map.mask_.empty()) {
@@ -118,6 +125,13 @@ void PerPixelMap::WritePPM(const fs::path& path, const PerPixelMap& map)
 
 auto PerPixelMap::ReadPPM(const fs::path& path) -> PerPixelMap
 {
+    if (io::IsTiledPPM(path)) {
+        const io::TiledPPMReader reader(path);
+        return reader.readRegion(cv::Rect(
+            0, 0, static_cast<int>(reader.width()),
+            static_cast<int>(reader.height())));
+    }
+
     PerPixelMap ppm;
     ppm.map_ = volcart::PointSetIO<cv::Vec6d>::ReadOrderedPointSet(path);
     ppm.height_ = ppm.map_.height();
@@ -1,5 +1,6 @@
 #include "vc/core/math/StructureTensor.hpp"
 
+#include <algorithm>
 #include <cstddef>
 
 #include <opencv2/imgproc.hpp>
@@ -14,6 +15,7 @@ auto VolumeGradient(const Tensor3D<double>& v, int kernelSize)
     -> Tensor3D<cv::Vec3d>;
 auto Gradient(const cv::Mat_<double>& input, Axis axis, int ksize)
     -> cv::Mat_<double>;
+void Gradient(const cv::Mat& input, Axis axis, int ksize, cv::Mat& grad);
 auto MakeUniformGaussianField(int radius) -> std::unique_ptr<double[]>;
 
 auto volcart::ComputeVoxelStructureTensor(
@@ -75,32 +77,8 @@ auto volcart::ComputeSubvoxelStructureTensor(
     int radius,
     int kernelSize) -> StructureTensor
 {
-    if (kernelSize < 3) {
-        throw std::invalid_argument("gradient kernel size must be at least 3");
-    }
-
-    // Get voxels in radius radius around voxel (x, y, z)
-    auto v = ComputeSubvoxelNeighbors<double>(
-        volume, {vx, vy, vz}, radius, radius, radius);
-
-    // Get gradient of volume
-    auto gradientField = VolumeGradient(v, kernelSize);
-
-    // Modulate by gaussian distribution (element-wise) and sum
-    auto gaussianField = MakeUniformGaussianField(radius);
-    StructureTensor sum(0, 0, 0, 0, 0, 0, 0, 0, 0);
-    for (std::size_t z = 0; z < v.dz(); ++z) {
-        for (std::size_t y = 0; y < v.dy(); ++y) {
-            for (std::size_t x = 0; x < v.dx(); ++x) {
-                sum += gaussianField[z * v.dy() * v.dx() + y * v.dx() + x] *
-                       Tensorize(gradientField(x, y, z));
-            }
-        }
-    }
-
-    cv::Mat matSum(sum);
-    matSum /= v.dx() * v.dy() * v.dz();
-    return StructureTensor{matSum};
+    StructureTensorWorkspace ws(radius, kernelSize);
+    return ws.subvoxelStructureTensor(volume, {vx, vy, vz});
 }
 
 auto volcart::ComputeSubvoxelStructureTensor(
@@ -122,20 +100,7 @@ auto volcart::ComputeVoxelEigenPairs(
     int kernelSize) -> EigenPairs
 {
     auto st = ComputeVoxelStructureTensor(volume, x, y, z, radius, kernelSize);
-    cv::Vec3d eigenValues;
-    cv::Matx33d eigenVectors;
-    cv::eigen(st, eigenValues, eigenVectors);
-    auto row0 = eigenVectors.row(0);
-    auto row1 = eigenVectors.row(1);
-    auto row2 = eigenVectors.row(2);
-    EigenVector e0{row0(0), row0(1), row0(2)};
-    EigenVector e1{row1(0), row1(1), row1(2)};
-    EigenVector e2{row2(0), row2(1), row2(2)};
-    return {
-        std::make_pair(eigenValues(0), e0),
-        std::make_pair(eigenValues(1), e1),
-        std::make_pair(eigenValues(2), e2),
-    };
+    return ComputeEigenPairs(st);
 }
 
 auto volcart::ComputeVoxelEigenPairs(
@@ -158,6 +123,104 @@ auto volcart::ComputeSubvoxelEigenPairs(
 {
     auto st =
         ComputeSubvoxelStructureTensor(volume, x, y, z, radius, kernelSize);
+    return ComputeEigenPairs(st);
+}
+
+auto volcart::ComputeSubvoxelEigenPairs(
+    const Volume::Pointer& volume,
+    const cv::Vec3d& index,
+    int radius,
+    int kernelSize) -> EigenPairs
+{
+    return ComputeSubvoxelEigenPairs(
+        volume, index(0), index(1), index(2), radius, kernelSize);
+}
+
+///// StructureTensorWorkspace /////
+StructureTensorWorkspace::StructureTensorWorkspace(int radius, int kernelSize)
+    : radius_{radius}, kernelSize_{kernelSize}, side_{2 * radius + 1}
+{
+    if (kernelSize < 3) {
+        throw std::invalid_argument("gradient kernel size must be at least 3");
+    }
+
+    const auto size = static_cast<std::size_t>(side_ * side_ * side_);
+    auto gaussian = MakeUniformGaussianField(radius_);
+    gaussian_.assign(gaussian.get(), gaussian.get() + size);
+
+    // Offsets in the same x, y, z order as ComputeSubvoxelNeighbors
+    offsets_.reserve(size);
+    for (int z = -radius_; z <= radius_; ++z) {
+        for (int y = -radius_; y <= radius_; ++y) {
+            for (int x = -radius_; x <= radius_; ++x) {
+                offsets_.emplace_back(x, y, z);
+            }
+        }
+    }
+
+    positions_.resize(size);
+    intensities_.resize(size);
+    values_.resize(size);
+    gx_.resize(size);
+    gy_.resize(size);
+    gz_.resize(size);
+}
+
+auto StructureTensorWorkspace::radius() const -> int { return radius_; }
+
+auto StructureTensorWorkspace::kernelSize() const -> int
+{
+    return kernelSize_;
+}
+
+auto StructureTensorWorkspace::subvoxelStructureTensor(
+    const Volume::Pointer& volume, const cv::Vec3d& center) -> StructureTensor
+{
+    // Sample the subvolume
+    const auto size = offsets_.size();
+    for (std::size_t i = 0; i < size; ++i) {
+        positions_[i] = center + offsets_[i];
+    }
+    volume->interpolateAt(positions_.data(), size, intensities_.data());
+    std::copy(intensities_.begin(), intensities_.end(), values_.begin());
+
+    // XY gradients of each z slice. The cv::Mat headers wrap the buffers, so
+    // the gradients are written in place.
+    const auto sliceSize = static_cast<std::size_t>(side_ * side_);
+    for (std::size_t z = 0; z < static_cast<std::size_t>(side_); ++z) {
+        const auto offset = z * sliceSize;
+        const cv::Mat slice(side_, side_, CV_64F, &values_[offset]);
+        cv::Mat xGradient(side_, side_, CV_64F, &gx_[offset]);
+        cv::Mat yGradient(side_, side_, CV_64F, &gy_[offset]);
+        Gradient(slice, Axis::X, kernelSize_, xGradient);
+        Gradient(slice, Axis::Y, kernelSize_, yGradient);
+    }
+
+    // Z gradients of each XZ slice. Rows of an XZ slice are one z slice apart.
+    const auto xzStep = sliceSize * sizeof(double);
+    for (std::size_t y = 0; y < static_cast<std::size_t>(side_); ++y) {
+        const auto offset = y * static_cast<std::size_t>(side_);
+        const cv::Mat slice(side_, side_, CV_64F, &values_[offset], xzStep);
+        cv::Mat zGradient(side_, side_, CV_64F, &gz_[offset], xzStep);
+        Gradient(slice, Axis::Y, kernelSize_, zGradient);
+    }
+
+    // Modulate by gaussian distribution (element-wise) and sum
+    StructureTensor sum(0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (std::size_t i = 0; i < size; ++i) {
+        sum += gaussian_[i] * Tensorize({gx_[i], gy_[i], gz_[i]});
+    }
+    return sum * (1.0 / static_cast<double>(size));
+}
+
+auto StructureTensorWorkspace::subvoxelEigenPairs(
+    const Volume::Pointer& volume, const cv::Vec3d& center) -> EigenPairs
+{
+    return ComputeEigenPairs(subvoxelStructureTensor(volume, center));
+}
+
+auto volcart::ComputeEigenPairs(const StructureTensor& st) -> EigenPairs
+{
     cv::Vec3d eigenValues;
     cv::Matx33d eigenVectors;
     cv::eigen(st, eigenValues, eigenVectors);
@@ -174,16 +237,6 @@ auto volcart::ComputeSubvoxelEigenPairs(
     };
 }
 
-auto volcart::ComputeSubvoxelEigenPairs(
-    const Volume::Pointer& volume,
-    const cv::Vec3d& index,
-    int radius,
-    int kernelSize) -> EigenPairs
-{
-    return ComputeSubvoxelEigenPairs(
-        volume, index(0), index(1), index(2), radius, kernelSize);
-}
-
 auto Tensorize(cv::Vec3d gradient) -> StructureTensor
 {
     double ix = gradient(0);
@@ -237,14 +290,21 @@ auto VolumeGradient(const Tensor3D<double>& v, int kernelSize)
 // gradient which is more accurate than 3x3 Sobel operator
 auto Gradient(const cv::Mat_<double>& input, Axis axis, int ksize)
     -> cv::Mat_<double>
+{
+    cv::Mat grad(input.rows, input.cols, CV_64F);
+    Gradient(input, axis, ksize, grad);
+    return grad;
+}
+
+// Calculate the gradient into an existing matrix. If grad already has the size
+// and type of the gradient, it is not reallocated.
+void Gradient(const cv::Mat& input, Axis axis, int ksize, cv::Mat& grad)
 {
     // OpenCV params for gradients
     // XXX Revisit this and see if changing these makes a big difference
     constexpr double SCALE = 1;
     constexpr double DELTA = 0;
 
-    cv::Mat_<double> grad(input.rows, input.cols);
-
     switch (axis) {
         case Axis::X:
             if (ksize == 3) {
@@ -269,7 +329,6 @@ auto Gradient(const cv::Mat_<double>& input, Axis axis, int ksize)
             }
             break;
     }
-    return grad;
 }
 
 auto MakeUniformGaussianField(int radius) -> std::unique_ptr<double[]>
@@ -0,0 +1,494 @@
+#include "vc/core/math/StructureTensorField.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vc/core/io/ChunkIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
+#include "vc/core/types/Metadata.hpp"
+#include "vc/core/util/IntegerMath.hpp"
+#include "vc/core/util/Parallel.hpp"
+
+namespace fs = volcart::filesystem;
+namespace cio = volcart::chunkio;
+
+using namespace volcart;
+
+namespace
+{
+// Metadata type identifier
+constexpr auto FIELD_TYPE = "structure_tensor_field";
+
+// Separable components of the 3x3 Scharr operator
+constexpr std::array<float, 3> SCHARR_SMOOTH{3, 10, 3};
+constexpr std::array<float, 3> SCHARR_DERIV{-1, 0, 1};
+
+// Flat block of voxels with x as the fastest axis
+using Block = std::vector<float>;
+
+auto ToArray(const cv::Vec3i& v) -> std::array<int, 3>
+{
+    return {v[0], v[1], v[2]};
+}
+
+auto FromArray(const std::array<int, 3>& a) -> cv::Vec3i
+{
+    return {a[0], a[1], a[2]};
+}
+
+// Copy the voxels of a Volume in [origin, origin + dims) into a block.
+// Voxels outside of the Volume are zero, like Volume::intensityAt().
+void LoadBlock(
+    const Volume::Pointer& volume,
+    const cv::Vec3i& origin,
+    const cv::Vec3i& dims,
+    Block& block)
+{
+    std::fill(block.begin(), block.end(), 0.F);
+    const cv::Vec3i extents{
+        volume->sliceWidth(), volume->sliceHeight(), volume->numSlices()};
+    cv::Vec3i lo;
+    cv::Vec3i hi;
+    for (int i = 0; i < 3; i++) {
+        lo[i] = std::max(origin[i], 0);
+        hi[i] = std::min(origin[i] + dims[i], extents[i]);
+        if (lo[i] >= hi[i]) {
+            return;
+        }
+    }
+
+    // Copy the rows of a slice or chunk which overlap the block
+    auto copyRows = [&](const cv::Mat& src, const cv::Vec3i& srcOrigin,
+                        const cv::Vec3i& from, const cv::Vec3i& to) {
+        const auto width = static_cast<std::size_t>(to[0] - from[0]);
+        for (auto z = from[2]; z < to[2]; z++) {
+            for (auto y = from[1]; y < to[1]; y++) {
+                const std::uint16_t* in{nullptr};
+                if (src.dims == 3) {
+                    in = src.ptr<std::uint16_t>(
+                        z - srcOrigin[2], y - srcOrigin[1]);
+                } else {
+                    in = src.ptr<std::uint16_t>(y - srcOrigin[1]);
+                }
+                in += from[0] - srcOrigin[0];
+                const auto offset =
+                    (static_cast<std::size_t>(z - origin[2]) * dims[1] +
+                     (y - origin[1])) *
+                        dims[0] +
+                    (from[0] - origin[0]);
+                std::copy(in, in + width, block.begin() + offset);
+            }
+        }
+    };
+
+    if (volume->storageFormat() == Volume::StorageFormat::Slices) {
+        for (auto z = lo[2]; z < hi[2]; z++) {
+            const auto slice = volume->getSliceData(z);
+            if (slice.empty()) {
+                continue;
+            }
+            const cv::Vec3i from{lo[0], lo[1], z};
+            const cv::Vec3i to{hi[0], hi[1], z + 1};
+            copyRows(slice, {0, 0, z}, from, to);
+        }
+        return;
+    }
+
+    const auto cs = volume->chunkSize();
+    const auto c0 = volume->chunkIndexAt(lo[0], lo[1], lo[2]);
+    const auto c1 = volume->chunkIndexAt(hi[0] - 1, hi[1] - 1, hi[2] - 1);
+    for (auto cz = c0[2]; cz <= c1[2]; cz++) {
+        for (auto cy = c0[1]; cy <= c1[1]; cy++) {
+            for (auto cx = c0[0]; cx <= c1[0]; cx++) {
+                const cv::Vec3i chunkOrigin{cx * cs, cy * cs, cz * cs};
+                cv::Vec3i from;
+                cv::Vec3i to;
+                for (int i = 0; i < 3; i++) {
+                    from[i] = std::max(lo[i], chunkOrigin[i]);
+                    to[i] = std::min(hi[i], chunkOrigin[i] + cs);
+                }
+                const auto chunk = volume->getChunkData({cx, cy, cz});
+                copyRows(chunk, chunkOrigin, from, to);
+            }
+        }
+    }
+}
+
+// Correlate a block with a 1D kernel along one axis. Only voxels which are at
+// least `radius` voxels from the ends of that axis are written. The inner loop
+// always runs along the contiguous x axis so that it can be vectorized.
+void Filter1D(
+    const Block& src,
+    Block& dst,
+    const cv::Vec3i& dims,
+    const int axis,
+    const float* kernel,
+    const int radius)
+{
+    const std::array<std::ptrdiff_t, 3> strides{
+        1, dims[0], static_cast<std::ptrdiff_t>(dims[0]) * dims[1]};
+    cv::Vec3i lo{0, 0, 0};
+    cv::Vec3i hi{dims};
+    lo[axis] = radius;
+    hi[axis] = dims[axis] - radius;
+    const auto stride = strides[axis];
+    for (auto z = lo[2]; z < hi[2]; z++) {
+        for (auto y = lo[1]; y < hi[1]; y++) {
+            const auto row = z * strides[2] + y * strides[1];
+            const auto* in = src.data() + row;
+            auto* out = dst.data() + row;
+            std::fill(out + lo[0], out + hi[0], 0.F);
+            for (auto i = -radius; i <= radius; i++) {
+                const auto w = kernel[i + radius];
+                if (w == 0.F) {
+                    continue;
+                }
+                const auto* tap = in + i * stride;
+                for (auto x = lo[0]; x < hi[0]; x++) {
+                    out[x] += w * tap[x];
+                }
+            }
+        }
+    }
+}
+
+// The normalized 1D factor of the Gaussian weighting used by
+// ComputeSubvoxelStructureTensor()
+auto GaussianKernel(const int radius) -> std::vector<float>
+{
+    std::vector<float> kernel;
+    double sum{0};
+    for (auto i = -radius; i <= radius; i++) {
+        sum += std::exp(-i * i);
+    }
+    for (auto i = -radius; i <= radius; i++) {
+        kernel.push_back(static_cast<float>(std::exp(-i * i) / sum));
+    }
+    return kernel;
+}
+
+// Unpack (xx, xy, xz, yy, yz, zz)
+auto Unpack(const cv::Vec6d& e) -> StructureTensor
+{
+    // clang-format off
+    return {e[0], e[1], e[2],
+            e[1], e[3], e[4],
+            e[2], e[4], e[5]};
+    // clang-format on
+}
+}  // namespace
+
+StructureTensorField::StructureTensorField(fs::path path)
+    : path_{std::move(path)}
+{
+    Metadata meta(path_ / "meta.json");
+    if (not meta.hasKey("type") or
+        meta.get<std::string>("type") != FIELD_TYPE) {
+        throw IOException("Not a structure tensor field: " + path_.string());
+    }
+    volumeID_ = meta.get<std::string>("volume").value_or("");
+    radius_ = meta.get<int>("radius").value();
+    chunkSize_ = meta.get<int>("chunksize").value();
+    min_ = ::FromArray(meta.get<std::array<int, 3>>("min").value());
+    max_ = ::FromArray(meta.get<std::array<int, 3>>("max").value());
+}
+
+auto StructureTensorField::New(fs::path path) -> Pointer
+{
+    return std::make_shared<StructureTensorField>(std::move(path));
+}
+
+auto StructureTensorField::Create(
+    const fs::path& path,
+    const Volume::Pointer& volume,
+    const int radius,
+    const cv::Vec3i& min,
+    const cv::Vec3i& max,
+    const int chunkSize) -> Pointer
+{
+    if (radius < 0) {
+        throw std::invalid_argument("radius must be >= 0");
+    }
+    if (chunkSize <= 0) {
+        throw std::invalid_argument("chunk size must be > 0");
+    }
+    if (max[0] <= min[0] or max[1] <= min[1] or max[2] <= min[2]) {
+        throw std::invalid_argument("region is empty");
+    }
+
+    auto field = Pointer(new StructureTensorField());
+    field->path_ = path;
+    field->volumeID_ = volume->id();
+    field->radius_ = radius;
+    field->chunkSize_ = chunkSize;
+    field->min_ = min;
+    field->max_ = max;
+
+    fs::create_directories(path);
+    Metadata meta;
+    meta.set("type", FIELD_TYPE);
+    meta.set("volume", volume->id());
+    meta.set("radius", radius);
+    meta.set("chunksize", chunkSize);
+    meta.set("min", ::ToArray(min));
+    meta.set("max", ::ToArray(max));
+    meta.save(path / "meta.json");
+    return field;
+}
+
+auto StructureTensorField::DefaultPath(
+    const Volume::Pointer& volume, const int radius) -> fs::path
+{
+    return volume->path() / "structure_tensors" /
+           ("r" + std::to_string(radius));
+}
+
+auto StructureTensorField::path() const -> fs::path { return path_; }
+
+auto StructureTensorField::volumeID() const -> std::string
+{
+    return volumeID_;
+}
+
+auto StructureTensorField::radius() const -> int { return radius_; }
+
+auto StructureTensorField::chunkSize() const -> int { return chunkSize_; }
+
+auto StructureTensorField::min() const -> cv::Vec3i { return min_; }
+
+auto StructureTensorField::max() const -> cv::Vec3i { return max_; }
+
+auto StructureTensorField::chunkGridExtents() const -> cv::Vec3i
+{
+    const auto ext = max_ - min_;
+    return {
+        (ext[0] + chunkSize_ - 1) / chunkSize_,
+        (ext[1] + chunkSize_ - 1) / chunkSize_,
+        (ext[2] + chunkSize_ - 1) / chunkSize_};
+}
+
+auto StructureTensorField::isInBounds(const cv::Vec3d& p) const -> bool
+{
+    for (int i = 0; i < 3; i++) {
+        if (p[i] < min_[i] or p[i] > max_[i] - 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto StructureTensorField::tensorAt(int x, int y, int z) const
+    -> StructureTensor
+{
+    x = std::clamp(x, min_[0], max_[0] - 1);
+    y = std::clamp(y, min_[1], max_[1] - 1);
+    z = std::clamp(z, min_[2], max_[2] - 1);
+    return ::Unpack(elements_(x, y, z));
+}
+
+auto StructureTensorField::interpolateAt(const cv::Vec3d& p) const
+    -> StructureTensor
+{
+    // Clamp to the region and find the surrounding voxels
+    std::array<int, 3> p0{};
+    std::array<int, 3> p1{};
+    std::array<double, 3> d{};
+    for (int i = 0; i < 3; i++) {
+        const auto v = std::clamp<double>(p[i], min_[i], max_[i] - 1);
+        const auto f = std::floor(v);
+        p0[i] = static_cast<int>(f);
+        p1[i] = std::min(p0[i] + 1, max_[i] - 1);
+        d[i] = v - f;
+    }
+
+    // Trilinear interpolation of the packed elements
+    auto e = [this](int x, int y, int z) {
+        return cv::Vec6d(elements_(x, y, z));
+    };
+    const auto c00 = e(p0[0], p0[1], p0[2]) * (1 - d[0]) +
+                     e(p1[0], p0[1], p0[2]) * d[0];
+    const auto c10 = e(p0[0], p1[1], p0[2]) * (1 - d[0]) +
+                     e(p1[0], p1[1], p0[2]) * d[0];
+    const auto c01 = e(p0[0], p0[1], p1[2]) * (1 - d[0]) +
+                     e(p1[0], p0[1], p1[2]) * d[0];
+    const auto c11 = e(p0[0], p1[1], p1[2]) * (1 - d[0]) +
+                     e(p1[0], p1[1], p1[2]) * d[0];
+    const auto c0 = c00 * (1 - d[1]) + c10 * d[1];
+    const auto c1 = c01 * (1 - d[1]) + c11 * d[1];
+    return ::Unpack(c0 * (1 - d[2]) + c1 * d[2]);
+}
+
+auto StructureTensorField::eigenPairsAt(const cv::Vec3d& p) const
+    -> EigenPairs
+{
+    return ComputeEigenPairs(interpolateAt(p));
+}
+
+void StructureTensorField::computeChunk(
+    const Volume::Pointer& volume, const ChunkIndex& index)
+{
+    const auto grid = chunkGridExtents();
+    for (int i = 0; i < 3; i++) {
+        if (index[i] < 0 or index[i] >= grid[i]) {
+            throw std::out_of_range("chunk index out of range");
+        }
+    }
+
+    // The output voxels of this chunk
+    const cv::Vec3i origin = min_ + index * chunkSize_;
+    cv::Vec3i extents;
+    for (int i = 0; i < 3; i++) {
+        extents[i] = std::min(chunkSize_, max_[i] - origin[i]);
+    }
+
+    // Load the chunk plus a halo for the gradient and the Gaussian window
+    const auto halo = radius_ + 1;
+    const cv::Vec3i dims = extents + cv::Vec3i::all(2 * halo);
+    const auto size = static_cast<std::size_t>(dims[0]) * dims[1] * dims[2];
+    Block block(size);
+    ::LoadBlock(volume, origin - cv::Vec3i::all(halo), dims, block);
+
+    // Scharr gradients. Like the 2D Scharr operator applied to every slice,
+    // each derivative is only smoothed along one other axis.
+    Block smoothX(size, 0.F);
+    Block smoothY(size, 0.F);
+    ::Filter1D(block, smoothX, dims, 0, SCHARR_SMOOTH.data(), 1);
+    ::Filter1D(block, smoothY, dims, 1, SCHARR_SMOOTH.data(), 1);
+    std::array<Block, 3> g{Block(size, 0.F), Block(size, 0.F),
+                           Block(size, 0.F)};
+    ::Filter1D(smoothY, g[0], dims, 0, SCHARR_DERIV.data(), 1);
+    ::Filter1D(smoothX, g[1], dims, 1, SCHARR_DERIV.data(), 1);
+    ::Filter1D(smoothX, g[2], dims, 2, SCHARR_DERIV.data(), 1);
+
+    // Weight each gradient product with the separable Gaussian window. The
+    // window is scaled like the one used by ComputeSubvoxelStructureTensor().
+    const auto gaussian = ::GaussianKernel(radius_);
+    const auto side = 2.0 * radius_ + 1;
+    const auto scale = static_cast<float>(
+        1.0 / (std::pow(2 * M_PI, 3.0 / 2.0) * side * side * side));
+    const std::array<std::pair<int, int>, 6> products{
+        {{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}}};
+    const std::array<int, 3> chunkExtents{chunkSize_, chunkSize_, chunkSize_};
+    cv::Mat chunk = cv::Mat::zeros(3, chunkExtents.data(), CHUNK_TYPE);
+    // The smoothing buffers are reused for the products
+    auto& product = smoothX;
+    auto& tmp = smoothY;
+    for (std::size_t e = 0; e < products.size(); e++) {
+        const auto& a = g[products[e].first];
+        const auto& b = g[products[e].second];
+        for (std::size_t i = 0; i < size; i++) {
+            product[i] = a[i] * b[i];
+        }
+        ::Filter1D(product, tmp, dims, 0, gaussian.data(), radius_);
+        ::Filter1D(tmp, product, dims, 1, gaussian.data(), radius_);
+        ::Filter1D(product, tmp, dims, 2, gaussian.data(), radius_);
+
+        for (int z = 0; z < extents[2]; z++) {
+            for (int y = 0; y < extents[1]; y++) {
+                const auto row =
+                    (static_cast<std::size_t>(z + halo) * dims[1] +
+                     (y + halo)) *
+                        dims[0] +
+                    halo;
+                auto* out = chunk.ptr<cv::Vec6f>(z, y);
+                for (int x = 0; x < extents[0]; x++) {
+                    out[x][e] = scale * tmp[row + x];
+                }
+            }
+        }
+    }
+
+    const auto path = chunkPath(index);
+    fs::create_directories(path.parent_path());
+    cio::WriteChunk(path, chunk);
+}
+
+auto StructureTensorField::chunkPath(const ChunkIndex& index) const -> fs::path
+{
+    return path_ / "chunks" / std::to_string(index[2]) /
+           std::to_string(index[1]) / (std::to_string(index[0]) + ".chunk");
+}
+
+void StructureTensorField::setCacheMemoryInBytes(std::size_t nbytes) const
+{
+    cache_->setCapacity(nbytes);
+}
+
+auto StructureTensorField::NewCache_() -> ChunkCache::Pointer
+{
+    auto cache = DefaultChunkCache::New(DEFAULT_CACHE_BYTES);
+    cache->setWeigher([](const cv::Mat& chunk) {
+        return chunk.total() * chunk.elemSize();
+    });
+    return cache;
+}
+
+void StructureTensorField::cachePurge() const { cache_->purge(); }
+
+auto StructureTensorField::chunk_(const ChunkIndex& index) const -> cv::Mat
+{
+    if (auto chunk = cache_->tryGet(index)) {
+        return chunk.value();
+    }
+
+    // Like Volume, occasionally loading a chunk twice is cheaper than
+    // serializing all loads
+    auto chunk = cio::ReadChunk(chunkPath(index), chunkSize_, CHUNK_TYPE);
+    cache_->put(index, chunk);
+    return chunk;
+}
+
+auto StructureTensorField::elements_(int x, int y, int z) const -> cv::Vec6f
+{
+    x -= min_[0];
+    y -= min_[1];
+    z -= min_[2];
+    const ChunkIndex index{
+        FloorDiv(x, chunkSize_), FloorDiv(y, chunkSize_),
+        FloorDiv(z, chunkSize_)};
+    const auto chunk = chunk_(index);
+    return chunk.at<cv::Vec6f>(
+        z - index[2] * chunkSize_, y - index[1] * chunkSize_,
+        x - index[0] * chunkSize_);
+}
+
+auto volcart::ComputeStructureTensorField(
+    const fs::path& path,
+    const Volume::Pointer& volume,
+    const int radius,
+    std::optional<cv::Vec3i> min,
+    std::optional<cv::Vec3i> max,
+    const int chunkSize,
+    const std::optional<std::uint32_t> maxThreads)
+    -> StructureTensorField::Pointer
+{
+    const cv::Vec3i extents{
+        volume->sliceWidth(), volume->sliceHeight(), volume->numSlices()};
+    auto field = StructureTensorField::Create(
+        path, volume, radius, min.value_or(cv::Vec3i{0, 0, 0}),
+        max.value_or(extents), chunkSize);
+
+    // Chunks are processed in z-major order, so concurrent chunks are close
+    // together in the Volume
+    const auto grid = field->chunkGridExtents();
+    const auto numChunks =
+        static_cast<std::size_t>(grid[0]) * grid[1] * grid[2];
+    ParallelFor(
+        numChunks, 1, NumThreads(maxThreads),
+        [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                const auto idx = static_cast<int>(i);
+                const StructureTensorField::ChunkIndex index{
+                    idx % grid[0], (idx / grid[0]) % grid[1],
+                    idx / (grid[0] * grid[1])};
+                field->computeChunk(volume, index);
+            }
+        });
+    return field;
+}
@@ -1,9 +1,14 @@
 #include "vc/core/io/TIFFIO.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <opencv2/imgproc.hpp>
 
@@ -11,6 +16,7 @@
 #include "vc/core/io/FileFilters.hpp"
 #include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
 
 // Wrapping in a namespace to avoid define collisions
 namespace lt
@@ -60,6 +66,12 @@ auto GetCVMatType(
 constexpr std::size_t MAX_TIFF_BYTES{4'294'967'296};
 constexpr std::size_t BITS_PER_BYTE{8};
 
+// Target size of the strips in compressed images
+constexpr std::size_t COMPRESSED_STRIP_BYTES{256 * 1024};
+
+// Smallest region which is worth decoding on several threads
+constexpr std::size_t PARALLEL_DECODE_BYTES{1024 * 1024};
+
 auto NeedBigTIFF(
     const std::size_t w,
     const std::size_t h,
@@ -74,12 +86,17 @@ struct TIFFHeader {
     std::uint32_t width = 0;
     std::uint32_t height = 0;
     std::uint32_t rowsPerStrip = 0;
+    std::uint32_t tileWidth = 0;
+    std::uint32_t tileHeight = 0;
+    std::uint32_t numStrips = 0;
     std::uint16_t type = 1;
     std::uint16_t depth = 1;
     std::uint16_t channels = 1;
     std::uint16_t config = 0;
     std::uint64_t* stripOffsets{nullptr};
     tio::Compression compression{tio::Compression::NONE};
+    bool tiled{false};
+    bool byteSwapped{false};
 };
 
 auto ReadHeader(lt::TIFF* tif)
@@ -93,33 +110,150 @@ auto ReadHeader(lt::TIFF* tif)
     TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &hdr.channels);
     TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &hdr.config);
     TIFFGetField(tif, TIFFTAG_COMPRESSION, &hdr.compression);
-    TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &hdr.rowsPerStrip);
-    TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &hdr.stripOffsets);
+    hdr.tiled = lt::TIFFIsTiled(tif) != 0;
+    hdr.byteSwapped = lt::TIFFIsByteSwapped(tif) != 0;
+    if (hdr.tiled) {
+        TIFFGetField(tif, TIFFTAG_TILEWIDTH, &hdr.tileWidth);
+        TIFFGetField(tif, TIFFTAG_TILELENGTH, &hdr.tileHeight);
+    } else {
+        TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &hdr.rowsPerStrip);
+        TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &hdr.stripOffsets);
+        hdr.numStrips = lt::TIFFNumberOfStrips(tif);
+        if (hdr.rowsPerStrip == 0 or hdr.rowsPerStrip > hdr.height) {
+            hdr.rowsPerStrip = hdr.height;
+        }
+    }
     return hdr;
 }
 
-auto ReadImage(lt::TIFF* tif, const TIFFHeader& hdr) -> cv::Mat
+// An independently encoded strip or tile of a TIFF
+struct Chunk {
+    // Strip or tile index
+    std::uint32_t index{0};
+    // Region of the image covered by the chunk
+    cv::Rect rect;
+    // Sample plane of the chunk. Always 0 for contiguous images.
+    int plane{0};
+};
+
+// Get the strips or tiles of the TIFF which overlap roi
+auto OverlappingChunks(
+    lt::TIFF* tif, const TIFFHeader& hdr, const cv::Rect& roi)
+    -> std::vector<Chunk>
 {
-    // Construct the mat
-    const auto h = static_cast<int>(hdr.height);
     const auto w = static_cast<int>(hdr.width);
-    const auto cvType = GetCVMatType(hdr.type, hdr.depth, hdr.channels);
-    cv::Mat img = cv::Mat::zeros(h, w, cvType);
-
-    // Read the rows
-    const auto bufferSize = static_cast<std::size_t>(lt::TIFFScanlineSize(tif));
-    std::vector<char> buffer(bufferSize + 4);
-    if (hdr.config == PLANARCONFIG_CONTIG) {
-        for (auto row = 0; row < hdr.height; row++) {
-            lt::TIFFReadScanline(tif, &buffer[0], row);
-            std::memcpy(img.ptr(row), &buffer[0], bufferSize);
+    const auto h = static_cast<int>(hdr.height);
+    const auto separate = hdr.config == PLANARCONFIG_SEPARATE;
+    const auto planes = separate ? static_cast<int>(hdr.channels) : 1;
+
+    std::vector<Chunk> chunks;
+    for (auto plane = 0; plane < planes; plane++) {
+        const auto sample = static_cast<std::uint16_t>(plane);
+        if (hdr.tiled) {
+            const auto tw = static_cast<int>(hdr.tileWidth);
+            const auto th = static_cast<int>(hdr.tileHeight);
+            for (auto y = roi.y / th * th; y < roi.br().y; y += th) {
+                for (auto x = roi.x / tw * tw; x < roi.br().x; x += tw) {
+                    Chunk c;
+                    c.index = lt::TIFFComputeTile(
+                        tif, static_cast<std::uint32_t>(x),
+                        static_cast<std::uint32_t>(y), 0, sample);
+                    c.rect = cv::Rect(
+                        x, y, std::min(tw, w - x), std::min(th, h - y));
+                    c.plane = plane;
+                    chunks.push_back(c);
+                }
+            }
+        } else {
+            const auto rps = static_cast<int>(hdr.rowsPerStrip);
+            for (auto y = roi.y / rps * rps; y < roi.br().y; y += rps) {
+                Chunk c;
+                c.index = lt::TIFFComputeStrip(
+                    tif, static_cast<std::uint32_t>(y), sample);
+                c.rect = cv::Rect(0, y, w, std::min(rps, h - y));
+                c.plane = plane;
+                chunks.push_back(c);
+            }
         }
-    } else if (hdr.config == PLANARCONFIG_SEPARATE) {
+    }
+    return chunks;
+}
+
+// Decode a strip or tile and copy the part which overlaps roi into img.
+// buffer is resized as needed and can be reused between calls.
+void DecodeChunk(
+    lt::TIFF* tif,
+    const TIFFHeader& hdr,
+    const Chunk& chunk,
+    const cv::Rect& roi,
+    cv::Mat& img,
+    std::vector<char>& buffer)
+{
+    const auto separate = hdr.config == PLANARCONFIG_SEPARATE;
+    const auto sampleSize = img.elemSize1();
+    const auto srcPixelSize = separate ? sampleSize : img.elemSize();
+    const auto overlap = chunk.rect & roi;
+
+    // Decode whole strips directly into the image rows when possible
+    const auto direct = not hdr.tiled and not separate and roi.x == 0 and
+                        roi.width == chunk.rect.width and
+                        overlap == chunk.rect;
+    if (direct) {
+        const auto size = img.elemSize() * chunk.rect.area();
+        const auto result = lt::TIFFReadEncodedStrip(
+            tif, chunk.index, img.ptr(chunk.rect.y - roi.y),
+            static_cast<lt::tmsize_t>(size));
+        if (result == -1) {
+            throw vc::IOException(
+                "Failed to read strip " + std::to_string(chunk.index));
+        }
+        return;
+    }
+
+    // Decode into the buffer
+    lt::tmsize_t result{-1};
+    std::size_t stride{0};
+    if (hdr.tiled) {
+        buffer.resize(static_cast<std::size_t>(lt::TIFFTileSize(tif)));
+        result = lt::TIFFReadEncodedTile(
+            tif, chunk.index, buffer.data(),
+            static_cast<lt::tmsize_t>(buffer.size()));
+        stride = srcPixelSize * hdr.tileWidth;
+    } else {
+        buffer.resize(static_cast<std::size_t>(lt::TIFFStripSize(tif)));
+        result = lt::TIFFReadEncodedStrip(
+            tif, chunk.index, buffer.data(),
+            static_cast<lt::tmsize_t>(buffer.size()));
+        stride = srcPixelSize * hdr.width;
+    }
+    if (result == -1) {
         throw vc::IOException(
-            "Unsupported TIFF planar configuration: PLANARCONFIG_SEPARATE");
+            "Failed to read chunk " + std::to_string(chunk.index));
     }
 
-    // Do channel conversion
+    // Copy the overlapping rows
+    const auto cols = static_cast<std::size_t>(overlap.width);
+    for (auto y = overlap.y; y < overlap.br().y; y++) {
+        const auto* src = buffer.data() + stride * (y - chunk.rect.y) +
+                          srcPixelSize * (overlap.x - chunk.rect.x);
+        auto* dst = img.ptr(y - roi.y, overlap.x - roi.x);
+        if (not separate) {
+            std::memcpy(dst, src, srcPixelSize * cols);
+            continue;
+        }
+        // Interleave a sample plane
+        dst += sampleSize * chunk.plane;
+        for (std::size_t x = 0; x < cols; x++) {
+            std::memcpy(dst, src, sampleSize);
+            src += sampleSize;
+            dst += img.elemSize();
+        }
+    }
+}
+
+// Convert RGB-type images to BGR channel order
+void ToCVChannelOrder(cv::Mat& img)
+{
     const auto cvtNeeded = img.channels() == 3 or img.channels() == 4;
     const auto cvtSupported = img.depth() != CV_8S and img.depth() != CV_16S and
                               img.depth() != CV_32S;
@@ -137,23 +271,101 @@ auto ReadImage(lt::TIFF* tif, const TIFFHeader& hdr) -> cv::Mat
                 "element order.");
         }
     }
+}
 
+// Read the region roi of the TIFF. Compressed chunks of large regions are
+// decoded in parallel, with each worker opening its own handle to the file
+// using mode. Callers which are already parallel workers decode serially, so
+// parallel loops over images don't start threads for every image.
+auto ReadImage(
+    lt::TIFF* tif,
+    const TIFFHeader& hdr,
+    const cv::Rect& roi,
+    const fs::path& path,
+    const char* mode) -> cv::Mat
+{
+    // Construct the mat. Every pixel is written by the chunks, so it isn't
+    // zero-filled first.
+    const auto cvType = GetCVMatType(hdr.type, hdr.depth, hdr.channels);
+    cv::Mat img(roi.size(), cvType);
+
+    // Decode the overlapping chunks
+    const auto chunks = ::OverlappingChunks(tif, hdr, roi);
+    const auto threads = vc::NumThreads();
+    const auto bytes = img.total() * img.elemSize();
+    const auto parallel = hdr.compression != tio::Compression::NONE and
+                          threads > 1 and chunks.size() > 1 and
+                          bytes >= PARALLEL_DECODE_BYTES and
+                          not vc::IsParallelWorker();
+    if (not parallel) {
+        std::vector<char> buffer;
+        for (const auto& chunk : chunks) {
+            ::DecodeChunk(tif, hdr, chunk, roi, img, buffer);
+        }
+    } else {
+        // libtiff handles are not thread safe, so each block gets its own
+        const auto blockSize = std::max<std::size_t>(
+            1, (chunks.size() + threads - 1) / threads);
+        vc::ParallelFor(
+            chunks.size(), blockSize, threads,
+            [&](std::size_t begin, std::size_t end) {
+                auto* worker = lt::TIFFOpen(path.c_str(), mode);
+                if (worker == nullptr) {
+                    throw vc::IOException("Failed to open TIFF");
+                }
+                std::vector<char> buffer;
+                try {
+                    for (auto i = begin; i < end; i++) {
+                        ::DecodeChunk(worker, hdr, chunks[i], roi, img, buffer);
+                    }
+                } catch (...) {
+                    lt::TIFFClose(worker);
+                    throw;
+                }
+                lt::TIFFClose(worker);
+            });
+    }
+
+    // Do channel conversion
+    ::ToCVChannelOrder(img);
     return img;
 }
 
-// Returns whether this TIFF file is encoded for memory mapping
+// Size of a row of pixels in bytes
+auto RowBytes(const TIFFHeader& hdr) -> std::uint64_t
+{
+    return std::uint64_t{hdr.width} * hdr.channels * hdr.depth /
+           BITS_PER_BYTE;
+}
+
+// Returns whether this TIFF file is encoded for memory mapping. The pixels
+// must be stored uncompressed, in native byte order, and in the same layout as
+// a cv::Mat. Strips must be packed back to back so that the rows of the image
+// are contiguous in the file.
 auto CanMMap(const TIFFHeader& hdr) -> bool
 {
-    auto res = hdr.config == PLANARCONFIG_CONTIG;
-    res &= hdr.type == SAMPLEFORMAT_UINT;
-    res &= hdr.depth == 16 and hdr.channels == 1;
+    auto res = hdr.config == PLANARCONFIG_CONTIG and not hdr.tiled;
     res &= hdr.compression == tio::Compression::NONE;
-    // important: full image is in a single strip
-    res &= hdr.rowsPerStrip == hdr.height;
-    return res;
+    res &= not hdr.byteSwapped;
+    res &= hdr.depth == 8 or hdr.depth == 16 or hdr.depth == 32;
+    // 3 and 4 channel images need channel conversion
+    res &= hdr.channels == 1 or hdr.channels == 2;
+    res &= hdr.stripOffsets != nullptr and hdr.numStrips > 0;
+    if (not res) {
+        return false;
+    }
+
+    // important: strips are contiguous
+    const auto stripBytes = RowBytes(hdr) * hdr.rowsPerStrip;
+    for (std::uint32_t s = 1; s < hdr.numStrips; s++) {
+        if (hdr.stripOffsets[s] != hdr.stripOffsets[0] + s * stripBytes) {
+            return false;
+        }
+    }
+    return true;
 }
 
-// Memory mapp the tiff
+// Memory map the tiff and wrap the pixels without copying
 auto MMapImage(const fs::path& path, const TIFFHeader& hdr)
     -> std::pair<cv::Mat, vc::mmap_info>
 {
@@ -164,6 +376,14 @@ auto MMapImage(const fs::path& path, const TIFFHeader& hdr)
             return {};
         }
 
+        // Make sure the pixels are inside the file
+        const auto end = hdr.stripOffsets[0] + RowBytes(hdr) * hdr.height;
+        if (end > static_cast<std::uint64_t>(mmap.size)) {
+            vc::Logger()->debug("TIFF strips are truncated: {}", path.string());
+            vc::UnmapFile(mmap);
+            return {};
+        }
+
         // Construct a Mat
         const auto h = static_cast<int>(hdr.height);
         const auto w = static_cast<int>(hdr.width);
@@ -176,123 +396,47 @@ auto MMapImage(const fs::path& path, const TIFFHeader& hdr)
     }
 }
 
-}  // namespace
-
-auto tio::ReadTIFF(const fs::path& path, mmap_info* mmap_info) -> cv::Mat
+// Get the TIFF sample format and bits per sample for a cv::Mat depth
+auto GetSampleFormat(const int depth) -> std::pair<int, int>
 {
-    // Make sure input file exists
-    if (not fs::exists(path)) {
-        throw IOException("File does not exist");
-    }
-
-    // Open the file read-only
-    lt::TIFF* tif = lt::TIFFOpen(path.c_str(), "rc");
-    if (tif == nullptr) {
-        throw IOException("Failed to open TIFF");
-    }
-
-    // Get metadata
-    const auto hdr = ReadHeader(tif);
-    cv::Mat img;
-
-    // Load memmap'd image
-    if (MEMMAP_SUPPORTED and mmap_info and CanMMap(hdr)) {
-        // Try to mmap
-        std::tie(img, *mmap_info) = MMapImage(path, hdr);
-        if (img.empty()) {
-            Logger()->debug(
-                "Falling back to reading TIFF into memory: {}", path.string());
-            img = ReadImage(tif, hdr);
-        }
-    } else {
-        // If we requested memory mapping (and it's available), log the failure
-        if (MEMMAP_SUPPORTED and mmap_info) {
-            Logger()->debug(
-                "TIFF cannot be memory mapped: {}. Image will be read into "
-                "memory instead",
-                path.string());
-        }
-        img = ReadImage(tif, hdr);
-    }
-
-    // Close the tif file
-    lt::TIFFClose(tif);
-    return img;
-}
-
-// Write a TIFF to a file. This implementation heavily borrows from how OpenCV's
-// TIFFEncoder writes to the TIFF
-void tio::WriteTIFF(
-    const fs::path& path, const cv::Mat& img, const Compression compression)
-{
-    // Safety checks
-    if (img.channels() < 1 or img.channels() > 4) {
-        throw IOException("Unsupported number of channels");
-    }
-
-    if (not io::FileExtensionFilter(path, {"tif", "tiff"})) {
-        throw IOException(
-            "Invalid file extension " + path.extension().string());
-    }
-
-    // Image metadata
-    const auto channels = img.channels();
-    const auto width = static_cast<unsigned>(img.cols);
-    const auto height = static_cast<unsigned>(img.rows);
-    const auto rowsPerStrip = height;
-
-    // Sample format
-    int bitsPerSample;
-    int sampleFormat;
-    switch (img.depth()) {
+    switch (depth) {
         case CV_8U:
-            sampleFormat = SAMPLEFORMAT_UINT;
-            bitsPerSample = 8;
-            break;
+            return {SAMPLEFORMAT_UINT, 8};
         case CV_8S:
-            sampleFormat = SAMPLEFORMAT_INT;
-            bitsPerSample = 8;
-            break;
+            return {SAMPLEFORMAT_INT, 8};
         case CV_16U:
-            sampleFormat = SAMPLEFORMAT_UINT;
-            bitsPerSample = 16;
-            break;
+            return {SAMPLEFORMAT_UINT, 16};
         case CV_16S:
-            sampleFormat = SAMPLEFORMAT_INT;
-            bitsPerSample = 16;
-            break;
+            return {SAMPLEFORMAT_INT, 16};
         case CV_32S:
-            sampleFormat = SAMPLEFORMAT_INT;
-            bitsPerSample = 32;
-            break;
+            return {SAMPLEFORMAT_INT, 32};
         case CV_32F:
-            sampleFormat = SAMPLEFORMAT_IEEEFP;
-            bitsPerSample = 32;
-            break;
+            return {SAMPLEFORMAT_IEEEFP, 32};
         case CV_64F:
-            sampleFormat = SAMPLEFORMAT_IEEEFP;
-            bitsPerSample = 64;
-            break;
+            return {SAMPLEFORMAT_IEEEFP, 64};
         default:
-            throw IOException("Unsupported image depth");
+            throw vc::IOException("Unsupported image depth");
     }
+}
 
-    // Photometric Interpretation
-    int photometric;
+// Get the TIFF photometric interpretation for a number of channels
+auto GetPhotometric(const int channels) -> int
+{
     switch (channels) {
         case 1:
         case 2:
-            photometric = PHOTOMETRIC_MINISBLACK;
-            break;
+            return PHOTOMETRIC_MINISBLACK;
         case 3:
         case 4:
-            photometric = PHOTOMETRIC_RGB;
-            break;
+            return PHOTOMETRIC_RGB;
         default:
-            throw IOException("Unsupported number of channels");
+            throw vc::IOException("Unsupported number of channels");
     }
+}
 
-    // Get working copy with converted channels if an RGB-type image
+// Get a working copy with converted channels if an RGB-type image
+auto ToTIFFChannelOrder(const cv::Mat& img) -> cv::Mat
+{
     const auto cvtNeeded = img.channels() == 3 or img.channels() == 4;
     const auto cvtSupported = img.depth() != CV_8S and img.depth() != CV_16S and
                               img.depth() != CV_32S;
@@ -304,38 +448,98 @@ void tio::WriteTIFF(
             cv::cvtColor(img, imgCopy, cv::COLOR_BGRA2RGBA);
         }
     } else if (cvtNeeded) {
-        throw IOException(
+        throw vc::IOException(
             "BGR->RGB conversion for signed 8-bit and 16-bit images is not "
             "supported.");
     } else {
         imgCopy = img;
     }
+    return imgCopy;
+}
+
+// Open a TIFF for writing, using BigTIFF if the image is >= 4GB
+auto OpenForWriting(
+    const fs::path& path,
+    const std::size_t width,
+    const std::size_t height,
+    const int cvType) -> lt::TIFF*
+{
+    // Safety checks
+    const auto channels = CV_MAT_CN(cvType);
+    if (channels < 1 or channels > 4) {
+        throw vc::IOException("Unsupported number of channels");
+    }
+    if (not vc::io::FileExtensionFilter(path, {"tif", "tiff"})) {
+        throw vc::IOException(
+            "Invalid file extension " + path.extension().string());
+    }
 
     // Estimated file size in bytes
-    const auto useBigTIFF =
-        ::NeedBigTIFF(width, height, channels, bitsPerSample);
+    const auto bitsPerSample = GetSampleFormat(CV_MAT_DEPTH(cvType)).second;
+    const auto useBigTIFF = NeedBigTIFF(width, height, channels, bitsPerSample);
     if (useBigTIFF) {
-        Logger()->warn("File estimate >= 4GB. Writing as BigTIFF.");
+        vc::Logger()->warn("File estimate >= 4GB. Writing as BigTIFF.");
     }
 
     // Open the file
     const std::string mode = (useBigTIFF) ? "w8" : "w";
     auto* out = lt::TIFFOpen(path.c_str(), mode.c_str());
     if (out == nullptr) {
-        Logger()->error("Failed to open file for writing: {}", path.string());
-        throw IOException("Failed to open file for writing: " + path.string());
+        vc::Logger()->error(
+            "Failed to open file for writing: {}", path.string());
+        throw vc::IOException(
+            "Failed to open file for writing: " + path.string());
+    }
+    return out;
+}
+
+// Compression schemes which have short names
+constexpr std::array<std::pair<tio::Compression, const char*>, 5>
+    COMPRESSION_NAMES{{
+        {tio::Compression::NONE, "none"},
+        {tio::Compression::LZW, "lzw"},
+        {tio::Compression::ADOBE_DEFLATE, "deflate"},
+        {tio::Compression::ZSTD, "zstd"},
+        {tio::Compression::LZMA, "lzma"},
+    }};
+
+// Set the tags shared by scanline and tiled images. Closes out on failure.
+void SetImageFields(
+    lt::TIFF* out,
+    const unsigned width,
+    const unsigned height,
+    const int cvType,
+    const tio::Compression compression,
+    const tio::Predictor predictor)
+{
+    if (not tio::IsCompressionSupported(compression)) {
+        lt::TIFFClose(out);
+        throw vc::IOException(
+            "Compression scheme not supported: " +
+            std::to_string(static_cast<int>(compression)));
     }
 
+    const auto channels = CV_MAT_CN(cvType);
+    const auto [sampleFormat, bitsPerSample] =
+        GetSampleFormat(CV_MAT_DEPTH(cvType));
+
     // Encoding parameters
     lt::TIFFSetField(out, TIFFTAG_IMAGEWIDTH, width);
     lt::TIFFSetField(out, TIFFTAG_IMAGELENGTH, height);
-    lt::TIFFSetField(out, TIFFTAG_PHOTOMETRIC, photometric);
+    lt::TIFFSetField(out, TIFFTAG_PHOTOMETRIC, GetPhotometric(channels));
     lt::TIFFSetField(out, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
     lt::TIFFSetField(out, TIFFTAG_COMPRESSION, compression);
     lt::TIFFSetField(out, TIFFTAG_SAMPLEFORMAT, sampleFormat);
     lt::TIFFSetField(out, TIFFTAG_BITSPERSAMPLE, bitsPerSample);
     lt::TIFFSetField(out, TIFFTAG_SAMPLESPERPIXEL, channels);
-    lt::TIFFSetField(out, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+
+    // The predictor tag is only defined for codecs which support it
+    if (compression != tio::Compression::NONE and
+        predictor != tio::Predictor::NONE and
+        lt::TIFFSetField(out, TIFFTAG_PREDICTOR, predictor) != 1) {
+        lt::TIFFClose(out);
+        throw vc::IOException("Predictor not supported by compression scheme");
+    }
 
     // Add alpha tag data
     // TODO: Let user decide associated/unassociated tag
@@ -347,7 +551,165 @@ void tio::WriteTIFF(
 
     // Metadata
     lt::TIFFSetField(
-        out, TIFFTAG_SOFTWARE, ProjectInfo::NameAndVersion().c_str());
+        out, TIFFTAG_SOFTWARE, vc::ProjectInfo::NameAndVersion().c_str());
+}
+}  // namespace
+
+auto tio::IsCompressionSupported(const Compression compression) -> bool
+{
+    return lt::TIFFIsCODECConfigured(static_cast<std::uint16_t>(compression)) ==
+           1;
+}
+
+auto tio::CompressionName(const Compression compression) -> std::string
+{
+    for (const auto& [c, name] : ::COMPRESSION_NAMES) {
+        if (c == compression) {
+            return name;
+        }
+    }
+    throw std::invalid_argument(
+        "Compression scheme does not have a name: " +
+        std::to_string(static_cast<int>(compression)));
+}
+
+auto tio::CompressionFromName(const std::string& name) -> Compression
+{
+    for (const auto& [c, n] : ::COMPRESSION_NAMES) {
+        if (name == n) {
+            return c;
+        }
+    }
+    throw std::invalid_argument("Unknown compression scheme: " + name);
+}
+
+auto tio::ReadTIFF(const fs::path& path, mmap_info* mmap_info) -> cv::Mat
+{
+    // Make sure input file exists
+    if (not fs::exists(path)) {
+        throw IOException("File does not exist");
+    }
+
+    // Open the file read-only. Strip chopping is disabled so that
+    // single-strip images can be memory mapped.
+    constexpr auto mode = "rc";
+    lt::TIFF* tif = lt::TIFFOpen(path.c_str(), mode);
+    if (tif == nullptr) {
+        throw IOException("Failed to open TIFF");
+    }
+
+    // Get metadata
+    const auto hdr = ReadHeader(tif);
+    const cv::Rect full(
+        0, 0, static_cast<int>(hdr.width), static_cast<int>(hdr.height));
+    cv::Mat img;
+
+    // Load memmap'd image
+    if (MEMMAP_SUPPORTED and mmap_info and CanMMap(hdr)) {
+        // Try to mmap
+        std::tie(img, *mmap_info) = MMapImage(path, hdr);
+        if (img.empty()) {
+            Logger()->debug(
+                "Falling back to reading TIFF into memory: {}", path.string());
+            img = ReadImage(tif, hdr, full, path, mode);
+        }
+    } else {
+        // If we requested memory mapping (and it's available), log the failure
+        if (MEMMAP_SUPPORTED and mmap_info) {
+            Logger()->debug(
+                "TIFF cannot be memory mapped: {}. Image will be read into "
+                "memory instead",
+                path.string());
+        }
+        img = ReadImage(tif, hdr, full, path, mode);
+    }
+
+    // Close the tif file
+    lt::TIFFClose(tif);
+    return img;
+}
+
+auto tio::ReadTIFF(const fs::path& path, const cv::Rect& roi) -> cv::Mat
+{
+    // Make sure input file exists
+    if (not fs::exists(path)) {
+        throw IOException("File does not exist");
+    }
+
+    // Open the file read-only. Strip chopping is left enabled, so large
+    // uncompressed strips are read in small pieces.
+    constexpr auto mode = "r";
+    lt::TIFF* tif = lt::TIFFOpen(path.c_str(), mode);
+    if (tif == nullptr) {
+        throw IOException("Failed to open TIFF");
+    }
+
+    // Clip the region to the image
+    const auto hdr = ReadHeader(tif);
+    const auto clipped =
+        roi & cv::Rect(
+                  0, 0, static_cast<int>(hdr.width),
+                  static_cast<int>(hdr.height));
+    if (clipped.empty()) {
+        lt::TIFFClose(tif);
+        throw IOException("Region does not overlap the image");
+    }
+
+    cv::Mat img;
+    try {
+        img = ReadImage(tif, hdr, clipped, path, mode);
+    } catch (...) {
+        lt::TIFFClose(tif);
+        throw;
+    }
+    lt::TIFFClose(tif);
+    return img;
+}
+
+// Write a TIFF to a file. This implementation heavily borrows from how OpenCV's
+// TIFFEncoder writes to the TIFF
+void tio::WriteTIFF(
+    const fs::path& path,
+    const cv::Mat& img,
+    const Compression compression,
+    const int tileSize,
+    const Predictor predictor)
+{
+    // Write tiled images with the tiled writer
+    if (tileSize > 0) {
+        TiledTIFFWriter writer(
+            path, img.cols, img.rows, img.type(), tileSize, compression,
+            predictor);
+        writer.write(img, 0, 0);
+        writer.close();
+        return;
+    }
+
+    // Image metadata
+    const auto width = static_cast<unsigned>(img.cols);
+    const auto height = static_cast<unsigned>(img.rows);
+
+    // Get working copy with converted channels if an RGB-type image
+    const auto imgCopy = ::ToTIFFChannelOrder(img);
+
+    // Open the file
+    auto* out = ::OpenForWriting(path, width, height, img.type());
+
+    // Encoding parameters
+    ::SetImageFields(
+        out, width, height, img.type(), compression, predictor);
+
+    // Uncompressed images are a single strip so they can be memory mapped.
+    // Compressed images are split into strips which can be decoded
+    // independently.
+    auto rowsPerStrip = height;
+    if (compression != Compression::NONE) {
+        const auto rowBytes =
+            std::max<std::size_t>(1, img.cols * img.elemSize());
+        rowsPerStrip = static_cast<unsigned>(std::clamp<std::size_t>(
+            ::COMPRESSED_STRIP_BYTES / rowBytes, 1, height));
+    }
+    lt::TIFFSetField(out, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
 
     // Row buffer. OpenCV documentation mentions that TIFFWriteScanline
     // modifies its read buffer, so we can't use the cv::Mat directly
@@ -368,3 +730,140 @@ void tio::WriteTIFF(
     // Close the TIFF
     lt::TIFFClose(out);
 }
+
+///// Tiled writer /////
+struct tio::TiledTIFFWriter::Handle {
+    /** libtiff handle */
+    lt::TIFF* tif{nullptr};
+};
+
+tio::TiledTIFFWriter::TiledTIFFWriter(
+    const fs::path& path,
+    const int width,
+    const int height,
+    const int cvType,
+    const int tileSize,
+    const Compression compression,
+    const Predictor predictor)
+    : path_{path}
+    , width_{width}
+    , height_{height}
+    , cvType_{cvType}
+    , tileSize_{tileSize}
+    , tif_{std::make_unique<Handle>()}
+{
+    // Safety checks
+    if (width_ <= 0 or height_ <= 0) {
+        throw IOException("Cannot write an empty image: " + path_.string());
+    }
+    if (tileSize_ <= 0 or tileSize_ % 16 != 0) {
+        throw IOException("Tile size must be a multiple of 16");
+    }
+
+    // Open the file
+    tif_->tif = ::OpenForWriting(path_, width_, height_, cvType_);
+
+    // Encoding parameters
+    ::SetImageFields(
+        tif_->tif, static_cast<unsigned>(width_),
+        static_cast<unsigned>(height_), cvType_, compression, predictor);
+    lt::TIFFSetField(tif_->tif, TIFFTAG_TILEWIDTH, tileSize_);
+    lt::TIFFSetField(tif_->tif, TIFFTAG_TILELENGTH, tileSize_);
+    written_.resize(lt::TIFFNumberOfTiles(tif_->tif), false);
+}
+
+tio::TiledTIFFWriter::~TiledTIFFWriter()
+{
+    try {
+        close();
+    } catch (const std::exception& e) {
+        Logger()->error("Failed to close TIFF: {}", e.what());
+    }
+}
+
+auto tio::TiledTIFFWriter::tileSize() const -> int { return tileSize_; }
+
+void tio::TiledTIFFWriter::write(const cv::Mat& img, const int x, const int y)
+{
+    // Safety checks
+    if (img.type() != cvType_) {
+        throw IOException("Region does not match the image type");
+    }
+    if (x < 0 or y < 0 or x % tileSize_ != 0 or y % tileSize_ != 0) {
+        throw IOException("Region origin is not on the tile grid");
+    }
+    if (x + img.cols > width_ or y + img.rows > height_) {
+        throw IOException("Region is out of bounds");
+    }
+    if ((img.cols % tileSize_ != 0 and x + img.cols != width_) or
+        (img.rows % tileSize_ != 0 and y + img.rows != height_)) {
+        throw IOException("Region does not cover whole tiles");
+    }
+
+    // Get working copy with converted channels if an RGB-type image
+    const auto imgCopy = ::ToTIFFChannelOrder(img);
+
+    // Tile buffer. Partial tiles at the image edge are zero padded.
+    const auto pixelSize = imgCopy.elemSize();
+    const auto tileBytes = pixelSize * tileSize_ * tileSize_;
+    std::vector<char> buffer(tileBytes);
+
+    for (auto ty = 0; ty < img.rows; ty += tileSize_) {
+        for (auto tx = 0; tx < img.cols; tx += tileSize_) {
+            // Copy the tile into the buffer
+            const auto rows = std::min(tileSize_, img.rows - ty);
+            const auto cols = std::min(tileSize_, img.cols - tx);
+            std::fill(buffer.begin(), buffer.end(), 0);
+            for (auto row = 0; row < rows; row++) {
+                std::memcpy(
+                    &buffer[pixelSize * tileSize_ * row],
+                    imgCopy.ptr(ty + row, tx), pixelSize * cols);
+            }
+
+            // Write the tile
+            const std::unique_lock lock(mutex_);
+            if (tif_->tif == nullptr) {
+                throw IOException("TIFF already closed: " + path_.string());
+            }
+            const auto tile = lt::TIFFComputeTile(
+                tif_->tif, static_cast<std::uint32_t>(x + tx),
+                static_cast<std::uint32_t>(y + ty), 0, 0);
+            const auto result = lt::TIFFWriteEncodedTile(
+                tif_->tif, tile, buffer.data(),
+                static_cast<lt::tmsize_t>(tileBytes));
+            if (result == -1) {
+                throw IOException(
+                    "Failed to write tile " + std::to_string(tile));
+            }
+            written_[tile] = true;
+        }
+    }
+}
+
+void tio::TiledTIFFWriter::close()
+{
+    const std::unique_lock lock(mutex_);
+    if (tif_->tif == nullptr) {
+        return;
+    }
+
+    // Fill the unwritten tiles
+    const auto pixelSize = CV_ELEM_SIZE(cvType_);
+    const auto tileBytes = pixelSize * tileSize_ * tileSize_;
+    std::vector<char> zeros(tileBytes, 0);
+    auto failed = false;
+    for (std::size_t tile = 0; tile < written_.size(); tile++) {
+        if (not written_[tile]) {
+            failed |= lt::TIFFWriteEncodedTile(
+                          tif_->tif, static_cast<std::uint32_t>(tile),
+                          zeros.data(),
+                          static_cast<lt::tmsize_t>(tileBytes)) == -1;
+        }
+    }
+
+    lt::TIFFClose(tif_->tif);
+    tif_->tif = nullptr;
+    if (failed) {
+        throw IOException("Failed to write TIFF: " + path_.string());
+    }
+}
@@ -0,0 +1,99 @@
+#include "vc/core/util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
+
+using namespace volcart;
+
+ThreadPool::ThreadPool(std::uint32_t numThreads)
+{
+    numThreads = std::max(1U, numThreads);
+    workers_.reserve(numThreads);
+    for (std::uint32_t i = 0; i < numThreads; i++) {
+        workers_.emplace_back(&ThreadPool::run_, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock lock(mutex_);
+        stop_ = true;
+        tasks_.clear();
+    }
+    taskReady_.notify_all();
+    for (auto& w : workers_) {
+        w.join();
+    }
+}
+
+auto ThreadPool::numThreads() const -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(workers_.size());
+}
+
+void ThreadPool::submit(Task task)
+{
+    {
+        std::unique_lock lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    taskReady_.notify_one();
+}
+
+auto ThreadPool::pending() const -> std::size_t
+{
+    std::unique_lock lock(mutex_);
+    return tasks_.size() + running_;
+}
+
+void ThreadPool::clear()
+{
+    std::unique_lock lock(mutex_);
+    tasks_.clear();
+    if (running_ == 0) {
+        idle_.notify_all();
+    }
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this]() { return tasks_.empty() and running_ == 0; });
+}
+
+void ThreadPool::run_()
+{
+    // Tasks shouldn't start their own threads for every pool thread
+    ParallelWorkerScope scope;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        taskReady_.wait(lock, [this]() { return stop_ or not tasks_.empty(); });
+        if (stop_) {
+            return;
+        }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        running_++;
+        lock.unlock();
+        try {
+            task();
+        } catch (const std::exception& e) {
+            Logger()->warn("Background task failed: {}", e.what());
+        } catch (...) {
+            Logger()->warn("Background task failed");
+        }
+        // Release the task's captures before reporting idle
+        task = nullptr;
+        lock.lock();
+        running_--;
+        if (tasks_.empty() and running_ == 0) {
+            idle_.notify_all();
+        }
+    }
+}
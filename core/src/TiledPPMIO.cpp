@@ -0,0 +1,508 @@
+#include "vc/core/io/TiledPPMIO.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "vc/core/types/Exceptions.hpp"
+#include "vc/core/util/Logging.hpp"
+
+using namespace volcart;
+using namespace volcart::io;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+// File identifier
+constexpr std::array<char, 8> MAGIC{'V', 'C', 'T', 'P', 'P', 'M', '\0', '\0'};
+// Current file format version
+constexpr std::uint32_t VERSION{1};
+// Number of elements in a mapping
+constexpr std::size_t MAPPING_ELEMS{6};
+
+// Header flags
+constexpr std::uint32_t FLAG_MASK{1U << 0};
+constexpr std::uint32_t FLAG_CELL_MAP{1U << 1};
+
+// Mapping element types
+constexpr std::uint32_t DTYPE_FLOAT64{0};
+constexpr std::uint32_t DTYPE_FLOAT32{1};
+
+// Fixed-size file header. Followed by the tile index and the tile data.
+struct Header {
+    std::array<char, 8> magic{MAGIC};
+    std::uint32_t version{VERSION};
+    std::uint32_t flags{0};
+    std::uint64_t height{0};
+    std::uint64_t width{0};
+    std::uint32_t tileSize{0};
+    std::uint32_t dtype{DTYPE_FLOAT64};
+    std::uint64_t numMappings{0};
+    std::uint64_t indexOffset{0};
+    std::uint64_t dataOffset{0};
+};
+static_assert(sizeof(Header) == 64, "Unexpected header padding");
+
+// Tile index entry: {offset, number of mappings}
+constexpr std::size_t INDEX_ENTRY_BYTES{2 * sizeof(std::uint64_t)};
+
+auto DivideRoundUp(std::size_t a, std::size_t b) -> std::size_t
+{
+    return (a + b - 1) / b;
+}
+
+auto MappingBytes(const TiledPPMOptions& opts) -> std::size_t
+{
+    return MAPPING_ELEMS * (opts.float32 ? sizeof(float) : sizeof(double));
+}
+
+// Tiles are stored as {mappings, cell map, mask}, padded so that the next
+// tile starts on an 8-byte boundary
+auto TileBytes(const cv::Rect& r, const TiledPPMOptions& opts) -> std::uint64_t
+{
+    const auto pixels = static_cast<std::uint64_t>(r.area());
+    auto bytes = pixels * MappingBytes(opts);
+    if (opts.cellMap) {
+        bytes += pixels * sizeof(std::int32_t);
+    }
+    if (opts.mask) {
+        bytes += pixels;
+    }
+    return DivideRoundUp(bytes, 8) * 8;
+}
+
+auto TileRect(
+    std::size_t tile,
+    std::size_t tileCols,
+    std::size_t tileSize,
+    std::size_t height,
+    std::size_t width) -> cv::Rect
+{
+    const auto y = (tile / tileCols) * tileSize;
+    const auto x = (tile % tileCols) * tileSize;
+    const auto h = std::min(tileSize, height - y);
+    const auto w = std::min(tileSize, width - x);
+    return {
+        static_cast<int>(x), static_cast<int>(y), static_cast<int>(w),
+        static_cast<int>(h)};
+}
+
+auto ReadHeader(std::istream& is) -> Header
+{
+    Header h;
+    is.read(reinterpret_cast<char*>(&h), sizeof(Header));
+    return h;
+}
+}  // namespace
+
+auto io::IsTiledPPM(const fs::path& path) -> bool
+{
+    std::ifstream ifs(path.string(), std::ios::binary);
+    if (not ifs.is_open()) {
+        return false;
+    }
+    const auto h = ::ReadHeader(ifs);
+    return not ifs.fail() and h.magic == ::MAGIC;
+}
+
+///// Reader /////
+TiledPPMReader::TiledPPMReader(const fs::path& path) : path_{path}
+{
+    // Make sure input file exists
+    if (not fs::exists(path_)) {
+        throw IOException("File does not exist: " + path_.string());
+    }
+    const auto fileSize = fs::file_size(path_);
+
+    // Prefer memory mapping, but fall back to a file stream
+    mmap_ = MemmapFile(path_);
+    if (not mmap_) {
+        ifs_.open(path_.string(), std::ios::binary);
+        if (not ifs_.is_open()) {
+            throw IOException("Failed to open file: " + path_.string());
+        }
+    }
+
+    // Read the header
+    if (fileSize < sizeof(Header)) {
+        throw IOException("Not a tiled PPM: " + path_.string());
+    }
+    Header header;
+    read_(0, sizeof(Header), &header);
+    if (header.magic != ::MAGIC) {
+        throw IOException("Not a tiled PPM: " + path_.string());
+    }
+    if (header.version != ::VERSION) {
+        throw IOException(
+            "Unsupported tiled PPM version " + std::to_string(header.version) +
+            ": " + path_.string());
+    }
+    if (header.dtype != ::DTYPE_FLOAT64 and header.dtype != ::DTYPE_FLOAT32) {
+        throw IOException("Unsupported mapping type: " + path_.string());
+    }
+    if (header.tileSize == 0) {
+        throw IOException("Invalid tile size: " + path_.string());
+    }
+    height_ = header.height;
+    width_ = header.width;
+    numMappings_ = header.numMappings;
+    opts_.tileSize = header.tileSize;
+    opts_.float32 = header.dtype == ::DTYPE_FLOAT32;
+    opts_.mask = (header.flags & ::FLAG_MASK) != 0;
+    opts_.cellMap = (header.flags & ::FLAG_CELL_MAP) != 0;
+    tileCols_ = ::DivideRoundUp(width_, opts_.tileSize);
+
+    // Read the tile index
+    const auto numTiles = ::DivideRoundUp(height_, opts_.tileSize) * tileCols_;
+    if (header.indexOffset + numTiles * ::INDEX_ENTRY_BYTES > fileSize) {
+        throw IOException("Truncated tile index: " + path_.string());
+    }
+    index_.resize(numTiles);
+    static_assert(sizeof(TileEntry) == ::INDEX_ENTRY_BYTES);
+    read_(header.indexOffset, numTiles * ::INDEX_ENTRY_BYTES, index_.data());
+
+    // Validate the tiles
+    for (std::size_t t = 0; t < numTiles; t++) {
+        const auto end = index_[t].offset + ::TileBytes(tileRect(t), opts_);
+        if (end > fileSize) {
+            throw IOException("Truncated tile data: " + path_.string());
+        }
+    }
+}
+
+auto TiledPPMReader::New(const fs::path& path) -> Pointer
+{
+    return std::make_shared<TiledPPMReader>(path);
+}
+
+auto TiledPPMReader::height() const -> std::size_t { return height_; }
+
+auto TiledPPMReader::width() const -> std::size_t { return width_; }
+
+auto TiledPPMReader::numMappings() const -> std::size_t
+{
+    return numMappings_;
+}
+
+auto TiledPPMReader::options() const -> TiledPPMOptions { return opts_; }
+
+auto TiledPPMReader::numTiles() const -> std::size_t { return index_.size(); }
+
+auto TiledPPMReader::tileRect(std::size_t tile) const -> cv::Rect
+{
+    return ::TileRect(tile, tileCols_, opts_.tileSize, height_, width_);
+}
+
+auto TiledPPMReader::tileMappings(std::size_t tile) const -> std::size_t
+{
+    return index_.at(tile).mappings;
+}
+
+auto TiledPPMReader::readTile(std::size_t tile) const -> PerPixelMap
+{
+    return readRegion(tileRect(tile));
+}
+
+auto TiledPPMReader::readRegion(const cv::Rect& roi) const -> PerPixelMap
+{
+    // Clip to the map
+    const cv::Rect bounds(
+        0, 0, static_cast<int>(width_), static_cast<int>(height_));
+    const auto r = roi & bounds;
+    if (r.empty()) {
+        throw std::out_of_range("Region does not overlap the PPM");
+    }
+
+    // Setup the output
+    PerPixelMap ppm(r.height, r.width);
+    cv::Mat mask;
+    if (opts_.mask) {
+        mask = cv::Mat::zeros(r.height, r.width, CV_8UC1);
+    }
+    cv::Mat cellMap;
+    if (opts_.cellMap) {
+        cellMap = cv::Mat(r.height, r.width, CV_32SC1, cv::Scalar::all(-1));
+    }
+
+    // Copy the overlapping tiles
+    const auto ts = static_cast<int>(opts_.tileSize);
+    for (auto ty = r.y / ts; ty <= (r.y + r.height - 1) / ts; ty++) {
+        for (auto tx = r.x / ts; tx <= (r.x + r.width - 1) / ts; tx++) {
+            const auto tile = static_cast<std::size_t>(ty) * tileCols_ + tx;
+            copy_tile_(tile, r, ppm, mask, cellMap);
+        }
+    }
+
+    ppm.setMask(mask);
+    ppm.setCellMap(cellMap);
+    return ppm;
+}
+
+void TiledPPMReader::read_(
+    std::uint64_t offset, std::size_t size, void* dst) const
+{
+    if (mmap_) {
+        std::memcpy(dst, static_cast<const char*>(mmap_.addr) + offset, size);
+        return;
+    }
+
+    std::unique_lock lock(mutex_);
+    ifs_.seekg(static_cast<std::streamoff>(offset));
+    ifs_.read(static_cast<char*>(dst), static_cast<std::streamsize>(size));
+    if (ifs_.fail()) {
+        ifs_.clear();
+        throw IOException("Failed to read tiled PPM: " + path_.string());
+    }
+}
+
+void TiledPPMReader::copy_tile_(
+    std::size_t tile,
+    const cv::Rect& roi,
+    PerPixelMap& ppm,
+    cv::Mat& mask,
+    cv::Mat& cellMap) const
+{
+    const auto rect = tileRect(tile);
+    const auto overlap = rect & roi;
+    const auto pixels = static_cast<std::uint64_t>(rect.area());
+    const auto cols = static_cast<std::size_t>(overlap.width);
+
+    // Byte offsets of each component within the tile
+    const auto mapStart = index_[tile].offset;
+    const auto cellMapStart = mapStart + pixels * ::MappingBytes(opts_);
+    auto maskStart = cellMapStart;
+    if (opts_.cellMap) {
+        maskStart += pixels * sizeof(std::int32_t);
+    }
+
+    // Copy each overlapping row
+    std::vector<double> f64;
+    std::vector<float> f32;
+    for (auto y = overlap.y; y < overlap.y + overlap.height; y++) {
+        // Pixel offset of the first overlapping pixel in the tile
+        const auto px = static_cast<std::uint64_t>(y - rect.y) * rect.width +
+                        (overlap.x - rect.x);
+        const auto dy = static_cast<std::size_t>(y - roi.y);
+        const auto dx = static_cast<std::size_t>(overlap.x - roi.x);
+
+        // Mappings
+        const auto rowOffset = mapStart + px * ::MappingBytes(opts_);
+        if (opts_.float32) {
+            f32.resize(cols * ::MAPPING_ELEMS);
+            read_(rowOffset, f32.size() * sizeof(float), f32.data());
+            for (std::size_t x = 0; x < cols; x++) {
+                const auto* m = &f32[x * ::MAPPING_ELEMS];
+                ppm(dy, dx + x) = {m[0], m[1], m[2], m[3], m[4], m[5]};
+            }
+        } else {
+            f64.resize(cols * ::MAPPING_ELEMS);
+            read_(rowOffset, f64.size() * sizeof(double), f64.data());
+            for (std::size_t x = 0; x < cols; x++) {
+                const auto* m = &f64[x * ::MAPPING_ELEMS];
+                ppm(dy, dx + x) = {m[0], m[1], m[2], m[3], m[4], m[5]};
+            }
+        }
+
+        // Cell map
+        if (opts_.cellMap) {
+            read_(
+                cellMapStart + px * sizeof(std::int32_t),
+                cols * sizeof(std::int32_t),
+                cellMap.ptr<std::int32_t>(static_cast<int>(dy)) + dx);
+        }
+
+        // Mask
+        if (opts_.mask) {
+            read_(
+                maskStart + px, cols,
+                mask.ptr<std::uint8_t>(static_cast<int>(dy)) + dx);
+        }
+    }
+}
+
+///// Writer /////
+TiledPPMWriter::TiledPPMWriter(
+    const fs::path& path,
+    std::size_t height,
+    std::size_t width,
+    TiledPPMOptions opts)
+    : path_{path}, height_{height}, width_{width}, opts_{opts}
+{
+    if (height_ == 0 or width_ == 0) {
+        throw IOException("Cannot write an empty PPM: " + path_.string());
+    }
+    if (opts_.tileSize == 0 or
+        opts_.tileSize > std::numeric_limits<std::uint32_t>::max()) {
+        throw IOException("Invalid tile size");
+    }
+
+    // Compute the tile layout
+    tileCols_ = ::DivideRoundUp(width_, opts_.tileSize);
+    const auto numTiles = ::DivideRoundUp(height_, opts_.tileSize) * tileCols_;
+    offsets_.resize(numTiles);
+    mappings_.resize(numTiles, 0);
+    std::uint64_t offset = sizeof(Header) + numTiles * ::INDEX_ENTRY_BYTES;
+    for (std::size_t t = 0; t < numTiles; t++) {
+        offsets_[t] = offset;
+        offset += ::TileBytes(tileRect(t), opts_);
+    }
+
+    // Open the file and extend it to its final size
+    ofs_.open(path_.string(), std::ios::binary | std::ios::trunc);
+    if (not ofs_.is_open()) {
+        throw IOException("Failed to open file for writing: " + path_.string());
+    }
+    ofs_.seekp(static_cast<std::streamoff>(offset - 1));
+    ofs_.put('\0');
+    if (ofs_.fail()) {
+        throw IOException("Failed to write file: " + path_.string());
+    }
+}
+
+TiledPPMWriter::~TiledPPMWriter()
+{
+    try {
+        close();
+    } catch (const std::exception& e) {
+        Logger()->error("Failed to close tiled PPM: {}", e.what());
+    }
+}
+
+auto TiledPPMWriter::numTiles() const -> std::size_t
+{
+    return offsets_.size();
+}
+
+auto TiledPPMWriter::tileRect(std::size_t tile) const -> cv::Rect
+{
+    return ::TileRect(tile, tileCols_, opts_.tileSize, height_, width_);
+}
+
+void TiledPPMWriter::writeTile(std::size_t tile, const PerPixelMap& ppm)
+{
+    // Safety checks
+    if (tile >= numTiles()) {
+        throw IOException("Tile index out of range: " + std::to_string(tile));
+    }
+    const auto rect = tileRect(tile);
+    if (ppm.height() != static_cast<std::size_t>(rect.height) or
+        ppm.width() != static_cast<std::size_t>(rect.width)) {
+        throw IOException("Tile has the wrong dimensions");
+    }
+    const auto& mask = ppm.mask();
+    if (not mask.empty() and
+        (mask.type() != CV_8UC1 or mask.size() != rect.size())) {
+        throw IOException("Tile has an invalid mask");
+    }
+    const auto& cellMap = ppm.cellMap();
+    if (not cellMap.empty() and
+        (cellMap.type() != CV_32SC1 or cellMap.size() != rect.size())) {
+        throw IOException("Tile has an invalid cell map");
+    }
+
+    // Serialize the tile
+    std::vector<char> buffer(::TileBytes(rect, opts_), 0);
+    auto* ptr = buffer.data();
+    for (std::size_t y = 0; y < ppm.height(); y++) {
+        for (std::size_t x = 0; x < ppm.width(); x++) {
+            const auto& m = ppm(y, x);
+            if (opts_.float32) {
+                const cv::Vec6f mf = m;
+                std::memcpy(ptr, mf.val, sizeof(mf.val));
+                ptr += sizeof(mf.val);
+            } else {
+                std::memcpy(ptr, m.val, sizeof(m.val));
+                ptr += sizeof(m.val);
+            }
+        }
+    }
+    const auto pixels = static_cast<std::size_t>(rect.area());
+    if (opts_.cellMap) {
+        cv::Mat dst(rect.height, rect.width, CV_32SC1, ptr);
+        if (cellMap.empty()) {
+            dst = cv::Scalar::all(-1);
+        } else {
+            cellMap.copyTo(dst);
+        }
+        ptr += pixels * sizeof(std::int32_t);
+    }
+    std::size_t count{pixels};
+    if (opts_.mask) {
+        cv::Mat dst(rect.height, rect.width, CV_8UC1, ptr);
+        if (mask.empty()) {
+            dst = cv::Scalar::all(255);
+        } else {
+            mask.copyTo(dst);
+            count = cv::countNonZero(dst);
+        }
+    }
+
+    // Write the tile
+    std::unique_lock lock(mutex_);
+    if (not ofs_.is_open()) {
+        throw IOException("Tiled PPM already closed: " + path_.string());
+    }
+    ofs_.seekp(static_cast<std::streamoff>(offsets_[tile]));
+    ofs_.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (ofs_.fail()) {
+        throw IOException("Failed to write tile: " + path_.string());
+    }
+    mappings_[tile] = count;
+}
+
+void TiledPPMWriter::close()
+{
+    std::unique_lock lock(mutex_);
+    if (not ofs_.is_open()) {
+        return;
+    }
+
+    // Header
+    Header header;
+    header.flags = (opts_.mask ? ::FLAG_MASK : 0U) |
+                   (opts_.cellMap ? ::FLAG_CELL_MAP : 0U);
+    header.height = height_;
+    header.width = width_;
+    header.tileSize = static_cast<std::uint32_t>(opts_.tileSize);
+    header.dtype = opts_.float32 ? ::DTYPE_FLOAT32 : ::DTYPE_FLOAT64;
+    header.numMappings = std::accumulate(
+        mappings_.begin(), mappings_.end(), std::uint64_t{0});
+    header.indexOffset = sizeof(Header);
+    header.dataOffset = header.indexOffset + numTiles() * ::INDEX_ENTRY_BYTES;
+
+    // Index
+    std::vector<std::uint64_t> index;
+    index.reserve(2 * numTiles());
+    for (std::size_t t = 0; t < numTiles(); t++) {
+        index.push_back(offsets_[t]);
+        index.push_back(mappings_[t]);
+    }
+
+    ofs_.seekp(0);
+    ofs_.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    ofs_.write(
+        reinterpret_cast<const char*>(index.data()),
+        static_cast<std::streamsize>(index.size() * sizeof(std::uint64_t)));
+    const auto failed = ofs_.fail();
+    ofs_.close();
+    if (failed) {
+        throw IOException("Failed to write tiled PPM: " + path_.string());
+    }
+}
+
+void io::WriteTiledPPM(
+    const fs::path& path, const PerPixelMap& ppm, TiledPPMOptions opts)
+{
+    opts.mask = not ppm.mask().empty();
+    opts.cellMap = not ppm.cellMap().empty();
+    TiledPPMWriter writer(path, ppm.height(), ppm.width(), opts);
+    for (std::size_t t = 0; t < writer.numTiles(); t++) {
+        const auto r = writer.tileRect(t);
+        writer.writeTile(
+            t, PerPixelMap::Crop(ppm, r.y, r.x, r.height, r.width));
+    }
+    writer.close();
+}
@@ -0,0 +1,161 @@
+#include "vc/core/types/TriangleMesh.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+using namespace volcart;
+
+TriangleMesh::TriangleMesh(
+    std::vector<Vertex> vertices, std::vector<Face> faces)
+    : vertices_{std::move(vertices)}, faces_{std::move(faces)}
+{
+}
+
+auto TriangleMesh::FromITKMesh(
+    const ITKMesh::Pointer& mesh, const UVMap::Pointer& uvMap) -> Pointer
+{
+    if (mesh.IsNull()) {
+        throw std::invalid_argument("Mesh is null");
+    }
+
+    auto result = New();
+    const auto numPts = mesh->GetNumberOfPoints();
+
+    // Vertices
+    result->vertices_.resize(numPts);
+    for (auto pt = mesh->GetPoints()->Begin(); pt != mesh->GetPoints()->End();
+         ++pt) {
+        const auto& p = pt.Value();
+        result->vertices_.at(pt.Index()) = {p[0], p[1], p[2]};
+    }
+
+    // Normals, if every vertex has one
+    const auto pointData = mesh->GetPointData();
+    if (pointData and pointData->Size() == numPts and numPts > 0) {
+        result->normals_.resize(numPts);
+        for (auto n = pointData->Begin(); n != pointData->End(); ++n) {
+            const auto& v = n.Value();
+            result->normals_.at(n.Index()) = {v[0], v[1], v[2]};
+        }
+    }
+
+    // UVs
+    if (uvMap) {
+        result->uvs_.resize(numPts);
+        for (std::size_t i = 0; i < numPts; i++) {
+            result->uvs_[i] = uvMap->get(i);
+        }
+    }
+
+    // Faces
+    result->faces_.reserve(mesh->GetNumberOfCells());
+    for (auto cell = mesh->GetCells()->Begin(); cell != mesh->GetCells()->End();
+         ++cell) {
+        const auto* c = cell.Value();
+        if (c->GetNumberOfPoints() != 3) {
+            throw std::invalid_argument("Mesh contains non-triangular faces");
+        }
+        const auto* ids = c->GetPointIds();
+        result->faces_.push_back({ids[0], ids[1], ids[2]});
+    }
+
+    return result;
+}
+
+auto TriangleMesh::toITKMesh() const -> ITKMesh::Pointer
+{
+    auto mesh = ITKMesh::New();
+
+    // Fill the point containers in bulk
+    auto points = ITKPointsContainer::New();
+    auto& pts = points->CastToSTLContainer();
+    pts.resize(vertices_.size());
+    for (std::size_t i = 0; i < vertices_.size(); i++) {
+        const auto& v = vertices_[i];
+        auto& p = pts[i];
+        p[0] = v[0];
+        p[1] = v[1];
+        p[2] = v[2];
+    }
+    mesh->SetPoints(points);
+
+    if (hasNormals()) {
+        auto pointData = ITKMesh::PointDataContainer::New();
+        auto& data = pointData->CastToSTLContainer();
+        data.resize(normals_.size());
+        for (std::size_t i = 0; i < normals_.size(); i++) {
+            const auto& n = normals_[i];
+            auto& d = data[i];
+            d[0] = n[0];
+            d[1] = n[1];
+            d[2] = n[2];
+        }
+        mesh->SetPointData(pointData);
+    }
+
+    // ITK stores each cell as a separate object
+    auto cells = ITKMesh::CellsContainer::New();
+    auto& cellPtrs = cells->CastToSTLContainer();
+    cellPtrs.resize(faces_.size());
+    ITKCell::CellAutoPointer cell;
+    for (std::size_t i = 0; i < faces_.size(); i++) {
+        const auto& f = faces_[i];
+        cell.TakeOwnership(new ITKTriangle);
+        cell->SetPointId(0, f[0]);
+        cell->SetPointId(1, f[1]);
+        cell->SetPointId(2, f[2]);
+        cellPtrs[i] = cell.ReleaseOwnership();
+    }
+    mesh->SetCells(cells);
+
+    return mesh;
+}
+
+auto TriangleMesh::numVertices() const -> std::size_t
+{
+    return vertices_.size();
+}
+
+auto TriangleMesh::numFaces() const -> std::size_t { return faces_.size(); }
+
+auto TriangleMesh::empty() const -> bool { return vertices_.empty(); }
+
+auto TriangleMesh::hasNormals() const -> bool
+{
+    return not vertices_.empty() and normals_.size() == vertices_.size();
+}
+
+auto TriangleMesh::hasUVs() const -> bool
+{
+    return not vertices_.empty() and uvs_.size() == vertices_.size();
+}
+
+void TriangleMesh::clear()
+{
+    vertices_.clear();
+    normals_.clear();
+    uvs_.clear();
+    faces_.clear();
+}
+
+auto TriangleMesh::vertices() -> std::vector<Vertex>& { return vertices_; }
+
+auto TriangleMesh::vertices() const -> const std::vector<Vertex>&
+{
+    return vertices_;
+}
+
+auto TriangleMesh::normals() -> std::vector<Normal>& { return normals_; }
+
+auto TriangleMesh::normals() const -> const std::vector<Normal>&
+{
+    return normals_;
+}
+
+auto TriangleMesh::uvs() -> std::vector<UV>& { return uvs_; }
+
+auto TriangleMesh::uvs() const -> const std::vector<UV>& { return uvs_; }
+
+auto TriangleMesh::faces() -> std::vector<Face>& { return faces_; }
+
+auto TriangleMesh::faces() const -> const std::vector<Face>& { return faces_; }
@@ -1,15 +1,29 @@
 #include "vc/core/types/Volume.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <opencv2/imgcodecs.hpp>
 
+#include "vc/core/io/ChunkIO.hpp"
 #include "vc/core/io/TIFFIO.hpp"
+#include "vc/core/util/IntegerMath.hpp"
 #include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
 
 namespace fs = volcart::filesystem;
 namespace tio = volcart::tiffio;
+namespace cio = volcart::chunkio;
 
 using namespace volcart;
 
@@ -31,6 +45,228 @@ auto OnEvict(int& key, Volume::SliceItem& value) -> bool
     }
     return true;
 }
+
+// Number of bytes held by a cached slice
+auto SliceWeight(const Volume::SliceItem& value) -> std::size_t
+{
+    return value.first.total() * value.first.elemSize();
+}
+
+// Number of bytes held by a cached chunk
+auto ChunkWeight(const cv::Mat& value) -> std::size_t
+{
+    return value.total() * value.elemSize();
+}
+
+auto FormatToString(const Volume::StorageFormat f) -> std::string
+{
+    switch (f) {
+        case Volume::StorageFormat::Slices:
+            return "slices";
+        case Volume::StorageFormat::Chunks:
+            return "chunks";
+    }
+    throw std::invalid_argument("Unknown storage format");
+}
+
+auto FormatFromString(const std::string& s) -> Volume::StorageFormat
+{
+    if (s == "slices") {
+        return Volume::StorageFormat::Slices;
+    }
+    if (s == "chunks") {
+        return Volume::StorageFormat::Chunks;
+    }
+    throw std::runtime_error("Unknown volume storage format: " + s);
+}
+
+// Number of net reads in one direction before reads are treated as sequential
+constexpr int SEQUENTIAL_READS{2};
+
+// Limit on the net read direction, so that a reversal is detected quickly
+constexpr int MAX_READ_TREND{4};
+
+// Lower an atomic to v if v is smaller. Most calls only load.
+void AtomicMin(std::atomic<int>& a, const int v)
+{
+    auto cur = a.load(std::memory_order_relaxed);
+    while (v < cur and
+           not a.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+    }
+}
+
+// Raise an atomic to v if v is larger. Most calls only load.
+void AtomicMax(std::atomic<int>& a, const int v)
+{
+    auto cur = a.load(std::memory_order_relaxed);
+    while (v > cur and
+           not a.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+    }
+}
+
+// Directory which holds resolution level n of a Volume
+auto LevelPath(const fs::path& volumePath, const int n) -> fs::path
+{
+    return volumePath / "levels" / std::to_string(n);
+}
+
+// Downsample one or two slices by averaging each 2x2x2 block of voxels. On
+// the upper boundaries of the source, the missing voxels are replaced by the
+// last row or column, so those blocks average only the voxels inside it.
+// Empty slices are treated as zeros, as in Volume::intensityAt().
+auto DownsampleSlices(
+    const std::array<cv::Mat, 2>& src,
+    const int depth,
+    const int width,
+    const int height) -> cv::Mat
+{
+    const auto count = static_cast<std::uint32_t>(4 * depth);
+    cv::Mat dst((height + 1) / 2, (width + 1) / 2, CV_16UC1);
+    for (int y = 0; y < dst.rows; y++) {
+        const auto y0 = 2 * y;
+        const auto y1 = std::min(y0 + 1, height - 1);
+        auto* out = dst.ptr<std::uint16_t>(y);
+        for (int x = 0; x < dst.cols; x++) {
+            const auto x0 = 2 * x;
+            const auto x1 = std::min(x0 + 1, width - 1);
+            std::uint32_t sum{0};
+            for (int z = 0; z < depth; z++) {
+                if (src[z].empty()) {
+                    continue;
+                }
+                const auto* r0 = src[z].ptr<std::uint16_t>(y0);
+                const auto* r1 = src[z].ptr<std::uint16_t>(y1);
+                sum += r0[x0] + r0[x1] + r1[x0] + r1[x1];
+            }
+            out[x] = static_cast<std::uint16_t>((sum + count / 2) / count);
+        }
+    }
+    return dst;
+}
+
+// Number of positions sampled between releases of the blocks held by a
+// BatchVoxelReader
+constexpr std::size_t POINTS_PER_GROUP{4096};
+
+// Limit on the bytes of blocks held by a BatchVoxelReader. Held blocks can't
+// be evicted, so this bounds how far a batch can push the cache past its
+// capacity.
+constexpr std::size_t MAX_HELD_BYTES{64 << 20};
+
+// Reads the voxels for a batch of samples. Holds a reference to the slices or
+// chunks it has read from, so each is fetched from the Volume once per group
+// of samples instead of once per voxel. Call release() between groups.
+class BatchVoxelReader
+{
+public:
+    explicit BatchVoxelReader(const Volume& vol)
+        : vol_{vol}
+        , chunked_{vol.storageFormat() == Volume::StorageFormat::Chunks}
+        , chunkSize_{vol.chunkSize()}
+        , width_{vol.sliceWidth()}
+        , height_{vol.sliceHeight()}
+        , slices_{vol.numSlices()}
+    {
+        // A trilinear sample reads from up to 2 slices or 8 chunks
+        const std::size_t blockVoxels =
+            chunked_ ? std::size_t(chunkSize_) * chunkSize_ * chunkSize_
+                     : std::size_t(width_) * height_;
+        const std::size_t minBlocks = chunked_ ? 8 : 2;
+        const auto blockBytes = std::max<std::size_t>(2 * blockVoxels, 1);
+        maxBlocks_ = std::max(minBlocks, MAX_HELD_BYTES / blockBytes);
+    }
+
+    // Same as Volume::intensityAt()
+    auto operator()(const int x, const int y, const int z) -> std::uint16_t
+    {
+        // clang-format off
+        if (x < 0 || x >= width_ ||
+            y < 0 || y >= height_ ||
+            z < 0 || z >= slices_) {
+            return 0;
+        }
+        // clang-format on
+        if (chunked_) {
+            const auto& chunk = block_(vol_.chunkIndexAt(x, y, z));
+            return chunk.at<std::uint16_t>(
+                z % chunkSize_, y % chunkSize_, x % chunkSize_);
+        }
+        const auto& slice = block_({0, 0, z});
+        if (slice.empty()) {
+            return 0;
+        }
+        return slice.at<std::uint16_t>(y, x);
+    }
+
+    // Drop the references to all held blocks, so the cache can evict them
+    void release()
+    {
+        blocks_.clear();
+        last_ = nullptr;
+    }
+
+private:
+    // Get a chunk by index or a slice by {0, 0, z}
+    auto block_(const cv::Vec3i& key) -> const cv::Mat&
+    {
+        // Consecutive reads usually come from the same block
+        if (last_ != nullptr and lastKey_ == key) {
+            return *last_;
+        }
+        auto it = blocks_.find(key);
+        if (it == blocks_.end()) {
+            if (blocks_.size() >= maxBlocks_) {
+                release();
+            }
+            auto block =
+                chunked_ ? vol_.getChunkData(key) : vol_.getSliceData(key[2]);
+            it = blocks_.emplace(key, std::move(block)).first;
+        }
+        lastKey_ = key;
+        last_ = &it->second;
+        return *last_;
+    }
+
+    const Volume& vol_;
+    bool chunked_;
+    int chunkSize_;
+    int width_;
+    int height_;
+    int slices_;
+    std::size_t maxBlocks_{0};
+    std::unordered_map<cv::Vec3i, cv::Mat, Vec3iHash> blocks_;
+    cv::Vec3i lastKey_;
+    const cv::Mat* last_{nullptr};
+};
+
+// Trilinear Interpolation
+// From: https://en.wikipedia.org/wiki/Trilinear_interpolation
+template <class VoxelFn>
+auto Trilinear(VoxelFn& voxel, const double x, const double y, const double z)
+    -> std::uint16_t
+{
+    double intPart;
+    const double dx = std::modf(x, &intPart);
+    const auto x0 = static_cast<int>(intPart);
+    const int x1 = x0 + 1;
+    const double dy = std::modf(y, &intPart);
+    const auto y0 = static_cast<int>(intPart);
+    const int y1 = y0 + 1;
+    const double dz = std::modf(z, &intPart);
+    const auto z0 = static_cast<int>(intPart);
+    const int z1 = z0 + 1;
+
+    const auto c00 = voxel(x0, y0, z0) * (1 - dx) + voxel(x1, y0, z0) * dx;
+    const auto c10 = voxel(x0, y1, z0) * (1 - dx) + voxel(x1, y1, z0) * dx;
+    const auto c01 = voxel(x0, y0, z1) * (1 - dx) + voxel(x1, y0, z1) * dx;
+    const auto c11 = voxel(x0, y1, z1) * (1 - dx) + voxel(x1, y1, z1) * dx;
+
+    const auto c0 = c00 * (1 - dy) + c10 * dy;
+    const auto c1 = c01 * (1 - dy) + c11 * dy;
+
+    const auto c = c0 * (1 - dz) + c1 * dz;
+    return static_cast<std::uint16_t>(cvRound(c));
+}
 }  // namespace
 
 // Load a Volume from disk
@@ -46,6 +282,32 @@ Volume::Volume(fs::path path) : DiskBasedObjectBaseClass(std::move(path))
     numSliceCharacters_ = static_cast<int>(std::to_string(slices_).size());
     sliceMutexes_ = std::vector<std::mutex>(slices_);
     cache_->onEvict(OnEvict);
+
+    // Optional storage layout keys
+    if (metadata_.hasKey("format")) {
+        format_ = FormatFromString(metadata_.get<std::string>("format").value());
+    }
+    if (metadata_.hasKey("chunksize")) {
+        chunkSize_ = metadata_.get<int>("chunksize").value();
+    }
+    if (metadata_.hasKey("compression")) {
+        // Unknown codecs only affect new slices, so don't refuse to open
+        const auto name = metadata_.get<std::string>("compression").value();
+        try {
+            compression_ = tio::CompressionFromName(name);
+        } catch (const std::invalid_argument&) {
+            Logger()->warn(
+                "Volume {} has unknown slice compression '{}'. Using lzw.",
+                id(), name);
+            compression_ = tio::Compression::LZW;
+        }
+    }
+    if (metadata_.hasKey("predictor")) {
+        predictor_ = metadata_.get<bool>("predictor").value();
+    }
+    if (metadata_.hasKey("levels")) {
+        numLevels_ = std::max(metadata_.get<int>("levels").value(), 1);
+    }
 }
 
 // Set up a Volume from a folder of slices
@@ -108,6 +370,8 @@ void Volume::setSliceHeight(const int h)
 
 void Volume::setNumberOfSlices(const std::size_t numSlices)
 {
+    cancelPrefetch();
+    waitForPrefetch();
     slices_ = static_cast<int>(numSlices);
     numSliceCharacters_ = static_cast<int>(std::to_string(numSlices).size());
     metadata_.set("slices", numSlices);
@@ -140,6 +404,30 @@ auto Volume::isInBounds(const cv::Vec3d& v) const -> bool
 
 void Volume::setMemoryMapSlices(const bool b) { memmap_ = b; }
 
+void Volume::setMemoryMapAdvice(const MemoryAdvice advice)
+{
+    memmapAdvice_ = advice;
+}
+
+void Volume::resetMemoryMapAdvice() { memmapAdvice_.reset(); }
+
+auto Volume::memoryMapAdvice() const -> std::optional<MemoryAdvice>
+{
+    return memmapAdvice_;
+}
+
+auto Volume::getLastMemoryMapAdvice() const -> MemoryAdvice
+{
+    return memmapLastAdvice_;
+}
+
+auto Volume::getMemoryMapHits() const -> std::size_t { return memmapHits_; }
+
+auto Volume::getMemoryMapMisses() const -> std::size_t
+{
+    return memmapMisses_;
+}
+
 auto Volume::getSlicePath(const int index) const -> fs::path
 {
     std::stringstream ss;
@@ -148,9 +436,88 @@ auto Volume::getSlicePath(const int index) const -> fs::path
     return path_ / ss.str();
 }
 
+auto Volume::storageFormat() const -> StorageFormat { return format_; }
+
+void Volume::setStorageFormat(const StorageFormat f)
+{
+    cancelPrefetch();
+    waitForPrefetch();
+    format_ = f;
+    metadata_.set("format", FormatToString(f));
+    if (f == StorageFormat::Chunks) {
+        metadata_.set("chunksize", chunkSize_);
+    }
+}
+
+auto Volume::chunkSize() const -> int { return chunkSize_; }
+
+void Volume::setChunkSize(const int s)
+{
+    if (s <= 0) {
+        throw std::invalid_argument("Chunk size must be > 0");
+    }
+    cancelPrefetch();
+    waitForPrefetch();
+    std::unique_lock lock(chunkCacheMutex_);
+    chunkSize_ = s;
+    metadata_.set("chunksize", s);
+    chunkCache_->purge();
+}
+
+auto Volume::chunkGridExtents() const -> cv::Vec3i
+{
+    return {
+        (width_ + chunkSize_ - 1) / chunkSize_,
+        (height_ + chunkSize_ - 1) / chunkSize_,
+        (slices_ + chunkSize_ - 1) / chunkSize_};
+}
+
+auto Volume::chunkIndexAt(const int x, const int y, const int z) const
+    -> ChunkIndex
+{
+    return {
+        FloorDiv(x, chunkSize_), FloorDiv(y, chunkSize_),
+        FloorDiv(z, chunkSize_)};
+}
+
+auto Volume::getChunkPath(const ChunkIndex& index) const -> fs::path
+{
+    return path_ / "chunks" / std::to_string(index[2]) /
+           std::to_string(index[1]) / (std::to_string(index[0]) + ".chunk");
+}
+
+auto Volume::getChunkData(const ChunkIndex& index) const -> cv::Mat
+{
+    if (cacheSlices_) {
+        note_read_(index[2]);
+        note_chunk_read_(index);
+        return cache_chunk_(index);
+    }
+    return load_chunk_(index);
+}
+
+void Volume::setChunkData(const ChunkIndex& index, const cv::Mat& chunk) const
+{
+    if (chunk.dims != 3 or chunk.size[0] != chunkSize_ or
+        chunk.size[1] != chunkSize_ or chunk.size[2] != chunkSize_) {
+        throw std::invalid_argument("Chunk does not match volume chunk size");
+    }
+    if (chunk.type() != CV_16UC1) {
+        throw std::invalid_argument("Volume chunks must be CV_16UC1");
+    }
+    const auto chunkPath = getChunkPath(index);
+    fs::create_directories(chunkPath.parent_path());
+    cio::WriteChunk(chunkPath, chunk);
+}
+
 auto Volume::getSliceData(const int index) const -> cv::Mat
 {
+    // Chunked slices are only cached as chunks
+    if (format_ == StorageFormat::Chunks) {
+        return assemble_slice_(index);
+    }
     if (cacheSlices_) {
+        note_read_(index);
         return cache_slice_(index);
     }
     // Never memory map if caching is disabled. This is mostly because there's
@@ -166,12 +533,52 @@ auto Volume::getSliceDataCopy(const int index) const -> cv::Mat
 void Volume::setSliceData(
     const int index, const cv::Mat& slice, const bool compress) const
 {
+    // Write a temporary file and move it over the slice, so that the slice is
+    // never partially written and mapped copies of the old slice stay valid
     const auto slicePath = getSlicePath(index);
-    tio::WriteTIFF(
-        slicePath.string(), slice,
-        compress ? tiffio::Compression::LZW : tiffio::Compression::NONE);
+    auto tmpPath = slicePath;
+    tmpPath += ".tmp";
+    try {
+        if (not compress) {
+            tio::WriteTIFF(tmpPath, slice, tio::Compression::NONE);
+        } else {
+            auto predictor = tio::Predictor::NONE;
+            if (predictor_) {
+                const auto isFloat =
+                    slice.depth() == CV_32F or slice.depth() == CV_64F;
+                predictor = isFloat ? tio::Predictor::FLOATINGPOINT
+                                    : tio::Predictor::HORIZONTAL;
+            }
+            tio::WriteTIFF(tmpPath, slice, compression_, 0, predictor);
+        }
+        fs::rename(tmpPath, slicePath);
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(tmpPath, ec);
+        throw;
+    }
+}
+
+void Volume::setSliceCompression(const tio::Compression c, const bool predictor)
+{
+    const auto name = tio::CompressionName(c);
+    if (not tio::IsCompressionSupported(c)) {
+        throw std::invalid_argument(
+            "Slice compression not supported by libtiff: " + name);
+    }
+    compression_ = c;
+    predictor_ = predictor;
+    metadata_.set("compression", name);
+    metadata_.set("predictor", predictor);
 }
 
+auto Volume::sliceCompression() const -> tio::Compression
+{
+    return compression_;
+}
+
+auto Volume::slicePredictor() const -> bool { return predictor_; }
+
 auto Volume::intensityAt(const int x, const int y, const int z) const
     -> std::uint16_t
 {
@@ -182,6 +589,11 @@ auto Volume::intensityAt(const int x, const int y, const int z) const
         return 0;
     }
     // clang-format on
+    if (format_ == StorageFormat::Chunks) {
+        const auto chunk = getChunkData(chunkIndexAt(x, y, z));
+        return chunk.at<std::uint16_t>(
+            z % chunkSize_, y % chunkSize_, x % chunkSize_);
+    }
     return getSliceData(z).at<std::uint16_t>(y, x);
 }
 
@@ -190,46 +602,74 @@ auto Volume::intensityAt(const cv::Vec3d& v) const -> std::uint16_t
     return intensityAt(static_cast<int>(v[0]), static_cast<int>(v[1]), static_cast<int>(v[2]));
 }
 
-// Trilinear Interpolation
-// From: https://en.wikipedia.org/wiki/Trilinear_interpolation
 auto Volume::interpolateAt(const double x, const double y, const double z) const
     -> std::uint16_t
 {
     // insert safety net
-    if (!isInBounds(x, y, z)) {
+    if (not isInBounds(x, y, z)) {
         return 0;
     }
+    auto voxel = [this](const int vx, const int vy, const int vz) {
+        return intensityAt(vx, vy, vz);
+    };
+    return ::Trilinear(voxel, x, y, z);
+}
 
-    double intPart;
-    const double dx = std::modf(x, &intPart);
-    const auto x0 = static_cast<int>(intPart);
-    const int x1 = x0 + 1;
-    const double dy = std::modf(y, &intPart);
-    const auto y0 = static_cast<int>(intPart);
-    const int y1 = y0 + 1;
-    const double dz = std::modf(z, &intPart);
-    const auto z0 = static_cast<int>(intPart);
-    const int z1 = z0 + 1;
-
-    const auto c00 =
-        intensityAt(x0, y0, z0) * (1 - dx) + intensityAt(x1, y0, z0) * dx;
-    const auto c10 =
-        intensityAt(x0, y1, z0) * (1 - dx) + intensityAt(x1, y0, z0) * dx;
-    const auto c01 =
-        intensityAt(x0, y0, z1) * (1 - dx) + intensityAt(x1, y0, z1) * dx;
-    const auto c11 =
-        intensityAt(x0, y1, z1) * (1 - dx) + intensityAt(x1, y1, z1) * dx;
+auto Volume::interpolateAt(const cv::Vec3d& v) const -> std::uint16_t
+{
+    return interpolateAt(v[0], v[1], v[2]);
+}
 
-    const auto c0 = c00 * (1 - dy) + c10 * dy;
-    const auto c1 = c01 * (1 - dy) + c11 * dy;
+void Volume::interpolateAt(
+    const cv::Vec3d* pts,
+    const std::size_t n,
+    std::uint16_t* out,
+    const int lvl) const
+{
+    if (lvl == 0) {
+        ::BatchVoxelReader voxel(*this);
+        for (std::size_t i = 0; i < n; i++) {
+            if (i % ::POINTS_PER_GROUP == 0) {
+                voxel.release();
+            }
+            const auto& [x, y, z] = pts[i].val;
+            // insert safety net
+            out[i] = isInBounds(x, y, z) ? ::Trilinear(voxel, x, y, z) : 0;
+        }
+        return;
+    }
 
-    const auto c = c0 * (1 - dz) + c1 * dz;
-    return static_cast<std::uint16_t>(cvRound(c));
+    // Map full-resolution positions to level positions. Positions between
+    // the edge of the Volume and the outermost level voxel centers are
+    // clamped to those centers.
+    const auto coarse = level(lvl);
+    const auto scale = static_cast<double>(1 << lvl);
+    const auto offset = (scale - 1) / 2;
+    const cv::Vec3d last{
+        coarse->width_ - 1.0, coarse->height_ - 1.0, coarse->slices_ - 1.0};
+    ::BatchVoxelReader voxel(*coarse);
+    for (std::size_t i = 0; i < n; i++) {
+        if (i % ::POINTS_PER_GROUP == 0) {
+            voxel.release();
+        }
+        if (not isInBounds(pts[i])) {
+            out[i] = 0;
+            continue;
+        }
+        cv::Vec3d q;
+        for (int a = 0; a < 3; a++) {
+            q[a] = std::clamp((pts[i][a] - offset) / scale, 0.0, last[a]);
+        }
+        out[i] = ::Trilinear(voxel, q[0], q[1], q[2]);
+    }
 }
 
-auto Volume::interpolateAt(const cv::Vec3d& v) const -> std::uint16_t
+auto Volume::interpolateAt(const std::vector<cv::Vec3d>& pts, const int lvl)
+    const -> std::vector<std::uint16_t>
 {
-    return interpolateAt(v[0], v[1], v[2]);
+    std::vector<std::uint16_t> values(pts.size());
+    interpolateAt(pts.data(), pts.size(), values.data(), lvl);
+    return values;
 }
 
 auto Volume::reslice(
@@ -237,50 +677,271 @@ auto Volume::reslice(
     const cv::Vec3d& xvec,
     const cv::Vec3d& yvec,
     const int width,
-    const int height) const -> Reslice
+    const int height,
+    const int lvl) const -> Reslice
 {
     auto xnorm = cv::normalize(xvec);
     auto ynorm = cv::normalize(yvec);
     auto origin = center - ((width / 2) * xnorm + (height / 2) * ynorm);
 
-    cv::Mat m(height, width, CV_16UC1);
+    std::vector<cv::Vec3d> pts;
+    pts.reserve(static_cast<std::size_t>(width) * height);
     for (int h = 0; h < height; ++h) {
         for (int w = 0; w < width; ++w) {
-            m.at<std::uint16_t>(h, w) =
-                interpolateAt(origin + (h * ynorm) + (w * xnorm));
+            pts.emplace_back(origin + (h * ynorm) + (w * xnorm));
         }
     }
 
+    cv::Mat m(height, width, CV_16UC1);
+    interpolateAt(pts.data(), pts.size(), m.ptr<std::uint16_t>(), lvl);
+
     return {m, origin, xnorm, ynorm};
 }
+
+auto Volume::numLevels() const -> int { return numLevels_; }
+
+auto Volume::level(const int n) const -> Pointer
+{
+    if (n < 0 or n >= numLevels_) {
+        throw std::out_of_range(
+            "Volume level " + std::to_string(n) + " out of range");
+    }
+    if (n == 0) {
+        return std::const_pointer_cast<Volume>(shared_from_this());
+    }
+
+    std::unique_lock lock(levelsMutex_);
+    levels_.resize(numLevels_ - 1);
+    auto& lvl = levels_[n - 1];
+    if (not lvl) {
+        lvl = Volume::New(::LevelPath(path_, n));
+        if (cacheMemory_) {
+            lvl->setCacheMemoryInBytes(cache_memory_share_(n));
+        }
+    }
+    return lvl;
+}
+
+void Volume::buildLevels(
+    const int numLevels, const std::optional<std::uint32_t> maxThreads)
+{
+    if (numLevels < 1) {
+        throw std::invalid_argument("Number of levels must be >= 1");
+    }
+
+    // Loaded levels read from the directories which are about to be replaced
+    std::unique_lock lock(levelsMutex_);
+    for (const auto& lvl : levels_) {
+        if (lvl and lvl.use_count() > 1) {
+            throw std::runtime_error(
+                "Cannot rebuild volume levels while they are in use");
+        }
+    }
+    levels_.clear();
+    numLevels_ = 1;
+    fs::remove_all(path_ / "levels");
+
+    // Each level is downsampled from the one before it
+    const Volume* src = this;
+    for (int n = 1; n < numLevels; n++) {
+        Logger()->debug("Building volume level {}", n);
+        levels_.emplace_back(build_level_(*src, n, maxThreads));
+        src = levels_.back().get();
+    }
+
+    numLevels_ = numLevels;
+    metadata_.set("levels", numLevels);
+    saveMetadata();
+    apply_cache_memory_();
+}
+
+auto Volume::build_level_(
+    const Volume& src,
+    const int n,
+    const std::optional<std::uint32_t> maxThreads) const -> Pointer
+{
+    const auto levelPath = ::LevelPath(path_, n);
+    fs::create_directories(levelPath);
+    const auto suffix = std::to_string(n);
+    auto dst = Volume::New(
+        levelPath, id() + "_level" + suffix,
+        name() + " (level " + suffix + ")");
+    dst->setSliceWidth((src.width_ + 1) / 2);
+    dst->setSliceHeight((src.height_ + 1) / 2);
+    dst->setNumberOfSlices((src.slices_ + 1) / 2);
+    dst->setVoxelSize(src.voxelSize() * 2);
+    dst->setMin(min());
+    dst->setMax(max());
+    dst->setChunkSize(chunkSize_);
+    dst->setStorageFormat(StorageFormat::Chunks);
+    dst->saveMetadata();
+
+    // Build one layer of chunks at a time
+    const auto numThreads = NumThreads(maxThreads);
+    const auto grid = dst->chunkGridExtents();
+    const std::array<int, 3> extents{chunkSize_, chunkSize_, chunkSize_};
+    std::vector<cv::Mat> layer;
+    for (int cz = 0; cz < grid[2]; cz++) {
+        // Downsample the slices of the layer
+        const auto z0 = cz * chunkSize_;
+        const auto depth = std::min(chunkSize_, dst->slices_ - z0);
+        layer.assign(depth, cv::Mat());
+        ParallelFor(
+            layer.size(), 1, numThreads,
+            [&](std::size_t begin, std::size_t end) {
+                for (auto i = begin; i < end; i++) {
+                    const auto z = 2 * (z0 + static_cast<int>(i));
+                    const auto d = std::min(2, src.slices_ - z);
+                    std::array<cv::Mat, 2> pair;
+                    for (int j = 0; j < d; j++) {
+                        pair[j] = src.getSliceData(z + j);
+                    }
+                    layer[i] = ::DownsampleSlices(
+                        pair, d, src.width_, src.height_);
+                }
+            });
+
+        // Create the directories up front so that the chunk writers don't
+        // race to create them
+        for (int cy = 0; cy < grid[1]; cy++) {
+            fs::create_directories(
+                dst->getChunkPath({0, cy, cz}).parent_path());
+        }
+
+        // Split into chunks
+        const auto numChunks = static_cast<std::size_t>(grid[0]) * grid[1];
+        ParallelFor(
+            numChunks, 1, numThreads, [&](std::size_t begin, std::size_t end) {
+                for (auto c = begin; c < end; c++) {
+                    const auto cx = static_cast<int>(c % grid[0]);
+                    const auto cy = static_cast<int>(c / grid[0]);
+                    const auto x0 = cx * chunkSize_;
+                    const auto y0 = cy * chunkSize_;
+                    const auto w = std::min(chunkSize_, dst->width_ - x0);
+                    const auto h = std::min(chunkSize_, dst->height_ - y0);
+                    cv::Mat chunk = cv::Mat::zeros(3, extents.data(), CV_16UC1);
+                    for (int z = 0; z < depth; z++) {
+                        for (int y = 0; y < h; y++) {
+                            const auto* row =
+                                layer[z].ptr<std::uint16_t>(y0 + y) + x0;
+                            std::copy(
+                                row, row + w, chunk.ptr<std::uint16_t>(z, y));
+                        }
+                    }
+                    dst->setChunkData({cx, cy, cz}, chunk);
+                }
+            });
+    }
+    return dst;
+}
 void Volume::setCacheSlices(const bool b) { cacheSlices_ = b; }
 
 void Volume::setCache(SliceCache::Pointer c) const
 {
+    cancelPrefetch();
+    waitForPrefetch();
     std::unique_lock lock(cacheMutex_);
+    cacheInBytes_ = false;
     cache_ = std::move(c);
     cache_->onEvict(OnEvict);
 }
 
 void Volume::setCacheCapacity(const std::size_t newCacheCapacity) const
 {
+    {
+        std::unique_lock lock(levelsMutex_);
+        cacheMemory_.reset();
+    }
     std::unique_lock lock(cacheMutex_);
+    cacheInBytes_ = false;
+    cache_->resetWeigher();
     cache_->setCapacity(newCacheCapacity);
 }
 
 void Volume::setCacheMemoryInBytes(const std::size_t nbytes) const
 {
-    // x2 because pixels are 16 bits normally. Not a great solution.
-    setCacheCapacity(nbytes / (sliceWidth() * sliceHeight() * 2));
+    std::unique_lock lock(levelsMutex_);
+    cacheMemory_ = nbytes;
+    apply_cache_memory_();
+}
+
+auto Volume::cache_memory_share_(const int n) const -> std::size_t
+{
+    // A region covers the same fraction of every level, so levels are given
+    // shares in proportion to their numbers of voxels
+    std::vector<double> voxels;
+    auto w = width_;
+    auto h = height_;
+    auto d = slices_;
+    double total{0};
+    for (int i = 0; i < numLevels_; i++) {
+        voxels.push_back(static_cast<double>(w) * h * d);
+        total += voxels.back();
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        d = (d + 1) / 2;
+    }
+    const auto share = total > 0 ? voxels[n] / total : 1.0;
+    const auto nbytes = static_cast<double>(cacheMemory_.value());
+    return std::max<std::size_t>(1, static_cast<std::size_t>(share * nbytes));
+}
+
+void Volume::apply_cache_memory_() const
+{
+    if (not cacheMemory_) {
+        return;
+    }
+    set_cache_memory_(cache_memory_share_(0));
+    for (std::size_t i = 0; i < levels_.size(); i++) {
+        if (levels_[i]) {
+            const auto n = static_cast<int>(i) + 1;
+            levels_[i]->setCacheMemoryInBytes(cache_memory_share_(n));
+        }
+    }
+}
+
+void Volume::set_cache_memory_(const std::size_t nbytes) const
+{
+    // Only one of the caches is used for a given storage format, so each gets
+    // the full budget
+    {
+        std::unique_lock lock(cacheMutex_);
+        cacheInBytes_ = true;
+        cache_->setWeigher(SliceWeight);
+        cache_->setCapacity(nbytes);
+    }
+    std::unique_lock lock(chunkCacheMutex_);
+    chunkCacheInBytes_ = true;
+    chunkCache_->setWeigher(ChunkWeight);
+    chunkCache_->setCapacity(nbytes);
 }
 
 auto Volume::getCacheCapacity() const -> std::size_t
 {
+    if (format_ == StorageFormat::Chunks) {
+        return getChunkCacheCapacity();
+    }
     std::shared_lock lock(cacheMutex_);
     return cache_->capacity();
 }
 
-auto Volume::getCacheSize() const -> std::size_t { return cache_->size(); }
+auto Volume::getCacheSize() const -> std::size_t
+{
+    if (format_ == StorageFormat::Chunks) {
+        return getChunkCacheSize();
+    }
+    return cache_->size();
+}
+
+auto Volume::getCacheMemoryUsage() const -> std::size_t
+{
+    if (format_ == StorageFormat::Chunks) {
+        std::shared_lock lock(chunkCacheMutex_);
+        return chunkCache_->weight();
+    }
+    std::shared_lock lock(cacheMutex_);
+    return cache_->weight();
+}
 
 auto Volume::load_slice_(int index, mmap_info* mmap_info) const -> cv::Mat
 {
@@ -297,28 +958,22 @@ auto Volume::load_slice_(int index, mmap_info* mmap_info) const -> cv::Mat
 
 auto Volume::cache_slice_(const int index) const -> cv::Mat
 {
-    // Check if the slice is in the cache.
-    {
-        std::shared_lock lock(cacheMutex_);
-        if (cache_->contains(index)) {
-            return cache_->get(index).first;
-        }
+    // Check if the slice is in the cache. The cache is thread-safe, so hits
+    // from different threads don't serialize on a Volume lock.
+    if (auto item = cache_->tryGet(index)) {
+        return item->first;
     }
 
     {
         // If the slice is not in the cache, get exclusive access to this
         // slice's mutex. This slice can't be set until we're done.
-        // TODO: Is this faster than just getting an unique cache lock?
         auto& mutex = sliceMutexes_[index];
         std::unique_lock lockSlice(mutex);
 
         // Check again to ensure the slice has not been added to the cache while
         // waiting for the lock.
-        {
-            std::shared_lock lockCache(cacheMutex_);
-            if (cache_->contains(index)) {
-                return cache_->get(index).first;
-            }
+        if (auto item = cache_->tryGet(index)) {
+            return item->first;
         }
 
         // Load the slice and put it in the cache
@@ -328,18 +983,393 @@ auto Volume::cache_slice_(const int index) const -> cv::Mat
         if (memmap_) {
             mmap_info i;
             slice = load_slice_(index, &i);
+            if (i) {
+                memmapHits_++;
+                const auto advice = memory_advice_(index);
+                if (advice != MemoryAdvice::Normal) {
+                    AdviseMemory(i, advice);
+                }
+                memmapLastAdvice_ = advice;
+            } else {
+                memmapMisses_++;
+            }
             mmapInfo = i;
         } else {
             slice = load_slice_(index);
         }
-        std::unique_lock lockCache(cacheMutex_);
         cache_->put(index, {slice, mmapInfo});
         return slice;
     }
 }
 
+auto Volume::memory_advice_(const int index) const -> MemoryAdvice
+{
+    if (memmapAdvice_) {
+        return *memmapAdvice_;
+    }
+
+    int trend{0};
+    {
+        std::unique_lock lock(prefetchMutex_);
+        trend = readTrend_;
+    }
+    if (std::abs(trend) < SEQUENTIAL_READS) {
+        return MemoryAdvice::Random;
+    }
+
+    // Slices past the last read are being prefetched, and the rest are read
+    // in full and in order
+    const auto last = lastRead_.load(std::memory_order_relaxed);
+    const auto ahead = trend > 0 ? index > last : index < last;
+    return ahead ? MemoryAdvice::WillNeed : MemoryAdvice::Sequential;
+}
+
 void Volume::cachePurge() const
 {
-    std::unique_lock lock(cacheMutex_);
-    cache_->purge();
+    {
+        std::unique_lock lock(cacheMutex_);
+        cache_->purge();
+    }
+    std::unique_lock lock(chunkCacheMutex_);
+    chunkCache_->purge();
+}
+
+void Volume::setChunkCache(ChunkCache::Pointer c) const
+{
+    cancelPrefetch();
+    waitForPrefetch();
+    std::unique_lock lock(chunkCacheMutex_);
+    chunkCacheInBytes_ = false;
+    chunkCache_ = std::move(c);
+}
+
+void Volume::setChunkCacheCapacity(const std::size_t newCacheCapacity) const
+{
+    {
+        std::unique_lock lock(levelsMutex_);
+        cacheMemory_.reset();
+    }
+    std::unique_lock lock(chunkCacheMutex_);
+    chunkCacheInBytes_ = false;
+    chunkCache_->resetWeigher();
+    chunkCache_->setCapacity(newCacheCapacity);
+}
+
+auto Volume::getChunkCacheCapacity() const -> std::size_t
+{
+    std::shared_lock lock(chunkCacheMutex_);
+    return chunkCache_->capacity();
+}
+
+auto Volume::getChunkCacheSize() const -> std::size_t
+{
+    return chunkCache_->size();
+}
+
+auto Volume::assemble_slice_(const int index) const -> cv::Mat
+{
+    cv::Mat slice = cv::Mat::zeros(height_, width_, CV_16UC1);
+    const auto z = index % chunkSize_;
+    const auto grid = chunkGridExtents();
+    for (int cy = 0; cy < grid[1]; cy++) {
+        for (int cx = 0; cx < grid[0]; cx++) {
+            const auto chunk = getChunkData({cx, cy, index / chunkSize_});
+            const auto x0 = cx * chunkSize_;
+            const auto y0 = cy * chunkSize_;
+            const auto w = std::min(chunkSize_, width_ - x0);
+            const auto h = std::min(chunkSize_, height_ - y0);
+            for (int y = 0; y < h; y++) {
+                const auto* src = chunk.ptr<std::uint16_t>(z, y);
+                std::copy(src, src + w, slice.ptr<std::uint16_t>(y0 + y) + x0);
+            }
+        }
+    }
+    return slice;
+}
+
+auto Volume::load_chunk_(const ChunkIndex& index) const -> cv::Mat
+{
+    Logger()->trace(
+        "Requested load chunk: ({}, {}, {})", index[0], index[1], index[2]);
+    try {
+        return cio::ReadChunk(getChunkPath(index), chunkSize_);
+    } catch (const std::exception& e) {
+        Logger()->warn(
+            "Failed to load chunk ({}, {}, {}): {}", index[0], index[1],
+            index[2], e.what());
+    }
+    // Missing chunks are treated as empty space
+    const std::array<int, 3> extents{chunkSize_, chunkSize_, chunkSize_};
+    return cv::Mat::zeros(3, extents.data(), CV_16UC1);
+}
+
+auto Volume::cache_chunk_(const ChunkIndex& index) const -> cv::Mat
+{
+    // Check if the chunk is in the cache
+    if (auto chunk = chunkCache_->tryGet(index)) {
+        return chunk.value();
+    }
+
+    // Load the chunk without locking. Chunks are small enough that
+    // occasionally loading the same chunk twice is cheaper than serializing
+    // all loads.
+    auto chunk = load_chunk_(index);
+    chunkCache_->put(index, chunk);
+    return chunk;
+}
+
+void Volume::prefetch(int zMin, int zMax) const
+{
+    zMin = std::max(zMin, 0);
+    zMax = std::min(zMax, slices_ - 1);
+    if (zMin > zMax) {
+        return;
+    }
+    if (format_ == StorageFormat::Chunks) {
+        // Only the chunks under recent reads, and no more than the cache holds
+        const auto footprint = read_footprint_();
+        const auto budget = static_cast<int>(std::min<std::size_t>(
+            prefetch_budget_(footprint), std::numeric_limits<int>::max()));
+        const auto begin = zMin / chunkSize_;
+        const auto count = std::min(zMax / chunkSize_ + 1 - begin, budget);
+        queue_prefetch_(begin, begin + count, footprint);
+    } else {
+        queue_prefetch_(zMin, zMax + 1, {});
+    }
+}
+
+void Volume::waitForPrefetch() const
+{
+    // Hold a reference, since setPrefetchThreads() may replace the pool while
+    // waiting
+    std::shared_ptr<ThreadPool> pool;
+    {
+        std::unique_lock lock(prefetchMutex_);
+        pool = prefetchPool_;
+    }
+    // Running prefetches need the lock to finish
+    if (pool) {
+        pool->wait();
+    }
+}
+
+void Volume::cancelPrefetch() const
+{
+    std::unique_lock lock(prefetchMutex_);
+    if (prefetchPool_) {
+        prefetchPool_->clear();
+    }
+    prefetchQueued_.clear();
+}
+
+void Volume::setPrefetchThreads(const std::uint32_t n)
+{
+    std::shared_ptr<ThreadPool> oldPool;
+    {
+        std::unique_lock lock(prefetchMutex_);
+        prefetchThreads_ = n;
+        oldPool = std::move(prefetchPool_);
+        prefetchQueued_.clear();
+    }
+    // Join the old threads without the lock, which running prefetches need.
+    // If another thread is waiting for them, it joins them instead.
+    oldPool.reset();
+}
+
+auto Volume::prefetchThreads() const -> std::uint32_t
+{
+    return prefetchThreads_;
+}
+
+void Volume::setPrefetchDepth(const int n) { prefetchDepth_ = std::max(n, 0); }
+
+auto Volume::prefetchDepth() const -> int { return prefetchDepth_; }
+
+void Volume::note_read_(const int unit) const
+{
+    // Chunked Volumes track the footprint of reads for explicit prefetches,
+    // and memory mapped slices track the read direction for their advice,
+    // even when automatic prefetching is disabled
+    const auto chunked = format_ == StorageFormat::Chunks;
+    const auto advising = memmap_ and not chunked and not memmapAdvice_;
+    if (not advising and
+        (prefetchThreads_ == 0 or (prefetchDepth_ == 0 and not chunked))) {
+        return;
+    }
+
+    // Most reads are from the same slice as the previous read, and only need
+    // this shared, read-only check
+    if (lastRead_.load(std::memory_order_relaxed) == unit) {
+        return;
+    }
+    const auto last = lastRead_.exchange(unit, std::memory_order_relaxed);
+    if (last == unit or last < 0) {
+        return;
+    }
+
+    // Chunked Volumes are prefetched in layers of chunks
+    int depth = prefetchDepth_;
+    if (chunked) {
+        depth = (depth + chunkSize_ - 1) / chunkSize_;
+    }
+
+    // Track the net direction of recent reads. Small steps against the trend
+    // are expected when several threads share the Volume, so only large jumps
+    // reset it.
+    const auto step = unit - last;
+    int trend{0};
+    cv::Rect footprint;
+    {
+        std::unique_lock lock(prefetchMutex_);
+        if (chunked) {
+            footprint = roll_footprint_();
+        }
+        if (std::abs(step) > std::max(depth, 1)) {
+            readTrend_ = 0;
+            return;
+        }
+        readTrend_ += step > 0 ? 1 : -1;
+        readTrend_ = std::clamp(readTrend_, -MAX_READ_TREND, MAX_READ_TREND);
+        trend = readTrend_;
+    }
+    if (prefetchThreads_ == 0 or depth == 0) {
+        return;
+    }
+
+    // Never use more than half of the cache
+    const auto budget = static_cast<int>(std::min<std::size_t>(
+        prefetch_budget_(footprint) / 2, std::numeric_limits<int>::max()));
+    depth = std::min(depth, budget);
+    if (trend >= SEQUENTIAL_READS) {
+        queue_prefetch_(unit + 1, unit + 1 + depth, footprint);
+    } else if (trend <= -SEQUENTIAL_READS) {
+        queue_prefetch_(unit - depth, unit, footprint);
+    }
+}
+
+void Volume::note_chunk_read_(const ChunkIndex& index) const
+{
+    if (prefetchThreads_ == 0) {
+        return;
+    }
+    ::AtomicMin(readMinX_, index[0]);
+    ::AtomicMin(readMinY_, index[1]);
+    ::AtomicMax(readMaxX_, index[0]);
+    ::AtomicMax(readMaxY_, index[1]);
+}
+
+auto Volume::roll_footprint_() const -> cv::Rect
+{
+    // Reads which race with the reset may be dropped, which only makes the
+    // footprint slightly smaller
+    const auto minX = readMinX_.exchange(std::numeric_limits<int>::max());
+    const auto minY = readMinY_.exchange(std::numeric_limits<int>::max());
+    const auto maxX = readMaxX_.exchange(std::numeric_limits<int>::min());
+    const auto maxY = readMaxY_.exchange(std::numeric_limits<int>::min());
+    cv::Rect current;
+    if (minX <= maxX and minY <= maxY) {
+        current = {minX, minY, maxX - minX + 1, maxY - minY + 1};
+    }
+
+    // Cover the last two layers, since reads from several threads interleave
+    const auto footprint = current | lastFootprint_;
+    lastFootprint_ = current;
+    return footprint;
+}
+
+auto Volume::read_footprint_() const -> cv::Rect
+{
+    const auto minX = readMinX_.load();
+    const auto minY = readMinY_.load();
+    const auto maxX = readMaxX_.load();
+    const auto maxY = readMaxY_.load();
+    std::unique_lock lock(prefetchMutex_);
+    if (minX <= maxX and minY <= maxY) {
+        return lastFootprint_ |
+               cv::Rect{minX, minY, maxX - minX + 1, maxY - minY + 1};
+    }
+    return lastFootprint_;
+}
+
+auto Volume::chunk_footprint_(const cv::Rect& footprint) const -> cv::Rect
+{
+    const auto grid = chunkGridExtents();
+    const cv::Rect layer{0, 0, grid[0], grid[1]};
+    if (footprint.empty()) {
+        return layer;
+    }
+    return footprint & layer;
+}
+
+void Volume::queue_prefetch_(int begin, int end, const cv::Rect& footprint)
+    const
+{
+    if (not cacheSlices_) {
+        return;
+    }
+    const auto chunked = format_ == StorageFormat::Chunks;
+    begin = std::max(begin, 0);
+    end = std::min(end, chunked ? chunkGridExtents()[2] : slices_);
+
+    std::unique_lock lock(prefetchMutex_);
+    if (prefetchThreads_ == 0) {
+        return;
+    }
+    for (auto unit = begin; unit < end; unit++) {
+        if (not chunked and cache_->contains(unit)) {
+            continue;
+        }
+        if (not prefetchQueued_.insert(unit).second) {
+            continue;
+        }
+        if (not prefetchPool_) {
+            prefetchPool_ = std::make_shared<ThreadPool>(prefetchThreads_);
+        }
+        prefetchPool_->submit([this, unit, footprint]() {
+            try {
+                prefetch_unit_(unit, footprint);
+            } catch (...) {
+                std::unique_lock taskLock(prefetchMutex_);
+                prefetchQueued_.erase(unit);
+                throw;
+            }
+            std::unique_lock taskLock(prefetchMutex_);
+            prefetchQueued_.erase(unit);
+        });
+    }
+}
+
+void Volume::prefetch_unit_(const int unit, const cv::Rect& footprint) const
+{
+    Logger()->trace("Prefetching: {}", unit);
+    if (format_ == StorageFormat::Chunks) {
+        const auto area = chunk_footprint_(footprint);
+        for (int cy = area.y; cy < area.br().y; cy++) {
+            for (int cx = area.x; cx < area.br().x; cx++) {
+                const ChunkIndex index{cx, cy, unit};
+                if (not chunkCache_->contains(index)) {
+                    cache_chunk_(index);
+                }
+            }
+        }
+    } else if (not cache_->contains(unit)) {
+        cache_slice_(unit);
+    }
+}
+
+auto Volume::prefetch_budget_(const cv::Rect& footprint) const -> std::size_t
+{
+    // Capacities are either item counts or bytes
+    std::size_t unitSize{1};
+    if (format_ == StorageFormat::Chunks) {
+        unitSize = static_cast<std::size_t>(chunk_footprint_(footprint).area());
+        if (chunkCacheInBytes_) {
+            unitSize *= static_cast<std::size_t>(chunkSize_) * chunkSize_ *
+                        chunkSize_ * sizeof(std::uint16_t);
+        }
+    } else if (cacheInBytes_) {
+        unitSize = static_cast<std::size_t>(width_) * height_ *
+                   sizeof(std::uint16_t);
+    }
+    return getCacheCapacity() / std::max(unitSize, std::size_t{1});
 }
@@ -644,6 +644,48 @@ auto VolumePkg::newVolume(std::string name) -> Volume::Pointer
     return r.first->second;
 }
 
+auto VolumePkg::removeVolume(const Volume::Identifier& id) -> bool
+{
+    // Ignore empty IDs
+    if (id.empty()) {
+        Logger()->warn("Not removing volume with empty ID");
+        return false;
+    }
+
+    // Check that the volume is in the map
+    auto it = volumes_.find(id);
+    if (it == volumes_.end()) {
+        Logger()->warn(
+            "Cannot remove volume with ID {}. Item does not exist in internal "
+            "map",
+            id);
+        return false;
+    }
+
+    // Stop background work before the volume's files are removed
+    it->second->cancelPrefetch();
+    it->second->waitForPrefetch();
+    const auto volDir = it->second->path();
+    volumes_.erase(it);
+
+    // Remove the volume directory
+    if (not fs::exists(volDir)) {
+        Logger()->warn(
+            "Volume directory does not exist for ID {}. No items will be "
+            "deleted from disk",
+            id);
+        return false;
+    }
+    std::error_code ec;
+    fs::remove_all(volDir, ec);
+    if (ec) {
+        Logger()->error(
+            "Failed to remove volume directory from disk: {}", ec.message());
+        return false;
+    }
+    return true;
+}
+
 auto VolumePkg::volume() const -> Volume::Pointer
 {
     if (volumes_.empty()) {
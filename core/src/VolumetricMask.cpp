@@ -1,14 +1,203 @@
 #include "vc/core/types/VolumetricMask.hpp"
 
+#include <bitset>
+#include <cmath>
+#include <stdexcept>
+
+#include "vc/core/util/IntegerMath.hpp"
+
 using namespace volcart;
 
-void VolumetricMask::setIn(const Voxel& v) { mask_.insert(v); }
+namespace
+{
+constexpr int BS = VolumetricMask::BLOCK_SIZE;
+
+// Index of a voxel's bit within its block
+auto BitIndex(const VolumetricMask::Voxel& v, const cv::Vec3i& blockIdx)
+    -> std::size_t
+{
+    const auto x = v[0] - blockIdx[0] * BS;
+    const auto y = v[1] - blockIdx[1] * BS;
+    const auto z = v[2] - blockIdx[2] * BS;
+    return static_cast<std::size_t>((z * BS + y) * BS + x);
+}
+
+auto PopCount(const std::uint64_t w) -> std::size_t
+{
+    return std::bitset<64>(w).count();
+}
+
+auto CountTrailingZeros(std::uint64_t w) -> std::size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctzll(w));
+#else
+    std::size_t n{0};
+    while ((w & 1U) == 0) {
+        w >>= 1U;
+        n++;
+    }
+    return n;
+#endif
+}
+
+auto IsEmpty(const VolumetricMask::Block& b) -> bool
+{
+    for (const auto w : b) {
+        if (w != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+///// Iterator /////
+VolumetricMask::const_iterator::const_iterator(
+    BlockMap::const_iterator block, BlockMap::const_iterator end)
+    : block_{block}, end_{end}
+{
+    find_next_(0);
+}
+
+auto VolumetricMask::const_iterator::operator++() -> const_iterator&
+{
+    find_next_(bit_ + 1);
+    return *this;
+}
+
+auto VolumetricMask::const_iterator::operator++(int) -> const_iterator
+{
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+void VolumetricMask::const_iterator::find_next_(std::size_t bit)
+{
+    while (block_ != end_) {
+        const auto& words = block_->second;
+        auto word = bit / 64;
+        if (word < BLOCK_WORDS) {
+            // Ignore the bits before `bit` in the first word
+            auto w = words[word] & (~std::uint64_t{0} << (bit % 64));
+            while (w == 0 and ++word < BLOCK_WORDS) {
+                w = words[word];
+            }
+            if (w != 0) {
+                bit_ = word * 64 + ::CountTrailingZeros(w);
+                const auto& idx = block_->first;
+                const auto local = static_cast<int>(bit_);
+                voxel_ = {
+                    idx[0] * BS + local % BS, idx[1] * BS + (local / BS) % BS,
+                    idx[2] * BS + local / (BS * BS)};
+                return;
+            }
+        }
+        ++block_;
+        bit = 0;
+    }
+    bit_ = 0;
+}
+
+///// Mask /////
+auto VolumetricMask::BlockIndexOf(const Voxel& v) -> BlockIndex
+{
+    return {FloorDiv(v[0], BS), FloorDiv(v[1], BS), FloorDiv(v[2], BS)};
+}
+
+auto VolumetricMask::block_(const BlockIndex& index) -> Block&
+{
+    // New blocks are value-initialized to zero
+    return blocks_.try_emplace(index).first->second;
+}
+
+void VolumetricMask::setIn(const Voxel& v)
+{
+    const auto idx = BlockIndexOf(v);
+    const auto bit = ::BitIndex(v, idx);
+    auto& word = block_(idx)[bit / 64];
+    const auto flag = std::uint64_t{1} << (bit % 64);
+    if ((word & flag) == 0) {
+        word |= flag;
+        size_++;
+    }
+}
+
+void VolumetricMask::setOut(const Voxel& v)
+{
+    const auto idx = BlockIndexOf(v);
+    auto it = blocks_.find(idx);
+    if (it == blocks_.end()) {
+        return;
+    }
+    const auto bit = ::BitIndex(v, idx);
+    auto& word = it->second[bit / 64];
+    const auto flag = std::uint64_t{1} << (bit % 64);
+    if ((word & flag) != 0) {
+        word &= ~flag;
+        size_--;
+        if (word == 0 and ::IsEmpty(it->second)) {
+            blocks_.erase(it);
+        }
+    }
+}
+
+void VolumetricMask::setIn(const cv::Mat& slice, const int z)
+{
+    if (slice.type() != CV_8UC1) {
+        throw std::invalid_argument("slice must be an 8-bit, 1 channel image");
+    }
+
+    // Only look up a block once per row segment
+    const auto bz = FloorDiv(z, BS);
+    for (int y = 0; y < slice.rows; y++) {
+        const auto* row = slice.ptr<std::uint8_t>(y);
+        const auto by = FloorDiv(y, BS);
+        Block* block{nullptr};
+        int blockX{-1};
+        for (int x = 0; x < slice.cols; x++) {
+            if (row[x] == 0) {
+                continue;
+            }
+            const auto bx = x / BS;
+            if (block == nullptr or bx != blockX) {
+                block = &block_({bx, by, bz});
+                blockX = bx;
+            }
+            const Voxel v{x, y, z};
+            const auto bit = ::BitIndex(v, {bx, by, bz});
+            auto& word = (*block)[bit / 64];
+            const auto flag = std::uint64_t{1} << (bit % 64);
+            if ((word & flag) == 0) {
+                word |= flag;
+                size_++;
+            }
+        }
+    }
+}
 
-void VolumetricMask::setOut(const Voxel& v) { mask_.erase(v); }
+void VolumetricMask::merge(const VolumetricMask& other)
+{
+    for (const auto& [idx, src] : other.blocks_) {
+        auto& dst = block_(idx);
+        for (std::size_t i = 0; i < BLOCK_WORDS; i++) {
+            size_ -= ::PopCount(dst[i]);
+            dst[i] |= src[i];
+            size_ += ::PopCount(dst[i]);
+        }
+    }
+}
 
 auto VolumetricMask::isIn(const Voxel& v) const -> bool
 {
-    return mask_.count(v) > 0;
+    const auto idx = BlockIndexOf(v);
+    const auto it = blocks_.find(idx);
+    if (it == blocks_.end()) {
+        return false;
+    }
+    const auto bit = ::BitIndex(v, idx);
+    return ((it->second[bit / 64] >> (bit % 64)) & 1U) != 0;
 }
 
 auto VolumetricMask::isOut(const Voxel& v) const -> bool { return not isIn(v); }
@@ -26,41 +215,60 @@ auto VolumetricMask::isOut(const cv::Vec3d& v) const -> bool
     return not isIn(v);
 }
 
-auto VolumetricMask::begin() noexcept -> VolumetricMask::iterator
-{
-    return mask_.begin();
-}
-
 auto VolumetricMask::begin() const noexcept -> VolumetricMask::const_iterator
 {
-    return mask_.begin();
+    return {blocks_.begin(), blocks_.end()};
 }
 
 auto VolumetricMask::cbegin() const noexcept -> VolumetricMask::const_iterator
 {
-    return mask_.cbegin();
+    return begin();
 }
 
-auto VolumetricMask::end() noexcept -> VolumetricMask::iterator
+auto VolumetricMask::end() const noexcept -> VolumetricMask::const_iterator
 {
-    return mask_.end();
+    return {blocks_.end(), blocks_.end()};
 }
 
-auto VolumetricMask::end() const noexcept -> VolumetricMask::const_iterator
+auto VolumetricMask::cend() const noexcept -> VolumetricMask::const_iterator
 {
-    return mask_.end();
+    return end();
 }
 
-auto VolumetricMask::cend() const noexcept -> VolumetricMask::const_iterator
+void VolumetricMask::clear()
 {
-    return mask_.end();
+    blocks_.clear();
+    size_ = 0;
 }
 
-void VolumetricMask::clear() { mask_.clear(); }
+auto VolumetricMask::empty() const -> bool { return size_ == 0; }
 
-auto VolumetricMask::empty() const -> bool { return mask_.empty(); }
+auto VolumetricMask::size() const -> std::size_t { return size_; }
 
 auto VolumetricMask::as_vector() const -> std::vector<VolumetricMask::Voxel>
 {
-    return {mask_.begin(), mask_.end()};
+    std::vector<Voxel> result;
+    result.reserve(size_);
+    result.insert(result.end(), begin(), end());
+    return result;
+}
+
+auto VolumetricMask::blocks() const -> const BlockMap& { return blocks_; }
+
+void VolumetricMask::setBlock(const BlockIndex& index, const Block& block)
+{
+    auto it = blocks_.find(index);
+    if (it != blocks_.end()) {
+        for (const auto w : it->second) {
+            size_ -= ::PopCount(w);
+        }
+        blocks_.erase(it);
+    }
+    if (::IsEmpty(block)) {
+        return;
+    }
+    for (const auto w : block) {
+        size_ += ::PopCount(w);
+    }
+    blocks_.emplace(index, block);
 }
@@ -0,0 +1,143 @@
+#include "vc/core/io/VolumetricMaskIO.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
+
+using namespace volcart;
+using namespace volcart::io;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+// File identifier
+constexpr std::array<char, 8> MAGIC{'V', 'C', 'V', 'M', 'A', 'S', 'K', '\0'};
+// Current file format version
+constexpr std::uint32_t VERSION{1};
+
+// Fixed-size file header. Followed by numBlocks block records.
+struct Header {
+    std::array<char, 8> magic{MAGIC};
+    std::uint32_t version{VERSION};
+    std::uint32_t blockSize{VolumetricMask::BLOCK_SIZE};
+    std::uint64_t numBlocks{0};
+    std::uint64_t numVoxels{0};
+};
+static_assert(sizeof(Header) == 32, "Unexpected header padding");
+
+// Block record: {x, y, z, padding} followed by the block's words
+struct RecordIndex {
+    std::array<std::int32_t, 3> index{};
+    std::uint32_t padding{0};
+};
+static_assert(sizeof(RecordIndex) == 16, "Unexpected record padding");
+
+auto ReadHeader(std::istream& is) -> Header
+{
+    Header h;
+    is.read(reinterpret_cast<char*>(&h), sizeof(Header));
+    return h;
+}
+}  // namespace
+
+auto io::IsVolumetricMask(const fs::path& path) -> bool
+{
+    std::ifstream ifs(path.string(), std::ios::binary);
+    if (not ifs.is_open()) {
+        return false;
+    }
+    const auto h = ::ReadHeader(ifs);
+    return not ifs.fail() and h.magic == ::MAGIC;
+}
+
+void io::WriteVolumetricMask(const fs::path& path, const VolumetricMask& mask)
+{
+    std::ofstream ofs(path.string(), std::ios::binary);
+    if (not ofs.is_open()) {
+        throw IOException("Failed to open file for writing: " + path.string());
+    }
+
+    // Sort the blocks so the output is deterministic
+    const auto& blocks = mask.blocks();
+    std::vector<const VolumetricMask::BlockMap::value_type*> sorted;
+    sorted.reserve(blocks.size());
+    for (const auto& b : blocks) {
+        sorted.push_back(&b);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+        const auto& l = a->first;
+        const auto& r = b->first;
+        return std::tie(l[2], l[1], l[0]) < std::tie(r[2], r[1], r[0]);
+    });
+
+    Header header;
+    header.numBlocks = sorted.size();
+    header.numVoxels = mask.size();
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    for (const auto* b : sorted) {
+        RecordIndex record;
+        record.index = {b->first[0], b->first[1], b->first[2]};
+        ofs.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        ofs.write(
+            reinterpret_cast<const char*>(b->second.data()),
+            sizeof(VolumetricMask::Block));
+    }
+    if (ofs.fail()) {
+        throw IOException("Failed to write file: " + path.string());
+    }
+}
+
+auto io::ReadVolumetricMask(const fs::path& path) -> VolumetricMask::Pointer
+{
+    std::ifstream ifs(path.string(), std::ios::binary);
+    if (not ifs.is_open()) {
+        throw IOException("Failed to open file: " + path.string());
+    }
+
+    const auto header = ::ReadHeader(ifs);
+    if (ifs.fail() or header.magic != ::MAGIC) {
+        throw IOException("Not a volumetric mask: " + path.string());
+    }
+    if (header.version != ::VERSION) {
+        throw IOException(
+            "Unsupported volumetric mask version " +
+            std::to_string(header.version) + ": " + path.string());
+    }
+    if (header.blockSize != VolumetricMask::BLOCK_SIZE) {
+        throw IOException(
+            "Unsupported volumetric mask block size " +
+            std::to_string(header.blockSize) + ": " + path.string());
+    }
+
+    auto mask = VolumetricMask::New();
+    RecordIndex record;
+    VolumetricMask::Block block;
+    for (std::uint64_t i = 0; i < header.numBlocks; i++) {
+        ifs.read(reinterpret_cast<char*>(&record), sizeof(record));
+        ifs.read(reinterpret_cast<char*>(block.data()), sizeof(block));
+        if (ifs.fail()) {
+            throw IOException("Truncated volumetric mask: " + path.string());
+        }
+        const auto& idx = record.index;
+        mask->setBlock({idx[0], idx[1], idx[2]}, block);
+    }
+    if (mask->size() != header.numVoxels) {
+        throw IOException("Corrupt volumetric mask: " + path.string());
+    }
+    return mask;
+}
+
+auto io::LoadVolumetricMask(const fs::path& path) -> VolumetricMask::Pointer
+{
+    if (IsVolumetricMask(path)) {
+        return ReadVolumetricMask(path);
+    }
+    return VolumetricMask::New(PointSetIO<cv::Vec3i>::ReadPointSet(path));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/io/ChunkIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
+
+using namespace volcart;
+using namespace volcart::chunkio;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+constexpr int TEST_CHUNK_SIZE{8};
+}  // namespace
+
+TEST(ChunkIO, WriteRead)
+{
+    const std::array<int, 3> extents{
+        ::TEST_CHUNK_SIZE, ::TEST_CHUNK_SIZE, ::TEST_CHUNK_SIZE};
+    cv::Mat chunk(3, extents.data(), CV_16UC1);
+    std::iota(
+        chunk.begin<std::uint16_t>(), chunk.end<std::uint16_t>(),
+        std::uint16_t{0});
+
+    const fs::path chunkPath("vc_core_ChunkIO_WriteRead.chunk");
+    WriteChunk(chunkPath, chunk);
+    auto result = ReadChunk(chunkPath, ::TEST_CHUNK_SIZE);
+
+    EXPECT_EQ(result.dims, 3);
+    EXPECT_EQ(result.size, chunk.size);
+    EXPECT_EQ(result.type(), chunk.type());
+
+    const auto equal = std::equal(
+        result.begin<std::uint16_t>(), result.end<std::uint16_t>(),
+        chunk.begin<std::uint16_t>());
+    EXPECT_TRUE(equal);
+
+    // Voxel addressing is (z, y, x)
+    EXPECT_EQ(result.at<std::uint16_t>(1, 2, 3), 1 * 64 + 2 * 8 + 3);
+}
+
+TEST(ChunkIO, WrongChunkSize)
+{
+    const std::array<int, 3> extents{
+        ::TEST_CHUNK_SIZE, ::TEST_CHUNK_SIZE, ::TEST_CHUNK_SIZE};
+    cv::Mat chunk = cv::Mat::zeros(3, extents.data(), CV_16UC1);
+
+    const fs::path chunkPath("vc_core_ChunkIO_WrongChunkSize.chunk");
+    WriteChunk(chunkPath, chunk);
+    EXPECT_THROW(ReadChunk(chunkPath, ::TEST_CHUNK_SIZE * 2), IOException);
+}
+
+TEST(ChunkIO, InvalidChunk)
+{
+    const fs::path chunkPath("vc_core_ChunkIO_InvalidChunk.chunk");
+
+    // Not 3D
+    cv::Mat img = cv::Mat::zeros(8, 8, CV_16UC1);
+    EXPECT_THROW(WriteChunk(chunkPath, img), IOException);
+
+    // Not cubic
+    const std::array<int, 3> extents{4, 8, 8};
+    cv::Mat chunk = cv::Mat::zeros(3, extents.data(), CV_16UC1);
+    EXPECT_THROW(WriteChunk(chunkPath, chunk), IOException);
+}
@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "vc/core/types/ClockCache.hpp"
+#include "vc/core/util/Iteration.hpp"
+
+using namespace volcart;
+
+///// FIXTURES /////
+class ClockCache_Empty : public testing::Test
+{
+public:
+    ClockCache<std::size_t, std::size_t> cache;
+};
+
+class ClockCache_Filled : public ClockCache_Empty
+{
+public:
+    ClockCache_Filled()
+    {
+        cache.setCapacity(100);
+        for (std::size_t idx = 0; idx < cache.capacity(); idx++) {
+            cache.put(idx, idx * idx);
+        }
+    }
+};
+
+///// TEST CASES /////
+TEST_F(ClockCache_Empty, ResizeCapacity)
+{
+    // Defaults
+    EXPECT_EQ(cache.capacity(), 200);
+    EXPECT_EQ(cache.size(), 0);
+
+    // Changed
+    cache.setCapacity(50);
+    EXPECT_EQ(cache.capacity(), 50);
+    EXPECT_EQ(cache.size(), 0);
+
+    // Invalid
+    EXPECT_THROW(cache.setCapacity(0), std::invalid_argument);
+    EXPECT_EQ(cache.capacity(), 50);
+}
+
+TEST_F(ClockCache_Filled, GetAndTryGet)
+{
+    EXPECT_EQ(cache.capacity(), cache.size());
+    for (std::size_t key = 0; key < cache.capacity(); key++) {
+        EXPECT_TRUE(cache.contains(key));
+        EXPECT_EQ(cache.get(key), key * key);
+        EXPECT_EQ(cache.tryGet(key), key * key);
+    }
+
+    EXPECT_FALSE(cache.contains(cache.capacity()));
+    EXPECT_THROW(cache.get(cache.capacity()), std::invalid_argument);
+    EXPECT_FALSE(cache.tryGet(cache.capacity()).has_value());
+}
+
+TEST_F(ClockCache_Filled, InsertPastCapacity)
+{
+    cache.put(100, 100 * 100);
+    EXPECT_EQ(cache.capacity(), 100);
+    EXPECT_EQ(cache.size(), 100);
+    EXPECT_TRUE(cache.contains(100));
+    EXPECT_EQ(cache.get(100), 10000);
+}
+
+TEST_F(ClockCache_Filled, ReplaceItem)
+{
+    cache.put(0, 1);
+    EXPECT_EQ(cache.size(), 100);
+    EXPECT_EQ(cache.get(0), 1);
+}
+
+TEST_F(ClockCache_Filled, ShrinkCapacity)
+{
+    cache.setCapacity(10);
+    EXPECT_EQ(cache.size(), 10);
+    EXPECT_EQ(cache.weight(), 10);
+}
+
+TEST_F(ClockCache_Filled, SecondChance)
+{
+    // The first insertion past capacity clears every reference bit and evicts
+    // one item
+    cache.put(100, 0);
+
+    // Reference every remaining item but one
+    std::optional<std::size_t> unreferenced;
+    for (const auto key : range(std::size_t{101})) {
+        if (not cache.contains(key)) {
+            continue;
+        }
+        if (not unreferenced and key != 100) {
+            unreferenced = key;
+            continue;
+        }
+        cache.get(key);
+    }
+    ASSERT_TRUE(unreferenced.has_value());
+
+    // The unreferenced item is evicted next
+    cache.put(101, 0);
+    EXPECT_FALSE(cache.contains(unreferenced.value()));
+    EXPECT_TRUE(cache.contains(101));
+    EXPECT_EQ(cache.size(), 100);
+}
+
+TEST_F(ClockCache_Filled, PurgeTheCache)
+{
+    cache.purge();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.weight(), 0);
+    EXPECT_FALSE(cache.contains(1));
+}
+
+TEST(ClockCache, Weigher)
+{
+    ClockCache<int, std::vector<char>> cache;
+    cache.setWeigher([](const auto& v) { return v.size(); });
+    cache.setCapacity(1000);
+
+    for (const auto key : range(10)) {
+        cache.put(key, std::vector<char>(100));
+    }
+    EXPECT_EQ(cache.size(), 10);
+    EXPECT_EQ(cache.weight(), 1000);
+
+    // Never exceeds the byte budget
+    cache.put(10, std::vector<char>(400));
+    EXPECT_LE(cache.weight(), 1000);
+    EXPECT_TRUE(cache.contains(10));
+
+    // Reweigh as counts
+    cache.resetWeigher();
+    EXPECT_EQ(cache.weight(), cache.size());
+}
+
+TEST(ClockCache, OnEvict)
+{
+    // Only evict items which aren't referenced outside of the cache
+    auto onEvict = [](int& /*key*/, std::shared_ptr<int>& v) -> bool {
+        return v.use_count() <= 1;
+    };
+
+    ClockCache<int, std::shared_ptr<int>> cache;
+    cache.setCapacity(10);
+    cache.onEvict(onEvict);
+
+    std::vector<std::shared_ptr<int>> refs;
+    for (const auto key : range(10)) {
+        auto v = std::make_shared<int>(key);
+        refs.push_back(v);
+        cache.put(key, v);
+    }
+
+    // Can't evict anything while everything has a reference
+    cache.setCapacity(9);
+    EXPECT_EQ(cache.size(), 10);
+
+    // Drop one reference
+    refs.erase(refs.begin());
+    cache.evict();
+    EXPECT_EQ(cache.size(), 9);
+    EXPECT_FALSE(cache.contains(0));
+
+    // Purge only removes unreferenced items
+    refs.erase(refs.begin(), std::next(refs.begin(), 3));
+    cache.purge();
+    EXPECT_EQ(cache.size(), 6);
+
+    refs.clear();
+    cache.purge();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ClockCache, ConcurrentAccess)
+{
+    ClockCache<int, int> cache(64);
+    constexpr int numThreads{8};
+    constexpr int numOps{10000};
+
+    std::vector<std::thread> threads;
+    for (const auto t : range(numThreads)) {
+        threads.emplace_back([&cache, t]() {
+            for (const auto i : range(numOps)) {
+                const auto key = (i * 7 + t) % 128;
+                if (auto v = cache.tryGet(key)) {
+                    EXPECT_EQ(v.value(), key);
+                } else {
+                    cache.put(key, key);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_LE(cache.size(), 64);
+    EXPECT_EQ(cache.weight(), cache.size());
+}
@@ -0,0 +1,16 @@
+#include <gtest/gtest.h>
+
+#include "vc/core/util/IntegerMath.hpp"
+
+using namespace volcart;
+
+TEST(IntegerMath, FloorDiv)
+{
+    EXPECT_EQ(FloorDiv(0, 4), 0);
+    EXPECT_EQ(FloorDiv(3, 4), 0);
+    EXPECT_EQ(FloorDiv(4, 4), 1);
+    EXPECT_EQ(FloorDiv(-1, 4), -1);
+    EXPECT_EQ(FloorDiv(-4, 4), -1);
+    EXPECT_EQ(FloorDiv(-5, 4), -2);
+    static_assert(FloorDiv(-8, 4) == -2);
+}
@@ -255,4 +255,46 @@ TEST(LRUCache, OnEvict)
     // Should still have items that don't pass test
     EXPECT_EQ(cache.capacity(), 9);
     EXPECT_EQ(cache.size(), 0);
-}
\ No newline at end of file
+}
+
+TEST(LRUCache, Weigher)
+{
+    // Weigh each image by the number of bytes it holds
+    auto weigher = [](const cv::Mat& i) -> std::size_t {
+        return i.total() * i.elemSize();
+    };
+
+    // Set up a cache with room for 1000 bytes
+    LRUCache<int, cv::Mat> cache;
+    cache.setWeigher(weigher);
+    cache.setCapacity(1000);
+
+    // 100 bytes each
+    for (auto key : range(10)) {
+        cache.put(key, cv::Mat::zeros(10, 10, CV_8UC1));
+    }
+    EXPECT_EQ(cache.size(), 10);
+    EXPECT_EQ(cache.weight(), 1000);
+
+    // 400 bytes evicts the 4 least recently used items
+    cache.put(10, cv::Mat::zeros(10, 20, CV_16UC1));
+    EXPECT_EQ(cache.size(), 7);
+    EXPECT_EQ(cache.weight(), 1000);
+    for (const auto key : range(4)) {
+        EXPECT_FALSE(cache.contains(key));
+    }
+
+    // Replacing an item updates the weight
+    cache.put(10, cv::Mat::zeros(10, 10, CV_8UC1));
+    EXPECT_EQ(cache.size(), 7);
+    EXPECT_EQ(cache.weight(), 700);
+
+    // Removing the weigher weighs every item as 1
+    cache.resetWeigher();
+    EXPECT_EQ(cache.size(), 7);
+    EXPECT_EQ(cache.weight(), 7);
+
+    // Purge resets the weight
+    cache.purge();
+    EXPECT_EQ(cache.weight(), 0);
+}
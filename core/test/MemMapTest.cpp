@@ -5,6 +5,7 @@
 #include <string_view>
 
 #include "vc/core/filesystem.hpp"
+#include "vc/core/types/Exceptions.hpp"
 #include "vc/core/util/MemMap.hpp"
 
 using namespace volcart;
@@ -76,4 +77,23 @@ TEST(Memmap, AutoUnmap)
     EXPECT_EXIT(testChar = str[2], ::testing::KilledBySignal(SIGSEGV), "");
     EXPECT_EQ(testChar, 'A');
 }
+
+TEST(Memmap, FileContents)
+{
+    // Create a file
+    const fs::path file("vc_core_Memmap_FileContents.txt");
+    std::ofstream out(file, std::ios::out);
+    if (not out.is_open()) {
+        throw std::runtime_error("Failed to open output file");
+    }
+    out << "BAZ";
+    out.close();
+
+    const FileContents contents(file);
+    EXPECT_TRUE(contents.isMapped());
+    EXPECT_EQ(contents.size(), 3);
+    EXPECT_EQ(contents.view(), "BAZ");
+
+    EXPECT_THROW(FileContents("vc_core_Memmap_Missing.txt"), IOException);
+}
 #endif
\ No newline at end of file
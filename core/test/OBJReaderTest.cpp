@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -84,4 +86,68 @@ TEST_F(OBJReader, Invalid)
 {
     reader.setPath(path + "Invalid.obj");
     EXPECT_THROW(reader.read(), IOException);
-}
\ No newline at end of file
+}
+
+TEST_F(OBJReader, NonTriangularFace)
+{
+    const std::string file{"vc_core_OBJReader_NonTriangularFace.obj"};
+    {
+        std::ofstream os(file);
+        os << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+    }
+    reader.setPath(file);
+    EXPECT_THROW(reader.read(), IOException);
+}
+
+TEST_F(OBJReader, SingleThreaded)
+{
+    reader.setPath(path + "TexturedWithNormals.obj");
+    reader.setMaxThreads(1);
+    ASSERT_NO_THROW(reader.read());
+    EXPECT_EQ(reader.getMesh()->GetNumberOfPoints(), 16);
+    EXPECT_EQ(reader.getMesh()->GetNumberOfCells(), 18);
+}
+
+TEST_F(OBJReader, ParallelChunks)
+{
+    // A grid large enough to be split into several parse chunks
+    constexpr int side{300};
+    const std::string file{"vc_core_OBJReader_ParallelChunks.obj"};
+    {
+        std::ofstream os(file);
+        for (int y = 0; y < side; y++) {
+            for (int x = 0; x < side; x++) {
+                os << "v " << x << " " << y << " 0\n";
+            }
+        }
+        for (int y = 0; y + 1 < side; y++) {
+            for (int x = 0; x + 1 < side; x++) {
+                const auto v = y * side + x + 1;
+                os << "f " << v << " " << v + 1 << " " << v + side << "\n";
+                os << "f " << v + 1 << " " << v + side + 1 << " " << v + side
+                   << "\n";
+            }
+        }
+    }
+    reader.setPath(file);
+    reader.setMaxThreads(4);
+    const auto mesh = reader.read();
+    ASSERT_EQ(mesh->GetNumberOfPoints(), side * side);
+    ASSERT_EQ(mesh->GetNumberOfCells(), 2 * (side - 1) * (side - 1));
+
+    // Chunks are merged in file order
+    for (std::uint64_t i = 0; i < mesh->GetNumberOfPoints(); i++) {
+        const auto pt = mesh->GetPoint(i);
+        EXPECT_EQ(pt[0], static_cast<double>(i % side));
+        EXPECT_EQ(pt[1], static_cast<double>(i / side));
+    }
+    for (std::uint64_t i = 0; i < mesh->GetNumberOfCells(); i += 2) {
+        volcart::ITKCell::CellAutoPointer c;
+        mesh->GetCell(i, c);
+        const auto row = i / 2 / (side - 1);
+        const auto v = row * side + i / 2 % (side - 1);
+        EXPECT_EQ(c->GetPointIds()[0], v);
+        EXPECT_EQ(c->GetPointIds()[1], v + 1);
+        EXPECT_EQ(c->GetPointIds()[2], v + side);
+    }
+}
@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
 #include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
 #include "vc/core/types/OrderedPointSet.hpp"
 
 using namespace volcart;
@@ -54,4 +58,69 @@ TEST_F(OrderedPointSetIO, WriteReadASCII)
     EXPECT_EQ(read(0, 0), ps(0, 0));
     EXPECT_EQ(read(0, 1), ps(0, 1));
     EXPECT_EQ(read(0, 2), ps(0, 2));
-}
\ No newline at end of file
+}
+
+TEST_F(OrderedPointSetIO, WriteReadFloat32)
+{
+    OrderedPointSet<cv::Vec3d> dps{2};
+    dps.pushRow({{0.5, 1.25, -2}, {3, 4, 5}});
+    dps.pushRow({{6, 7, 8}, {-9.75, 10, 11}});
+
+    // Write to disk with float storage
+    path += "WriteReadFloat32.vcps";
+    PointSetIO<cv::Vec3d>::WriteOrderedPointSet(
+        path, dps, IOMode::BINARY, PointStorage::Float32);
+
+    // Read as doubles and as floats
+    auto readD = PointSetIO<cv::Vec3d>::ReadOrderedPointSet(path);
+    auto readF = PointSetIO<cv::Vec3f>::ReadOrderedPointSet(path);
+    EXPECT_EQ(readD.width(), 2);
+    EXPECT_EQ(readD.height(), 2);
+    EXPECT_EQ(readF.height(), 2);
+    for (std::size_t y = 0; y < 2; y++) {
+        for (std::size_t x = 0; x < 2; x++) {
+            EXPECT_EQ(readD(y, x), dps(y, x));
+            EXPECT_EQ(cv::Vec3d(readF(y, x)), dps(y, x));
+        }
+    }
+
+    // Integer point sets can't be stored as floats
+    EXPECT_THROW(
+        PointSetIO<cv::Vec3i>::WriteOrderedPointSet(
+            path, ps, IOMode::BINARY, PointStorage::Float32),
+        IOException);
+}
+
+TEST_F(OrderedPointSetIO, MappedPointSet)
+{
+    path += "MappedPointSet.vcps";
+    PointSetIO<cv::Vec3i>::WriteOrderedPointSet(path, ps);
+
+    // Payload of a matching type is used in place
+    const PointSetIO<cv::Vec3i>::MappedPointSet mapped(path);
+    EXPECT_EQ(mapped.header().width, 3);
+    EXPECT_EQ(mapped.header().height, 1);
+    EXPECT_EQ(mapped.size(), 3);
+    EXPECT_EQ(mapped.payload().size(), 3 * sizeof(cv::Vec3i));
+    ASSERT_NE(mapped.data(), nullptr);
+    for (std::size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(mapped.data()[i], ps(0, i));
+        EXPECT_EQ(mapped.at(i), ps(0, i));
+    }
+    std::vector<cv::Vec3i> pts(2);
+    mapped.copy(1, 3, pts.data());
+    EXPECT_EQ(pts[0], ps(0, 1));
+    EXPECT_EQ(pts[1], ps(0, 2));
+    EXPECT_THROW(mapped.at(3), std::out_of_range);
+}
+
+TEST_F(OrderedPointSetIO, ReadTruncatedBinary)
+{
+    path += "ReadTruncatedBinary.vcps";
+    std::ofstream out(path, std::ios::binary);
+    out << PointSetIO<cv::Vec3i>::MakeOrderedHeader(ps);
+    out.write(reinterpret_cast<const char*>(&ps(0, 0)), sizeof(cv::Vec3i));
+    out.close();
+
+    EXPECT_THROW(PointSetIO<cv::Vec3i>::ReadOrderedPointSet(path), IOException);
+}
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
 
 #include "vc/core/io/PLYReader.hpp"
 #include "vc/core/io/PLYWriter.hpp"
@@ -8,6 +13,7 @@
 #include "vc/core/shapes/Cone.hpp"
 #include "vc/core/shapes/Plane.hpp"
 #include "vc/core/shapes/Sphere.hpp"
+#include "vc/core/types/Exceptions.hpp"
 #include "vc/core/types/SimpleMesh.hpp"
 #include "vc/testing/ParsingHelpers.hpp"
 #include "vc/testing/TestingUtils.hpp"
@@ -259,4 +265,140 @@ TEST_F(ReadITKSphereMeshFixture, ReadSphereMeshTest)
         EXPECT_EQ(in_C->GetPointIds()[1], read_C->GetPointIds()[1]);
         EXPECT_EQ(in_C->GetPointIds()[2], read_C->GetPointIds()[2]);
     }
-}
\ No newline at end of file
+}
+
+namespace
+{
+// Write a value with the given endianness
+template <typename T>
+void WriteValue(std::ostream& os, T val, bool littleEndian)
+{
+    std::array<char, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), &val, sizeof(T));
+    const std::uint16_t one{1};
+    const bool hostLittle = *reinterpret_cast<const char*>(&one) == 1;
+    if (hostLittle != littleEndian) {
+        std::reverse(bytes.begin(), bytes.end());
+    }
+    os.write(bytes.data(), bytes.size());
+}
+
+// Write a binary PLY with a skipped property on each element
+void WriteBinaryPLY(const std::string& path, bool littleEndian)
+{
+    std::ofstream os(path, std::ios::binary);
+    os << "ply\n";
+    os << "format binary_" << (littleEndian ? "little" : "big")
+       << "_endian 1.0\n";
+    os << "comment VC test file\n";
+    os << "element vertex 4\n";
+    os << "property double x\n";
+    os << "property double y\n";
+    os << "property float z\n";
+    os << "property uchar red\n";
+    os << "element face 2\n";
+    os << "property uchar flags\n";
+    os << "property list uchar uint vertex_indices\n";
+    os << "end_header\n";
+    for (int i = 0; i < 4; i++) {
+        WriteValue<double>(os, i, littleEndian);
+        WriteValue<double>(os, 2 * i, littleEndian);
+        WriteValue<float>(os, 3.5F * i, littleEndian);
+        WriteValue<std::uint8_t>(os, 255, littleEndian);
+    }
+    for (std::uint32_t i = 0; i < 2; i++) {
+        WriteValue<std::uint8_t>(os, 7, littleEndian);
+        WriteValue<std::uint8_t>(os, 3, littleEndian);
+        WriteValue<std::uint32_t>(os, i, littleEndian);
+        WriteValue<std::uint32_t>(os, i + 1, littleEndian);
+        WriteValue<std::uint32_t>(os, i + 2, littleEndian);
+    }
+}
+
+void CheckBinaryPLY(const volcart::ITKMesh::Pointer& mesh)
+{
+    ASSERT_EQ(mesh->GetNumberOfPoints(), 4);
+    ASSERT_EQ(mesh->GetNumberOfCells(), 2);
+    for (std::uint64_t i = 0; i < 4; i++) {
+        const auto pt = mesh->GetPoint(i);
+        EXPECT_DOUBLE_EQ(pt[0], i);
+        EXPECT_DOUBLE_EQ(pt[1], 2.0 * i);
+        EXPECT_DOUBLE_EQ(pt[2], 3.5 * i);
+    }
+    for (std::uint64_t i = 0; i < 2; i++) {
+        volcart::ITKCell::CellAutoPointer c;
+        mesh->GetCell(i, c);
+        EXPECT_EQ(c->GetPointIds()[0], i);
+        EXPECT_EQ(c->GetPointIds()[1], i + 1);
+        EXPECT_EQ(c->GetPointIds()[2], i + 2);
+    }
+}
+}  // namespace
+
+TEST(PLYReader, ReadBinaryLittleEndian)
+{
+    ::WriteBinaryPLY("PLYReader_binary_le.ply", true);
+    volcart::io::PLYReader reader("PLYReader_binary_le.ply");
+    ::CheckBinaryPLY(reader.read());
+}
+
+TEST(PLYReader, ReadBinaryBigEndian)
+{
+    ::WriteBinaryPLY("PLYReader_binary_be.ply", false);
+    volcart::io::PLYReader reader("PLYReader_binary_be.ply");
+    reader.setMaxThreads(1);
+    ::CheckBinaryPLY(reader.read());
+}
+
+TEST(PLYReader, ReadLargeAscii)
+{
+    // Enough vertices and faces to be parsed in several blocks
+    const volcart::shapes::Sphere sphere(5, 5);
+    const auto input = sphere.itkMesh();
+    volcart::io::PLYWriter writer("PLYReader_large.ply", input);
+    writer.write();
+
+    volcart::io::PLYReader reader("PLYReader_large.ply");
+    reader.setMaxThreads(4);
+    const auto mesh = reader.read();
+    ASSERT_EQ(mesh->GetNumberOfPoints(), input->GetNumberOfPoints());
+    ASSERT_EQ(mesh->GetNumberOfCells(), input->GetNumberOfCells());
+    ASSERT_GT(mesh->GetNumberOfCells(), 16384U);
+    for (std::uint64_t i = 0; i < mesh->GetNumberOfPoints(); i++) {
+        const auto pt = mesh->GetPoint(i);
+        const auto expected = input->GetPoint(i);
+        EXPECT_NEAR(pt[0], expected[0], 1e-4);
+        EXPECT_NEAR(pt[1], expected[1], 1e-4);
+        EXPECT_NEAR(pt[2], expected[2], 1e-4);
+    }
+    for (std::uint64_t i = 0; i < mesh->GetNumberOfCells(); i++) {
+        volcart::ITKCell::CellAutoPointer c;
+        volcart::ITKCell::CellAutoPointer expected;
+        mesh->GetCell(i, c);
+        input->GetCell(i, expected);
+        EXPECT_EQ(c->GetPointIds()[0], expected->GetPointIds()[0]);
+        EXPECT_EQ(c->GetPointIds()[1], expected->GetPointIds()[1]);
+        EXPECT_EQ(c->GetPointIds()[2], expected->GetPointIds()[2]);
+    }
+}
+
+TEST(PLYReader, ReadInvalid)
+{
+    {
+        std::ofstream os("PLYReader_quads.ply");
+        os << "ply\nformat ascii 1.0\nelement vertex 4\nproperty float x\n"
+              "property float y\nproperty float z\nelement face 1\n"
+              "property list uchar int vertex_indices\nend_header\n"
+              "0 0 0\n1 0 0\n1 1 0\n0 1 0\n4 0 1 2 3\n";
+    }
+    volcart::io::PLYReader reader("PLYReader_quads.ply");
+    EXPECT_THROW(reader.read(), volcart::IOException);
+
+    {
+        std::ofstream os("PLYReader_truncated.ply");
+        os << "ply\nformat ascii 1.0\nelement vertex 4\nproperty float x\n"
+              "property float y\nproperty float z\nend_header\n0 0 0\n";
+    }
+    reader.setPath("PLYReader_truncated.ply");
+    EXPECT_THROW(reader.read(), volcart::IOException);
+}
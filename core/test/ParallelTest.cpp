@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "vc/core/util/Parallel.hpp"
+
+using namespace volcart;
+
+TEST(Parallel, NumThreads)
+{
+    EXPECT_GE(NumThreads(), 1);
+    EXPECT_EQ(NumThreads(1), 1);
+    EXPECT_EQ(NumThreads(0), 1);
+    EXPECT_LE(NumThreads(2), 2);
+}
+
+TEST(Parallel, VisitsEveryIndexOnce)
+{
+    constexpr std::size_t size{10007};
+    for (const auto threads : {1U, 2U, 8U}) {
+        std::vector<std::atomic<int>> visits(size);
+        ParallelFor(size, 64, threads, [&](auto begin, auto end) {
+            EXPECT_LT(begin, end);
+            EXPECT_LE(end - begin, 64);
+            for (auto i = begin; i < end; i++) {
+                visits[i]++;
+            }
+        });
+        for (const auto& v : visits) {
+            EXPECT_EQ(v, 1);
+        }
+    }
+}
+
+TEST(Parallel, EmptyRange)
+{
+    bool called{false};
+    ParallelFor(0, 16, 4, [&](auto, auto) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(Parallel, SingleThreadIsOrdered)
+{
+    std::vector<std::size_t> order;
+    ParallelFor(100, 7, 1, [&](auto begin, auto end) {
+        for (auto i = begin; i < end; i++) {
+            order.push_back(i);
+        }
+    });
+    ASSERT_EQ(order.size(), 100);
+    for (std::size_t i = 0; i < order.size(); i++) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(Parallel, RethrowsException)
+{
+    auto fn = [](auto begin, auto end) {
+        for (auto i = begin; i < end; i++) {
+            if (i == 500) {
+                throw std::runtime_error("failed");
+            }
+        }
+    };
+    EXPECT_THROW(ParallelFor(1000, 10, 4, fn), std::runtime_error);
+}
+
+TEST(Parallel, ParallelProgress)
+{
+    Signal<std::size_t> signal;
+    std::vector<std::size_t> updates;
+    signal.connect([&](auto v) { updates.push_back(v); });
+
+    ParallelProgress progress(signal);
+    ParallelFor(1000, 10, 4, [&](auto begin, auto end) {
+        progress.add(end - begin);
+    });
+
+    ASSERT_FALSE(updates.empty());
+    EXPECT_LE(updates.back(), 1000);
+    for (std::size_t i = 1; i < updates.size(); i++) {
+        EXPECT_LT(updates[i - 1], updates[i]);
+    }
+}
+
+TEST(Parallel, ParallelPass)
+{
+    ParallelPass pass(100);
+    EXPECT_EQ(pass.progressIterations(), 100U);
+    std::size_t started{0};
+    std::size_t last{0};
+    std::size_t completed{0};
+    pass.progressStarted.connect([&]() { started++; });
+    pass.progressUpdated.connect([&](auto v) { last = v; });
+    pass.progressComplete.connect([&]() { completed++; });
+
+    std::vector<std::atomic<int>> visits(100);
+    pass.run(4, [&](std::size_t i) { visits[i]++; });
+    for (const auto& v : visits) {
+        EXPECT_EQ(v, 1);
+    }
+    EXPECT_EQ(started, 1U);
+    EXPECT_EQ(completed, 1U);
+    EXPECT_LE(last, 100U);
+}
+
+TEST(Parallel, MarksWorkers)
+{
+    EXPECT_FALSE(IsParallelWorker());
+
+    // Single-threaded loops run on the caller, which isn't a worker
+    ParallelFor(10, 1, 1, [](auto, auto) { EXPECT_FALSE(IsParallelWorker()); });
+
+    std::atomic<std::size_t> marked{0};
+    ParallelFor(100, 1, 4, [&](auto begin, auto end) {
+        if (IsParallelWorker()) {
+            marked += end - begin;
+        }
+    });
+    EXPECT_EQ(marked, 100);
+    EXPECT_FALSE(IsParallelWorker());
+}
+
+TEST(Parallel, WorkerIndex)
+{
+    // Each worker index is used by one thread at a time
+    constexpr std::uint32_t threads{4};
+    std::vector<std::atomic<int>> active(threads);
+    std::atomic<bool> shared{false};
+    std::atomic<std::size_t> visited{0};
+    ParallelFor(
+        1000, 3, threads,
+        [&](std::uint32_t worker, std::size_t begin, std::size_t end) {
+            ASSERT_LT(worker, threads);
+            if (active[worker]++ > 0) {
+                shared = true;
+            }
+            visited += end - begin;
+            active[worker]--;
+        });
+    EXPECT_FALSE(shared);
+    EXPECT_EQ(visited, 1000);
+
+    // A single thread is always worker 0
+    ParallelFor(
+        10, 1, 1, [](std::uint32_t worker, std::size_t, std::size_t) {
+            EXPECT_EQ(worker, 0);
+        });
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/math/StructureTensor.hpp"
+#include "vc/core/math/StructureTensorField.hpp"
+#include "vc/core/types/Volume.hpp"
+
+using namespace volcart;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+constexpr int TEST_EXTENT{12};
+constexpr int TEST_CHUNK_SIZE{4};
+
+// Linear intensity field with a constant gradient of (1, 10, 100)
+auto MakeVolume(const fs::path& path) -> Volume::Pointer
+{
+    fs::remove_all(path);
+    fs::create_directories(path);
+    auto vol = Volume::New(path, "linear", "Linear");
+    vol->setSliceWidth(TEST_EXTENT);
+    vol->setSliceHeight(TEST_EXTENT);
+    vol->setNumberOfSlices(TEST_EXTENT);
+    for (int z = 0; z < TEST_EXTENT; z++) {
+        cv::Mat slice(TEST_EXTENT, TEST_EXTENT, CV_16UC1);
+        for (int y = 0; y < TEST_EXTENT; y++) {
+            for (int x = 0; x < TEST_EXTENT; x++) {
+                slice.at<std::uint16_t>(y, x) =
+                    static_cast<std::uint16_t>(x + 10 * y + 100 * z);
+            }
+        }
+        vol->setSliceData(z, slice);
+    }
+    return vol;
+}
+}  // namespace
+
+TEST(StructureTensorField, LinearField)
+{
+    auto vol = ::MakeVolume("vc_core_StructureTensorField_LinearField");
+    const auto path = StructureTensorField::DefaultPath(vol, 1);
+    auto field = ComputeStructureTensorField(
+        path, vol, 1, std::nullopt, std::nullopt, ::TEST_CHUNK_SIZE, 2);
+    EXPECT_EQ(field->chunkGridExtents(), cv::Vec3i(3, 3, 3));
+    EXPECT_EQ(field->volumeID(), "linear");
+
+    // Away from the volume edges, every gradient is the Scharr response to
+    // the linear field and the tensor is a scaled outer product of it
+    const cv::Vec3d gradient{32, 320, 3200};
+    const auto scale = 1 / (std::pow(2 * M_PI, 3.0 / 2.0) * 27);
+    const StructureTensor expected = scale * gradient * gradient.t();
+    const auto result = field->tensorAt(5, 6, 5);
+    for (int i = 0; i < 9; i++) {
+        EXPECT_NEAR(result.val[i], expected.val[i], 1e-4 * expected.val[i]);
+    }
+
+    // Eigenvectors agree with the per-query computation
+    StructureTensorWorkspace ws(1);
+    const cv::Vec3d pos{5.5, 6.25, 4.75};
+    const auto ep = field->eigenPairsAt(pos);
+    const auto wsEp = ws.subvoxelEigenPairs(vol, pos);
+    EXPECT_GT(std::abs(ep[0].second.dot(wsEp[0].second)), 0.99);
+    EXPECT_GT(std::abs(ep[0].second.dot(cv::normalize(gradient))), 0.999);
+    EXPECT_GT(ep[0].first, ep[1].first);
+}
+
+TEST(StructureTensorField, ReadWrite)
+{
+    auto vol = ::MakeVolume("vc_core_StructureTensorField_ReadWrite");
+    const fs::path path{"vc_core_StructureTensorField_ReadWrite.field"};
+    fs::remove_all(path);
+    const cv::Vec3i min{2, 3, 1};
+    const cv::Vec3i max{9, 10, 11};
+    auto field = ComputeStructureTensorField(
+        path, vol, 2, min, max, ::TEST_CHUNK_SIZE, 1);
+
+    const auto loaded = StructureTensorField::New(path);
+    EXPECT_EQ(loaded->radius(), 2);
+    EXPECT_EQ(loaded->chunkSize(), ::TEST_CHUNK_SIZE);
+    EXPECT_EQ(loaded->min(), min);
+    EXPECT_EQ(loaded->max(), max);
+    EXPECT_TRUE(loaded->isInBounds({2, 3, 1}));
+    EXPECT_TRUE(loaded->isInBounds({8, 9, 10}));
+    EXPECT_FALSE(loaded->isInBounds({8.5, 9, 10}));
+    EXPECT_FALSE(loaded->isInBounds({1.9, 5, 5}));
+
+    for (int z = min[2]; z < max[2]; z++) {
+        for (int y = min[1]; y < max[1]; y++) {
+            for (int x = min[0]; x < max[0]; x++) {
+                EXPECT_EQ(
+                    cv::norm(
+                        field->tensorAt(x, y, z), loaded->tensorAt(x, y, z),
+                        cv::NORM_INF),
+                    0);
+            }
+        }
+    }
+
+    // Voxel positions interpolate to the voxel tensor
+    EXPECT_EQ(
+        cv::norm(
+            loaded->interpolateAt({4, 5, 6}), loaded->tensorAt(4, 5, 6),
+            cv::NORM_INF),
+        0);
+}
+
+TEST(StructureTensorField, InvalidRegion)
+{
+    auto vol = ::MakeVolume("vc_core_StructureTensorField_InvalidRegion");
+    EXPECT_THROW(
+        StructureTensorField::Create(
+            "vc_core_StructureTensorField_InvalidRegion.field", vol, 1,
+            {4, 4, 4}, {4, 8, 8}),
+        std::invalid_argument);
+}
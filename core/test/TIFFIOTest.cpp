@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 #include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
 
 #include "vc/core/io/TIFFIO.hpp"
 
@@ -13,6 +17,12 @@
 #include "vc/core/util/Logging.hpp"
 #include "vc/testing/TestingUtils.hpp"
 
+// Wrapping in a namespace to avoid define collisions
+namespace lt
+{
+#include <tiffio.h>
+}
+
 using namespace volcart;
 using namespace volcart::tiffio;
 using namespace volcart::testing;
@@ -540,6 +550,71 @@ TEST(TIFFIO, WriteRead32FC4)
     EXPECT_TRUE(equal);
 }
 
+//// Compression tests ////
+TEST(TIFFIO, CompressionNames)
+{
+    for (const auto c :
+         {Compression::NONE, Compression::LZW, Compression::ADOBE_DEFLATE,
+          Compression::ZSTD, Compression::LZMA}) {
+        EXPECT_EQ(CompressionFromName(CompressionName(c)), c);
+    }
+    EXPECT_EQ(CompressionName(Compression::ZSTD), "zstd");
+    EXPECT_THROW(CompressionName(Compression::JPEG), std::invalid_argument);
+    EXPECT_THROW(CompressionFromName("foo"), std::invalid_argument);
+}
+
+TEST(TIFFIO, WriteReadPredictors)
+{
+    cv::Mat img16(::TEST_IMG_SIZE, CV_16UC1);
+    ::FillRandom<std::uint16_t, 1>(img16);
+    cv::Mat img32(::TEST_IMG_SIZE, CV_32FC1);
+    ::FillRandom<float, 1>(img32);
+
+    const fs::path imgPath("vc_core_TIFFIO_WriteReadPredictors.tif");
+    for (const auto c : {Compression::LZW, Compression::ADOBE_DEFLATE,
+                         Compression::ZSTD, Compression::LZMA}) {
+        if (not IsCompressionSupported(c)) {
+            continue;
+        }
+        WriteTIFF(imgPath, img16, c, 0, Predictor::HORIZONTAL);
+        auto result = ReadTIFF(imgPath);
+        EXPECT_EQ(result.type(), img16.type());
+        EXPECT_EQ(cv::countNonZero(result != img16), 0);
+
+        WriteTIFF(imgPath, img32, c, 0, Predictor::FLOATINGPOINT);
+        result = ReadTIFF(imgPath);
+        EXPECT_EQ(result.type(), img32.type());
+        EXPECT_EQ(cv::countNonZero(result != img32), 0);
+    }
+}
+
+TEST(TIFFIO, WriteReadZSTD)
+{
+    if (not IsCompressionSupported(Compression::ZSTD)) {
+        GTEST_SKIP() << "libtiff was built without ZSTD";
+    }
+    cv::Mat img(::TEST_IMG_SIZE, CV_16UC1);
+    ::FillRandom<std::uint16_t, 1>(img);
+
+    const fs::path imgPath("vc_core_TIFFIO_WriteReadZSTD.tif");
+    WriteTIFF(imgPath, img, Compression::ZSTD, 16, Predictor::HORIZONTAL);
+    auto result = ReadTIFF(imgPath);
+    EXPECT_EQ(result.type(), img.type());
+    EXPECT_EQ(cv::countNonZero(result != img), 0);
+}
+
+TEST(TIFFIO, WriteUnsupportedPredictor)
+{
+    // PackBits does not support predictors
+    cv::Mat img(::TEST_IMG_SIZE, CV_16UC1);
+    ::FillRandom<std::uint16_t, 1>(img);
+    const fs::path imgPath("vc_core_TIFFIO_WriteUnsupportedPredictor.tif");
+    EXPECT_THROW(
+        WriteTIFF(
+            imgPath, img, Compression::PACKBITS, 0, Predictor::HORIZONTAL),
+        IOException);
+}
+
 //// Memory mapping tests ////
 #if (VC_MEMMAP_SUPPORTED == true)
 TEST(TIFFIO, WriteRead16UC1MMap)
@@ -614,6 +689,34 @@ TEST(TIFFIO, CannotWriteToMMap)
     clone = cv::Scalar(0);
 }
 
+TEST(TIFFIO, MemMapMultipleStrips)
+{
+    using ElemT = std::uint8_t;
+    using PixelT = ElemT;
+    constexpr auto cvType = CV_8UC1;
+
+    cv::Mat img(300, 200, cvType);
+    ::FillRandom<ElemT, 1>(img);
+
+    // OpenCV writes uncompressed images as many contiguous strips
+    const fs::path imgPath("vc_core_TIFFIO_MemMapMultipleStrips.tif");
+    const std::vector<int> params{cv::IMWRITE_TIFF_COMPRESSION, 1};
+    cv::imwrite(imgPath.string(), img, params);
+
+    mmap_info mmap_info;
+    auto result = ReadTIFF(imgPath, &mmap_info);
+    EXPECT_TRUE(mmap_info);
+    EXPECT_EQ(result.size, img.size);
+    EXPECT_EQ(result.type(), img.type());
+
+    const auto equal = std::equal(
+        result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
+    EXPECT_TRUE(equal);
+    EXPECT_EQ(AdviseMemory(mmap_info, MemoryAdvice::Sequential), 0);
+
+    UnmapFile(mmap_info);
+}
+
 TEST(TIFFIO, MemMapUnsupportedType)
 {
     using ElemT = std::uint8_t;
@@ -668,4 +771,175 @@ TEST(TIFFIO, MemMapUnsupportedPlatform)
         result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
     EXPECT_TRUE(equal);
 }
-#endif
\ No newline at end of file
+#endif
+
+TEST(TIFFIO, TiledWriter)
+{
+    using ElemT = std::uint16_t;
+    using PixelT = ElemT;
+    constexpr auto cvType = CV_16UC1;
+
+    cv::Mat img(100, 70, cvType);
+    ::FillRandom<ElemT, 1>(img);
+
+    // Write every region except the top-left, in reverse order
+    const fs::path imgPath("vc_core_TIFFIO_TiledWriter.tif");
+    {
+        TiledTIFFWriter writer(imgPath, img.cols, img.rows, cvType, 32);
+        for (auto y = 64; y >= 0; y -= 64) {
+            for (auto x = 64; x >= 0; x -= 64) {
+                if (x == 0 and y == 0) {
+                    continue;
+                }
+                const cv::Rect r(
+                    x, y, std::min(64, img.cols - x),
+                    std::min(64, img.rows - y));
+                writer.write(img(r), x, y);
+            }
+        }
+        writer.close();
+    }
+    img(cv::Rect(0, 0, 64, 64)) = 0;
+
+    auto result = cv::imread(imgPath.string(), cv::IMREAD_UNCHANGED);
+    EXPECT_EQ(result.size, img.size);
+    EXPECT_EQ(result.type(), img.type());
+
+    const auto equal = std::equal(
+        result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
+    EXPECT_TRUE(equal);
+}
+
+TEST(TIFFIO, TiledWriterInvalidRegion)
+{
+    const fs::path imgPath("vc_core_TIFFIO_TiledWriterInvalidRegion.tif");
+    EXPECT_THROW(
+        TiledTIFFWriter(imgPath, 100, 100, CV_8UC1, 20), IOException);
+
+    TiledTIFFWriter writer(imgPath, 100, 100, CV_8UC1, 32);
+    const cv::Mat tile = cv::Mat::zeros(32, 32, CV_8UC1);
+    EXPECT_THROW(writer.write(tile, 16, 0), IOException);
+    EXPECT_THROW(writer.write(tile, 96, 0), IOException);
+    EXPECT_THROW(writer.write(tile(cv::Rect(0, 0, 20, 32)), 0, 0), IOException);
+    EXPECT_THROW(
+        writer.write(cv::Mat::zeros(32, 32, CV_16UC1), 0, 0), IOException);
+    EXPECT_NO_THROW(writer.write(tile(cv::Rect(0, 0, 4, 32)), 96, 0));
+}
+
+TEST(TIFFIO, WriteReadTiled)
+{
+    using ElemT = std::uint8_t;
+    using PixelT = cv::Vec<ElemT, 3>;
+    constexpr auto cvType = CV_8UC3;
+
+    cv::Mat img(70, 100, cvType);
+    ::FillRandom<ElemT, 3>(img);
+
+    const fs::path imgPath("vc_core_TIFFIO_WriteReadTiled.tif");
+    WriteTIFF(imgPath, img, Compression::LZW, 32);
+    auto result = ReadTIFF(imgPath);
+
+    EXPECT_EQ(result.size, img.size);
+    EXPECT_EQ(result.type(), img.type());
+
+    const auto equal = std::equal(
+        result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
+    EXPECT_TRUE(equal);
+}
+
+TEST(TIFFIO, ReadRegion)
+{
+    using ElemT = std::uint16_t;
+    using PixelT = ElemT;
+    constexpr auto cvType = CV_16UC1;
+
+    // Large enough to be split into several compressed strips, which are
+    // decoded in parallel
+    cv::Mat img(1024, 1024, cvType);
+    ::FillRandom<ElemT, 1>(img);
+
+    const fs::path stripPath("vc_core_TIFFIO_ReadRegion_Strips.tif");
+    const fs::path tilePath("vc_core_TIFFIO_ReadRegion_Tiles.tif");
+    const fs::path rawPath("vc_core_TIFFIO_ReadRegion_Raw.tif");
+    WriteTIFF(stripPath, img);
+    WriteTIFF(tilePath, img, Compression::LZW, 64);
+    WriteTIFF(rawPath, img, Compression::NONE);
+
+    const cv::Rect roi(70, 210, 300, 250);
+    for (const auto& path : {stripPath, tilePath, rawPath}) {
+        // Full reads
+        auto result = ReadTIFF(path);
+        EXPECT_EQ(result.size, img.size);
+        auto equal = std::equal(
+            result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
+        EXPECT_TRUE(equal);
+
+        // Region reads
+        result = ReadTIFF(path, roi);
+        ASSERT_EQ(result.size(), roi.size());
+        const cv::Mat expected = img(roi);
+        equal = std::equal(
+            result.begin<PixelT>(), result.end<PixelT>(),
+            expected.begin<PixelT>());
+        EXPECT_TRUE(equal);
+
+        // Regions are clipped to the image
+        result = ReadTIFF(path, {974, 1004, 100, 100});
+        EXPECT_EQ(result.size(), cv::Size(50, 20));
+        EXPECT_THROW(ReadTIFF(path, {1024, 0, 10, 10}), IOException);
+    }
+}
+
+TEST(TIFFIO, ReadSeparatePlanes)
+{
+    using PixelT = cv::Vec3b;
+    constexpr std::uint32_t rowsPerStrip{16};
+
+    // WriteTIFF only writes contiguous images, so write the planes with libtiff
+    cv::Mat img(512, 1024, CV_8UC3);
+    ::FillRandom<std::uint8_t, 3>(img);
+    const fs::path path("vc_core_TIFFIO_ReadSeparatePlanes.tif");
+    auto* tif = lt::TIFFOpen(path.c_str(), "w");
+    ASSERT_NE(tif, nullptr);
+    lt::TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, img.cols);
+    lt::TIFFSetField(tif, TIFFTAG_IMAGELENGTH, img.rows);
+    lt::TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 3);
+    lt::TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
+    lt::TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT);
+    lt::TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+    lt::TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_SEPARATE);
+    lt::TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+    lt::TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+    // Planes are stored in RGB order
+    std::vector<cv::Mat> planes;
+    cv::split(img, planes);
+    std::reverse(planes.begin(), planes.end());
+    for (std::size_t p = 0; p < planes.size(); p++) {
+        for (int row = 0; row < planes[p].rows; row++) {
+            ASSERT_EQ(
+                lt::TIFFWriteScanline(
+                    tif, planes[p].ptr(row), static_cast<std::uint32_t>(row),
+                    static_cast<std::uint16_t>(p)),
+                1);
+        }
+    }
+    lt::TIFFClose(tif);
+
+    // Full reads
+    auto result = ReadTIFF(path);
+    ASSERT_EQ(result.type(), img.type());
+    ASSERT_EQ(result.size(), img.size());
+    auto equal = std::equal(
+        result.begin<PixelT>(), result.end<PixelT>(), img.begin<PixelT>());
+    EXPECT_TRUE(equal);
+
+    // Region reads
+    const cv::Rect roi(100, 37, 700, 300);
+    result = ReadTIFF(path, roi);
+    ASSERT_EQ(result.size(), roi.size());
+    const cv::Mat expected = img(roi);
+    equal = std::equal(
+        result.begin<PixelT>(), result.end<PixelT>(),
+        expected.begin<PixelT>());
+    EXPECT_TRUE(equal);
+}
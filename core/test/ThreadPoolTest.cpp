@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "vc/core/util/ThreadPool.hpp"
+
+using namespace volcart;
+
+TEST(ThreadPool, RunsEveryTask)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.numThreads(), 4);
+
+    constexpr std::size_t numTasks{1000};
+    std::vector<std::atomic<int>> runs(numTasks);
+    for (std::size_t i = 0; i < numTasks; i++) {
+        pool.submit([&runs, i]() { runs[i]++; });
+    }
+    pool.wait();
+    EXPECT_EQ(pool.pending(), 0);
+    for (const auto& r : runs) {
+        EXPECT_EQ(r, 1);
+    }
+}
+
+TEST(ThreadPool, SingleThreadIsOrdered)
+{
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.numThreads(), 1);
+
+    std::vector<int> order;
+    for (int i = 0; i < 100; i++) {
+        pool.submit([&order, i]() { order.push_back(i); });
+    }
+    pool.wait();
+    ASSERT_EQ(order.size(), 100);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(ThreadPool, ClearDiscardsQueuedTasks)
+{
+    ThreadPool pool(1);
+    std::promise<void> start;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> runs{0};
+
+    // Block the only worker so that the other tasks stay queued
+    pool.submit([&start, released, &runs]() {
+        start.set_value();
+        released.wait();
+        runs++;
+    });
+    start.get_future().wait();
+    for (int i = 0; i < 10; i++) {
+        pool.submit([&runs]() { runs++; });
+    }
+    EXPECT_EQ(pool.pending(), 11);
+
+    pool.clear();
+    EXPECT_EQ(pool.pending(), 1);
+    release.set_value();
+    pool.wait();
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(ThreadPool, ExceptionsDoNotStopWorkers)
+{
+    ThreadPool pool(2);
+    std::atomic<int> runs{0};
+    for (int i = 0; i < 10; i++) {
+        pool.submit([]() { throw std::runtime_error("task failed"); });
+        pool.submit([&runs]() { runs++; });
+    }
+    pool.wait();
+    EXPECT_EQ(runs, 10);
+}
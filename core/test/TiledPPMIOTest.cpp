@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "vc/core/io/TiledPPMIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
+#include "vc/core/types/PerPixelMap.hpp"
+
+using namespace volcart;
+using namespace volcart::io;
+
+namespace
+{
+constexpr int TEST_HEIGHT{50};
+constexpr int TEST_WIDTH{37};
+
+// Build a PPM with a diagonal band of mapped pixels
+auto MakePPM() -> PerPixelMap
+{
+    PerPixelMap ppm(TEST_HEIGHT, TEST_WIDTH);
+    cv::Mat mask = cv::Mat::zeros(TEST_HEIGHT, TEST_WIDTH, CV_8UC1);
+    cv::Mat cellMap(TEST_HEIGHT, TEST_WIDTH, CV_32SC1, cv::Scalar::all(-1));
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            if (x + 5 < y or x > y + 10) {
+                continue;
+            }
+            const auto dx = static_cast<double>(x);
+            const auto dy = static_cast<double>(y);
+            ppm(y, x) = {dx + 0.25, dy + 0.5, dx * dy, 0, 0.6, 0.8};
+            mask.at<std::uint8_t>(y, x) = 255;
+            cellMap.at<std::int32_t>(y, x) = x + y;
+        }
+    }
+    ppm.setMask(mask);
+    ppm.setCellMap(cellMap);
+    return ppm;
+}
+
+void ExpectRegionEqual(
+    const PerPixelMap& expected, const PerPixelMap& result, const cv::Rect& r)
+{
+    ASSERT_EQ(result.height(), r.height);
+    ASSERT_EQ(result.width(), r.width);
+    for (auto y = 0; y < r.height; y++) {
+        for (auto x = 0; x < r.width; x++) {
+            EXPECT_EQ(result(y, x), expected(r.y + y, r.x + x));
+        }
+    }
+    cv::Mat diff = expected.mask()(r) != result.mask();
+    EXPECT_EQ(cv::countNonZero(diff), 0);
+    diff = expected.cellMap()(r) != result.cellMap();
+    EXPECT_EQ(cv::countNonZero(diff), 0);
+}
+}  // namespace
+
+TEST(TiledPPMIO, WriteReadTiles)
+{
+    const auto ppm = ::MakePPM();
+    const std::string path{"vc_core_TiledPPMIO_WriteReadTiles.tppm"};
+    TiledPPMOptions opts;
+    opts.tileSize = 16;
+    EXPECT_NO_THROW(WriteTiledPPM(path, ppm, opts));
+    EXPECT_TRUE(IsTiledPPM(path));
+
+    TiledPPMReader reader(path);
+    EXPECT_EQ(reader.height(), TEST_HEIGHT);
+    EXPECT_EQ(reader.width(), TEST_WIDTH);
+    EXPECT_EQ(reader.numMappings(), ppm.numMappings());
+    EXPECT_EQ(reader.numTiles(), 4 * 3);
+    EXPECT_EQ(reader.options().tileSize, 16);
+    EXPECT_FALSE(reader.options().float32);
+
+    std::size_t mappings{0};
+    for (std::size_t t = 0; t < reader.numTiles(); t++) {
+        const auto rect = reader.tileRect(t);
+        ::ExpectRegionEqual(ppm, reader.readTile(t), rect);
+        EXPECT_EQ(
+            reader.tileMappings(t), cv::countNonZero(ppm.mask()(rect)));
+        mappings += reader.tileMappings(t);
+    }
+    EXPECT_EQ(mappings, ppm.numMappings());
+
+    // Edge tiles are clipped to the map
+    EXPECT_EQ(reader.tileRect(11), cv::Rect(32, 48, 5, 2));
+}
+
+TEST(TiledPPMIO, ReadRegion)
+{
+    const auto ppm = ::MakePPM();
+    const std::string path{"vc_core_TiledPPMIO_ReadRegion.tppm"};
+    TiledPPMOptions opts;
+    opts.tileSize = 8;
+    WriteTiledPPM(path, ppm, opts);
+
+    TiledPPMReader reader(path);
+    const cv::Rect roi(5, 3, 20, 30);
+    ::ExpectRegionEqual(ppm, reader.readRegion(roi), roi);
+
+    // Regions are clipped to the map
+    const auto clipped = reader.readRegion({30, 40, 20, 20});
+    ::ExpectRegionEqual(ppm, clipped, {30, 40, 7, 10});
+    EXPECT_THROW(
+        static_cast<void>(reader.readRegion({40, 0, 5, 5})),
+        std::out_of_range);
+}
+
+TEST(TiledPPMIO, Float32)
+{
+    const auto ppm = ::MakePPM();
+    const std::string path{"vc_core_TiledPPMIO_Float32.tppm"};
+    TiledPPMOptions opts;
+    opts.tileSize = 16;
+    opts.float32 = true;
+    WriteTiledPPM(path, ppm, opts);
+
+    TiledPPMReader reader(path);
+    EXPECT_TRUE(reader.options().float32);
+    const auto result = reader.readRegion({0, 0, TEST_WIDTH, TEST_HEIGHT});
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            for (int i = 0; i < 6; i++) {
+                EXPECT_FLOAT_EQ(result(y, x)[i], ppm(y, x)[i]);
+            }
+        }
+    }
+}
+
+TEST(TiledPPMIO, WriterUnwrittenTiles)
+{
+    const std::string path{"vc_core_TiledPPMIO_WriterUnwrittenTiles.tppm"};
+    {
+        TiledPPMWriter writer(path, 20, 20, {10, false, true, false});
+        ASSERT_EQ(writer.numTiles(), 4);
+
+        // Write only the last tile, without a mask
+        PerPixelMap tile(10, 10);
+        tile(2, 3) = {1, 2, 3, 4, 5, 6};
+        writer.writeTile(3, tile);
+        EXPECT_THROW(writer.writeTile(0, PerPixelMap(5, 5)), IOException);
+    }
+
+    TiledPPMReader reader(path);
+    EXPECT_EQ(reader.numMappings(), 100);
+    EXPECT_FALSE(reader.options().cellMap);
+    const auto result = reader.readRegion({0, 0, 20, 20});
+    EXPECT_TRUE(result.cellMap().empty());
+    EXPECT_EQ(result.numMappings(), 100);
+    EXPECT_FALSE(result.hasMapping(0, 0));
+    EXPECT_TRUE(result.hasMapping(12, 13));
+    EXPECT_EQ(result(12, 13), cv::Vec6d(1, 2, 3, 4, 5, 6));
+}
+
+TEST(TiledPPMIO, PerPixelMapReadWrite)
+{
+    const auto ppm = ::MakePPM();
+    const std::string path{"vc_core_TiledPPMIO_PerPixelMapReadWrite.tppm"};
+    PerPixelMap::WritePPM(path, ppm);
+    EXPECT_TRUE(IsTiledPPM(path));
+
+    const auto result = PerPixelMap::ReadPPM(path);
+    ::ExpectRegionEqual(ppm, result, {0, 0, TEST_WIDTH, TEST_HEIGHT});
+}
+
+TEST(TiledPPMIO, NotTiled)
+{
+    const auto ppm = ::MakePPM();
+    const std::string path{"vc_core_TiledPPMIO_NotTiled.ppm"};
+    PerPixelMap::WritePPM(path, ppm);
+    EXPECT_FALSE(IsTiledPPM(path));
+    EXPECT_THROW(TiledPPMReader{path}, IOException);
+}
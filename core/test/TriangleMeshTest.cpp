@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/shapes/Arch.hpp"
+#include "vc/core/types/TriangleMesh.hpp"
+#include "vc/core/util/MeshMath.hpp"
+
+using namespace volcart;
+
+TEST(TriangleMesh, FromITKMesh)
+{
+    const auto itkMesh = shapes::Arch().itkMesh();
+    const auto mesh = TriangleMesh::FromITKMesh(itkMesh);
+
+    EXPECT_EQ(mesh->numVertices(), itkMesh->GetNumberOfPoints());
+    EXPECT_EQ(mesh->numFaces(), itkMesh->GetNumberOfCells());
+    EXPECT_TRUE(mesh->hasNormals());
+    EXPECT_FALSE(mesh->hasUVs());
+
+    for (std::size_t i = 0; i < mesh->numVertices(); i++) {
+        const auto p = itkMesh->GetPoint(i);
+        ITKPixel n;
+        itkMesh->GetPointData(i, &n);
+        EXPECT_EQ(mesh->vertices()[i], cv::Vec3d(p[0], p[1], p[2]));
+        EXPECT_EQ(mesh->normals()[i], cv::Vec3d(n[0], n[1], n[2]));
+    }
+
+    for (auto cell = itkMesh->GetCells()->Begin();
+         cell != itkMesh->GetCells()->End(); ++cell) {
+        const auto& f = mesh->faces()[cell.Index()];
+        for (std::size_t v = 0; v < 3; v++) {
+            EXPECT_EQ(f[v], cell.Value()->GetPointIds()[v]);
+        }
+    }
+
+    EXPECT_DOUBLE_EQ(
+        meshmath::SurfaceArea(*mesh), meshmath::SurfaceArea(itkMesh));
+}
+
+TEST(TriangleMesh, ToITKMesh)
+{
+    const auto itkMesh = shapes::Arch().itkMesh();
+    const auto mesh = TriangleMesh::FromITKMesh(itkMesh);
+    const auto result = mesh->toITKMesh();
+    const auto roundTrip = TriangleMesh::FromITKMesh(result);
+
+    EXPECT_EQ(result->GetNumberOfPoints(), itkMesh->GetNumberOfPoints());
+    EXPECT_EQ(result->GetNumberOfCells(), itkMesh->GetNumberOfCells());
+    EXPECT_EQ(roundTrip->vertices(), mesh->vertices());
+    EXPECT_EQ(roundTrip->normals(), mesh->normals());
+    EXPECT_EQ(roundTrip->faces(), mesh->faces());
+}
+
+TEST(TriangleMesh, UVs)
+{
+    const auto itkMesh = shapes::Arch().itkMesh();
+    auto uvMap = UVMap::New();
+    for (std::size_t i = 0; i < itkMesh->GetNumberOfPoints(); i += 2) {
+        uvMap->set(i, {0.5, static_cast<double>(i % 7) / 7.0});
+    }
+
+    const auto mesh = TriangleMesh::FromITKMesh(itkMesh, uvMap);
+    EXPECT_TRUE(mesh->hasUVs());
+    EXPECT_EQ(mesh->uvs()[0], uvMap->get(0));
+    EXPECT_EQ(mesh->uvs()[1], NULL_MAPPING);
+    EXPECT_EQ(mesh->uvs()[2], uvMap->get(2));
+}
+
+TEST(TriangleMesh, Construct)
+{
+    TriangleMesh mesh({{0, 0, 0}, {1, 0, 0}, {0, 1, 0}}, {{0, 1, 2}});
+    EXPECT_EQ(mesh.numVertices(), 3);
+    EXPECT_EQ(mesh.numFaces(), 1);
+    EXPECT_FALSE(mesh.hasNormals());
+    EXPECT_DOUBLE_EQ(meshmath::SurfaceArea(mesh), 0.5);
+
+    mesh.clear();
+    EXPECT_TRUE(mesh.empty());
+    EXPECT_EQ(mesh.numFaces(), 0);
+}
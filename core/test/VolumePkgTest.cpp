@@ -164,4 +164,23 @@ TEST(VolumePkg, TransformByComplexPath)
     EXPECT_EQ(tfms[1].first, idI);
     EXPECT_EQ(tfms[2].first, id2 + "->" + id3 + "->" + id4);
     EXPECT_EQ(tfms[3].first, id6 + "->" + id7 + "->" + id8);
-}
\ No newline at end of file
+}
+
+TEST(VolumePkg, RemoveVolume)
+{
+    fs::path p("RemoveVolume.volpkg");
+    fs::remove_all(p);
+    auto vpkg = VolumePkg::New(p, VOLPKG_VERSION_LATEST);
+    const auto volume = vpkg->newVolume("remove");
+    const auto id = volume->id();
+    const auto volDir = volume->path();
+    ASSERT_TRUE(vpkg->hasVolume(id));
+
+    EXPECT_TRUE(vpkg->removeVolume(id));
+    EXPECT_FALSE(vpkg->hasVolume(id));
+    EXPECT_FALSE(vpkg->hasVolumes());
+    EXPECT_FALSE(fs::exists(volDir));
+
+    EXPECT_FALSE(vpkg->removeVolume(id));
+    EXPECT_FALSE(vpkg->removeVolume(""));
+}
@@ -0,0 +1,511 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/Volume.hpp"
+
+using namespace volcart;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+constexpr int TEST_EXTENT{8};
+
+// Linear intensity field, which trilinear interpolation reproduces exactly
+auto Field(double x, double y, double z) -> double
+{
+    return x + 10 * y + 100 * z;
+}
+
+auto MakeSliceVolume(const fs::path& path) -> Volume::Pointer
+{
+    fs::remove_all(path);
+    fs::create_directories(path);
+    auto vol = Volume::New(path, "slices", "Slices");
+    vol->setSliceWidth(TEST_EXTENT);
+    vol->setSliceHeight(TEST_EXTENT);
+    vol->setNumberOfSlices(TEST_EXTENT);
+    for (int z = 0; z < TEST_EXTENT; z++) {
+        cv::Mat slice(TEST_EXTENT, TEST_EXTENT, CV_16UC1);
+        for (int y = 0; y < TEST_EXTENT; y++) {
+            for (int x = 0; x < TEST_EXTENT; x++) {
+                slice.at<std::uint16_t>(y, x) =
+                    static_cast<std::uint16_t>(Field(x, y, z));
+            }
+        }
+        vol->setSliceData(z, slice);
+    }
+    return vol;
+}
+
+auto MakeChunkVolume(const fs::path& path) -> Volume::Pointer
+{
+    constexpr int chunkSize{4};
+    fs::remove_all(path);
+    fs::create_directories(path);
+    auto vol = Volume::New(path, "chunks", "Chunks");
+    vol->setSliceWidth(TEST_EXTENT);
+    vol->setSliceHeight(TEST_EXTENT);
+    vol->setNumberOfSlices(TEST_EXTENT);
+    vol->setChunkSize(chunkSize);
+    vol->setStorageFormat(Volume::StorageFormat::Chunks);
+
+    const std::array<int, 3> extents{chunkSize, chunkSize, chunkSize};
+    const auto grid = vol->chunkGridExtents();
+    for (int cz = 0; cz < grid[2]; cz++) {
+        for (int cy = 0; cy < grid[1]; cy++) {
+            for (int cx = 0; cx < grid[0]; cx++) {
+                cv::Mat chunk(3, extents.data(), CV_16UC1);
+                for (int z = 0; z < chunkSize; z++) {
+                    for (int y = 0; y < chunkSize; y++) {
+                        for (int x = 0; x < chunkSize; x++) {
+                            chunk.at<std::uint16_t>(z, y, x) =
+                                static_cast<std::uint16_t>(Field(
+                                    cx * chunkSize + x, cy * chunkSize + y,
+                                    cz * chunkSize + z));
+                        }
+                    }
+                }
+                vol->setChunkData({cx, cy, cz}, chunk);
+            }
+        }
+    }
+    return vol;
+}
+
+auto TestPoints() -> std::vector<cv::Vec3d>
+{
+    return {
+        {0, 0, 0},        {1, 2, 3},       {1.25, 2.5, 3.5}, {0.25, 6.75, 2},
+        {6.25, 0.5, 6.5}, {3.1, 3.9, 4.2}, {-1, 0, 0},       {0, 0, 8},
+        {8.5, 1, 1},      {2.2, 1.7, -0.5},
+    };
+}
+
+void ExpectInterpolation(const Volume::Pointer& vol)
+{
+    const auto pts = TestPoints();
+    const auto batch = vol->interpolateAt(pts);
+    ASSERT_EQ(batch.size(), pts.size());
+
+    for (std::size_t i = 0; i < pts.size(); i++) {
+        const auto& p = pts[i];
+        // Batch and single lookups match
+        EXPECT_EQ(batch[i], vol->interpolateAt(p));
+
+        // Out of bounds is 0, interior points match the linear field
+        if (not vol->isInBounds(p)) {
+            EXPECT_EQ(batch[i], 0);
+        } else if (
+            p[0] <= TEST_EXTENT - 1 and p[1] <= TEST_EXTENT - 1 and
+            p[2] <= TEST_EXTENT - 1) {
+            EXPECT_EQ(batch[i], cvRound(Field(p[0], p[1], p[2])));
+        }
+    }
+}
+}  // namespace
+
+TEST(Volume, InterpolateSlices)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_InterpolateSlices");
+    ::ExpectInterpolation(vol);
+}
+
+TEST(Volume, InterpolateChunks)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_InterpolateChunks");
+    ::ExpectInterpolation(vol);
+}
+
+TEST(Volume, SetChunkDataChecks)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_SetChunkDataChecks");
+    const auto cs = vol->chunkSize();
+    const std::array<int, 3> extents{cs, cs, cs};
+    EXPECT_THROW(
+        vol->setChunkData({0, 0, 0}, cv::Mat(3, extents.data(), CV_32FC1)),
+        std::invalid_argument);
+    EXPECT_THROW(
+        vol->setChunkData({0, 0, 0}, cv::Mat(3, extents.data(), CV_8UC1)),
+        std::invalid_argument);
+    const std::array<int, 3> small{cs, cs, cs - 1};
+    EXPECT_THROW(
+        vol->setChunkData({0, 0, 0}, cv::Mat(3, small.data(), CV_16UC1)),
+        std::invalid_argument);
+}
+
+TEST(Volume, InterpolateLargeBatch)
+{
+    // Enough positions for several groups, spread over every slice and chunk,
+    // with caches which can't hold all of them
+    std::vector<cv::Vec3d> pts;
+    for (int i = 0; i < 10000; i++) {
+        pts.emplace_back(
+            (i * 7) % TEST_EXTENT + 0.25, (i * 5) % TEST_EXTENT + 0.5,
+            (i * 3) % TEST_EXTENT + 0.75);
+    }
+    auto slices = ::MakeSliceVolume("vc_core_Volume_InterpolateLargeBatch_S");
+    slices->setCacheCapacity(2);
+    auto chunks = ::MakeChunkVolume("vc_core_Volume_InterpolateLargeBatch_C");
+    chunks->setChunkCacheCapacity(2);
+    for (const auto& vol : {slices, chunks}) {
+        const auto batch = vol->interpolateAt(pts);
+        ASSERT_EQ(batch.size(), pts.size());
+        for (std::size_t i = 0; i < pts.size(); i++) {
+            EXPECT_EQ(batch[i], vol->interpolateAt(pts[i]));
+        }
+    }
+}
+
+TEST(Volume, Reslice)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_Reslice");
+    auto r = vol->reslice({4, 4, 4}, {1, 0, 0}, {0, 1, 0}, 4, 4);
+    const auto img = r.sliceData();
+    ASSERT_EQ(img.rows, 4);
+    ASSERT_EQ(img.cols, 4);
+    for (int y = 0; y < img.rows; y++) {
+        for (int x = 0; x < img.cols; x++) {
+            EXPECT_EQ(
+                img.at<std::uint16_t>(y, x), cvRound(Field(2 + x, 2 + y, 4)));
+        }
+    }
+}
+
+TEST(Volume, MemoryMapCounts)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_MemoryMapCounts");
+    vol->setMemoryMapAdvice(MemoryAdvice::Random);
+    EXPECT_EQ(vol->memoryMapAdvice(), MemoryAdvice::Random);
+
+    // Compressed slices are decoded into memory
+    static_cast<void>(vol->getSliceData(0));
+    EXPECT_EQ(vol->getMemoryMapHits(), 0);
+    EXPECT_EQ(vol->getMemoryMapMisses(), 1);
+
+    // Uncompressed slices are mapped
+    vol->setSliceData(1, vol->getSliceDataCopy(0), false);
+    const auto slice = vol->getSliceData(1);
+    EXPECT_EQ(vol->getMemoryMapHits(), VC_MEMMAP_SUPPORTED ? 1 : 0);
+    EXPECT_EQ(vol->getMemoryMapMisses(), VC_MEMMAP_SUPPORTED ? 1 : 2);
+    EXPECT_EQ(cv::countNonZero(slice != vol->getSliceData(0)), 0);
+}
+
+TEST(Volume, MemoryMapAdvice)
+{
+    const fs::path path{"vc_core_Volume_MemoryMapAdvice"};
+    {
+        auto vol = ::MakeSliceVolume(path);
+        for (int z = 0; z < TEST_EXTENT; z++) {
+            vol->setSliceData(z, vol->getSliceDataCopy(z), false);
+        }
+        vol->saveMetadata();
+    }
+
+    // Reopen so that the writes above aren't part of the read history
+    auto vol = Volume::New(path);
+    vol->setPrefetchThreads(0);
+    vol->setPrefetchDepth(2);
+    EXPECT_FALSE(vol->memoryMapAdvice());
+    EXPECT_EQ(vol->getLastMemoryMapAdvice(), MemoryAdvice::Normal);
+    if (not VC_MEMMAP_SUPPORTED) {
+        GTEST_SKIP() << "Memory mapping is not supported";
+    }
+
+    // Isolated reads are random
+    static_cast<void>(vol->getSliceData(0));
+    EXPECT_EQ(vol->getLastMemoryMapAdvice(), MemoryAdvice::Random);
+
+    // A sequential scan is advised as sequential
+    for (int z = 1; z < TEST_EXTENT / 2; z++) {
+        static_cast<void>(vol->getSliceData(z));
+    }
+    EXPECT_EQ(vol->getLastMemoryMapAdvice(), MemoryAdvice::Sequential);
+
+    // A jump resets the read direction
+    static_cast<void>(vol->getSliceData(TEST_EXTENT - 1));
+    EXPECT_EQ(vol->getLastMemoryMapAdvice(), MemoryAdvice::Random);
+
+    // The override replaces the automatic advice
+    vol->setMemoryMapAdvice(MemoryAdvice::Normal);
+    static_cast<void>(vol->getSliceData(TEST_EXTENT - 2));
+    EXPECT_EQ(vol->getLastMemoryMapAdvice(), MemoryAdvice::Normal);
+}
+
+TEST(Volume, SliceCompression)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_SliceCompression");
+    EXPECT_EQ(vol->sliceCompression(), tiffio::Compression::LZW);
+    EXPECT_FALSE(vol->slicePredictor());
+    EXPECT_THROW(
+        vol->setSliceCompression(tiffio::Compression::JPEG),
+        std::invalid_argument);
+
+    const auto expected = vol->getSliceDataCopy(0);
+    vol->setSliceCompression(tiffio::Compression::ADOBE_DEFLATE);
+    vol->saveMetadata();
+    vol->setSliceData(0, expected);
+
+    // The codec is stored in the metadata
+    auto loaded = Volume::New(vol->path());
+    EXPECT_EQ(loaded->sliceCompression(), tiffio::Compression::ADOBE_DEFLATE);
+    EXPECT_TRUE(loaded->slicePredictor());
+    EXPECT_EQ(cv::countNonZero(loaded->getSliceData(0) != expected), 0);
+}
+
+TEST(Volume, Prefetch)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_Prefetch");
+    vol->setPrefetchDepth(0);
+    EXPECT_EQ(vol->prefetchThreads(), Volume::DEFAULT_PREFETCH_THREADS);
+
+    vol->prefetch(2, 5);
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), 4);
+    EXPECT_EQ(vol->intensityAt(3, 4, 5), Field(3, 4, 5));
+
+    // Ranges are clamped to the Volume
+    vol->prefetch(-10, 100);
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), TEST_EXTENT);
+
+    // Disabled
+    vol->cachePurge();
+    vol->setPrefetchThreads(0);
+    vol->prefetch(0, TEST_EXTENT - 1);
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), 0);
+}
+
+TEST(Volume, PrefetchChunks)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_PrefetchChunks");
+    vol->setPrefetchDepth(0);
+
+    // Slices 5 and 6 are both in the second layer of chunks
+    vol->prefetch(5, 6);
+    vol->waitForPrefetch();
+    const auto grid = vol->chunkGridExtents();
+    EXPECT_EQ(
+        vol->getChunkCacheSize(), static_cast<std::size_t>(grid[0] * grid[1]));
+    EXPECT_EQ(vol->intensityAt(7, 6, 5), Field(7, 6, 5));
+}
+
+TEST(Volume, PrefetchChunkFootprint)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_PrefetchChunkFootprint");
+    vol->setPrefetchDepth(0);
+
+    // Only the chunks under recent reads are prefetched
+    EXPECT_EQ(vol->intensityAt(1, 2, 1), Field(1, 2, 1));
+    vol->prefetch(4, 7);
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getChunkCacheSize(), 2);
+
+    // Without reads, whole layers are prefetched, up to the cache capacity
+    vol = ::MakeChunkVolume("vc_core_Volume_PrefetchChunkFootprint_Layers");
+    vol->setPrefetchDepth(0);
+    const auto grid = vol->chunkGridExtents();
+    const auto layer = static_cast<std::size_t>(grid[0] * grid[1]);
+    vol->setChunkCacheCapacity(layer);
+    vol->prefetch(0, TEST_EXTENT - 1);
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getChunkCacheSize(), layer);
+}
+
+TEST(Volume, ChunkCache)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_ChunkCache");
+    vol->setPrefetchThreads(0);
+
+    // Voxel reads only cache the chunk they're in, and later reads share it
+    EXPECT_EQ(vol->intensityAt(1, 2, 3), Field(1, 2, 3));
+    EXPECT_EQ(vol->getChunkCacheSize(), 1);
+    const auto chunk = vol->getChunkData({0, 0, 0});
+    EXPECT_EQ(vol->getChunkData({0, 0, 0}).data, chunk.data);
+    EXPECT_EQ(vol->getChunkCacheSize(), 1);
+
+    // Slices cache the chunks of their layer
+    const auto grid = vol->chunkGridExtents();
+    const auto layer = static_cast<std::size_t>(grid[0] * grid[1]);
+    const auto slice = vol->getSliceData(5);
+    EXPECT_EQ(slice.at<std::uint16_t>(6, 7), Field(7, 6, 5));
+    EXPECT_EQ(vol->getChunkCacheSize(), layer + 1);
+
+    // Concurrent reads share the cache, which stays within its capacity
+    vol->setChunkCacheCapacity(2);
+    EXPECT_LE(vol->getChunkCacheSize(), 2U);
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> mismatches{0};
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&vol, &mismatches, t]() {
+            for (int i = 0; i < 1000; i++) {
+                const auto x = (i + t) % TEST_EXTENT;
+                const auto y = (i / TEST_EXTENT + t) % TEST_EXTENT;
+                const auto z = (i * 3 + t) % TEST_EXTENT;
+                if (vol->intensityAt(x, y, z) != Field(x, y, z)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_LE(vol->getChunkCacheSize(), 2U);
+
+    // Memory budgets are weighed by chunk size
+    const auto chunkBytes = chunk.total() * chunk.elemSize();
+    vol->setCacheMemoryInBytes(3 * chunkBytes);
+    EXPECT_EQ(vol->getCacheCapacity(), 3 * chunkBytes);
+    for (int z = 0; z < TEST_EXTENT; z++) {
+        vol->getSliceData(z);
+    }
+    EXPECT_LE(vol->getCacheMemoryUsage(), 3 * chunkBytes);
+    EXPECT_GT(vol->getCacheMemoryUsage(), 0U);
+
+    vol->cachePurge();
+    EXPECT_EQ(vol->getChunkCacheSize(), 0);
+}
+
+TEST(Volume, SequentialPrefetch)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_SequentialPrefetch");
+    vol->setPrefetchDepth(3);
+    EXPECT_EQ(vol->prefetchDepth(), 3);
+
+    // Sequential reads prefetch the next slices
+    for (int z = 0; z < 3; z++) {
+        static_cast<void>(vol->getSliceData(z));
+    }
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), 6);
+
+    // A jump is not sequential
+    vol->cachePurge();
+    static_cast<void>(vol->getSliceData(7));
+    static_cast<void>(vol->getSliceData(0));
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), 2);
+
+    // Neither is moving back and forth
+    static_cast<void>(vol->getSliceData(1));
+    static_cast<void>(vol->getSliceData(0));
+    static_cast<void>(vol->getSliceData(1));
+    vol->waitForPrefetch();
+    EXPECT_EQ(vol->getCacheSize(), 3);
+}
+
+TEST(Volume, Levels)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_Levels");
+    EXPECT_EQ(vol->numLevels(), 1);
+    vol->buildLevels(3, 2);
+    ASSERT_EQ(vol->numLevels(), 3);
+    EXPECT_EQ(vol->level(0), vol);
+    EXPECT_THROW(vol->level(3), std::out_of_range);
+
+    // Each level voxel is the mean of a block of voxels. For a linear field,
+    // that's the field at the center of the block, plus rounding.
+    for (int n = 1; n < vol->numLevels(); n++) {
+        const auto lvl = vol->level(n);
+        const auto scale = 1 << n;
+        const auto extent = TEST_EXTENT / scale;
+        EXPECT_EQ(lvl->storageFormat(), Volume::StorageFormat::Chunks);
+        ASSERT_EQ(lvl->sliceWidth(), extent);
+        ASSERT_EQ(lvl->sliceHeight(), extent);
+        ASSERT_EQ(lvl->numSlices(), extent);
+        const auto offset = (scale - 1) / 2.0;
+        for (int z = 0; z < extent; z++) {
+            for (int y = 0; y < extent; y++) {
+                for (int x = 0; x < extent; x++) {
+                    EXPECT_NEAR(
+                        lvl->intensityAt(x, y, z),
+                        Field(
+                            scale * x + offset, scale * y + offset,
+                            scale * z + offset),
+                        1);
+                }
+            }
+        }
+    }
+
+    // Levels are sampled in full-resolution coordinates
+    const std::vector<cv::Vec3d> pts{
+        {1.5, 2.5, 3.5}, {3.1, 3.9, 4.2}, {4.25, 1.75, 2}, {-1, 0, 0}};
+    const auto values = vol->interpolateAt(pts, 1);
+    for (std::size_t i = 0; i < pts.size(); i++) {
+        const auto& p = pts[i];
+        if (vol->isInBounds(p)) {
+            EXPECT_NEAR(values[i], Field(p[0], p[1], p[2]), 1);
+        } else {
+            EXPECT_EQ(values[i], 0);
+        }
+    }
+    const auto r = vol->reslice({4, 4, 4}, {1, 0, 0}, {0, 1, 0}, 4, 4, 2);
+    EXPECT_NEAR(r.sliceData().at<std::uint16_t>(1, 1), Field(3, 3, 4), 1);
+
+    // Levels are loaded from disk
+    auto loaded = Volume::New(vol->path());
+    ASSERT_EQ(loaded->numLevels(), 3);
+    EXPECT_EQ(loaded->interpolateAt(pts, 1), values);
+
+    // Levels can't be rebuilt while they're in use
+    auto held = vol->level(1);
+    EXPECT_THROW(vol->buildLevels(2), std::runtime_error);
+    EXPECT_EQ(vol->numLevels(), 3);
+    held.reset();
+
+    // Building a single level removes the others
+    vol->buildLevels(1);
+    EXPECT_EQ(vol->numLevels(), 1);
+    EXPECT_FALSE(fs::exists(vol->path() / "levels"));
+}
+
+TEST(Volume, LevelsShareCacheMemory)
+{
+    auto vol = ::MakeSliceVolume("vc_core_Volume_LevelsShareCacheMemory");
+    vol->buildLevels(3);
+
+    // The budget is split by voxel count: 512, 64 and 8 voxels
+    constexpr std::size_t budget{584 * 1000};
+    auto lvl1 = vol->level(1);
+    vol->setCacheMemoryInBytes(budget);
+    EXPECT_NEAR(vol->getCacheCapacity(), 512000, 1);
+    EXPECT_NEAR(lvl1->getCacheCapacity(), 64000, 1);
+
+    // Levels loaded later get their share too
+    EXPECT_NEAR(vol->level(2)->getCacheCapacity(), 8000, 1);
+
+    // So do rebuilt levels
+    lvl1.reset();
+    vol->buildLevels(2);
+    EXPECT_NEAR(vol->getCacheCapacity(), budget * 512.0 / 576, 1);
+    EXPECT_NEAR(vol->level(1)->getCacheCapacity(), budget * 64.0 / 576, 1);
+
+    // Count-based capacities stop the sharing
+    vol->setCacheCapacity(10);
+    vol->buildLevels(3);
+    EXPECT_EQ(vol->getCacheCapacity(), 10);
+    EXPECT_EQ(
+        vol->level(1)->getCacheCapacity(), Volume::DEFAULT_CHUNK_CAPACITY);
+}
+
+TEST(Volume, LevelsFromChunks)
+{
+    auto vol = ::MakeChunkVolume("vc_core_Volume_LevelsFromChunks");
+    vol->buildLevels(2);
+    const auto lvl = vol->level(1);
+    EXPECT_EQ(lvl->chunkSize(), vol->chunkSize());
+    EXPECT_NEAR(lvl->intensityAt(3, 2, 1), Field(6.5, 4.5, 2.5), 1);
+}
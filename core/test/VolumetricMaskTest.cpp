@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
+#include "vc/core/types/Exceptions.hpp"
+#include "vc/core/types/VolumetricMask.hpp"
+
+using namespace volcart;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+using VoxelSet = std::set<std::tuple<int, int, int>>;
+
+auto ToSet(const VolumetricMask& mask) -> VoxelSet
+{
+    VoxelSet result;
+    for (const auto& v : mask) {
+        result.emplace(v[0], v[1], v[2]);
+    }
+    return result;
+}
+
+// Voxels spread over several blocks, including negative coordinates
+auto MakeMask() -> VolumetricMask
+{
+    VolumetricMask mask;
+    for (int z = -20; z < 40; z += 7) {
+        for (int y = -3; y < 35; y += 5) {
+            for (int x = -17; x < 50; x += 3) {
+                mask.setIn({x, y, z});
+            }
+        }
+    }
+    return mask;
+}
+}  // namespace
+
+TEST(VolumetricMask, SetInSetOut)
+{
+    VolumetricMask mask;
+    EXPECT_TRUE(mask.empty());
+
+    mask.setIn({1, 2, 3});
+    mask.setIn({-1, -2, -3});
+    mask.setIn({1, 2, 3});
+    EXPECT_EQ(mask.size(), 2);
+    EXPECT_TRUE(mask.isIn(cv::Vec3i{1, 2, 3}));
+    EXPECT_TRUE(mask.isIn(cv::Vec3i{-1, -2, -3}));
+    EXPECT_TRUE(mask.isOut(cv::Vec3i{3, 2, 1}));
+    EXPECT_TRUE(mask.isOut(cv::Vec3i{15, -2, -3}));
+
+    // Sub-voxel positions round towards negative infinity
+    EXPECT_TRUE(mask.isIn(cv::Vec3d{1.9, 2.5, 3.1}));
+    EXPECT_TRUE(mask.isIn(cv::Vec3d{-0.5, -1.5, -2.1}));
+    EXPECT_TRUE(mask.isOut(cv::Vec3d{0.9, 2.5, 3.1}));
+
+    // Emptied blocks are released
+    mask.setOut({-1, -2, -3});
+    mask.setOut({100, 100, 100});
+    EXPECT_EQ(mask.size(), 1);
+    EXPECT_TRUE(mask.isOut(cv::Vec3i{-1, -2, -3}));
+    EXPECT_EQ(mask.blocks().size(), 1);
+
+    mask.clear();
+    EXPECT_TRUE(mask.empty());
+    EXPECT_EQ(mask.begin(), mask.end());
+}
+
+TEST(VolumetricMask, Iteration)
+{
+    const auto mask = ::MakeMask();
+    const auto voxels = ::ToSet(mask);
+    EXPECT_EQ(voxels.size(), mask.size());
+    EXPECT_EQ(mask.as_vector().size(), mask.size());
+    for (const auto& [x, y, z] : voxels) {
+        EXPECT_TRUE(mask.isIn(cv::Vec3i{x, y, z}));
+    }
+}
+
+TEST(VolumetricMask, SetInSlice)
+{
+    cv::Mat slice = cv::Mat::zeros(40, 50, CV_8UC1);
+    slice.at<std::uint8_t>(0, 0) = 255;
+    slice.at<std::uint8_t>(17, 33) = 1;
+    slice.at<std::uint8_t>(39, 49) = 128;
+
+    VolumetricMask mask;
+    mask.setIn(slice, 5);
+    EXPECT_EQ(mask.size(), 3);
+    EXPECT_TRUE(mask.isIn(cv::Vec3i{0, 0, 5}));
+    EXPECT_TRUE(mask.isIn(cv::Vec3i{33, 17, 5}));
+    EXPECT_TRUE(mask.isIn(cv::Vec3i{49, 39, 5}));
+    EXPECT_TRUE(mask.isOut(cv::Vec3i{17, 33, 5}));
+
+    EXPECT_THROW(
+        mask.setIn(cv::Mat::zeros(4, 4, CV_16UC1), 0), std::invalid_argument);
+}
+
+TEST(VolumetricMask, Merge)
+{
+    VolumetricMask a;
+    a.setIn({0, 0, 0});
+    a.setIn({20, 0, 0});
+    VolumetricMask b;
+    b.setIn({0, 0, 0});
+    b.setIn({-20, 0, 0});
+
+    a.merge(b);
+    EXPECT_EQ(a.size(), 3);
+    EXPECT_TRUE(a.isIn(cv::Vec3i{-20, 0, 0}));
+    EXPECT_TRUE(a.isIn(cv::Vec3i{20, 0, 0}));
+}
+
+TEST(VolumetricMask, WriteRead)
+{
+    const fs::path path{"vc_core_VolumetricMask_WriteRead.vcmask"};
+    const auto mask = ::MakeMask();
+    io::WriteVolumetricMask(path, mask);
+    EXPECT_TRUE(io::IsVolumetricMask(path));
+
+    const auto result = io::ReadVolumetricMask(path);
+    EXPECT_EQ(result->size(), mask.size());
+    EXPECT_EQ(::ToSet(*result), ::ToSet(mask));
+}
+
+TEST(VolumetricMask, LoadPointSet)
+{
+    const fs::path path{"vc_core_VolumetricMask_LoadPointSet.vcps"};
+    PointSet<cv::Vec3i> ps;
+    ps.emplace_back(1, 2, 3);
+    ps.emplace_back(-4, 5, 60);
+    PointSetIO<cv::Vec3i>::WritePointSet(path, ps);
+    EXPECT_FALSE(io::IsVolumetricMask(path));
+    EXPECT_THROW(io::ReadVolumetricMask(path), IOException);
+
+    const auto mask = io::LoadVolumetricMask(path);
+    EXPECT_EQ(mask->size(), 2);
+    EXPECT_TRUE(mask->isIn(cv::Vec3i{1, 2, 3}));
+    EXPECT_TRUE(mask->isIn(cv::Vec3i{-4, 5, 60}));
+}
@@ -0,0 +1,103 @@
+/*
+ * Purpose: Compare the cache hit throughput of volcart::LRUCache and
+ *          volcart::ClockCache as the number of reading threads increases.
+ *
+ *          Every thread repeatedly reads random keys from a pre-filled cache,
+ *          so every read is a hit. The value type is a shared pointer, which
+ *          mimics the reference counting of cached cv::Mat slices.
+ *          Results past the number of hardware threads only measure
+ *          oversubscription, not scaling.
+ *
+ * Usage: vc_cache_benchmark [max threads] [reads per thread]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vc/core/types/ClockCache.hpp"
+#include "vc/core/types/LRUCache.hpp"
+
+using namespace volcart;
+
+namespace
+{
+using Value = std::shared_ptr<int>;
+using CacheType = Cache<int, Value>;
+
+constexpr int NUM_KEYS{256};
+
+// Sum of every value read. Keeps the reads from being optimized away.
+std::atomic<std::size_t> checksum{0};
+
+// Returns the number of reads per second across all threads
+auto MeasureHits(CacheType& cache, std::size_t threads, std::size_t reads)
+    -> double
+{
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&cache, reads, t]() {
+            std::minstd_rand gen(static_cast<unsigned>(t));
+            std::uniform_int_distribution<int> dist(0, NUM_KEYS - 1);
+            std::size_t sum{0};
+            for (std::size_t i = 0; i < reads; i++) {
+                sum += static_cast<std::size_t>(*cache.get(dist(gen)));
+            }
+            checksum += sum;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return static_cast<double>(threads * reads) / elapsed.count();
+}
+
+void Fill(CacheType& cache)
+{
+    cache.setCapacity(NUM_KEYS);
+    for (int k = 0; k < NUM_KEYS; k++) {
+        cache.put(k, std::make_shared<int>(k));
+    }
+}
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+    std::size_t maxThreads{64};
+    std::size_t reads{1'000'000};
+    if (argc > 1) {
+        maxThreads = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        reads = std::stoul(argv[2]);
+    }
+
+    LRUCache<int, Value> lru;
+    Fill(lru);
+    ClockCache<int, Value> clock;
+    Fill(clock);
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+              << '\n';
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "LRU (Mops/s)"
+              << std::setw(18) << "Clock (Mops/s)" << std::setw(10)
+              << "speedup" << '\n';
+    for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        const auto lruOps = MeasureHits(lru, threads, reads) / 1e6;
+        const auto clockOps = MeasureHits(clock, threads, reads) / 1e6;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8)
+                  << threads << std::setw(18) << lruOps << std::setw(18)
+                  << clockOps << std::setw(10) << clockOps / lruOps << '\n';
+    }
+    std::cout << "Checksum: " << checksum << '\n';
+}
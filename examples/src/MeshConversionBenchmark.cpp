@@ -0,0 +1,184 @@
+/*
+ * Purpose: Measure the time taken by volcart::meshing::ITK2VTK() and
+ *          volcart::meshing::VTK2ITK() on a large mesh, compared to the
+ *          original conversions, which built one vtkIdList per face and
+ *          fetched one vtkCell per face.
+ *
+ *          The input is a flat grid mesh with vertex normals.
+ *
+ * Usage: vc_mesh_conversion_benchmark [faces] [repetitions]
+ */
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdList.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+#include "vc/meshing/ITK2VTK.hpp"
+
+using namespace volcart;
+
+namespace
+{
+// Grid mesh with approximately the requested number of faces
+auto MakeGrid(std::size_t faces) -> ITKMesh::Pointer
+{
+    const auto half = static_cast<double>(faces) / 2;
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(half))) + 1;
+    auto mesh = ITKMesh::New();
+    ITKPoint pt;
+    ITKPixel normal;
+    normal[0] = 0;
+    normal[1] = 0;
+    normal[2] = 1;
+    for (std::size_t y = 0; y < side; y++) {
+        for (std::size_t x = 0; x < side; x++) {
+            pt[0] = static_cast<double>(x);
+            pt[1] = static_cast<double>(y);
+            pt[2] = 0;
+            mesh->SetPoint(y * side + x, pt);
+            mesh->SetPointData(y * side + x, normal);
+        }
+    }
+
+    ITKCell::CellAutoPointer cell;
+    std::size_t cellId{0};
+    auto addFace = [&](std::size_t a, std::size_t b, std::size_t c) {
+        cell.TakeOwnership(new ITKTriangle);
+        cell->SetPointId(0, a);
+        cell->SetPointId(1, b);
+        cell->SetPointId(2, c);
+        mesh->SetCell(cellId++, cell);
+    };
+    for (std::size_t y = 0; y + 1 < side; y++) {
+        for (std::size_t x = 0; x + 1 < side; x++) {
+            const auto v = y * side + x;
+            addFace(v, v + 1, v + side);
+            addFace(v + 1, v + side + 1, v + side);
+        }
+    }
+    return mesh;
+}
+
+// The original per-point, per-cell ITK2VTK
+auto LegacyITK2VTK(const ITKMesh::Pointer& input)
+    -> vtkSmartPointer<vtkPolyData>
+{
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    auto pointNormals = vtkSmartPointer<vtkDoubleArray>::New();
+    pointNormals->SetNumberOfComponents(3);
+    for (auto point = input->GetPoints()->Begin();
+         point != input->GetPoints()->End(); ++point) {
+        points->InsertPoint(
+            point->Index(), point->Value()[0], point->Value()[1],
+            point->Value()[2]);
+        ITKPixel normal;
+        if (input->GetPointData(point.Index(), &normal)) {
+            std::array<double, 3> ptNorm = {normal[0], normal[1], normal[2]};
+            pointNormals->InsertTuple(point->Index(), ptNorm.data());
+        }
+    }
+
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    for (auto cell = input->GetCells()->Begin();
+         cell != input->GetCells()->End(); ++cell) {
+        auto poly = vtkSmartPointer<vtkIdList>::New();
+        for (auto point = cell.Value()->PointIdsBegin();
+             point != cell.Value()->PointIdsEnd(); ++point) {
+            poly->InsertNextId(*point);
+        }
+        polys->InsertNextCell(poly);
+    }
+
+    auto output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetPolys(polys);
+    output->GetPointData()->SetNormals(pointNormals);
+    return output;
+}
+
+// The original per-point, per-cell VTK2ITK
+auto LegacyVTK2ITK(const vtkSmartPointer<vtkPolyData>& input)
+    -> ITKMesh::Pointer
+{
+    auto output = ITKMesh::New();
+    auto pointNormals = input->GetPointData()->GetNormals();
+    for (vtkIdType pointId = 0; pointId < input->GetNumberOfPoints();
+         ++pointId) {
+        output->SetPoint(pointId, input->GetPoint(pointId));
+        if (pointNormals != nullptr) {
+            output->SetPointData(pointId, pointNormals->GetTuple(pointId));
+        }
+    }
+
+    ITKCell::CellAutoPointer cell;
+    for (vtkIdType cellId = 0; cellId < input->GetNumberOfCells(); ++cellId) {
+        auto inputCell = input->GetCell(cellId);
+        cell.TakeOwnership(new ITKTriangle);
+        for (vtkIdType pointId = 0; pointId < inputCell->GetNumberOfPoints();
+             ++pointId) {
+            cell->SetPointId(pointId, inputCell->GetPointId(pointId));
+        }
+        output->SetCell(cellId, cell);
+    }
+    return output;
+}
+
+// Returns the mean number of seconds taken by fn
+template <typename Fn>
+auto Measure(std::size_t reps, Fn fn) -> double
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < reps; i++) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(reps);
+}
+
+void Report(const std::string& name, double legacy, double bulk)
+{
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10) << name
+              << std::setw(14) << legacy << std::setw(14) << bulk
+              << std::setw(10) << legacy / bulk << '\n';
+}
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+    std::size_t faces{10'000'000};
+    std::size_t reps{3};
+    if (argc > 1) {
+        faces = std::stoul(argv[1]);
+    }
+    if (argc > 2) {
+        reps = std::stoul(argv[2]);
+    }
+
+    const auto itkMesh = MakeGrid(faces);
+    const auto vtkMesh = meshing::ITK2VTK(itkMesh);
+    std::cout << "Mesh: " << itkMesh->GetNumberOfPoints() << " vertices, "
+              << itkMesh->GetNumberOfCells() << " faces\n";
+
+    const auto legacyTo = Measure(reps, [&]() { LegacyITK2VTK(itkMesh); });
+    const auto bulkTo = Measure(reps, [&]() { meshing::ITK2VTK(itkMesh); });
+    const auto legacyFrom = Measure(reps, [&]() { LegacyVTK2ITK(vtkMesh); });
+    const auto bulkFrom = Measure(reps, [&]() { meshing::VTK2ITK(vtkMesh); });
+
+    std::cout << std::setw(10) << "direction" << std::setw(14) << "legacy (s)"
+              << std::setw(14) << "bulk (s)" << std::setw(10) << "speedup"
+              << '\n';
+    Report("ITK2VTK", legacyTo, bulkTo);
+    Report("VTK2ITK", legacyFrom, bulkFrom);
+    Report("both", legacyTo + legacyFrom, bulkTo + bulkFrom);
+}
@@ -0,0 +1,148 @@
+/*
+ * Purpose: Compare the size and speed of the TIFF compression schemes which
+ *          Volume::setSliceCompression() accepts, on real slice images.
+ *
+ *          Each slice is encoded with every scheme supported by the local
+ *          libtiff, with and without a predictor. The compression ratio is
+ *          relative to the uncompressed pixel data. Throughput is measured in
+ *          MB of pixel data per second.
+ *
+ * Usage: vc_slice_codec_benchmark [-r repetitions] slice.tif [slice.tif ...]
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/io/TIFFIO.hpp"
+
+using namespace volcart;
+namespace fs = volcart::filesystem;
+namespace tio = volcart::tiffio;
+
+namespace
+{
+// Returns the mean number of seconds taken by fn
+template <typename Fn>
+auto Measure(std::size_t reps, Fn fn) -> double
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < reps; i++) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(reps);
+}
+
+void Report(
+    const std::string& name,
+    const std::string& predictor,
+    double ratio,
+    double encode,
+    double decode)
+{
+    std::cout << std::fixed << std::setprecision(2) << std::setw(10) << name
+              << std::setw(12) << predictor << std::setw(10) << ratio
+              << std::setw(14) << encode << std::setw(14) << decode << '\n';
+}
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+    std::size_t reps{3};
+    std::vector<fs::path> paths;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg{argv[i]};
+        if (arg == "-r" and i + 1 < argc) {
+            reps = std::stoul(argv[++i]);
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+    if (paths.empty() or reps == 0) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-r repetitions] slice.tif [slice.tif ...]\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<cv::Mat> slices;
+    double rawBytes{0};
+    for (const auto& p : paths) {
+        slices.push_back(tio::ReadTIFF(p));
+        const auto& s = slices.back();
+        rawBytes += static_cast<double>(s.total() * s.elemSize());
+    }
+    const auto rawMB = rawBytes / (1024.0 * 1024.0);
+    std::cout << "Slices: " << slices.size() << ", " << std::fixed
+              << std::setprecision(2) << rawMB << " MB, "
+              << cv::typeToString(slices.front().type()) << '\n';
+
+    const auto dir = fs::temp_directory_path() / "vc_slice_codec_benchmark";
+    fs::create_directories(dir);
+    std::vector<fs::path> outPaths;
+    for (std::size_t i = 0; i < slices.size(); i++) {
+        outPaths.push_back(dir / (std::to_string(i) + ".tif"));
+    }
+
+    std::cout << std::setw(10) << "codec" << std::setw(12) << "predictor"
+              << std::setw(10) << "ratio" << std::setw(14) << "encode MB/s"
+              << std::setw(14) << "decode MB/s" << '\n';
+    for (const auto c :
+         {tio::Compression::NONE, tio::Compression::LZW,
+          tio::Compression::ADOBE_DEFLATE, tio::Compression::ZSTD,
+          tio::Compression::LZMA}) {
+        const auto name = tio::CompressionName(c);
+        if (not tio::IsCompressionSupported(c)) {
+            std::cout << std::setw(10) << name << "  not supported\n";
+            continue;
+        }
+        for (const auto usePredictor : {false, true}) {
+            if (usePredictor and c == tio::Compression::NONE) {
+                continue;
+            }
+
+            // Same predictor selection as Volume::setSliceData()
+            auto predictor = [&](const cv::Mat& s) {
+                if (not usePredictor) {
+                    return tio::Predictor::NONE;
+                }
+                const auto isFloat =
+                    s.depth() == CV_32F or s.depth() == CV_64F;
+                return isFloat ? tio::Predictor::FLOATINGPOINT
+                               : tio::Predictor::HORIZONTAL;
+            };
+
+            const auto encode = Measure(reps, [&]() {
+                for (std::size_t i = 0; i < slices.size(); i++) {
+                    tio::WriteTIFF(
+                        outPaths[i], slices[i], c, 0, predictor(slices[i]));
+                }
+            });
+            const auto decode = Measure(reps, [&]() {
+                for (const auto& p : outPaths) {
+                    static_cast<void>(tio::ReadTIFF(p));
+                }
+            });
+
+            std::uintmax_t fileBytes{0};
+            for (const auto& p : outPaths) {
+                fileBytes += fs::file_size(p);
+            }
+            Report(
+                name, usePredictor ? "yes" : "no",
+                rawBytes / static_cast<double>(fileBytes), rawMB / encode,
+                rawMB / decode);
+        }
+    }
+
+    fs::remove_all(dir);
+}
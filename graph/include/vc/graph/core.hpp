@@ -718,9 +718,11 @@ public:
 };
 
 /**
- * @brief Load a VolumetricMask from a .vcps file
+ * @brief Load a VolumetricMask from a .vcmask or .vcps file
  *
- * Given file must be of type=int, dim=3.
+ * A .vcps file must be of type=int, dim=3.
+ *
+ * @see io::LoadVolumetricMask()
  *
  * @ingroup Graph
  */
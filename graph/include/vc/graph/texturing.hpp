@@ -376,6 +376,8 @@ public:
     smgl::InputPort<Generator> generator;
     /** @brief Composite filter type */
     smgl::InputPort<Filter> filter;
+    /** @copybrief texturing::TexturingAlgorithm::setMaxThreads() */
+    smgl::InputPort<std::uint32_t> maxThreads;
     /** @brief Generated texture image */
     smgl::OutputPort<cv::Mat> texture;
 
@@ -412,6 +414,8 @@ public:
     smgl::InputPort<PerPixelMap::Pointer> ppm;
     /** @brief Input Volume */
     smgl::InputPort<Volume::Pointer> volume;
+    /** @copybrief texturing::TexturingAlgorithm::setMaxThreads() */
+    smgl::InputPort<std::uint32_t> maxThreads;
     /** @brief Generated texture image */
     smgl::OutputPort<cv::Mat> texture;
 
@@ -484,6 +488,8 @@ public:
     smgl::InputPort<double> exponentialDiffBaseValue;
     /** @copybrief TAlgo::setExponentialDiffSuppressBelowBase() */
     smgl::InputPort<bool> exponentialDiffSuppressBelowBase;
+    /** @copybrief texturing::TexturingAlgorithm::setMaxThreads() */
+    smgl::InputPort<std::uint32_t> maxThreads;
     /** @brief Generated texture image */
     smgl::OutputPort<cv::Mat> texture;
 
@@ -573,6 +579,8 @@ public:
      * LineGenerator.
      */
     smgl::InputPort<Generator> generator;
+    /** @copybrief texturing::TexturingAlgorithm::setMaxThreads() */
+    smgl::InputPort<std::uint32_t> maxThreads;
     /** @brief Generated texture image */
     smgl::OutputPort<ImageList> texture;
 
@@ -2,8 +2,8 @@
 
 #include <nlohmann/json.hpp>
 
-#include "vc/core/io/PointSetIO.hpp"
 #include "vc/core/io/UVMapIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
 #include "vc/core/util/FloatComparison.hpp"
 #include "vc/core/util/Logging.hpp"
 
@@ -605,8 +605,7 @@ LoadVolumetricMaskNode::LoadVolumetricMaskNode()
     compute = [&]() {
         Logger()->debug(
             "[graph.core] loading volumetric mask: {}", path_.string());
-        using psio = PointSetIO<cv::Vec3i>;
-        mask_ = VolumetricMask::New(psio::ReadPointSet(path_));
+        mask_ = io::LoadVolumetricMask(path_);
     };
     usesCacheDir = [&]() { return cacheArgs_; };
 }
@@ -616,12 +615,8 @@ auto LoadVolumetricMaskNode::serialize_(bool useCache, const fs::path& cacheDir)
 {
     smgl::Metadata meta{{"path", path_.string()}, {"cacheArgs", cacheArgs_}};
     if (useCache and cacheArgs_ and mask_) {
-        using psio = PointSetIO<cv::Vec3i>;
-        PointSet<cv::Vec3i> ps;
-        ps.append(*mask_);
-
-        auto file = path_.filename().replace_extension(".vcps");
-        psio::WritePointSet(cacheDir / file, ps);
+        auto file = path_.filename().replace_extension(".vcmask");
+        io::WriteVolumetricMask(cacheDir / file, *mask_);
         meta["cachedFile"] = file.string();
     }
     return meta;
@@ -634,9 +629,8 @@ void LoadVolumetricMaskNode::deserialize_(
     cacheArgs_ = meta["cacheArgs"].get<bool>();
 
     if (meta.contains("cachedFile")) {
-        using psio = PointSetIO<cv::Vec3i>;
         auto file = meta["cachedFile"].get<std::string>();
-        mask_ = VolumetricMask::New(psio::ReadPointSet(cacheDir / file));
+        mask_ = io::LoadVolumetricMask(cacheDir / file);
     }
 }
 
@@ -410,12 +410,14 @@ CompositeTextureNode::CompositeTextureNode()
         filter_ = f;
         textureGen_.setFilter(filter_);
     }}
+    , maxThreads{&textureGen_, &TAlgo::setMaxThreads}
     , texture{&texture_}
 {
     registerInputPort("ppm", ppm);
     registerInputPort("volume", volume);
     registerInputPort("generator", generator);
     registerInputPort("filter", filter);
+    registerInputPort("maxThreads", maxThreads);
     registerOutputPort("texture", texture);
     compute = [&]() {
         Logger()->debug("[graph.texturing] generating composite texture");
@@ -450,10 +452,12 @@ IntersectionTextureNode::IntersectionTextureNode()
     : Node{true}
     , ppm{&textureGen_, &TAlgo::setPerPixelMap}
     , volume{&textureGen_, &TAlgo::setVolume}
+    , maxThreads{&textureGen_, &TAlgo::setMaxThreads}
     , texture{&texture_}
 {
     registerInputPort("ppm", ppm);
     registerInputPort("volume", volume);
+    registerInputPort("maxThreads", maxThreads);
     registerOutputPort("texture", texture);
     compute = [&]() {
         Logger()->debug("[graph.texturing] generating intersection texture");
@@ -494,6 +498,7 @@ IntegralTextureNode::IntegralTextureNode()
     , exponentialDiffBaseMethod{&textureGen_, &TAlgo::setExponentialDiffBaseMethod}
     , exponentialDiffBaseValue{&textureGen_, &TAlgo::setExponentialDiffBaseValue}
     , exponentialDiffSuppressBelowBase{&textureGen_, &TAlgo::setExponentialDiffSuppressBelowBase}
+    , maxThreads{&textureGen_, &TAlgo::setMaxThreads}
     , texture{&texture_}
 {
     registerInputPort("ppm", ppm);
@@ -508,6 +513,7 @@ IntegralTextureNode::IntegralTextureNode()
     registerInputPort("exponentialDiffBaseValue", exponentialDiffBaseValue);
     registerInputPort(
         "exponentialDiffSuppressBelowBase", exponentialDiffSuppressBelowBase);
+    registerInputPort("maxThreads", maxThreads);
     registerOutputPort("texture", texture);
 
     compute = [&]() {
@@ -617,11 +623,13 @@ LayerTextureNode::LayerTextureNode()
         textureGen_.setGenerator(derived);
     }}
     , volume{&textureGen_, &TAlgo::setVolume}
+    , maxThreads{&textureGen_, &TAlgo::setMaxThreads}
     , texture{&texture_}
 {
     registerInputPort("ppm", ppm);
     registerInputPort("volume", volume);
     registerInputPort("generator", generator);
+    registerInputPort("maxThreads", maxThreads);
     registerOutputPort("texture", texture);
 
     compute = [&]() {
@@ -2,11 +2,14 @@
 
 /** @file */
 
+#include <cstdint>
 #include <iostream>
+#include <optional>
 
 #include <opencv2/core.hpp>
 
 #include "vc/core/types/ITKMesh.hpp"
+#include "vc/core/types/TriangleMesh.hpp"
 
 namespace volcart::meshing
 {
@@ -49,35 +52,54 @@ public:
     ITKMesh::Pointer getMesh() const { return output_; }
     //@}
 
+    //** @name Parameters */
+    //@{
     /**
-     * @brief Compute vertex normals for the mesh.
-     */
-    ITKMesh::Pointer compute();
-
-private:
-    /**
-     * @brief Compute normals for each vertex.
+     * @brief Set the maximum number of threads used by compute()
      *
-     * For each face, computes the normal to that face and adds the resulting
-     * vector to a sum vector for each vertex in that face.
+     * By default, compute() uses every available hardware thread.
      */
-    void compute_normals_();
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
+    //@}
 
     /**
-     * @brief Assign the summed normals to the output mesh.
-     *
-     * Takes the summed normals for each vertex and assigns them to the
-     * corresponding vertex in the output mesh.
+     * @brief Compute vertex normals for the mesh.
      */
-    void assign_to_mesh_();
+    ITKMesh::Pointer compute();
 
+private:
     /** Mesh for which normals will be calculated. */
     ITKMesh::Pointer input_;
 
     /** Mesh with calculated normals. */
     ITKMesh::Pointer output_;
 
-    /** Storage for summed normals, organized by vertex ID */
-    std::vector<cv::Vec3d> vertexNormals_;
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 };
+
+/**
+ * @brief Calculate vertex normals for a TriangleMesh
+ *
+ * Each vertex normal is the normalized sum of the normals of the faces which
+ * contain the vertex, weighted by face area. Replaces any existing normals.
+ *
+ * Face normals are computed in parallel and then gathered by each vertex
+ * through a vertex-to-face adjacency list, so no two threads write to the
+ * same normal. Each vertex sums its faces in face order, so the result does
+ * not depend on the number of threads.
+ *
+ * @param maxThreads Maximum number of threads. Defaults to every available
+ * hardware thread.
+ *
+ * @throws std::invalid_argument If a face references a vertex which is not
+ * in the mesh
+ *
+ * @ingroup Meshing
+ */
+void ComputeVertexNormals(
+    TriangleMesh& mesh, std::optional<std::uint32_t> maxThreads = std::nullopt);
 }  // namespace volcart::meshing
@@ -13,6 +13,9 @@ namespace volcart::meshing
  * @brief Convert from an ITKMesh to VTK PolyData.
  *
  * Copy vertices, vertex normals, and faces (cells) from input to output.
+ * Vertex normals are copied if every vertex has one. The output's points and
+ * polygon connectivity are filled as flat arrays rather than point by point
+ * and cell by cell.
  *
  * @see  examples/src/ITK2VTKExample.cpp
  *       meshing/test/ITK2VTKTest.cpp
@@ -28,6 +31,12 @@ auto ITK2VTK(ITKMesh::Pointer input) -> vtkSmartPointer<vtkPolyData>;
  * @brief Convert from a VTK PolyData to an ITKMesh.
  *
  * Copy vertices, vertex normals, and faces (cells) from input to output.
+ * Vertex normals are copied if every vertex has one. Faces are read directly
+ * from the input's polygon connectivity array. Vertex, line, and triangle
+ * strip cells are not copied. Replaces the output's existing points, point
+ * data, and cells.
+ *
+ * @throws std::invalid_argument If the input has non-triangular polygons
  *
  * @see  examples/src/ITK2VTKExample.cpp
  *       meshing/test/ITK2VTKTest.cpp
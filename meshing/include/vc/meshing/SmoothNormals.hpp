@@ -2,7 +2,11 @@
 
 /** @file */
 
+#include <cstdint>
+#include <optional>
+
 #include "vc/core/types/ITKMesh.hpp"
+#include "vc/core/types/TriangleMesh.hpp"
 
 namespace volcart::meshing
 {
@@ -12,13 +16,37 @@ namespace volcart::meshing
  *
  * @brief Smooth vertex normals within a specified radius.
  *
- * Uses ITK's neighborhood locator to get the list of neighboring vertices
- * within the provided spherical radius. Returns a DeepCopy of the
- * original mesh, with smoothed vertex normals.
+ * Each smoothed normal is the average of the vertex's normal and the normals
+ * of every vertex within the provided spherical radius, including the vertex
+ * itself. Returns a DeepCopy of the original mesh, with smoothed vertex
+ * normals.
+ *
+ * The vertices are binned into a uniform grid once, and the neighborhoods of
+ * the vertices are then searched in parallel.
  *
  * @ingroup Meshing
  *
  * @param radius Size of the spherical neighborhood
+ * @param maxThreads Maximum number of threads. Defaults to every available
+ * hardware thread.
+ */
+ITKMesh::Pointer SmoothNormals(
+    const ITKMesh::Pointer& input,
+    double radius,
+    std::optional<std::uint32_t> maxThreads = std::nullopt);
+
+/**
+ * @copybrief SmoothNormals(const ITKMesh::Pointer&, double, std::optional<std::uint32_t>)
+ *
+ * Returns a copy of the input mesh with smoothed vertex normals.
+ *
+ * @throws std::invalid_argument If the input mesh does not have normals
+ *
+ * @ingroup Meshing
  */
-ITKMesh::Pointer SmoothNormals(const ITKMesh::Pointer& input, double radius);
+auto SmoothNormals(
+    const TriangleMesh& input,
+    double radius,
+    std::optional<std::uint32_t> maxThreads = std::nullopt)
+    -> TriangleMesh::Pointer;
 }  // namespace volcart::meshing
@@ -1,10 +1,21 @@
 #include "vc/meshing/CalculateNormals.hpp"
 
-#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vc/core/util/Parallel.hpp"
 
 using namespace volcart;
 using namespace volcart::meshing;
 
+namespace
+{
+// Number of faces or vertices processed by each parallel task
+constexpr std::size_t ELEMENTS_PER_BLOCK{8192};
+}  // namespace
+
 CalculateNormals::CalculateNormals(const ITKMesh::Pointer& mesh)
     : input_{mesh}, output_{ITKMesh::New()}
 {
@@ -14,76 +25,78 @@ CalculateNormals::CalculateNormals(const ITKMesh::Pointer& mesh)
 ///// Input/Output /////
 void CalculateNormals::setMesh(const ITKMesh::Pointer& mesh) { input_ = mesh; }
 
+///// Parameters /////
+void CalculateNormals::setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+void CalculateNormals::resetMaxThreads() { maxThreads_ = std::nullopt; }
+
 ///// Processing /////
 auto CalculateNormals::compute() -> ITKMesh::Pointer
 {
-    output_ = ITKMesh::New();
-    DeepCopy(input_, output_);
-
-    compute_normals_();
-    assign_to_mesh_();
-
+    auto mesh = TriangleMesh::FromITKMesh(input_);
+    ComputeVertexNormals(*mesh, maxThreads_);
+    output_ = mesh->toITKMesh();
     return output_;
 }
 
-void CalculateNormals::compute_normals_()
+void volcart::meshing::ComputeVertexNormals(
+    TriangleMesh& mesh, std::optional<std::uint32_t> maxThreads)
 {
-    vertexNormals_ = std::vector<cv::Vec3d>(output_->GetNumberOfPoints(), 0);
-
-    for (auto cellIt = input_->GetCells()->Begin();
-         cellIt != input_->GetCells()->End(); ++cellIt) {
-
-        // Empty vectors for the vertex and edge info
-        cv::Vec3d v0, v1, v2, e0, e1;
-
-        // Collect the point id's for this cell
-        std::vector<std::uint64_t> pointIds;
-        ITKPoint vert;
-        for (auto p = cellIt->Value()->PointIdsBegin();
-             p != cellIt->Value()->PointIdsEnd(); ++p) {
-            pointIds.push_back(*p);
+    const auto& vertices = mesh.vertices();
+    const auto& faces = mesh.faces();
+    const auto numVertices = mesh.numVertices();
+    const auto numThreads = NumThreads(maxThreads);
+
+    // Vertex-to-face adjacency in compressed sparse row form: the faces of
+    // vertex v are adjacent[offsets[v]] to adjacent[offsets[v + 1] - 1], in
+    // increasing order
+    std::vector<std::size_t> offsets(numVertices + 1, 0);
+    for (const auto& face : faces) {
+        for (const auto v : face) {
+            if (v >= numVertices) {
+                throw std::invalid_argument(
+                    "Face references vertex " + std::to_string(v) +
+                    ", but mesh has " + std::to_string(numVertices) +
+                    " vertices");
+            }
+            offsets[v + 1]++;
         }
-
-        // To-Do: #185
-
-        // Collect the vertex info for each point
-        vert = input_->GetPoint(pointIds[0]);
-        v0(0) = vert[0];
-        v0(1) = vert[1];
-        v0(2) = vert[2];
-
-        vert = input_->GetPoint(pointIds[1]);
-        v1(0) = vert[0];
-        v1(1) = vert[1];
-        v1(2) = vert[2];
-
-        vert = input_->GetPoint(pointIds[2]);
-        v2(0) = vert[0];
-        v2(1) = vert[1];
-        v2(2) = vert[2];
-
-        // Get the edge vectors
-        e0 = v2 - v0;
-        e1 = v1 - v0;
-
-        // Take the cross-product
-        cv::Vec3d normals;
-        normals = e1.cross(e0);
-
-        // Add the norm for this face to the running sum for each vertex
-        vertexNormals_[pointIds[0]] += normals;
-        vertexNormals_[pointIds[1]] += normals;
-        vertexNormals_[pointIds[2]] += normals;
     }
-}
-
-void CalculateNormals::assign_to_mesh_()
-{
-    for (auto point = input_->GetPoints()->Begin();
-         point != input_->GetPoints()->End(); ++point) {
-        cv::Vec3d norm = vertexNormals_[point.Index()];
-        cv::normalize(norm, norm);
-
-        output_->SetPointData(point.Index(), norm.val);
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<std::size_t> adjacent(offsets.back());
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t f = 0; f < faces.size(); f++) {
+        for (const auto v : faces[f]) {
+            adjacent[next[v]++] = f;
+        }
     }
+
+    // Area-weighted face normals
+    std::vector<TriangleMesh::Normal> faceNormals(faces.size());
+    ParallelFor(
+        faces.size(), ELEMENTS_PER_BLOCK, numThreads,
+        [&](std::size_t begin, std::size_t end) {
+            for (auto f = begin; f < end; f++) {
+                const auto& [a, b, c] = faces[f];
+                // To-Do: #185
+                const auto e0 = vertices[c] - vertices[a];
+                const auto e1 = vertices[b] - vertices[a];
+                faceNormals[f] = e1.cross(e0);
+            }
+        });
+
+    // Each vertex sums the normals of its own faces
+    auto& normals = mesh.normals();
+    normals.resize(numVertices);
+    ParallelFor(
+        numVertices, ELEMENTS_PER_BLOCK, numThreads,
+        [&](std::size_t begin, std::size_t end) {
+            for (auto v = begin; v < end; v++) {
+                TriangleMesh::Normal n{0, 0, 0};
+                for (auto i = offsets[v]; i < offsets[v + 1]; i++) {
+                    n += faceNormals[adjacent[i]];
+                }
+                normals[v] = cv::normalize(n);
+            }
+        });
 }
@@ -1,53 +1,151 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <vtkCellArray.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkTypeInt64Array.h>
 
+#include "vc/core/util/Parallel.hpp"
 #include "vc/meshing/ITK2VTK.hpp"
 
-namespace volcart::meshing
+namespace
 {
+// Number of cells converted by each parallel task
+constexpr std::size_t CELLS_PER_BLOCK{16384};
 
-///// ITK Mesh -> VTK Polydata /////
-void ITK2VTK(ITKMesh::Pointer input, vtkSmartPointer<vtkPolyData> output)
+// Copy the tuples of a 3-component VTK array to a packed array of doubles.
+// Double arrays are copied with memcpy, float arrays are converted directly,
+// and everything else goes through the generic tuple interface.
+void CopyTuples(vtkDataArray* input, double* output)
 {
+    const auto numTuples = input->GetNumberOfTuples();
+    if (auto* d = vtkDoubleArray::FastDownCast(input); d != nullptr) {
+        std::memcpy(
+            output, d->GetPointer(0),
+            static_cast<std::size_t>(numTuples) * 3 * sizeof(double));
+    } else if (auto* f = vtkFloatArray::FastDownCast(input); f != nullptr) {
+        const auto* in = f->GetPointer(0);
+        for (vtkIdType i = 0; i < numTuples * 3; i++) {
+            output[i] = static_cast<double>(in[i]);
+        }
+    } else {
+        for (vtkIdType i = 0; i < numTuples; i++) {
+            input->GetTuple(i, output + i * 3);
+        }
+    }
+}
 
-    // points + normals
-    auto points = vtkSmartPointer<vtkPoints>::New();
-    auto pointNormals = vtkSmartPointer<vtkDoubleArray>::New();
-    pointNormals->SetNumberOfComponents(3);  // 3d normals (ie x,y,z)
-
-    for (auto point = input->GetPoints()->Begin();
-         point != input->GetPoints()->End(); ++point) {
-        // assign the point
-        points->InsertPoint(
-            point->Index(), point->Value()[0], point->Value()[1],
-            point->Value()[2]);
-
-        // assign the normal
-        ITKPixel normal;
-        if (input->GetPointData(point.Index(), &normal)) {
-            std::array<double, 3> ptNorm = {normal[0], normal[1], normal[2]};
-            pointNormals->InsertTuple(point->Index(), ptNorm.data());
+// Create an ITK triangle for each polygon in a VTK cell array
+template <typename ArrayT>
+void CopyTriangles(
+    ArrayT* offsetsArray,
+    ArrayT* connArray,
+    volcart::ITKMesh::CellsContainer::STLContainerType& cells)
+{
+    using namespace volcart;
+    using PointId = ITKMesh::PointIdentifier;
+
+    const auto* offsets = offsetsArray->GetPointer(0);
+    const auto* conn = connArray->GetPointer(0);
+    const auto numCells = cells.size();
+    for (std::size_t c = 0; c < numCells; c++) {
+        if (offsets[c + 1] - offsets[c] != 3) {
+            throw std::invalid_argument(
+                "Polygon " + std::to_string(c) + " is not a triangle");
         }
     }
 
-    // cells
-    auto polys = vtkSmartPointer<vtkCellArray>::New();
-    for (auto cell = input->GetCells()->Begin();
-         cell != input->GetCells()->End(); ++cell) {
+    ParallelFor(
+        numCells, CELLS_PER_BLOCK, NumThreads(),
+        [&](std::size_t begin, std::size_t end) {
+            ITKCell::CellAutoPointer cell;
+            for (auto c = begin; c < end; c++) {
+                const auto* ids = conn + offsets[c];
+                cell.TakeOwnership(new ITKTriangle);
+                cell->SetPointId(0, static_cast<PointId>(ids[0]));
+                cell->SetPointId(1, static_cast<PointId>(ids[1]));
+                cell->SetPointId(2, static_cast<PointId>(ids[2]));
+                cells[c] = cell.ReleaseOwnership();
+            }
+        });
+}
+}  // namespace
+
+namespace volcart::meshing
+{
 
-        auto poly = vtkSmartPointer<vtkIdList>::New();
-        for (auto point = cell.Value()->PointIdsBegin();
-             point != cell.Value()->PointIdsEnd(); ++point) {
-            poly->InsertNextId(*point);
+///// ITK Mesh -> VTK Polydata /////
+void ITK2VTK(ITKMesh::Pointer input, vtkSmartPointer<vtkPolyData> output)
+{
+    // points
+    const auto& inPts = input->GetPoints()->CastToSTLConstContainer();
+    const auto numPts = static_cast<vtkIdType>(inPts.size());
+    auto pointsArray = vtkSmartPointer<vtkDoubleArray>::New();
+    pointsArray->SetNumberOfComponents(3);
+    pointsArray->SetNumberOfTuples(numPts);
+    auto* pts = pointsArray->GetPointer(0);
+    for (const auto& p : inPts) {
+        *pts++ = p[0];
+        *pts++ = p[1];
+        *pts++ = p[2];
+    }
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointsArray);
+
+    // normals, if every point has one
+    vtkSmartPointer<vtkDoubleArray> pointNormals;
+    const auto* pointData = input->GetPointData();
+    if (pointData != nullptr and numPts > 0 and
+        pointData->Size() == inPts.size()) {
+        pointNormals = vtkSmartPointer<vtkDoubleArray>::New();
+        pointNormals->SetNumberOfComponents(3);  // 3d normals (ie x,y,z)
+        pointNormals->SetNumberOfTuples(numPts);
+        auto* normals = pointNormals->GetPointer(0);
+        for (const auto& n : pointData->CastToSTLConstContainer()) {
+            *normals++ = n[0];
+            *normals++ = n[1];
+            *normals++ = n[2];
         }
+    }
 
-        polys->InsertNextCell(poly);
+    // cells: offsets first, then the connectivity in parallel. The arrays use
+    // vtkCellArray's native storage type, so they are adopted without a copy.
+    const auto& inCells = input->GetCells()->CastToSTLConstContainer();
+    const auto numCells = inCells.size();
+    auto offsetsArray = vtkSmartPointer<vtkTypeInt64Array>::New();
+    offsetsArray->SetNumberOfValues(static_cast<vtkIdType>(numCells + 1));
+    auto* offsets = offsetsArray->GetPointer(0);
+    offsets[0] = 0;
+    for (std::size_t c = 0; c < numCells; c++) {
+        const auto size = inCells[c]->GetNumberOfPoints();
+        offsets[c + 1] = offsets[c] + static_cast<vtkTypeInt64>(size);
     }
 
+    auto connArray = vtkSmartPointer<vtkTypeInt64Array>::New();
+    connArray->SetNumberOfValues(offsets[numCells]);
+    auto* conn = connArray->GetPointer(0);
+    ParallelFor(
+        numCells, CELLS_PER_BLOCK, NumThreads(),
+        [&](std::size_t begin, std::size_t end) {
+            for (auto c = begin; c < end; c++) {
+                auto* ids = conn + offsets[c];
+                for (auto point = inCells[c]->PointIdsBegin();
+                     point != inCells[c]->PointIdsEnd(); ++point) {
+                    *ids++ = static_cast<vtkTypeInt64>(*point);
+                }
+            }
+        });
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    polys->SetData(offsetsArray, connArray);
+
     // assign to the mesh
     output->SetPoints(points);
     output->SetPolys(polys);
-    if (pointNormals->GetNumberOfTuples() > 0) {
+    if (pointNormals) {
         output->GetPointData()->SetNormals(pointNormals);
     }
 }
@@ -55,35 +153,47 @@ void ITK2VTK(ITKMesh::Pointer input, vtkSmartPointer<vtkPolyData> output)
 ///// VTK Polydata -> ITK Mesh /////
 void VTK2ITK(vtkSmartPointer<vtkPolyData> input, ITKMesh::Pointer output)
 {
+    // points
+    const auto numPts = input->GetNumberOfPoints();
+    auto points = ITKPointsContainer::New();
+    auto& pts = points->CastToSTLContainer();
+    pts.resize(static_cast<std::size_t>(numPts));
+    if (numPts > 0) {
+        static_assert(sizeof(ITKPoint) == 3 * sizeof(double));
+        ::CopyTuples(input->GetPoints()->GetData(), pts[0].GetDataPointer());
+    }
+    output->SetPoints(points);
 
-    // points + normals
-    auto pointNormals = input->GetPointData()->GetNormals();
-    for (vtkIdType pointId = 0; pointId < input->GetNumberOfPoints();
-         ++pointId) {
-        auto point = input->GetPoint(pointId);
-        output->SetPoint(pointId, point);
-        if (pointNormals != nullptr) {
-            auto normal = pointNormals->GetTuple(pointId);
-            output->SetPointData(pointId, normal);
-        }
+    // normals, if there is one for every point
+    auto pointData = ITKMesh::PointDataContainer::New();
+    auto* pointNormals = input->GetPointData()->GetNormals();
+    if (pointNormals != nullptr and numPts > 0 and
+        pointNormals->GetNumberOfComponents() == 3 and
+        pointNormals->GetNumberOfTuples() == numPts) {
+        auto& normals = pointData->CastToSTLContainer();
+        normals.resize(static_cast<std::size_t>(numPts));
+        static_assert(sizeof(ITKPixel) == 3 * sizeof(double));
+        ::CopyTuples(pointNormals, normals[0].GetDataPointer());
     }
+    output->SetPointData(pointData);
 
     // cells
-    ITKCell::CellAutoPointer cell;
-    for (vtkIdType cellId = 0; cellId < input->GetNumberOfCells(); ++cellId) {
-        auto inputCell = input->GetCell(cellId);  // input cell
-        cell.TakeOwnership(new ITKTriangle);      // output cell
-
-        for (vtkIdType pointId = 0; pointId < inputCell->GetNumberOfPoints();
-             ++pointId) {
-            cell->SetPointId(
-                pointId,
-                inputCell->GetPointId(pointId));  // assign the point id's
-        }
-
-        output->SetCell(cellId, cell);
+    auto* polys = input->GetPolys();
+    auto cells = ITKMesh::CellsContainer::New();
+    auto& cellPtrs = cells->CastToSTLContainer();
+    cellPtrs.resize(static_cast<std::size_t>(polys->GetNumberOfCells()));
+    if (polys->IsStorage64Bit()) {
+        ::CopyTriangles(
+            polys->GetOffsetsArray64(), polys->GetConnectivityArray64(),
+            cellPtrs);
+    } else {
+        ::CopyTriangles(
+            polys->GetOffsetsArray32(), polys->GetConnectivityArray32(),
+            cellPtrs);
     }
+    output->SetCells(cells);
 }
+
 auto ITK2VTK(ITKMesh::Pointer input) -> vtkSmartPointer<vtkPolyData>
 {
     auto result = vtkSmartPointer<vtkPolyData>::New();
@@ -2,75 +2,197 @@
 // Abigail Coleman June 2015
 
 /** @file SmoothNormals.cpp*/
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
 #include <vector>
 
 #include <opencv2/core.hpp>
 
+#include "vc/core/util/Parallel.hpp"
 #include "vc/meshing/SmoothNormals.hpp"
 
-namespace volcart::meshing
+namespace
 {
+using Vertex = volcart::TriangleMesh::Vertex;
+
+// Number of vertices smoothed by each parallel task
+constexpr std::size_t VERTICES_PER_BLOCK{4096};
+
+// Limit on the number of grid cells per vertex
+constexpr double MAX_CELLS_PER_VERTEX{4};
 
-auto SmoothNormals(const ITKMesh::Pointer& input, double radius)
-    -> ITKMesh::Pointer
+// Uniform grid of vertex indices for fixed-radius neighbor searches. Cells are
+// at least as large as the search radius, so every neighbor of a point is in
+// the point's cell or one of the 26 cells around it.
+class VertexGrid
 {
-    // declare pointer to new Mesh object to be returned
-    auto outputMesh = ITKMesh::New();
-    DeepCopy(input, outputMesh);
-
-    // Variables for normal smoothing
-    cv::Vec3d neighborAvg;
-    double neighborCount;
-
-    // Use pointsLocator to find neighborhood within given radius
-    auto pointsLocator = ITKPointsLocator::New();
-    pointsLocator->SetPoints(input->GetPoints());
-    pointsLocator->Initialize();
-    typename ITKPointsLocator::NeighborsIdentifierType neighborhood;
-
-    // Iterate over all of the cells to lay out the faces in the output texture
-    for (auto point = input->GetPoints()->Begin();
-         point != input->GetPoints()->End(); ++point) {
-
-        // Empty our averaging variables
-        if (!neighborhood.empty()) {
-            neighborhood.clear();
+public:
+    VertexGrid(const std::vector<Vertex>& vertices, double radius)
+        : vertices_{vertices}, radius2_{radius < 0 ? -1 : radius * radius}
+    {
+        if (vertices_.empty()) {
+            return;
+        }
+
+        // Bounding box
+        min_ = max_ = vertices_.front();
+        for (const auto& v : vertices_) {
+            for (int d = 0; d < 3; d++) {
+                min_[d] = std::min(min_[d], v[d]);
+                max_[d] = std::max(max_[d], v[d]);
+            }
+        }
+        for (int d = 0; d < 3; d++) {
+            if (not std::isfinite(min_[d]) or not std::isfinite(max_[d])) {
+                throw std::invalid_argument("Mesh has non-finite vertices");
+            }
+        }
+
+        // Grow the cells if the grid would be much larger than the mesh
+        cellSize_ = radius > 0 ? radius : 1;
+        const auto maxCells = std::max(
+            MAX_CELLS_PER_VERTEX * static_cast<double>(vertices_.size()), 1.0);
+        std::array<double, 3> dims{};
+        while (true) {
+            for (int d = 0; d < 3; d++) {
+                dims[d] = std::floor((max_[d] - min_[d]) / cellSize_) + 1;
+            }
+            const auto numCells = dims[0] * dims[1] * dims[2];
+            if (numCells <= maxCells) {
+                break;
+            }
+            cellSize_ *= std::max(std::cbrt(numCells / maxCells), 1.1);
+        }
+        for (int d = 0; d < 3; d++) {
+            dims_[d] = static_cast<std::size_t>(dims[d]);
+        }
+
+        // Sort the vertex indices by cell. Within a cell, indices are in
+        // increasing order.
+        std::vector<std::size_t> cells(vertices_.size());
+        offsets_.assign(dims_[0] * dims_[1] * dims_[2] + 1, 0);
+        for (std::size_t i = 0; i < vertices_.size(); i++) {
+            cells[i] = cell_index_(cell_(vertices_[i]));
+            offsets_[cells[i] + 1]++;
+        }
+        std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+        indices_.resize(vertices_.size());
+        std::vector<std::size_t> next(offsets_.begin(), offsets_.end() - 1);
+        for (std::size_t i = 0; i < vertices_.size(); i++) {
+            indices_[next[cells[i]]++] = i;
+        }
+    }
+
+    // Call fn(index) for every vertex within the radius of the point
+    template <typename Fn>
+    void forEachNeighbor(const Vertex& p, Fn fn) const
+    {
+        const auto c = cell_(p);
+        std::array<std::size_t, 3> lo{};
+        std::array<std::size_t, 3> hi{};
+        for (int d = 0; d < 3; d++) {
+            lo[d] = c[d] > 0 ? c[d] - 1 : 0;
+            hi[d] = std::min(c[d] + 1, dims_[d] - 1);
+        }
+
+        for (auto z = lo[2]; z <= hi[2]; z++) {
+            for (auto y = lo[1]; y <= hi[1]; y++) {
+                for (auto x = lo[0]; x <= hi[0]; x++) {
+                    const auto cell = cell_index_({x, y, z});
+                    for (auto i = offsets_[cell]; i < offsets_[cell + 1];
+                         i++) {
+                        const auto idx = indices_[i];
+                        const auto diff = vertices_[idx] - p;
+                        if (diff.dot(diff) <= radius2_) {
+                            fn(idx);
+                        }
+                    }
+                }
+            }
         }
-        neighborCount = 0;
-        neighborAvg = cv::Vec3d(0, 0, 0);
-
-        // Get the current normal and add it to the summed normal
-        ITKPixel currentNormal;
-        input->GetPointData(point.Index(), &currentNormal);
-        neighborAvg[0] += currentNormal[0];
-        neighborAvg[1] += currentNormal[1];
-        neighborAvg[2] += currentNormal[2];
-        ++neighborCount;
-
-        // find neighborhood for current point within radius
-        pointsLocator->FindPointsWithinRadius(
-            point->Value(), radius, neighborhood);
-
-        // Sum the normals of the neighbors
-        for (auto nb : neighborhood) {
-            ITKPixel neighborNormal;
-            input->GetPointData(nb, &neighborNormal);
-
-            neighborAvg[0] += neighborNormal[0];
-            neighborAvg[1] += neighborNormal[1];
-            neighborAvg[2] += neighborNormal[2];
-            ++neighborCount;
+    }
+
+private:
+    // Cell coordinate of a point, clamped to the grid
+    [[nodiscard]] auto cell_(const Vertex& p) const
+        -> std::array<std::size_t, 3>
+    {
+        std::array<std::size_t, 3> c{};
+        for (int d = 0; d < 3; d++) {
+            const auto i = std::floor((p[d] - min_[d]) / cellSize_);
+            const auto maxIdx = static_cast<double>(dims_[d] - 1);
+            c[d] = static_cast<std::size_t>(std::clamp(i, 0.0, maxIdx));
         }
+        return c;
+    }
 
-        // Average the sum normal
-        currentNormal[0] = neighborAvg[0] / neighborCount;
-        currentNormal[1] = neighborAvg[1] / neighborCount;
-        currentNormal[2] = neighborAvg[2] / neighborCount;
-        outputMesh->SetPointData(point.Index(), currentNormal);
+    [[nodiscard]] auto cell_index_(const std::array<std::size_t, 3>& c) const
+        -> std::size_t
+    {
+        return (c[2] * dims_[1] + c[1]) * dims_[0] + c[0];
     }
 
+    const std::vector<Vertex>& vertices_;
+    double radius2_;
+    Vertex min_;
+    Vertex max_;
+    double cellSize_{1};
+    std::array<std::size_t, 3> dims_{1, 1, 1};
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> indices_;
+};
+}  // namespace
+
+namespace volcart::meshing
+{
+
+auto SmoothNormals(
+    const ITKMesh::Pointer& input,
+    double radius,
+    std::optional<std::uint32_t> maxThreads) -> ITKMesh::Pointer
+{
+    const auto mesh = TriangleMesh::FromITKMesh(input);
+    return SmoothNormals(*mesh, radius, maxThreads)->toITKMesh();
+}
+
+auto SmoothNormals(
+    const TriangleMesh& input,
+    double radius,
+    std::optional<std::uint32_t> maxThreads) -> TriangleMesh::Pointer
+{
+    if (not input.hasNormals()) {
+        throw std::invalid_argument("Input mesh does not have vertex normals");
+    }
+
+    auto outputMesh = TriangleMesh::New(input);
+    const auto& vertices = input.vertices();
+    const auto& normals = input.normals();
+    auto& smoothed = outputMesh->normals();
+
+    // Bin the vertices once, then search the neighborhoods in parallel
+    const ::VertexGrid grid(vertices, radius);
+    ParallelFor(
+        vertices.size(), VERTICES_PER_BLOCK, NumThreads(maxThreads),
+        [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                // Start with the current normal
+                auto neighborAvg = normals[i];
+                double neighborCount{1};
+
+                // Sum the normals of the neighbors within radius
+                grid.forEachNeighbor(vertices[i], [&](std::size_t nb) {
+                    neighborAvg += normals[nb];
+                    ++neighborCount;
+                });
+
+                // Average the sum normal
+                smoothed[i] = neighborAvg / neighborCount;
+            }
+        });
+
     return outputMesh;
 }
 }  // namespace volcart::meshing
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
 #include "vc/core/shapes/Plane.hpp"
+#include "vc/core/shapes/Sphere.hpp"
 #include "vc/meshing/CalculateNormals.hpp"
 
 class PlaneFixture : public ::testing::Test
@@ -30,3 +35,48 @@ TEST_F(PlaneFixture, ComputePlaneNormalsTest)
         EXPECT_DOUBLE_EQ(outNormal[2], inNormal[2]);
     }
 }
+
+TEST_F(PlaneFixture, ComputeVertexNormals)
+{
+    auto mesh = volcart::TriangleMesh::FromITKMesh(inMesh);
+    mesh->normals().clear();
+    volcart::meshing::ComputeVertexNormals(*mesh);
+    ASSERT_TRUE(mesh->hasNormals());
+
+    for (std::size_t i = 0; i < mesh->numVertices(); i++) {
+        volcart::ITKPixel inNormal;
+        inMesh->GetPointData(i, &inNormal);
+        const auto& n = mesh->normals()[i];
+        EXPECT_DOUBLE_EQ(n[0], inNormal[0]);
+        EXPECT_DOUBLE_EQ(n[1], inNormal[1]);
+        EXPECT_DOUBLE_EQ(n[2], inNormal[2]);
+    }
+}
+
+TEST(CalculateNormals, ComputeVertexNormalsThreadCount)
+{
+    // Large enough to be split into several blocks of faces and vertices
+    const volcart::shapes::Sphere sphere(5, 5);
+    auto serial = volcart::TriangleMesh::FromITKMesh(sphere.itkMesh());
+    ASSERT_GT(serial->numFaces(), 16384U);
+    ASSERT_GT(serial->numVertices(), 8192U);
+    auto parallel = volcart::TriangleMesh::New(*serial);
+    volcart::meshing::ComputeVertexNormals(*serial, 1);
+    volcart::meshing::ComputeVertexNormals(*parallel, 4);
+
+    // Each vertex sums its faces in the same order
+    ASSERT_TRUE(parallel->hasNormals());
+    EXPECT_EQ(serial->normals(), parallel->normals());
+
+    // Sphere normals point away from the center
+    for (std::size_t i = 0; i < parallel->numVertices(); i++) {
+        const auto v = cv::normalize(parallel->vertices()[i]);
+        EXPECT_GT(std::abs(v.dot(parallel->normals()[i])), 0.99);
+    }
+
+    // Faces must reference existing vertices
+    parallel->faces().push_back({0, 1, parallel->numVertices()});
+    EXPECT_THROW(
+        volcart::meshing::ComputeVertexNormals(*parallel),
+        std::invalid_argument);
+}
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <array>
 #include <cstddef>
+#include <stdexcept>
+
+#include <vtkCellArray.h>
+#include <vtkPointData.h>
 
 #include "vc/core/shapes/Arch.hpp"
 #include "vc/core/shapes/Cone.hpp"
@@ -879,4 +884,58 @@ TEST_F(NoNormalsFixture, MeshWithNoNormals)
     // VTK to ITK
     ITKMesh::Pointer itk_Mesh2 = ITKMesh::New();
     volcart::meshing::VTK2ITK(vtk_Mesh, itk_Mesh2);
-}
\ No newline at end of file
+
+    // Without normals, no normals are added
+    EXPECT_EQ(vtk_Mesh->GetPointData()->GetNormals(), nullptr);
+    EXPECT_EQ(itk_Mesh2->GetNumberOfPoints(), 4);
+    EXPECT_EQ(itk_Mesh2->GetNumberOfCells(), 2);
+    EXPECT_EQ(itk_Mesh2->GetPointData()->Size(), 0);
+}
+
+// Round trip conversions are exact
+TEST(ITK2VTK, RoundTrip)
+{
+    volcart::shapes::Sphere sphere;
+    auto input = sphere.itkMesh();
+    auto output = volcart::meshing::VTK2ITK(volcart::meshing::ITK2VTK(input));
+
+    ASSERT_EQ(output->GetNumberOfPoints(), input->GetNumberOfPoints());
+    ASSERT_EQ(output->GetNumberOfCells(), input->GetNumberOfCells());
+    for (std::size_t p = 0; p < input->GetNumberOfPoints(); p++) {
+        EXPECT_EQ(output->GetPoint(p), input->GetPoint(p));
+        ITKPixel inNormal;
+        ITKPixel outNormal;
+        input->GetPointData(p, &inNormal);
+        ASSERT_TRUE(output->GetPointData(p, &outNormal));
+        EXPECT_EQ(outNormal, inNormal);
+    }
+
+    auto inCell = input->GetCells()->Begin();
+    auto outCell = output->GetCells()->Begin();
+    for (; inCell != input->GetCells()->End(); ++inCell, ++outCell) {
+        ASSERT_EQ(outCell.Value()->GetNumberOfPoints(), 3);
+        for (int i = 0; i < 3; i++) {
+            EXPECT_EQ(
+                outCell.Value()->GetPointIds()[i],
+                inCell.Value()->GetPointIds()[i]);
+        }
+    }
+}
+
+// Only triangles can be converted to an ITKMesh
+TEST(ITK2VTK, NonTriangularPolygon)
+{
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    points->InsertNextPoint(0, 0, 0);
+    points->InsertNextPoint(1, 0, 0);
+    points->InsertNextPoint(1, 1, 0);
+    points->InsertNextPoint(0, 1, 0);
+    auto polys = vtkSmartPointer<vtkCellArray>::New();
+    const std::array<vtkIdType, 4> quad{0, 1, 2, 3};
+    polys->InsertNextCell(4, quad.data());
+    auto mesh = vtkSmartPointer<vtkPolyData>::New();
+    mesh->SetPoints(points);
+    mesh->SetPolys(polys);
+
+    EXPECT_THROW(volcart::meshing::VTK2ITK(mesh), std::invalid_argument);
+}
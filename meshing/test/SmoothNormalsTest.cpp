@@ -555,4 +555,40 @@ TEST_F(SmoothNormalsFixture, SmoothWithZeroRadiusTest)
         ++in_ArchCell;
         ++ZeroRadiusSmoothedCell;
     }
-}
\ No newline at end of file
+}
+
+/*
+ * Compare TriangleMesh smoothing against an exhaustive neighborhood search
+ */
+TEST_F(SmoothNormalsFixture, SmoothTriangleMeshMatchesBruteForce)
+{
+    // Large enough to be smoothed in several parallel blocks
+    const shapes::Sphere sphere(5, 5);
+    const auto mesh = TriangleMesh::FromITKMesh(sphere.itkMesh());
+    ASSERT_GT(mesh->numVertices(), 8192U);
+    const auto& vertices = mesh->vertices();
+    const auto& normals = mesh->normals();
+
+    for (const double radius : {0.0, 0.5, _SmoothingFactor}) {
+        const auto smoothed = volcart::meshing::SmoothNormals(*mesh, radius, 4);
+        ASSERT_EQ(smoothed->numVertices(), mesh->numVertices());
+
+        for (std::size_t i = 0; i < vertices.size(); i++) {
+            auto expected = normals[i];
+            double count{1};
+            for (std::size_t j = 0; j < vertices.size(); j++) {
+                const auto diff = vertices[j] - vertices[i];
+                if (diff.dot(diff) <= radius * radius) {
+                    expected += normals[j];
+                    ++count;
+                }
+            }
+            expected /= count;
+
+            const auto& n = smoothed->normals()[i];
+            volcart::testing::SmallOrClose(n[0], expected[0]);
+            volcart::testing::SmallOrClose(n[1], expected[1]);
+            volcart::testing::SmallOrClose(n[2], expected[2]);
+        }
+    }
+}
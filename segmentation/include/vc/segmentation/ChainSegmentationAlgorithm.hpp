@@ -4,6 +4,7 @@
 
 #include <cstddef>
 
+#include "vc/core/math/StructureTensorField.hpp"
 #include "vc/core/types/BoundingBox.hpp"
 #include "vc/core/types/Mixins.hpp"
 #include "vc/core/types/OrderedPointSet.hpp"
@@ -53,6 +54,20 @@ public:
 
     /** @brief Set the input chain of seed points */
     void setChain(Chain c) { startingChain_ = std::move(c); }
+
+    /**
+     * @brief Set a precomputed structure tensor field for the input Volume
+     *
+     * Algorithms which estimate the local surface orientation with the
+     * structure tensor look up the tensors in this field instead of computing
+     * them. The field's radius takes the place of the radius the algorithm
+     * would otherwise use. Positions outside of the field are computed as
+     * usual.
+     */
+    void setStructureTensorField(StructureTensorField::Pointer f)
+    {
+        stField_ = std::move(f);
+    }
     /**@}*/
 
     /**@{*/
@@ -103,6 +118,8 @@ protected:
     Volume::Pointer vol_;
     /** Seed chain */
     Chain startingChain_;
+    /** Precomputed structure tensor field */
+    StructureTensorField::Pointer stField_;
     /** Bounding box */
     Bounds bb_;
     /** Number of propagation steps */
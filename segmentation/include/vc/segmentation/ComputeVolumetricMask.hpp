@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 
 #include "vc/core/types/Mixins.hpp"
 #include "vc/core/types/PointSet.hpp"
@@ -21,6 +22,9 @@ namespace volcart::segmentation
  * compute a per-voxel mask for a segmented layer in a volume. For each slice
  * in the Z-range of the input PointSet, the points which intersect that slice
  * are used as the seeds for running the flood fill algorithm.
+ *
+ * Slices are independent of each other, so they are processed in parallel
+ * and each slice's mask is merged into the full volume mask as it completes.
  */
 class ComputeVolumetricMask : public IterationsProgress
 {
@@ -62,6 +66,16 @@ public:
      */
     void setMaxRadius(std::size_t radius);
 
+    /**
+     * @brief Set the maximum number of threads
+     *
+     * Default: The number of hardware threads
+     */
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
+
     /** @brief Computes the segmentation. */
     VolumetricMask::Pointer compute();
 
@@ -90,6 +104,8 @@ private:
     std::size_t maxRadius_{std::numeric_limits<std::size_t>::max()};
     /** Mask */
     VolumetricMask::Pointer mask_;
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 };
 
 }  // namespace volcart::segmentation
\ No newline at end of file
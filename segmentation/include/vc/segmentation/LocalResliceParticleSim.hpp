@@ -3,13 +3,20 @@
 /** @file */
 
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <optional>
+#include <vector>
 
+#include "vc/core/math/StructureTensor.hpp"
 #include "vc/core/types/OrderedPointSet.hpp"
+#include "vc/core/types/Reslice.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/segmentation/ChainSegmentationAlgorithm.hpp"
 #include "vc/segmentation/lrps/Common.hpp"
 #include "vc/segmentation/lrps/FittedCurve.hpp"
+#include "vc/segmentation/lrps/IntensityMap.hpp"
 
 namespace volcart::segmentation
 {
@@ -29,6 +36,9 @@ namespace volcart::segmentation
  *
  * The ending index is inclusive.
  *
+ * Candidate positions are generated for every point in parallel. Only the
+ * energy minimization, which couples all points of the chain, is serial.
+ *
  * @ingroup lrps
  */
 class LocalResliceSegmentation : public ChainSegmentationAlgorithm
@@ -104,6 +114,12 @@ public:
      */
     void setConsiderPrevious(bool b) { considerPrevious_ = b; }
 
+    /** @brief Set the maximum number of threads */
+    void setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads() { maxThreads_.reset(); }
+
     /** @brief Compute the segmentation */
     auto compute() -> PointSet override;
 
@@ -117,13 +133,36 @@ public:
     [[nodiscard]] auto progressIterations() const -> std::size_t override;
 
 private:
+    /**
+     * @brief Generate the candidate positions of a point on the curve
+     *
+     * Reslices the volume along the estimated normal at the point and returns
+     * the maxima of the intensity map as voxel positions, sorted from best to
+     * worst. Thread safe, as long as each thread uses its own workspace.
+     *
+     * @param ws Structure tensor workspace of the calling thread
+     * @param currentCurve Input curve
+     * @param index Index of point on curve
+     * @param map Debug: If not null, receives the intensity map
+     * @param reslice Debug: If not null, receives the reslice
+     */
+    auto generate_candidates_(
+        StructureTensorWorkspace& ws,
+        const FittedCurve& currentCurve,
+        int index,
+        std::optional<IntensityMap>* map,
+        std::optional<Reslice>* reslice) const -> std::deque<Voxel>;
+
     /**
      * @brief Estimate the normal to the curve at point index
+     * @param ws Structure tensor workspace of the calling thread
      * @param currentCurve Input curve
      * @param index Index of point on curve
      */
-    auto estimate_normal_at_index_(const FittedCurve& currentCurve, int index)
-        -> cv::Vec3d;
+    auto estimate_normal_at_index_(
+        StructureTensorWorkspace& ws,
+        const FittedCurve& currentCurve,
+        int index) const -> cv::Vec3d;
 
     /**
      * @brief Debug: Draw curve on slice image
@@ -171,5 +210,9 @@ private:
     double materialThickness_{100};
     /** Window size for reslice */
     int resliceSize_{32};
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
+    /** Structure tensor workspaces, one per thread */
+    std::vector<StructureTensorWorkspace> workspaces_;
 };
 }  // namespace volcart::segmentation
\ No newline at end of file
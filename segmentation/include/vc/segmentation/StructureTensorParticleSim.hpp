@@ -3,9 +3,13 @@
 /** @file */
 
 #include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
+#include "vc/core/math/StructureTensor.hpp"
 #include "vc/segmentation/ChainSegmentationAlgorithm.hpp"
 #include "vc/segmentation/stps/Particle.hpp"
 #include "vc/segmentation/stps/ParticleChain.hpp"
@@ -20,6 +24,11 @@ namespace volcart::segmentation
  * estimate of the local neighborhood as a guide. Point movement is constrained
  * by way of a corrective spring force between each point.
  *
+ * The forces on each particle are independent of one another, so every
+ * Runge-Kutta stage evaluates them in parallel. Each thread keeps its own
+ * StructureTensorWorkspace, and the intermediate chains and forces of each
+ * stage are stored in buffers which are reused for the whole run.
+ *
  * @ingroup stps
  */
 class StructureTensorParticleSim : public ChainSegmentationAlgorithm
@@ -50,6 +59,12 @@ public:
      * RK iterations per output step is determined by `stepSize_ / rkStepSize_`.
      */
     void setRKStepSize(double s) { rkStepSize_ = s; }
+
+    /** @brief Set the maximum number of threads */
+    void setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads() { maxThreads_.reset(); }
     /**@}*/
 
     /**@{*/
@@ -79,11 +94,31 @@ private:
      */
     double rkStepSize_{0.5};
 
-    /** Calculate the propagation force direction for each point in the chain */
-    ForceChain calc_prop_forces_(ParticleChain c);
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
+    /** Per-thread structure tensor workspaces */
+    std::vector<StructureTensorWorkspace> workspaces_;
+    /** Intermediate chain of the current Runge-Kutta stage */
+    ParticleChain stageChain_;
+    /** Forces of each Runge-Kutta stage */
+    std::vector<ForceChain> stageForces_;
+
+    /**
+     * Calculate the normalized sum of the propagation and corrective spring
+     * forces for each point in the chain. Points are processed in parallel.
+     */
+    void calc_forces_(const ParticleChain& c, ForceChain& forces);
+
+    /** Calculate the propagation force direction for a point in the chain */
+    auto calc_prop_force_(StructureTensorWorkspace& ws, const Particle& p) const
+        -> Force;
+
+    /** Calculate the corrective spring force for a point in the chain */
+    auto calc_spring_force_(const ParticleChain& c, std::size_t i) const
+        -> Force;
 
-    /** Calculate the corrective spring force for each point in the chain */
-    ForceChain calc_spring_forces_(ParticleChain c);
+    /** Set stageChain_ to the current chain offset by `scale * forces` */
+    void make_stage_chain_(const ForceChain& forces, double scale);
 
     /** Add the current chain to the final result point set */
     void add_chain_to_result_();
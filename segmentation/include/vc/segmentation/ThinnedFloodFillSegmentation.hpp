@@ -41,12 +41,13 @@ class ThinnedFloodFillSegmentation
     : public RegionGrowingSegmentationAlgorithmBaseClass
 {
 public:
-    using VoxelMask = volcart::PointSet<cv::Vec3i>;
+    /** Voxel mask type */
+    using VoxelMask = volcart::VolumetricMask;
 
     /** Sends when the segmentation is updated with intermediate results */
     Signal<PointSet> pointsetUpdated;
     /** Sends when the layer mask is updated with intermediate results */
-    Signal<VoxelMask> maskUpdated;
+    Signal<const VoxelMask&> maskUpdated;
 
     /** @brief Default constructor */
     ThinnedFloodFillSegmentation() = default;
@@ -101,7 +102,7 @@ public:
     PointSet compute() override;
 
     /** @brief Return the full, 3D mask. */
-    VoxelMask getMask() const;
+    const VoxelMask& getMask() const;
 
     /**
      * @brief Debug: Dumps visualizations of the mask and skeleton for each
@@ -44,10 +44,10 @@ public:
     auto operator*=(const double& rhs) -> ParticleChain&;
 
     /** @brief Element access operator */
-    auto operator[](std::size_t i) { return data_[i]; }
+    auto operator[](std::size_t i) -> Particle& { return data_[i]; }
 
     /** @copydoc operator[](std::size_t) */
-    auto operator[](std::size_t i) const { return data_[i]; }
+    auto operator[](std::size_t i) const -> const Particle& { return data_[i]; }
 
     /** @brief Returns an iterator to the beginning of the chain */
     auto begin() { return data_.begin(); }
@@ -80,6 +80,9 @@ public:
     /** @brief Empties and resets the chain */
     void clear() { data_.clear(); }
 
+    /** @brief Resizes the chain to contain `n` elements */
+    void resize(std::size_t n) { data_.resize(n); }
+
 private:
     /** Data storage vector */
     Chain data_;
@@ -2,6 +2,7 @@
 
 /** @file */
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
@@ -14,7 +15,7 @@ namespace volcart::segmentation
 {
 
 /** Get the list of a voxel's eight neighbors */
-std::vector<cv::Vec3i> GetNeighbors(const cv::Vec3i& v);
+std::array<cv::Vec3i, 8> GetNeighbors(const cv::Vec3i& v);
 
 /** Calculate the Euclidean distance between two voxels */
 int EuclideanDistance(const cv::Vec3i& start, const cv::Vec3i& end);
@@ -55,4 +56,18 @@ std::vector<cv::Vec3i> DoFloodFill(
     std::uint16_t low,
     std::uint16_t high);
 
+/**
+ * Run flood fill using the provided set of seed points
+ *
+ * Same as DoFloodFill(), but returns the filled points as a binary, 8-bit
+ * image the size of `img`. Filled pixels are 255 and all others are 0. Faster
+ * than DoFloodFill() when the result is needed as an image.
+ */
+cv::Mat FloodFillImage(
+    const std::vector<cv::Vec3i>& pts,
+    int bound,
+    const cv::Mat& img,
+    std::uint16_t low,
+    std::uint16_t high);
+
 }  // namespace volcart::segmentation
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "vc/segmentation/ComputeVolumetricMask.hpp"
 
 #include <map>
+#include <mutex>
+
 #include <opencv2/imgproc.hpp>
 
-#include "vc/core/util/Iteration.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/segmentation/tff/FloodFill.hpp"
 
 using namespace volcart;
@@ -30,6 +32,13 @@ void ComputeVolumetricMask::setMaxRadius(std::size_t radius)
     maxRadius_ = radius;
 }
 
+void ComputeVolumetricMask::setMaxThreads(std::uint32_t t)
+{
+    maxThreads_ = t;
+}
+
+void ComputeVolumetricMask::resetMaxThreads() { maxThreads_.reset(); }
+
 auto ComputeVolumetricMask::compute() -> VolumetricMask::Pointer
 {
     // Setup the output
@@ -49,63 +58,62 @@ auto ComputeVolumetricMask::compute() -> VolumetricMask::Pointer
 
     // Signal progress has begun
     progressStarted();
+    if (seedsBySlice.empty()) {
+        progressComplete();
+        return mask_;
+    }
 
-    // Iterate over z-slices
-    for (auto zIndex : range(startSlice, endSlice + 1)) {
-        // Update progress
-        progressUpdated(zIndex - startSlice);
-
-        // Get this slice's seed points
-        VoxelList seedPoints;
-        try {
-            seedPoints = seedsBySlice.at(zIndex);
-        } catch (const std::out_of_range& e) {
-            // No seeds for this slice. Skip.
-            continue;
-        }
+    // Every slice is independent given its seeds, so process the slices in
+    // parallel and merge each slice's mask into the full volume mask
+    std::mutex maskMutex;
+    ParallelProgress progress(progressUpdated);
+    auto slices = [&](std::size_t begin, std::size_t end) {
+        for (auto zIndex = startSlice + begin; zIndex < startSlice + end;
+             zIndex++) {
+            // Get this slice's seed points. Skip slices without seeds.
+            const auto seeds = seedsBySlice.find(zIndex);
+            if (seeds == seedsBySlice.end()) {
+                continue;
+            }
+            const auto& seedPoints = seeds->second;
 
-        // Get the current (single) slice image (Of type Mat)
-        auto slice = vol_->getSliceDataCopy(zIndex);
+            // Get the current (single) slice image (Of type Mat)
+            auto slice = vol_->getSliceDataCopy(zIndex);
 
-        // Estimate thickness of page from every seed point.
-        std::vector<std::size_t> estimates;
-        for (const auto& v : seedPoints) {
-            estimates.emplace_back(MeasureThickness(
-                v, slice, low_, high_, measureVertically_, maxRadius_));
-        }
+            // Estimate thickness of page from every seed point.
+            std::vector<std::size_t> estimates;
+            estimates.reserve(seedPoints.size());
+            for (const auto& v : seedPoints) {
+                estimates.emplace_back(MeasureThickness(
+                    v, slice, low_, high_, measureVertically_, maxRadius_));
+            }
 
-        // Calculate the median thickness.
-        // Choose the median of the measurements to be the boundary for every
-        // point.
-        auto bound = Median(estimates);
+            // Calculate the median thickness.
+            // Choose the median of the measurements to be the boundary for
+            // every point.
+            auto bound = Median(estimates);
 
-        // Do flood-fill with the given seed points to the estimated thickness.
-        auto sliceMask = DoFloodFill(seedPoints, bound, slice, low_, high_);
+            // Do flood-fill with the given seed points to the estimated
+            // thickness.
+            auto sliceImg =
+                FloodFillImage(seedPoints, bound, slice, low_, high_);
 
-        // Apply closing to fill holes and gaps.
-        if (enableClosing_) {
-            // Convert mask to a binary image so we can apply closing
-            cv::Mat binaryImg = cv::Mat::zeros(slice.size(), CV_8UC1);
-            for (const Voxel& v : sliceMask) {
-                binaryImg.at<std::uint8_t>(v[1], v[0]) = 255;
+            // Apply closing to fill holes and gaps.
+            if (enableClosing_) {
+                cv::Mat kernel = cv::Mat::ones(kernel_, kernel_, CV_8U);
+                cv::morphologyEx(sliceImg, sliceImg, cv::MORPH_CLOSE, kernel);
             }
 
-            cv::Mat kernel = cv::Mat::ones(kernel_, kernel_, CV_8U);
-            cv::Mat closedImg;
-            cv::morphologyEx(binaryImg, closedImg, cv::MORPH_CLOSE, kernel);
-
             // Save to the full volume mask
-            for (const auto p : range2D(closedImg.rows, closedImg.cols)) {
-                const auto& x = p.second;
-                const auto& y = p.first;
-                if (closedImg.at<std::uint8_t>(y, x) > 0) {
-                    mask_->setIn({x, y, zIndex});
-                }
-            }
-        } else {
-            mask_->setIn(sliceMask);
+            VolumetricMask sliceMask;
+            sliceMask.setIn(sliceImg, static_cast<int>(zIndex));
+            std::unique_lock lock(maskMutex);
+            mask_->merge(sliceMask);
         }
-    }
+        progress.add(end - begin);
+    };
+    ParallelFor(endSlice + 1 - startSlice, 1, NumThreads(maxThreads_), slices);
+
     progressComplete();
     return mask_;
 }
@@ -1,7 +1,7 @@
 #include "vc/segmentation/tff/FloodFill.hpp"
 
+#include <cstdint>
 #include <queue>
-#include <unordered_set>
 
 using namespace volcart;
 using namespace volcart::segmentation;
@@ -10,7 +10,6 @@ namespace vcs = volcart::segmentation;
 
 using Voxel = cv::Vec3i;
 using VoxelList = std::vector<cv::Vec3i>;
-using VoxelSet = std::unordered_set<Voxel, Vec3iHash>;
 
 struct VoxelPair {
     VoxelPair() = default;
@@ -20,12 +19,16 @@ struct VoxelPair {
     Voxel parent;
 };
 
-auto vcs::GetNeighbors(const cv::Vec3i& v) -> std::vector<cv::Vec3i>
+auto vcs::GetNeighbors(const cv::Vec3i& v) -> std::array<cv::Vec3i, 8>
 {
-    return {{v[0] - 1, v[1] - 1, v[2]}, {v[0], v[1] - 1, v[2]},
-            {v[0] + 1, v[1] - 1, v[2]}, {v[0] - 1, v[1], v[2]},
-            {v[0] + 1, v[1], v[2]},     {v[0] - 1, v[1] + 1, v[2]},
-            {v[0], v[1] + 1, v[2]},     {v[0] + 1, v[1] + 1, v[2]}};
+    return {{{v[0] - 1, v[1] - 1, v[2]},
+             {v[0], v[1] - 1, v[2]},
+             {v[0] + 1, v[1] - 1, v[2]},
+             {v[0] - 1, v[1], v[2]},
+             {v[0] + 1, v[1], v[2]},
+             {v[0] - 1, v[1] + 1, v[2]},
+             {v[0], v[1] + 1, v[2]},
+             {v[0] + 1, v[1] + 1, v[2]}}};
 }
 
 auto vcs::EuclideanDistance(const cv::Vec3i& start, const cv::Vec3i& end) -> int
@@ -90,24 +93,46 @@ auto vcs::MeasureThickness(
     return length;
 }
 
-auto vcs::DoFloodFill(
+namespace
+{
+// Run the bounded flood fill. Every filled pixel is set to 255 in `visited`
+// and passed to `onFill` in the order it was reached.
+template <typename OnFill>
+void FloodFill(
     const VoxelList& pts,
     int bound,
-    cv::Mat img,
+    const cv::Mat& img,
     std::uint16_t low,
-    std::uint16_t high) -> VoxelList
+    std::uint16_t high,
+    cv::Mat& visited,
+    OnFill onFill)
 {
-    std::queue<VoxelPair> q;
-    VoxelList mask;
-    VoxelSet visited;
+    visited = cv::Mat::zeros(img.size(), CV_8UC1);
+    auto inRange = [&](const Voxel& v) {
+        if (v[0] < 0 or v[0] >= img.cols or v[1] < 0 or v[1] >= img.rows) {
+            return false;
+        }
+        auto val = img.at<std::uint16_t>(v[1], v[0]);
+        return val >= low and val <= high;
+    };
+
+    // EuclideanDistance(a, b) <= bound, without the square root
+    const auto maxDist = static_cast<std::int64_t>(bound) + 1;
+    const auto maxDistSq = maxDist * maxDist;
+    auto inBound = [maxDistSq](const Voxel& a, const Voxel& b) {
+        const auto dx = static_cast<std::int64_t>(a[0] - b[0]);
+        const auto dy = static_cast<std::int64_t>(a[1] - b[1]);
+        const auto dz = static_cast<std::int64_t>(a[2] - b[2]);
+        return dx * dx + dy * dy + dz * dz < maxDistSq;
+    };
 
     // Push all the initial points onto the queue.
     // Initial points are their own 'parents'.
+    std::queue<VoxelPair> q;
     for (const auto& pt : pts) {
-        auto greyVal = img.at<std::uint16_t>(pt[1], pt[0]);
-        if (greyVal >= low && greyVal <= high) {
+        if (inRange(pt) and visited.at<std::uint8_t>(pt[1], pt[0]) == 0) {
             q.emplace(pt, pt);
-            visited.insert(pt);
+            visited.at<std::uint8_t>(pt[1], pt[0]) = 255;
         }
     }
 
@@ -117,33 +142,58 @@ auto vcs::DoFloodFill(
         q.pop();
 
         //'color'/record that cv::Vec3i as part of the mask
-        mask.push_back(pair.v);
+        onFill(pair.v);
 
         // check neighbors; if they're valid according to the user-defined
         // threshold AND they are not outside the original(/parent) seed point's
         // boundary, add them to the queue
         for (const auto& neighbor : GetNeighbors(pair.v)) {
-            // Make sure this cv::Vec3i hasn't already been added to the
-            // visited list: (We don't want to add it to the queue
-            // twice...)
-            if (visited.find(neighbor) != visited.end()) {
+            // Make sure this neighbor is in the image bounds and in the
+            // threshold range
+            if (not inRange(neighbor)) {
                 continue;
             }
 
-            // Make sure this neighbor is in the image bounds
-            if (neighbor[0] < 0 or neighbor[0] >= img.cols or neighbor[1] < 0 or
-                neighbor[1] >= img.rows) {
+            // Make sure this cv::Vec3i hasn't already been visited: (We don't
+            // want to add it to the queue twice...)
+            auto& flag = visited.at<std::uint8_t>(neighbor[1], neighbor[0]);
+            if (flag != 0) {
                 continue;
             }
 
             // Add the valid neighbor to the queue and mark it as visited.
-            auto val = img.at<std::uint16_t>(neighbor[1], neighbor[0]);
-            auto dist = EuclideanDistance(neighbor, pair.parent);
-            if (val >= low && val <= high && dist <= bound) {
+            if (inBound(neighbor, pair.parent)) {
                 q.emplace(neighbor, pair.parent);
-                visited.insert(neighbor);
+                flag = 255;
             }
         }
     }
+}
+}  // namespace
+
+auto vcs::DoFloodFill(
+    const VoxelList& pts,
+    int bound,
+    cv::Mat img,
+    std::uint16_t low,
+    std::uint16_t high) -> VoxelList
+{
+    VoxelList mask;
+    cv::Mat visited;
+    ::FloodFill(pts, bound, img, low, high, visited, [&mask](const Voxel& v) {
+        mask.push_back(v);
+    });
     return mask;
-}
\ No newline at end of file
+}
+
+auto vcs::FloodFillImage(
+    const VoxelList& pts,
+    int bound,
+    const cv::Mat& img,
+    std::uint16_t low,
+    std::uint16_t high) -> cv::Mat
+{
+    cv::Mat visited;
+    ::FloodFill(pts, bound, img, low, high, visited, [](const Voxel&) {});
+    return visited;
+}
@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <limits>
 #include <list>
+#include <optional>
 #include <tuple>
 
 #include <opencv2/core.hpp>
@@ -12,6 +13,7 @@
 
 #include "vc/core/filesystem.hpp"
 #include "vc/core/math/StructureTensor.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/segmentation/LocalResliceParticleSim.hpp"
 #include "vc/segmentation/lrps/Common.hpp"
 #include "vc/segmentation/lrps/Derivative.hpp"
@@ -24,6 +26,9 @@ namespace fs = volcart::filesystem;
 using std::begin;
 using std::end;
 
+// Number of particles per parallel block
+static constexpr std::size_t PARTICLES_PER_BLOCK = 4;
+
 auto LocalResliceSegmentation::progressIterations() const -> std::size_t
 {
     auto minZPoint = std::min_element(
@@ -76,6 +81,12 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
         (endIndex_ - startIndex + 1) / static_cast<std::uint64_t>(stepSize_));
     points.push_back(currentVs);
 
+    // Per-thread structure tensor workspaces
+    const auto radius = static_cast<int>(
+        std::ceil(materialThickness_ / vol_->voxelSize()) * 0.5);
+    const auto threads = NumThreads(maxThreads_);
+    workspaces_.assign(threads, StructureTensorWorkspace(radius));
+
     // Iterate over z-slices
     auto stepSize = static_cast<int>(stepSize_);
     std::size_t iteration{0};
@@ -106,50 +117,31 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
         }
 
         /////////////////////////////////////////////////////////
-        // 1. Generate all candidate positions for all particles
-        std::vector<std::deque<Voxel>> nextPositions;
-        nextPositions.reserve(currentCurve.size());
-        // XXX DEBUG
-        std::vector<IntensityMap> maps;
-        std::vector<Reslice> reslices;
-        maps.reserve(currentCurve.size());
-        reslices.reserve(currentCurve.size());
-        // XXX DEBUG
-        for (int i = 0; i < int(currentCurve.size()); ++i) {
-            // Estimate normal and reslice along it
-            const auto normal = estimate_normal_at_index_(currentCurve, i);
-            const auto reslice = vol_->reslice(
-                currentCurve(i), normal, {0, 0, 1}, resliceSize_, resliceSize_);
-            reslices.push_back(reslice);
-            auto resliceIntensities = reslice.sliceData();
-
-            // Make the intensity map `stepSize_` layers down from current
-            // position and find the maxima
-            const cv::Point2i center{
-                resliceIntensities.cols / 2, resliceIntensities.rows / 2};
-            const int nextLayerIndex = center.y + static_cast<int>(stepSize_);
-            IntensityMap map(
-                resliceIntensities, static_cast<int>(stepSize_),
-                peakDistanceWeight_, considerPrevious_);
-            const auto allMaxima = map.sortedMaxima();
-            maps.push_back(map);
-
-            // Handle case where there's no maxima - go straight down
-            if (allMaxima.empty()) {
-                nextPositions.emplace_back(
-                    std::deque<Voxel>{reslice.sliceToVoxelCoord<int>(
-                        {center.x, nextLayerIndex})});
-                continue;
-            }
-
-            // Convert maxima to voxel positions
-            std::deque<Voxel> maximaQueue;
-            for (auto&& maxima : allMaxima) {
-                maximaQueue.emplace_back(reslice.sliceToVoxelCoord<double>(
-                    {maxima.first, nextLayerIndex}));
-            }
-            nextPositions.push_back(maximaQueue);
+        // 1. Generate all candidate positions for all particles. Particles
+        // are independent, so they're processed in parallel and each worker
+        // uses its own workspace.
+        const auto numParticles = currentCurve.size();
+        std::vector<std::deque<Voxel>> nextPositions(numParticles);
+        // Debug: Only kept when dumping visualizations
+        std::vector<std::optional<IntensityMap>> maps;
+        std::vector<std::optional<Reslice>> reslices;
+        if (dumpVis_) {
+            maps.resize(numParticles);
+            reslices.resize(numParticles);
         }
+        ParallelFor(
+            numParticles, PARTICLES_PER_BLOCK,
+            static_cast<std::uint32_t>(workspaces_.size()),
+            [&](std::uint32_t worker, std::size_t begin, std::size_t end) {
+                auto& ws = workspaces_[worker];
+                for (auto i = begin; i < end; i++) {
+                    const auto idx = static_cast<int>(i);
+                    nextPositions[i] = generate_candidates_(
+                        ws, currentCurve, idx,
+                        dumpVis_ ? &maps[i] : nullptr,
+                        dumpVis_ ? &reslices[i] : nullptr);
+                }
+            });
 
         /////////////////////////////////////////////////////////
         // 2. Construct initial guess using top maxima for each next position
@@ -157,7 +149,9 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
         nextVs.reserve(currentVs.size());
         for (int i = 0; i < int(nextPositions.size()); ++i) {
             nextVs.push_back(nextPositions[i].front());
-            maps[i].setChosenMaximaIndex(0);
+            if (dumpVis_) {
+                maps[i]->setChosenMaximaIndex(0);
+            }
         }
         FittedCurve nextCurve(nextVs, zIndex + 1);
 
@@ -221,7 +215,9 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
                         combCurve, alpha_, k1_, k2_, beta_, delta_);
                     if (newE < minEnergy) {
                         minEnergy = newE;
-                        maps[maxDiffIdx].incrementMaximaIndex();
+                        if (dumpVis_) {
+                            maps[maxDiffIdx]->incrementMaximaIndex();
+                        }
                         nextVs = combVs;
                         nextCurve = combCurve;
                     }
@@ -306,8 +302,8 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
             for (std::size_t i = 0; i < nextVs.size(); ++i) {
                 cv::Mat chain =
                     draw_particle_on_slice_(currentCurve, zIndex, i);
-                cv::Mat resliceMat = reslices[i].draw();
-                cv::Mat map = maps[i].draw();
+                cv::Mat resliceMat = reslices[i]->draw();
+                cv::Mat map = maps[i]->draw();
                 std::stringstream stream;
                 stream << std::setw(nchars) << std::setfill('0') << zIndex
                        << "_" << std::setw(nchars) << std::setfill('0') << i;
@@ -332,13 +328,61 @@ auto LocalResliceSegmentation::compute() -> LocalResliceSegmentation::PointSet
     return create_final_pointset_(points);
 }
 
+auto LocalResliceSegmentation::generate_candidates_(
+    StructureTensorWorkspace& ws,
+    const FittedCurve& currentCurve,
+    int index,
+    std::optional<IntensityMap>* map,
+    std::optional<Reslice>* reslice) const -> std::deque<Voxel>
+{
+    // Estimate normal and reslice along it
+    const auto normal = estimate_normal_at_index_(ws, currentCurve, index);
+    const auto r = vol_->reslice(
+        currentCurve(index), normal, {0, 0, 1}, resliceSize_, resliceSize_);
+    auto resliceIntensities = r.sliceData();
+
+    // Make the intensity map `stepSize_` layers down from current
+    // position and find the maxima
+    const cv::Point2i center{
+        resliceIntensities.cols / 2, resliceIntensities.rows / 2};
+    const int nextLayerIndex = center.y + static_cast<int>(stepSize_);
+    IntensityMap intensityMap(
+        resliceIntensities, static_cast<int>(stepSize_), peakDistanceWeight_,
+        considerPrevious_);
+    const auto allMaxima = intensityMap.sortedMaxima();
+    if (map != nullptr) {
+        *map = intensityMap;
+    }
+    if (reslice != nullptr) {
+        *reslice = r;
+    }
+
+    // Handle case where there's no maxima - go straight down
+    if (allMaxima.empty()) {
+        return {r.sliceToVoxelCoord<int>({center.x, nextLayerIndex})};
+    }
+
+    // Convert maxima to voxel positions
+    std::deque<Voxel> maximaQueue;
+    for (auto&& maxima : allMaxima) {
+        maximaQueue.emplace_back(
+            r.sliceToVoxelCoord<double>({maxima.first, nextLayerIndex}));
+    }
+    return maximaQueue;
+}
+
 auto LocalResliceSegmentation::estimate_normal_at_index_(
-    const FittedCurve& currentCurve, int index) -> cv::Vec3d
+    StructureTensorWorkspace& ws,
+    const FittedCurve& currentCurve,
+    int index) const -> cv::Vec3d
 {
     auto currentVoxel = currentCurve(index);
-    auto radius = static_cast<int>(
-        std::ceil(materialThickness_ / vol_->voxelSize()) * 0.5);
-    auto eigenPairs = ComputeSubvoxelEigenPairs(vol_, currentVoxel, radius);
+    EigenPairs eigenPairs;
+    if (stField_ and stField_->isInBounds(currentVoxel)) {
+        eigenPairs = stField_->eigenPairsAt(currentVoxel);
+    } else {
+        eigenPairs = ws.subvoxelEigenPairs(vol_, currentVoxel);
+    }
     double exp0 = std::log10(eigenPairs[0].first);
     double exp1 = std::log10(eigenPairs[1].first);
     if (std::abs(exp0 - exp1) > 2.0) {
@@ -1,11 +1,17 @@
 #include "vc/segmentation/StructureTensorParticleSim.hpp"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "vc/core/math/StructureTensor.hpp"
+#include "vc/core/util/Parallel.hpp"
 
 namespace vc = volcart;
 using namespace vc::segmentation;
 
 static constexpr double RK_STEP_SCALE = 1.0 / 6.0;
+// Number of particles per parallel block
+static constexpr std::size_t PARTICLES_PER_BLOCK = 16;
 
 auto StructureTensorParticleSim::progressIterations() const -> std::size_t
 {
@@ -50,32 +56,39 @@ auto StructureTensorParticleSim::compute()
     // Runge-Kutta iterations
     auto rkIters = static_cast<std::size_t>(std::ceil(stepSize_ / rkStepSize_));
 
+    // Per-thread workspaces and stage buffers
+    const auto threads = NumThreads(maxThreads_);
+    workspaces_.assign(threads, StructureTensorWorkspace(radius_));
+    stageForces_.assign(4, ForceChain());
+
     // Sampled output iterations
     for (std::size_t it = 0; it < outIters; it++) {
         // Update progress
         progressUpdated(it);
 
         // Run Runge-Kutta multiple times to accumulate one full output step
+        auto& k1 = stageForces_[0];
+        auto& k2 = stageForces_[1];
+        auto& k3 = stageForces_[2];
+        auto& k4 = stageForces_[3];
         for (std::size_t rkIt = 0; rkIt < rkIters; rkIt++) {
             // K1
-            auto chainK1 = currentChain_;
-            auto k1 = calc_prop_forces_(chainK1) + calc_spring_forces_(chainK1);
-            ForceChain::Normalize(k1);
+            calc_forces_(currentChain_, k1);
             // K2
-            auto chainK2 = currentChain_ + (rkStepSize_ * 0.5 * k1);
-            auto k2 = calc_prop_forces_(chainK2) + calc_spring_forces_(chainK2);
-            ForceChain::Normalize(k2);
+            make_stage_chain_(k1, rkStepSize_ * 0.5);
+            calc_forces_(stageChain_, k2);
             // K3
-            auto chainK3 = currentChain_ + (rkStepSize_ * 0.5 * k2);
-            auto k3 = calc_prop_forces_(chainK3) + calc_spring_forces_(chainK3);
-            ForceChain::Normalize(k3);
+            make_stage_chain_(k2, rkStepSize_ * 0.5);
+            calc_forces_(stageChain_, k3);
             // K4
-            auto chainK4 = currentChain_ + (rkStepSize_ * k3);
-            auto k4 = calc_prop_forces_(chainK4) + calc_spring_forces_(chainK4);
-            ForceChain::Normalize(k4);
-
-            currentChain_ +=
-                (rkStepSize_ * RK_STEP_SCALE * (k1 + (2 * k2) + (2 * k3) + k4));
+            make_stage_chain_(k3, rkStepSize_);
+            calc_forces_(stageChain_, k4);
+
+            const auto scale = rkStepSize_ * RK_STEP_SCALE;
+            for (std::size_t i = 0; i < currentChain_.size(); i++) {
+                currentChain_[i] +=
+                    scale * (k1[i] + (2 * k2[i]) + (2 * k3[i]) + k4[i]);
+            }
         }
 
         if (chain_stopped_()) {
@@ -109,49 +122,70 @@ void StructureTensorParticleSim::add_chain_to_result_()
     result_.pushRow(row);
 }
 
-auto StructureTensorParticleSim::calc_prop_forces_(ParticleChain c)
-    -> ForceChain
+void StructureTensorParticleSim::calc_forces_(
+    const ParticleChain& c, ForceChain& forces)
 {
-    ForceChain res;
-    Force zDir{0, 0, 1};
-
-    for (const auto& p : c) {
-        auto ep = ComputeSubvoxelEigenPairs(vol_, p.pos(), radius_);
-        auto offset = ep[0].second;
-        offset = zDir - (zDir.dot(offset)) / (offset.dot(offset)) * offset;
-        cv::normalize(offset, offset);
-        res.push_back(offset * propagationScaleFactor_);
-    }
-
-    return res;
+    // Each worker uses its own workspace
+    forces.resize(c.size());
+    ParallelFor(
+        c.size(), PARTICLES_PER_BLOCK,
+        static_cast<std::uint32_t>(workspaces_.size()),
+        [&](std::uint32_t worker, std::size_t begin, std::size_t end) {
+            auto& ws = workspaces_[worker];
+            for (auto i = begin; i < end; i++) {
+                auto f = calc_prop_force_(ws, c[i]) + calc_spring_force_(c, i);
+                cv::normalize(f, f);
+                forces[i] = f;
+            }
+        });
 }
 
-auto StructureTensorParticleSim::calc_spring_forces_(ParticleChain c)
-    -> ForceChain
+auto StructureTensorParticleSim::calc_prop_force_(
+    StructureTensorWorkspace& ws, const Particle& p) const -> Force
 {
-    ForceChain res;
-    for (auto it = c.begin(); it != c.end(); it++) {
-        // Setup an empty force vector
-        Force f{0, 0, 0};
-
-        // Calculate left spring
-        if (it != c.begin()) {
-            auto vec = it->pos() - std::prev(it)->pos();
-            auto dist = cv::norm(vec);
-            cv::normalize(vec, vec, springConstantK_ * (dist - it->restingL()));
-            f += vec;
-        }
+    const Force zDir{0, 0, 1};
+    const auto& pos = p.pos();
+    auto ep = (stField_ and stField_->isInBounds(pos))
+                  ? stField_->eigenPairsAt(pos)
+                  : ws.subvoxelEigenPairs(vol_, pos);
+    auto offset = ep[0].second;
+    offset = zDir - (zDir.dot(offset)) / (offset.dot(offset)) * offset;
+    cv::normalize(offset, offset);
+    return offset * propagationScaleFactor_;
+}
 
-        // Calculate right resting
-        if (it != c.end() - 1) {
-            auto vec = std::next(it)->pos() - it->pos();
-            auto dist = cv::norm(vec);
-            cv::normalize(vec, vec, springConstantK_ * (dist - it->restingR()));
-            f += vec;
-        }
+auto StructureTensorParticleSim::calc_spring_force_(
+    const ParticleChain& c, std::size_t i) const -> Force
+{
+    // Setup an empty force vector
+    Force f{0, 0, 0};
+    const auto& p = c[i];
+
+    // Calculate left spring
+    if (i > 0) {
+        auto vec = p.pos() - c[i - 1].pos();
+        auto dist = cv::norm(vec);
+        cv::normalize(vec, vec, springConstantK_ * (dist - p.restingL()));
+        f += vec;
+    }
 
-        res.push_back(f);
+    // Calculate right resting
+    if (i + 1 < c.size()) {
+        auto vec = c[i + 1].pos() - p.pos();
+        auto dist = cv::norm(vec);
+        cv::normalize(vec, vec, springConstantK_ * (dist - p.restingR()));
+        f += vec;
     }
 
-    return res;
-}
\ No newline at end of file
+    return f;
+}
+
+void StructureTensorParticleSim::make_stage_chain_(
+    const ForceChain& forces, double scale)
+{
+    // Copy assignment reuses the stage chain's storage
+    stageChain_ = currentChain_;
+    for (std::size_t i = 0; i < stageChain_.size(); i++) {
+        stageChain_[i] += scale * forces[i];
+    }
+}
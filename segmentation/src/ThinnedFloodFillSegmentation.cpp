@@ -235,7 +235,7 @@ void TFF::setClosingKernelSize(int s) { kernel_ = s; }
 void TFF::setMeasureVertical(bool b) { measureVertically_ = b; }
 void TFF::setSpurLengthThreshold(int length) { spurLength_ = length; }
 void TFF::setMaxRadius(std::size_t radius) { maxRadius_ = radius; }
-auto TFF::getMask() const -> TFF::VoxelMask { return volMask_; }
+auto TFF::getMask() const -> const TFF::VoxelMask& { return volMask_; }
 void TFF::setDumpVis(bool b) { dumpVis_ = b; }
 
 auto TFF::compute() -> TFF::PointSet
@@ -299,17 +299,9 @@ auto TFF::compute() -> TFF::PointSet
         auto bound = Median(estimates);
 
         // Do flood-fill with the given seed points to the estimated thickness.
-        auto sliceMask = DoFloodFill(seedPoints, bound, slice, low_, high_);
-
-        // Convert mask to a binary image so we can apply closing and distance
-        // transform operations:
-        cv::Mat binaryImg = cv::Mat::zeros(slice.size(), CV_8UC1);
-
-        // Each voxel in the mask should be assigned 'white' in the binary
-        // image.
-        for (const Voxel& v : sliceMask) {
-            binaryImg.at<std::uint8_t>(v[1], v[0]) = 255;
-        }
+        // The result is a binary image so we can apply closing and distance
+        // transform operations.
+        auto binaryImg = FloodFillImage(seedPoints, bound, slice, low_, high_);
 
         // Apply closing to fill holes and gaps.
         cv::Mat kernel = cv::Mat::ones(kernel_, kernel_, CV_8U);
@@ -317,13 +309,7 @@ auto TFF::compute() -> TFF::PointSet
         cv::morphologyEx(binaryImg, closedImg, cv::MORPH_CLOSE, kernel);
 
         // Save to the full volume mask
-        for (const auto p : range2D(closedImg.rows, closedImg.cols)) {
-            const auto& x = p.second;
-            const auto& y = p.first;
-            if (closedImg.at<std::uint8_t>(y, x) > 0) {
-                volMask_.emplace_back(x, y, zIndex);
-            }
-        }
+        volMask_.setIn(closedImg, static_cast<int>(zIndex));
 
         // Dump image of mask on slice
         if (dumpVis_) {
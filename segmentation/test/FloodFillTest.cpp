@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "vc/segmentation/tff/FloodFill.hpp"
+
+using namespace volcart::segmentation;
+
+namespace
+{
+// A bright horizontal band, 3 pixels thick, with a gap in the middle
+auto MakeSlice() -> cv::Mat
+{
+    cv::Mat slice = cv::Mat::zeros(20, 30, CV_16UC1);
+    slice.rowRange(8, 11).setTo(1000);
+    slice.colRange(15, 16).setTo(0);
+    return slice;
+}
+}  // namespace
+
+TEST(FloodFill, GetNeighbors)
+{
+    const auto neighbors = GetNeighbors({5, 5, 2});
+    EXPECT_EQ(neighbors.size(), 8);
+    for (const auto& n : neighbors) {
+        EXPECT_EQ(n[2], 2);
+        EXPECT_LE(std::abs(n[0] - 5), 1);
+        EXPECT_LE(std::abs(n[1] - 5), 1);
+        EXPECT_NE(n, cv::Vec3i(5, 5, 2));
+    }
+}
+
+TEST(FloodFill, FillBand)
+{
+    const auto slice = ::MakeSlice();
+    const std::vector<cv::Vec3i> seeds{{2, 9, 0}};
+
+    // The fill stays in the left half of the band
+    const auto img = FloodFillImage(seeds, 100, slice, 500, 2000);
+    EXPECT_EQ(img.type(), CV_8UC1);
+    EXPECT_EQ(img.size(), slice.size());
+    EXPECT_EQ(cv::countNonZero(img), 15 * 3);
+    EXPECT_EQ(img.at<std::uint8_t>(8, 0), 255);
+    EXPECT_EQ(img.at<std::uint8_t>(10, 14), 255);
+    EXPECT_EQ(img.at<std::uint8_t>(9, 16), 0);
+    EXPECT_EQ(img.at<std::uint8_t>(7, 2), 0);
+
+    // The point list matches the image
+    const auto pts = DoFloodFill(seeds, 100, slice, 500, 2000);
+    EXPECT_EQ(pts.size(), 15 * 3);
+    for (const auto& p : pts) {
+        EXPECT_EQ(img.at<std::uint8_t>(p[1], p[0]), 255);
+    }
+}
+
+TEST(FloodFill, Bound)
+{
+    const auto slice = ::MakeSlice();
+    const std::vector<cv::Vec3i> seeds{{5, 9, 0}};
+
+    // Pixels are filled if their truncated distance to the seed is <= bound
+    const auto pts = DoFloodFill(seeds, 2, slice, 500, 2000);
+    for (const auto& p : pts) {
+        EXPECT_LE(EuclideanDistance(p, seeds[0]), 2);
+    }
+    const auto img = FloodFillImage(seeds, 2, slice, 500, 2000);
+    EXPECT_EQ(static_cast<std::size_t>(cv::countNonZero(img)), pts.size());
+    EXPECT_EQ(img.at<std::uint8_t>(9, 7), 255);
+    EXPECT_EQ(img.at<std::uint8_t>(10, 7), 255);
+    EXPECT_EQ(img.at<std::uint8_t>(9, 8), 0);
+
+    // Out of range seeds are ignored
+    const std::vector<cv::Vec3i> badSeeds{{5, 2, 0}, {-1, 9, 0}};
+    EXPECT_TRUE(DoFloodFill(badSeeds, 2, slice, 500, 2000).empty());
+}
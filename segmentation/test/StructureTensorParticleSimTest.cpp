@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/Volume.hpp"
+#include "vc/segmentation/StructureTensorParticleSim.hpp"
+
+using namespace volcart;
+using namespace volcart::segmentation;
+namespace fs = volcart::filesystem;
+
+namespace
+{
+constexpr int TEST_WIDTH{16};
+constexpr int TEST_HEIGHT{16};
+constexpr int TEST_SLICES{32};
+
+// Layers perpendicular to the x-axis. The intensity only changes along x.
+auto MakeVolume(const fs::path& path) -> Volume::Pointer
+{
+    fs::remove_all(path);
+    fs::create_directories(path);
+    auto vol = Volume::New(path, "layers", "Layers");
+    vol->setSliceWidth(TEST_WIDTH);
+    vol->setSliceHeight(TEST_HEIGHT);
+    vol->setNumberOfSlices(TEST_SLICES);
+    vol->setVoxelSize(1);
+    cv::Mat slice(TEST_HEIGHT, TEST_WIDTH, CV_16UC1);
+    for (int x = 0; x < TEST_WIDTH; x++) {
+        slice.col(x).setTo(1000 * x);
+    }
+    for (int z = 0; z < TEST_SLICES; z++) {
+        vol->setSliceData(z, slice);
+    }
+    return vol;
+}
+
+// A chain along the y-axis, long enough to be split between threads
+auto MakeChain() -> ChainSegmentationAlgorithm::Chain
+{
+    ChainSegmentationAlgorithm::Chain chain;
+    for (int i = 0; i < 64; i++) {
+        chain.emplace_back(8, 2.5 + 0.15 * i, 4);
+    }
+    return chain;
+}
+
+auto Segment(const Volume::Pointer& vol, std::uint32_t threads)
+    -> ChainSegmentationAlgorithm::PointSet
+{
+    StructureTensorParticleSim stps;
+    stps.setVolume(vol);
+    stps.setChain(::MakeChain());
+    stps.setMaterialThickness(4);
+    stps.setNumberOfSteps(10);
+    stps.setStepSize(1);
+    stps.setMaxThreads(threads);
+    auto result = stps.compute();
+    EXPECT_EQ(stps.getStatus(), ChainSegmentationAlgorithm::Status::Success);
+    return result;
+}
+}  // namespace
+
+TEST(StructureTensorParticleSim, PropagatesAlongLayers)
+{
+    auto vol = ::MakeVolume("vc_segmentation_STPS_Layers");
+    const auto chain = ::MakeChain();
+    const auto result = ::Segment(vol, 1);
+
+    // The chain follows the layer it starts in, one step in z per row
+    ASSERT_EQ(result.height(), 10U);
+    ASSERT_EQ(result.width(), chain.size());
+    for (std::size_t row = 0; row < result.height(); row++) {
+        for (std::size_t i = 0; i < chain.size(); i++) {
+            const auto expected =
+                chain[i] + cv::Vec3d(0, 0, static_cast<double>(row + 1));
+            EXPECT_LT(cv::norm(result(row, i) - expected), 1e-6);
+        }
+    }
+}
+
+TEST(StructureTensorParticleSim, ThreadsMatchSingleThread)
+{
+    auto vol = ::MakeVolume("vc_segmentation_STPS_Threads");
+    const auto expected = ::Segment(vol, 1);
+    for (const std::uint32_t threads : {2, 4}) {
+        const auto result = ::Segment(vol, threads);
+        ASSERT_EQ(result.height(), expected.height());
+        ASSERT_EQ(result.width(), expected.width());
+        for (std::size_t row = 0; row < result.height(); row++) {
+            for (std::size_t i = 0; i < result.width(); i++) {
+                EXPECT_EQ(result(row, i), expected(row, i));
+            }
+        }
+    }
+}
@@ -107,6 +107,17 @@ public:
     /** @copydoc setClampMax(std::uint16_t) */
     [[nodiscard]] auto clampMax() const -> std::uint16_t;
 
+    /**
+     * @brief Normalize the output image
+     *
+     * If true (default), normalize the output image between [0, 1]. Otherwise,
+     * return the raw integrated values.
+     */
+    void setNormalizeOutput(bool b);
+
+    /** @copydetails setNormalizeOutput(bool) */
+    [[nodiscard]] auto normalizeOutput() const -> bool;
+
     /**
      * @brief Set the weighting method
      *
@@ -182,6 +193,9 @@ private:
     /** Maximum allowed value in neighborhood when clamping is enabled */
     std::uint16_t clampMax_{std::numeric_limits<uint16_t>::max()};
 
+    /** Normalize output */
+    bool normalize_{true};
+
     /** Selected Weighting method */
     WeightMethod weight_{WeightMethod::None};
 
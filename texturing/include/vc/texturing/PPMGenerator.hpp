@@ -3,16 +3,19 @@
 /** @file */
 
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 
 #include "vc/core/types/ITKMesh.hpp"
 #include "vc/core/types/Mixins.hpp"
 #include "vc/core/types/PerPixelMap.hpp"
+#include "vc/core/types/TriangleMesh.hpp"
 #include "vc/core/types/UVMap.hpp"
 
 namespace volcart::texturing
 {
 /**
- * @brief Generates a PerPixelMap from an ITKMesh and a UVMap
+ * @brief Generates a PerPixelMap from a mesh and a UVMap
  *
  * Rasters a UVMap and embeds the raster with 2D-to-3D lookup information. Each
  * pixel in the PPM stores a vector of six double-precision floats which
@@ -51,6 +54,14 @@ public:
     /** @brief Set the input mesh */
     void setMesh(const ITKMesh::Pointer& m);
 
+    /**
+     * @copybrief setMesh(const ITKMesh::Pointer&)
+     *
+     * If the mesh has UVs, they are used instead of the input UV map. The
+     * mesh is not modified.
+     */
+    void setMesh(const TriangleMesh::Pointer& m);
+
     /** @brief Set the input UV map */
     void setUVMap(const UVMap::Pointer& u);
     /**@}*/
@@ -61,6 +72,16 @@ public:
 
     /** @brief Set the normal shading method */
     void setShading(Shading s);
+
+    /**
+     * @brief Set the maximum number of threads used by compute()
+     *
+     * By default, compute() uses every available hardware thread.
+     */
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
     /**@}*/
 
     /**@{*/
@@ -77,13 +98,18 @@ public:
     [[nodiscard]] auto progressIterations() const -> std::size_t override;
 
 private:
+    /** Get the input as a mesh with UVs and, if needed, normals */
+    [[nodiscard]] auto make_working_mesh_() const -> TriangleMesh::Pointer;
+
     /** Input mesh */
     ITKMesh::Pointer inputMesh_;
+    /** Input mesh, if set as a TriangleMesh */
+    TriangleMesh::Pointer inputFlatMesh_;
     /** Input UV Map */
     UVMap::Pointer uvMap_;
 
     /** Working mesh */
-    ITKMesh::Pointer workingMesh_;
+    TriangleMesh::Pointer workingMesh_;
     /** Output PerPixelMap */
     PerPixelMap::Pointer ppm_;
     /** Output shading */
@@ -92,6 +118,8 @@ private:
     std::size_t width_{0};
     /** Output height of the PerPixelMap */
     std::size_t height_{0};
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 };
 
 /**
@@ -3,7 +3,10 @@
 /** @file */
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 
 #include "vc/core/neighborhood/NeighborhoodGenerator.hpp"
 #include "vc/core/types/Mixins.hpp"
@@ -30,6 +33,17 @@ public:
     /** @brief Set the input Volume */
     void setVolume(Volume::Pointer vol);
 
+    /**
+     * @brief Set the maximum number of threads used by compute()
+     *
+     * By default, compute() uses every available hardware thread. Algorithms
+     * which do not support parallel execution ignore this setting.
+     */
+    void setMaxThreads(std::uint32_t t);
+
+    /** @brief Clear the maximum number of threads */
+    void resetMaxThreads();
+
     /** @brief Compute the Texture */
     virtual auto compute() -> Texture = 0;
 
@@ -51,11 +65,34 @@ protected:
     /** Default move operator */
     auto operator=(TexturingAlgorithm&&) -> TexturingAlgorithm& = default;
 
+    /** Mapping coordinates callback: fn(y, x) */
+    using MappingFn = std::function<void(std::size_t, std::size_t)>;
+
+    /**
+     * Call `fn` for every mapping in the PPM in order of increasing Z. The
+     * mappings are processed in blocks on up to maxThreads_ threads, so `fn`
+     * must be safe to call concurrently for different mappings. Emits
+     * progressUpdated() but not progressStarted() or progressComplete().
+     */
+    void for_each_mapping_(const MappingFn& fn);
+
+    /** Mapping coordinates block callback: fn(first, last) */
+    using MappingBlockFn = std::function<void(
+        const PerPixelMap::Coord2D*, const PerPixelMap::Coord2D*)>;
+
+    /**
+     * Same as for_each_mapping_(), but calls `fn` once for each block of
+     * consecutive mappings. Useful for batching Volume lookups.
+     */
+    void for_each_mapping_block_(const MappingBlockFn& fn);
+
     /** PPM */
     PerPixelMap::Pointer ppm_;
     /** Volume */
     Volume::Pointer vol_;
     /** Result */
     Texture result_;
+    /** Maximum number of threads */
+    std::optional<std::uint32_t> maxThreads_;
 };
 }  // namespace volcart::texturing
@@ -2,13 +2,12 @@
 
 #include <OpenABF/OpenABF.hpp>
 
+#include "vc/core/types/TriangleMesh.hpp"
 #include "vc/core/util/Logging.hpp"
 #include "vc/core/util/MeshMath.hpp"
-#include "vc/meshing/ScaleMesh.hpp"
 
 using namespace volcart;
 using namespace volcart::meshmath;
-using namespace volcart::meshing;
 using namespace volcart::texturing;
 
 using ABF = OpenABF::ABFPlusPlus<double>;
@@ -32,27 +31,25 @@ auto AngleBasedFlattening::compute() -> ITKMesh::Pointer
 {
     // Construct HEM
     auto hem = HalfEdgeMesh::New();
+    const auto mesh = TriangleMesh::FromITKMesh(mesh_);
 
     // Copy the points
     Logger()->debug("Inserting vertices into half-edge mesh");
     OpenABF::Vec3d p;
-    for (auto pt = mesh_->GetPoints()->Begin(); pt != mesh_->GetPoints()->End();
-         ++pt) {
-        p[0] = pt->Value()[0];
-        p[1] = pt->Value()[1];
-        p[2] = pt->Value()[2];
+    for (const auto& v : mesh->vertices()) {
+        p[0] = v[0];
+        p[1] = v[1];
+        p[2] = v[2];
         hem->insert_vertex(p);
     }
 
     // Copy the faces
     Logger()->debug("Inserting faces into half-edge mesh");
     OpenABF::Vec<std::size_t, 3> indices;
-    for (auto cell = mesh_->GetCells()->Begin();
-         cell != mesh_->GetCells()->End(); ++cell) {
-
-        indices[0] = cell.Value()->GetPointIdsContainer()[0];
-        indices[1] = cell.Value()->GetPointIdsContainer()[1];
-        indices[2] = cell.Value()->GetPointIdsContainer()[2];
+    for (const auto& f : mesh->faces()) {
+        indices[0] = f[0];
+        indices[1] = f[1];
+        indices[2] = f[2];
         hem->insert_face(indices);
     }
 
@@ -84,23 +81,20 @@ auto AngleBasedFlattening::compute() -> ITKMesh::Pointer
     // Fill output
     // OpenABF flattens to XY, but we want it on XZ
     Logger()->debug("Converting half-edge mesh to output mesh");
-    auto flatMesh = ITKMesh::New();
-    DeepCopy(mesh_, flatMesh);
-    ITKPoint pt;
-    cv::Vec3d norm{0.0, 1.0, 0.0};
+    auto flatMesh = TriangleMesh::New(*mesh);
+    auto& vertices = flatMesh->vertices();
+    flatMesh->normals().assign(vertices.size(), {0.0, 1.0, 0.0});
     for (const auto& v : hem->vertices()) {
-        pt[0] = v->pos[0];
-        pt[1] = 0.0;
-        pt[2] = v->pos[1];
-        flatMesh->SetPoint(v->idx, pt);
-        flatMesh->SetPointData(v->idx, norm.val);
+        vertices[v->idx] = {v->pos[0], 0.0, v->pos[1]};
     }
 
     // Scale mesh surface area to same as original
-    auto scale = std::sqrt(SurfaceArea(mesh_) / SurfaceArea(flatMesh));
+    auto scale = std::sqrt(SurfaceArea(*mesh) / SurfaceArea(*flatMesh));
     Logger()->debug("Scaling output mesh by scale factor {:.5g}", scale);
-    output_ = ITKMesh::New();
-    ScaleMesh(flatMesh, output_, scale);
+    for (auto& v : vertices) {
+        v *= scale;
+    }
+    output_ = flatMesh->toITKMesh();
 
     return output_;
 }
@@ -5,7 +5,6 @@
 #include <cstdint>
 
 #include "vc/core/util/FloatComparison.hpp"
-#include "vc/core/util/Iteration.hpp"
 
 using namespace volcart;
 using namespace volcart::texturing;
@@ -110,23 +109,10 @@ auto CompositeTexture::compute() -> Texture
     // Output image
     cv::Mat image = cv::Mat::zeros(height, width, CV_16UC1);
 
-    // Get the mappings
-    auto mappings = ppm_->getMappingCoords();
-
-    // Sort the mappings by Z-value
-    std::sort(
-        mappings.begin(), mappings.end(),
-        [&](const auto& lhs, const auto& rhs) {
-            return (*ppm_)(lhs.y, lhs.x)[2] < (*ppm_)(rhs.y, rhs.x)[2];
-        });
-
     // Iterate through the mappings
     progressStarted();
-    for (const auto [idx, coord] : enumerate(mappings)) {
-        progressUpdated(idx);
-
+    for_each_mapping_([&](auto y, auto x) {
         // Generate the neighborhood
-        const auto [y, x] = coord;
         const auto& m = ppm_->getMapping(y, x);
         const cv::Vec3d pos{m[0], m[1], m[2]};
         const cv::Vec3d normal{m[3], m[4], m[5]};
@@ -137,7 +123,7 @@ auto CompositeTexture::compute() -> Texture
         const auto v = static_cast<int>(y);
         const auto u = static_cast<int>(x);
         image.at<std::uint16_t>(v, u) = ::ApplyFilter(neighborhood, filter_);
-    }
+    });
     progressComplete();
 
     // Set output
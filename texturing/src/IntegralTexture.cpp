@@ -7,8 +7,6 @@
 
 #include <opencv2/core.hpp>
 
-#include "vc/core/util/Iteration.hpp"
-
 using namespace volcart;
 using namespace volcart::texturing;
 
@@ -28,23 +26,10 @@ auto IntegralTexture::compute() -> Texture
     // Output image
     cv::Mat image = cv::Mat::zeros(height, width, CV_32FC1);
 
-    // Get the mappings
-    auto mappings = ppm_->getMappingCoords();
-
-    // Sort the mappings by Z-value
-    std::sort(
-        mappings.begin(), mappings.end(),
-        [&](const auto& lhs, const auto& rhs) {
-            return (*ppm_)(lhs.y, lhs.x)[2] < (*ppm_)(rhs.y, rhs.x)[2];
-        });
-
     // Iterate through the mappings
     progressStarted();
-    for (const auto [idx, coord] : enumerate(mappings)) {
-        progressUpdated(idx);
-
+    for_each_mapping_([&](auto y, auto x) {
         // Generate the neighborhood
-        const auto [y, x] = coord;
         const auto& m = ppm_->getMapping(y, x);
         const cv::Vec3d pos{m[0], m[1], m[2]};
         const cv::Vec3d normal{m[3], m[4], m[5]};
@@ -69,10 +54,12 @@ auto IntegralTexture::compute() -> Texture
         const auto v = static_cast<int>(y);
         const auto u = static_cast<int>(x);
         image.at<float>(v, u) = static_cast<float>(value);
-    }
+    });
     progressComplete();
 
-    cv::normalize(image, image, 0.0, 1.0, cv::NORM_MINMAX);
+    if (normalize_) {
+        cv::normalize(image, image, 0.0, 1.0, cv::NORM_MINMAX);
+    }
 
     // Set output
     result_.push_back(image);
@@ -248,6 +235,10 @@ void IntegralTexture::setClampMax(std::uint16_t m) { clampMax_ = m; }
 
 auto IntegralTexture::clampMax() const -> std::uint16_t { return clampMax_; }
 
+void IntegralTexture::setNormalizeOutput(bool b) { normalize_ = b; }
+
+auto IntegralTexture::normalizeOutput() const -> bool { return normalize_; }
+
 void IntegralTexture::setWeightMethod(IntegralTexture::WeightMethod w)
 {
     weight_ = w;
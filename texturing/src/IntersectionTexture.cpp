@@ -1,8 +1,9 @@
 #include "vc/texturing/IntersectionTexture.hpp"
 
-#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <vector>
 
 using namespace volcart;
 using namespace volcart::texturing;
@@ -24,27 +25,25 @@ auto IntersectionTexture::compute() -> Texture
     // Output image
     cv::Mat image = cv::Mat::zeros(height, width, CV_16UC1);
 
-    // Get the mappings
-    auto mappings = ppm_->getMappingCoords();
-
-    // Sort the mappings by Z-value
-    std::sort(
-        mappings.begin(), mappings.end(),
-        [&](const auto& lhs, const auto& rhs) {
-            return (*ppm_)(lhs.y, lhs.x)[2] < (*ppm_)(rhs.y, rhs.x)[2];
-        });
-
     // Iterate through the mappings
-    std::size_t counter{0};
     progressStarted();
-    for (const auto [y, x] : mappings) {
-        progressUpdated(counter++);
+    for_each_mapping_block_([&](auto first, auto last) {
+        // Sample the block in one batch
+        std::vector<cv::Vec3d> pts;
+        pts.reserve(std::distance(first, last));
+        for (auto it = first; it != last; ++it) {
+            const auto& m = ppm_->getMapping(it->y, it->x);
+            pts.emplace_back(m[0], m[1], m[2]);
+        }
+        const auto values = vol_->interpolateAt(pts);
 
         // Assign the intensity value at the XY position
-        const auto& m = ppm_->getMapping(y, x);
-        image.at<std::uint16_t>(static_cast<int>(y), static_cast<int>(x)) =
-            vol_->interpolateAt({m[0], m[1], m[2]});
-    }
+        for (auto it = first; it != last; ++it) {
+            const auto y = static_cast<int>(it->y);
+            const auto x = static_cast<int>(it->x);
+            image.at<std::uint16_t>(y, x) = values[it - first];
+        }
+    });
     progressComplete();
 
     // Set output
@@ -25,23 +25,10 @@ auto LayerTexture::compute() -> Texture
         result_.emplace_back(cv::Mat::zeros(height, width, CV_16UC1));
     }
 
-    // Get the mappings
-    auto mappings = ppm_->getMappingCoords();
-
-    // Sort the mappings by Z-value
-    std::sort(
-        mappings.begin(), mappings.end(),
-        [&](const auto& lhs, const auto& rhs) {
-            return (*ppm_)(lhs.y, lhs.x)[2] < (*ppm_)(rhs.y, rhs.x)[2];
-        });
-
     // Iterate through the mappings
     progressStarted();
-    for (const auto [idx, coord] : enumerate(mappings)) {
-        progressUpdated(idx);
-
+    for_each_mapping_([&](auto y, auto x) {
         // Generate the neighborhood
-        const auto [y, x] = coord;
         const auto& m = ppm_->getMapping(y, x);
         const cv::Vec3d pos{m[0], m[1], m[2]};
         const cv::Vec3d normal{m[3], m[4], m[5]};
@@ -53,7 +40,7 @@ auto LayerTexture::compute() -> Texture
             const auto xx = static_cast<int>(x);
             result_.at(it).at<std::uint16_t>(yy, xx) = v;
         }
-    }
+    });
     progressComplete();
 
     return result_;
@@ -1,7 +1,11 @@
 #include "vc/texturing/PPMGenerator.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <exception>
+#include <optional>
+#include <vector>
 
 #include <bvh/bvh.hpp>
 #include <bvh/primitive_intersectors.hpp>
@@ -14,6 +18,7 @@
 
 #include "vc/core/util/BarycentricCoordinates.hpp"
 #include "vc/core/util/Iteration.hpp"
+#include "vc/core/util/Parallel.hpp"
 #include "vc/meshing/CalculateNormals.hpp"
 
 using namespace volcart;
@@ -32,11 +37,103 @@ using Bvh = bvh::Bvh<Scalar>;
 using Intersector = bvh::ClosestPrimitiveIntersector<Bvh, Triangle>;
 using Traverser = bvh::SingleRayTraverser<Bvh>;
 
+namespace
+{
+// Target number of pixels per parallel work item
+constexpr std::size_t PIXELS_PER_BLOCK{4096};
+
+// Vertex indices of a face
+using Face = TriangleMesh::Face;
+
+// Get the UV coordinate of every vertex as a 3D point on the z = 0 plane
+auto VertexUVs(const TriangleMesh& mesh) -> std::vector<cv::Vec3d>
+{
+    std::vector<cv::Vec3d> uvs;
+    uvs.reserve(mesh.numVertices());
+    for (const auto& uv : mesh.uvs()) {
+        uvs.emplace_back(uv[0], uv[1], 0.0);
+    }
+    return uvs;
+}
+
+// BVH of the mesh faces in UV space. The primitive index of an intersection is
+// the index of the face in the list of faces.
+class UVFaceTree
+{
+public:
+    UVFaceTree(
+        const std::vector<Face>& faces, const std::vector<cv::Vec3d>& uvs)
+    {
+        triangles_.reserve(faces.size());
+        for (const auto& [a, b, c] : faces) {
+            const auto& uvA = uvs[a];
+            const auto& uvB = uvs[b];
+            const auto& uvC = uvs[c];
+            triangles_.emplace_back(
+                Vector3(uvA[0], uvA[1], 0), Vector3(uvB[0], uvB[1], 0),
+                Vector3(uvC[0], uvC[1], 0));
+        }
+        bvh::SweepSahBuilder<Bvh> builder(bvh_);
+        auto [bboxes, centers] = bvh::compute_bounding_boxes_and_centers(
+            triangles_.data(), triangles_.size());
+        auto meshBBox =
+            bvh::compute_bounding_boxes_union(bboxes.get(), triangles_.size());
+        builder.build(meshBBox, bboxes.get(), centers.get(), triangles_.size());
+    }
+
+    // Intersects a single UV position with the faces. Create one per thread.
+    class Query
+    {
+    public:
+        explicit Query(const UVFaceTree& tree)
+            : intersector_{tree.bvh_, tree.triangles_.data()}
+            , traverser_{tree.bvh_}
+        {
+        }
+
+        // Get the index of the face which contains the UV position
+        auto operator()(double u, double v) -> std::optional<std::size_t>
+        {
+            Ray ray(Vector3(u, v, 0), Vector3(u, v, 1.0), 0.0, 1.0);
+            auto hit = traverser_.traverse(ray, intersector_);
+            if (not hit) {
+                return std::nullopt;
+            }
+            return hit->primitive_index;
+        }
+
+    private:
+        Intersector intersector_;
+        Traverser traverser_;
+    };
+
+private:
+    std::vector<Triangle> triangles_;
+    Bvh bvh_;
+};
+
+// Number of image rows per parallel work item
+auto RowsPerBlock(std::size_t width) -> std::size_t
+{
+    return std::max(std::size_t{1}, PIXELS_PER_BLOCK / width);
+}
+}  // namespace
+
 PPMGenerator::PPMGenerator(std::size_t h, std::size_t w) : width_{w}, height_{h}
 {
 }
 
-void PPMGenerator::setMesh(const ITKMesh::Pointer& m) { inputMesh_ = m; }
+void PPMGenerator::setMesh(const ITKMesh::Pointer& m)
+{
+    inputMesh_ = m;
+    inputFlatMesh_.reset();
+}
+
+void PPMGenerator::setMesh(const TriangleMesh::Pointer& m)
+{
+    inputFlatMesh_ = m;
+    inputMesh_ = nullptr;
+}
 
 void PPMGenerator::setUVMap(const UVMap::Pointer& u) { uvMap_ = u; }
 
@@ -49,6 +146,10 @@ void PPMGenerator::setDimensions(std::size_t h, std::size_t w)
 
 void PPMGenerator::setShading(PPMGenerator::Shading s) { shading_ = s; }
 
+void PPMGenerator::setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+void PPMGenerator::resetMaxThreads() { maxThreads_.reset(); }
+
 auto PPMGenerator::getPPM() const -> PerPixelMap::Pointer { return ppm_; }
 
 auto PPMGenerator::progressIterations() const -> std::size_t
@@ -59,21 +160,12 @@ auto PPMGenerator::progressIterations() const -> std::size_t
 // Compute
 auto PPMGenerator::compute() -> PerPixelMap::Pointer
 {
-    if (inputMesh_.IsNull() || inputMesh_->GetNumberOfPoints() == 0 ||
-        inputMesh_->GetNumberOfCells() == 0 || not uvMap_ || uvMap_->empty() ||
-        width_ == 0 || height_ == 0) {
-        const auto* msg = "Invalid input parameters";
-        throw std::invalid_argument(msg);
-    }
-
-    // Generate normals
-    if (shading_ == Shading::Smooth &&
-        inputMesh_->GetPointData()->Size() != inputMesh_->GetNumberOfPoints()) {
-        vcm::CalculateNormals normCalc(inputMesh_);
-        workingMesh_ = normCalc.compute();
-    } else {
-        workingMesh_ = inputMesh_;
-    }
+    // Flatten the mesh for fast, lock-free lookups
+    workingMesh_ = make_working_mesh_();
+    const auto& faces = workingMesh_->faces();
+    const auto& xyzs = workingMesh_->vertices();
+    const auto& normals = workingMesh_->normals();
+    const auto uvs = ::VertexUVs(*workingMesh_);
 
     // Setup the output
     ppm_ = PerPixelMap::New(height_, width_);
@@ -82,108 +174,60 @@ auto PPMGenerator::compute() -> PerPixelMap::Pointer
     cellMap = cv::Scalar::all(-1);
 
     // Create BVH for mesh
-    std::vector<Triangle> triangles;
-    for (auto cell = workingMesh_->GetCells()->Begin();
-         cell != workingMesh_->GetCells()->End(); ++cell) {
-        // Get the vertex IDs
-        auto a = cell->Value()->GetPointIdsContainer().GetElement(0);
-        auto b = cell->Value()->GetPointIdsContainer().GetElement(1);
-        auto c = cell->Value()->GetPointIdsContainer().GetElement(2);
-
-        auto uvA = uvMap_->get(a);
-        auto uvB = uvMap_->get(b);
-        auto uvC = uvMap_->get(c);
-
-        // Add the face to the BVH tree
-        triangles.emplace_back(
-            Vector3(uvA[0], uvA[1], 0), Vector3(uvB[0], uvB[1], 0),
-            Vector3(uvC[0], uvC[1], 0));
-    }
-    Bvh bvh;
-    bvh::SweepSahBuilder<Bvh> builder(bvh);
-    auto [bboxes, centers] = bvh::compute_bounding_boxes_and_centers(
-        triangles.data(), triangles.size());
-    auto meshBBox =
-        bvh::compute_bounding_boxes_union(bboxes.get(), triangles.size());
-    builder.build(meshBBox, bboxes.get(), centers.get(), triangles.size());
-    Intersector intersector(bvh, triangles.data());
-    Traverser traverser(bvh);
-
-    // Iterate over all of the pixels
-    progressStarted();
-    ITKCell::CellAutoPointer cell;
-    for (const auto [y, x] : range2D(height_, width_)) {
-        progressUpdated(y * width_ + x);
-        // This pixel's uv coordinate
-        cv::Vec3d uv{0, 0, 0};
-        uv[0] = static_cast<double>(x) / static_cast<double>(width_ - 1);
-        uv[1] = static_cast<double>(y) / static_cast<double>(height_ - 1);
-
-        // Intersect a ray with the data structure
-        Ray ray(Vector3(uv[0], uv[1], 0), Vector3(uv[0], uv[1], 1.0), 0.0, 1.0);
-        auto hit = traverser.traverse(ray, intersector);
-        if (not hit) {
-            continue;
-        }
+    const ::UVFaceTree tree(faces, uvs);
 
-        // Cell info
-        auto cellId = hit->primitive_index;
-        cell.TakeOwnership(new ITKTriangle);
-        workingMesh_->GetCell(cellId, cell);
-        auto a = cell->GetPointIdsContainer().GetElement(0);
-        auto b = cell->GetPointIdsContainer().GetElement(1);
-        auto c = cell->GetPointIdsContainer().GetElement(2);
-
-        // Get the 2D and 3D pts
-        std::vector<cv::Vec3d> uvPts;
-        std::vector<cv::Vec3d> xyzPts;
-        for (const auto& idx : {a, b, c}) {
-            auto uvPt = uvMap_->get(idx);
-            auto xyzPt = workingMesh_->GetPoint(idx);
-            uvPts.emplace_back(uvPt[0], uvPt[1], 0.0);
-            xyzPts.emplace_back(xyzPt[0], xyzPt[1], xyzPt[2]);
-        }
+    // Iterate over all of the pixels, distributing blocks of rows over threads
+    progressStarted();
+    ParallelProgress progress(progressUpdated);
+    auto rows = [&](std::size_t y0, std::size_t y1) {
+        ::UVFaceTree::Query query(tree);
+        for (const auto [y, x] : range2D(y0, y1, 0, width_)) {
+            // This pixel's uv coordinate
+            cv::Vec3d uv{0, 0, 0};
+            uv[0] = static_cast<double>(x) / static_cast<double>(width_ - 1);
+            uv[1] = static_cast<double>(y) / static_cast<double>(height_ - 1);
+
+            // Intersect a ray with the data structure
+            auto hit = query(uv[0], uv[1]);
+            if (not hit) {
+                continue;
+            }
 
-        // Find the xyz coordinate of the original point
-        auto baryCoord =
-            CartesianToBarycentric(uv, uvPts[0], uvPts[1], uvPts[2]);
-        auto xyz =
-            BarycentricToCartesian(baryCoord, xyzPts[0], xyzPts[1], xyzPts[2]);
-
-        // Get this corresponding normal
-        cv::Vec3d xyzNorm;
-        if (shading_ == Shading::Flat) {
-            auto v1v0 = xyzPts[1] - xyzPts[0];
-            auto v2v0 = xyzPts[2] - xyzPts[0];
-            xyzNorm = cv::normalize(v1v0.cross(v2v0));
-        } else {
-            ITKPixel nA;
-            ITKPixel nB;
-            ITKPixel nC;
-            auto found = workingMesh_->GetPointData(a, &nA);
-            found &= workingMesh_->GetPointData(b, &nB);
-            found &= workingMesh_->GetPointData(c, &nC);
-            if (not found) {
-                throw std::runtime_error(
-                    "Performing smooth shading but missing vertex normal");
+            // Get the 2D and 3D pts
+            const auto cellId = hit.value();
+            const auto& [a, b, c] = faces[cellId];
+
+            // Find the xyz coordinate of the original point
+            auto baryCoord = CartesianToBarycentric(uv, uvs[a], uvs[b], uvs[c]);
+            auto xyz =
+                BarycentricToCartesian(baryCoord, xyzs[a], xyzs[b], xyzs[c]);
+
+            // Get this corresponding normal
+            cv::Vec3d xyzNorm;
+            if (shading_ == Shading::Flat) {
+                auto v1v0 = xyzs[b] - xyzs[a];
+                auto v2v0 = xyzs[c] - xyzs[a];
+                xyzNorm = cv::normalize(v1v0.cross(v2v0));
+            } else {
+                xyzNorm = BarycentricNormalInterpolation(
+                    baryCoord, normals[a], normals[b], normals[c]);
             }
-            xyzNorm = BarycentricNormalInterpolation(
-                baryCoord, {nA[0], nA[1], nA[2]}, {nB[0], nB[1], nB[2]},
-                {nC[0], nC[1], nC[2]});
-        }
 
-        // Assign the cell index to the cell map
-        auto intX = static_cast<int>(x);
-        auto intY = static_cast<int>(y);
-        cellMap.at<std::int32_t>(intY, intX) = cellId;
+            // Assign the cell index to the cell map
+            auto intX = static_cast<int>(x);
+            auto intY = static_cast<int>(y);
+            cellMap.at<std::int32_t>(intY, intX) = static_cast<int>(cellId);
 
-        // Assign the intensity value at the UV position
-        mask.at<std::uint8_t>(intY, intX) = MASK_TRUE;
+            // Assign the intensity value at the UV position
+            mask.at<std::uint8_t>(intY, intX) = MASK_TRUE;
 
-        // Assign 3D position to the lookup map
-        ppm_->getMapping(y, x) = cv::Vec6d(
-            xyz(0), xyz(1), xyz(2), xyzNorm(0), xyzNorm(1), xyzNorm(2));
-    }
+            // Assign 3D position to the lookup map
+            ppm_->getMapping(y, x) = cv::Vec6d(
+                xyz(0), xyz(1), xyz(2), xyzNorm(0), xyzNorm(1), xyzNorm(2));
+        }
+        progress.add((y1 - y0) * width_);
+    };
+    ParallelFor(height_, ::RowsPerBlock(width_), NumThreads(maxThreads_), rows);
     progressComplete();
 
     // Finish setting up the output
@@ -193,6 +237,51 @@ auto PPMGenerator::compute() -> PerPixelMap::Pointer
     return ppm_;
 }
 
+auto PPMGenerator::make_working_mesh_() const -> TriangleMesh::Pointer
+{
+    const auto* msg = "Invalid input parameters";
+    if (width_ == 0 || height_ == 0) {
+        throw std::invalid_argument(msg);
+    }
+
+    // Get a mesh with UVs
+    TriangleMesh::Pointer mesh;
+    const auto hasUVMap = uvMap_ and not uvMap_->empty();
+    if (inputFlatMesh_) {
+        if (inputFlatMesh_->empty() || inputFlatMesh_->numFaces() == 0) {
+            throw std::invalid_argument(msg);
+        }
+        if (inputFlatMesh_->hasUVs()) {
+            mesh = inputFlatMesh_;
+        } else if (hasUVMap) {
+            mesh = TriangleMesh::New(*inputFlatMesh_);
+            auto& uvs = mesh->uvs();
+            uvs.resize(mesh->numVertices());
+            for (const auto idx : range(uvs.size())) {
+                uvs[idx] = uvMap_->get(idx);
+            }
+        } else {
+            throw std::invalid_argument(msg);
+        }
+    } else {
+        if (inputMesh_.IsNull() || inputMesh_->GetNumberOfPoints() == 0 ||
+            inputMesh_->GetNumberOfCells() == 0 || not hasUVMap) {
+            throw std::invalid_argument(msg);
+        }
+        mesh = TriangleMesh::FromITKMesh(inputMesh_, uvMap_);
+    }
+
+    // Generate normals without modifying the input
+    if (shading_ == Shading::Smooth && not mesh->hasNormals()) {
+        if (mesh == inputFlatMesh_) {
+            mesh = TriangleMesh::New(*inputFlatMesh_);
+        }
+        vcm::ComputeVertexNormals(*mesh, maxThreads_);
+    }
+
+    return mesh;
+}
+
 auto vct::GenerateCellMap(
     const ITKMesh::Pointer& mesh,
     const UVMap::Pointer& uvMap,
@@ -204,53 +293,32 @@ auto vct::GenerateCellMap(
     cellMap = cv::Scalar::all(-1);
 
     // Create BVH for mesh
-    std::vector<Triangle> triangles;
-    for (auto cell = mesh->GetCells()->Begin(); cell != mesh->GetCells()->End();
-         ++cell) {
-        // Get the vertex IDs
-        auto a = cell->Value()->GetPointIdsContainer().GetElement(0);
-        auto b = cell->Value()->GetPointIdsContainer().GetElement(1);
-        auto c = cell->Value()->GetPointIdsContainer().GetElement(2);
-
-        auto uvA = uvMap->get(a);
-        auto uvB = uvMap->get(b);
-        auto uvC = uvMap->get(c);
-
-        // Add the face to the BVH tree
-        triangles.emplace_back(
-            Vector3(uvA[0], uvA[1], 0), Vector3(uvB[0], uvB[1], 0),
-            Vector3(uvC[0], uvC[1], 0));
-    }
-    Bvh bvh;
-    bvh::SweepSahBuilder<Bvh> builder(bvh);
-    auto [bboxes, centers] = bvh::compute_bounding_boxes_and_centers(
-        triangles.data(), triangles.size());
-    auto meshBBox =
-        bvh::compute_bounding_boxes_union(bboxes.get(), triangles.size());
-    builder.build(meshBBox, bboxes.get(), centers.get(), triangles.size());
-    Intersector intersector(bvh, triangles.data());
-    Traverser traverser(bvh);
-
-    ITKCell::CellAutoPointer cell;
-    for (const auto [y, x] : range2D(height, width)) {
-        // This pixel's uv coordinate
-        cv::Vec3d uv{0, 0, 0};
-        uv[0] = static_cast<double>(x) / static_cast<double>(width - 1);
-        uv[1] = static_cast<double>(y) / static_cast<double>(height - 1);
-
-        // Intersect a ray with the data structure
-        Ray ray(Vector3(uv[0], uv[1], 0), Vector3(uv[0], uv[1], 1.0), 0.0, 1.0);
-        auto hit = traverser.traverse(ray, intersector);
-        if (not hit) {
-            continue;
-        }
+    const auto flat = TriangleMesh::FromITKMesh(mesh, uvMap);
+    const ::UVFaceTree tree(flat->faces(), ::VertexUVs(*flat));
+
+    auto rows = [&](std::size_t y0, std::size_t y1) {
+        ::UVFaceTree::Query query(tree);
+        for (const auto [y, x] : range2D(y0, y1, 0, width)) {
+            // This pixel's uv coordinate
+            const auto u =
+                static_cast<double>(x) / static_cast<double>(width - 1);
+            const auto v =
+                static_cast<double>(y) / static_cast<double>(height - 1);
+
+            // Intersect a ray with the data structure
+            auto hit = query(u, v);
+            if (not hit) {
+                continue;
+            }
 
-        // Assign the cell index to the cell map
-        auto intX = static_cast<int>(x);
-        auto intY = static_cast<int>(y);
-        cellMap.at<std::int32_t>(intY, intX) =
-            static_cast<int>(hit->primitive_index);
-    }
+            // Assign the cell index to the cell map
+            auto intX = static_cast<int>(x);
+            auto intY = static_cast<int>(y);
+            cellMap.at<std::int32_t>(intY, intX) =
+                static_cast<int>(hit.value());
+        }
+    };
+    ParallelFor(height, ::RowsPerBlock(width), NumThreads(), rows);
 
     return cellMap;
 }
@@ -1,7 +1,20 @@
 #include "vc/texturing/TexturingAlgorithm.hpp"
 
+#include <algorithm>
+
+#include "vc/core/util/Parallel.hpp"
+
+using namespace volcart;
 using namespace volcart::texturing;
 
+namespace
+{
+// Number of mappings processed by a thread at a time. Small enough that the
+// threads stay within a few slices of each other, large enough to amortize
+// the scheduling and progress reporting.
+constexpr std::size_t MAPPING_BLOCK_SIZE{256};
+}  // namespace
+
 void TexturingAlgorithm::setPerPixelMap(PerPixelMap::Pointer ppm)
 {
     ppm_ = std::move(ppm);
@@ -12,9 +25,44 @@ void TexturingAlgorithm::setVolume(Volume::Pointer vol)
     vol_ = std::move(vol);
 }
 
+void TexturingAlgorithm::setMaxThreads(std::uint32_t t) { maxThreads_ = t; }
+
+void TexturingAlgorithm::resetMaxThreads() { maxThreads_.reset(); }
+
 auto TexturingAlgorithm::getTexture() -> Texture { return result_; }
 
 auto TexturingAlgorithm::progressIterations() const -> std::size_t
 {
     return ppm_->numMappings();
-}
\ No newline at end of file
+}
+
+void TexturingAlgorithm::for_each_mapping_(const MappingFn& fn)
+{
+    for_each_mapping_block_([&fn](auto first, auto last) {
+        for (auto it = first; it != last; ++it) {
+            fn(it->y, it->x);
+        }
+    });
+}
+
+void TexturingAlgorithm::for_each_mapping_block_(const MappingBlockFn& fn)
+{
+    // Get the mappings
+    auto mappings = ppm_->getMappingCoords();
+
+    // Sort the mappings by Z-value
+    std::sort(
+        mappings.begin(), mappings.end(),
+        [&](const auto& lhs, const auto& rhs) {
+            return (*ppm_)(lhs.y, lhs.x)[2] < (*ppm_)(rhs.y, rhs.x)[2];
+        });
+
+    // Iterate through the mappings
+    ParallelProgress progress(progressUpdated);
+    auto block = [&](std::size_t begin, std::size_t end) {
+        fn(mappings.data() + begin, mappings.data() + end);
+        progress.add(end - begin);
+    };
+    ParallelFor(
+        mappings.size(), ::MAPPING_BLOCK_SIZE, NumThreads(maxThreads_), block);
+}
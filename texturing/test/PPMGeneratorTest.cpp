@@ -55,6 +55,37 @@ TEST(PPMGeneratorTest, RegressionTest)
     }
 }
 
+TEST(PPMGeneratorTest, TriangleMeshInput)
+{
+    // Build Plane UVMap
+    vc::shapes::Plane plane(5, 5);
+    auto mesh = plane.itkMesh();
+    auto uvMap = vc::UVMap::New();
+    std::size_t id{0};
+    for (const auto uv : vc::range2D(5, 5)) {
+        auto u = double(uv.first) / 4.0;
+        auto v = double(uv.second) / 4.0;
+        uvMap->set(id++, {u, v});
+    }
+
+    // Generate a PPM from the ITK mesh
+    vct::PPMGenerator ppmGenerator(50, 50);
+    ppmGenerator.setMesh(mesh);
+    ppmGenerator.setUVMap(uvMap);
+    auto expected = ppmGenerator.compute();
+
+    // Generate a PPM from a TriangleMesh with embedded UVs
+    auto flat = vc::TriangleMesh::FromITKMesh(mesh, uvMap);
+    ppmGenerator.setMesh(flat);
+    ppmGenerator.setUVMap(nullptr);
+    auto ppm = ppmGenerator.compute();
+
+    for (const auto [y, x] : vc::range2D(50, 50)) {
+        EXPECT_EQ(ppm->hasMapping(y, x), expected->hasMapping(y, x));
+        EXPECT_EQ(ppm->getMapping(y, x), expected->getMapping(y, x));
+    }
+}
+
 TEST_P(PPMGeneratorTest, PerformanceTest)
 {
     // Build Plane
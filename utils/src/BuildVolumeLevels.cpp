@@ -0,0 +1,98 @@
+// vc_build_volume_levels: Build the downsampled resolution levels of a Volume
+
+#include <cstdint>
+#include <optional>
+
+#include <boost/program_options.hpp>
+
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/VolumePkg.hpp"
+#include "vc/core/util/Logging.hpp"
+
+namespace fs = volcart::filesystem;
+namespace po = boost::program_options;
+namespace vc = volcart;
+
+// Volpkg version required by this app
+static constexpr int VOLPKG_MIN_VERSION = 6;
+
+auto main(int argc, char* argv[]) -> int
+{
+    ///// Parse the command line options /////
+    // clang-format off
+    po::options_description all("Usage");
+    all.add_options()
+        ("help,h", "Show this message")
+        ("volpkg,v", po::value<std::string>()->required(), "VolumePkg path")
+        ("volume", po::value<std::string>(), "Volume to process. Default: The "
+           "first volume in the volume package.")
+        ("levels,l", po::value<int>()->default_value(vc::Volume::DEFAULT_NUM_LEVELS),
+           "Number of resolution levels, including full resolution. Level n "
+           "is downsampled by 2^n along every axis. 1 removes all "
+           "downsampled levels.")
+        ("threads,t", po::value<std::uint32_t>(), "Maximum number of threads. "
+           "Default: The number of hardware threads.");
+    // clang-format on
+
+    // parsed will hold the values of all parsed options as a Map
+    po::variables_map parsed;
+    po::store(po::command_line_parser(argc, argv).options(all).run(), parsed);
+
+    // Show the help message
+    if (parsed.count("help") || argc < 2) {
+        std::cout << all << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    // Warn of missing options
+    try {
+        po::notify(parsed);
+    } catch (po::error& e) {
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the volume package /////
+    fs::path volpkgPath = parsed["volpkg"].as<std::string>();
+    auto vpkg = vc::VolumePkg::New(volpkgPath);
+    if (vpkg->version() < VOLPKG_MIN_VERSION) {
+        vc::Logger()->error(
+            "Volume Package is version {} but this program requires version "
+            "{}+. ",
+            vpkg->version(), VOLPKG_MIN_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the Volume /////
+    vc::Volume::Pointer volume;
+    try {
+        if (parsed.count("volume")) {
+            volume = vpkg->volume(parsed["volume"].as<std::string>());
+        } else {
+            volume = vpkg->volume();
+        }
+    } catch (const std::exception& e) {
+        vc::Logger()->error(
+            "Cannot load volume. Please check that the Volume Package has "
+            "volumes and that the volume ID is correct.");
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    const auto levels = parsed["levels"].as<int>();
+    if (levels < 1) {
+        vc::Logger()->error("Number of levels must be >= 1");
+        return EXIT_FAILURE;
+    }
+
+    std::optional<std::uint32_t> threads;
+    if (parsed.count("threads")) {
+        threads = parsed["threads"].as<std::uint32_t>();
+    }
+
+    ///// Build the levels /////
+    vc::Logger()->info(
+        "Building {} resolution levels of volume {}", levels, volume->id());
+    volume->buildLevels(levels, threads);
+    vc::Logger()->info("Done.");
+}
@@ -0,0 +1,169 @@
+// vc_compute_structure_tensors: Precompute the structure tensor field of a
+// Volume
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <opencv2/core.hpp>
+
+#include "vc/app_support/ProgressIndicator.hpp"
+#include "vc/core/filesystem.hpp"
+#include "vc/core/math/StructureTensorField.hpp"
+#include "vc/core/types/VolumePkg.hpp"
+#include "vc/core/util/Iteration.hpp"
+#include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
+
+namespace fs = volcart::filesystem;
+namespace po = boost::program_options;
+namespace vc = volcart;
+
+// Volpkg version required by this app
+static constexpr int VOLPKG_MIN_VERSION = 6;
+
+auto main(int argc, char* argv[]) -> int
+{
+    ///// Parse the command line options /////
+    // clang-format off
+    po::options_description all("Usage");
+    all.add_options()
+        ("help,h", "Show this message")
+        ("volpkg,v", po::value<std::string>()->required(), "VolumePkg path")
+        ("volume", po::value<std::string>(), "Volume to process. Default: The "
+           "first volume in the volume package.")
+        ("output-dir,o", po::value<std::string>(), "Output directory. "
+           "Default: structure_tensors/r<radius> in the volume's directory.")
+        ("radius", po::value<int>(), "Subvolume radius of the structure "
+           "tensors. Default: The radius used by the segmentation algorithms, "
+           "which is derived from the material thickness.")
+        ("region", po::value<std::vector<int>>()->multitoken(), "Region of "
+           "the volume to process, given as 'x0 y0 z0 x1 y1 z1' where the "
+           "maximum is exclusive. Default: The whole volume.")
+        ("chunk-size", po::value<int>()->default_value(
+           vc::StructureTensorField::DEFAULT_CHUNK_SIZE),
+           "Edge length of the cubic chunks in voxels")
+        ("threads,t", po::value<std::uint32_t>(), "Maximum number of threads. "
+           "Default: The number of hardware threads.");
+    // clang-format on
+
+    // parsed will hold the values of all parsed options as a Map
+    po::variables_map parsed;
+    po::store(po::command_line_parser(argc, argv).options(all).run(), parsed);
+
+    // Show the help message
+    if (parsed.count("help") || argc < 2) {
+        std::cout << all << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    // Warn of missing options
+    try {
+        po::notify(parsed);
+    } catch (po::error& e) {
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the volume package /////
+    fs::path volpkgPath = parsed["volpkg"].as<std::string>();
+    auto vpkg = vc::VolumePkg::New(volpkgPath);
+    if (vpkg->version() < VOLPKG_MIN_VERSION) {
+        vc::Logger()->error(
+            "Volume Package is version {} but this program requires version "
+            "{}+. ",
+            vpkg->version(), VOLPKG_MIN_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the Volume /////
+    vc::Volume::Pointer volume;
+    try {
+        if (parsed.count("volume")) {
+            volume = vpkg->volume(parsed["volume"].as<std::string>());
+        } else {
+            volume = vpkg->volume();
+        }
+    } catch (const std::exception& e) {
+        vc::Logger()->error(
+            "Cannot load volume. Please check that the Volume Package has "
+            "volumes and that the volume ID is correct.");
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    ///// Parameters /////
+    // Same radius as LocalResliceSegmentation and StructureTensorParticleSim
+    auto radius = static_cast<int>(
+        std::ceil(vpkg->materialThickness() / volume->voxelSize()) * 0.5);
+    if (parsed.count("radius")) {
+        radius = parsed["radius"].as<int>();
+    }
+    if (radius < 0) {
+        vc::Logger()->error("Radius must be >= 0");
+        return EXIT_FAILURE;
+    }
+
+    const auto chunkSize = parsed["chunk-size"].as<int>();
+    if (chunkSize <= 0) {
+        vc::Logger()->error("Chunk size must be > 0");
+        return EXIT_FAILURE;
+    }
+
+    cv::Vec3i min{0, 0, 0};
+    cv::Vec3i max{
+        volume->sliceWidth(), volume->sliceHeight(), volume->numSlices()};
+    if (parsed.count("region")) {
+        const auto region = parsed["region"].as<std::vector<int>>();
+        if (region.size() != 6) {
+            vc::Logger()->error("Region must have 6 values");
+            return EXIT_FAILURE;
+        }
+        min = {region[0], region[1], region[2]};
+        max = {region[3], region[4], region[5]};
+    }
+
+    std::optional<std::uint32_t> threads;
+    if (parsed.count("threads")) {
+        threads = parsed["threads"].as<std::uint32_t>();
+    }
+
+    auto outputDir = vc::StructureTensorField::DefaultPath(volume, radius);
+    if (parsed.count("output-dir")) {
+        outputDir = parsed["output-dir"].as<std::string>();
+    }
+
+    ///// Compute the field one layer of chunks at a time /////
+    vc::StructureTensorField::Pointer field;
+    try {
+        field = vc::StructureTensorField::Create(
+            outputDir, volume, radius, min, max, chunkSize);
+    } catch (const std::exception& e) {
+        vc::Logger()->error("Cannot create field: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    vc::Logger()->info(
+        "Computing structure tensors of volume {} with radius {}: {}",
+        volume->id(), radius, outputDir.string());
+
+    using vc::ProgressWrap;
+    using vc::range;
+    const auto grid = field->chunkGridExtents();
+    const auto layerSize = static_cast<std::size_t>(grid[0]) * grid[1];
+    const auto numThreads = vc::NumThreads(threads);
+    for (const auto cz : ProgressWrap(range(grid[2]), "Computing chunks")) {
+        vc::ParallelFor(
+            layerSize, 1, numThreads, [&](std::size_t begin, std::size_t end) {
+                for (auto i = begin; i < end; i++) {
+                    const auto idx = static_cast<int>(i);
+                    field->computeChunk(
+                        volume, {idx % grid[0], idx / grid[0], cz});
+                }
+            });
+    }
+
+    vc::Logger()->info("Done.");
+}
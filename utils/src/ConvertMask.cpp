@@ -1,5 +1,5 @@
-// vc_convert_mask: Bidirectional conversion between Point Mask (.vcps) and
-// Volume Mask (Image sequence)
+// vc_convert_mask: Bidirectional conversion between Point Mask (.vcps or
+// .vcmask) and Volume Mask (Image sequence)
 
 #include <cstddef>
 #include <cstdint>
@@ -15,9 +15,9 @@
 #include "vc/core/filesystem.hpp"
 #include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/core/util/FormatStrToRegexStr.hpp"
-#include "vc/core/util/Iteration.hpp"
 #include "vc/core/util/Logging.hpp"
 
 namespace fs = volcart::filesystem;
@@ -76,7 +76,7 @@ auto main(int argc, char* argv[]) -> int
     fs::path inPath = parsed["input"].as<std::string>();
     fs::path outPath = parsed["output"].as<std::string>();
 
-    if (vc::IsFileType(inPath, {"vcps"})) {
+    if (vc::IsFileType(inPath, {"vcps", "vcmask"})) {
         // Load the volume package
         if (parsed.count("volpkg") == 0) {
             vc::Logger()->error(
@@ -126,11 +126,10 @@ void PointMaskToVolumeMask(
 {
     // Read the points
     vc::Logger()->info("Loading point mask");
-    auto ptsRaw = vc::PointSetIO<cv::Vec3i>::ReadPointSet(ptsPath);
+    auto pts = vc::io::LoadVolumetricMask(ptsPath)->as_vector();
 
     // Sort the points
     vc::Logger()->info("Sorting points");
-    auto pts = ptsRaw.as_vector();
     std::sort(pts.begin(), pts.end(), [](const auto& a, const auto& b) {
         return a[2] < b[2];
     });
@@ -173,7 +172,7 @@ void WriteMaskImage(
 
 void VolumeMaskToPointMask(const fs::path& inPath, const fs::path& outPath)
 {
-    vc::PointSet<cv::Vec3i> pts;
+    vc::VolumetricMask mask;
 
     // Collect files
     vc::Logger()->info("Collecting file list");
@@ -187,18 +186,19 @@ void VolumeMaskToPointMask(const fs::path& inPath, const fs::path& outPath)
         const auto& fpath = p.second;
 
         auto img = cv::imread(fpath.string(), cv::IMREAD_GRAYSCALE);
-        for (const auto px : vc::range2D(img.rows, img.cols)) {
-            const auto& x = px.second;
-            const auto& y = px.first;
-            if (img.at<std::uint8_t>(y, x) > 0) {
-                pts.emplace_back(x, y, z);
-            }
-        }
+        mask.setIn(img, static_cast<int>(z));
     }
 
-    // Write point set
-    vc::Logger()->info("Writing point set...");
-    vc::PointSetIO<cv::Vec3i>::WritePointSet(outPath, pts);
+    // Write the mask
+    if (vc::IsFileType(outPath, {"vcmask"})) {
+        vc::Logger()->info("Writing mask...");
+        vc::io::WriteVolumetricMask(outPath, mask);
+    } else {
+        vc::Logger()->info("Writing point set...");
+        vc::PointSet<cv::Vec3i> pts;
+        pts.append(mask.as_vector());
+        vc::PointSetIO<cv::Vec3i>::WritePointSet(outPath, pts);
+    }
 }
 
 auto CollectVolumeFiles(const fs::path& fmtPath) -> SliceList
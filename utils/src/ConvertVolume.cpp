@@ -0,0 +1,158 @@
+// vc_convert_volume: Convert a slice-based Volume into a chunked Volume
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <opencv2/core.hpp>
+
+#include "vc/app_support/ProgressIndicator.hpp"
+#include "vc/core/filesystem.hpp"
+#include "vc/core/types/VolumePkg.hpp"
+#include "vc/core/util/Iteration.hpp"
+#include "vc/core/util/Logging.hpp"
+
+namespace fs = volcart::filesystem;
+namespace po = boost::program_options;
+namespace vc = volcart;
+
+// Volpkg version required by this app
+static constexpr int VOLPKG_MIN_VERSION = 6;
+
+auto main(int argc, char* argv[]) -> int
+{
+    ///// Parse the command line options /////
+    // clang-format off
+    po::options_description all("Usage");
+    all.add_options()
+        ("help,h", "Show this message")
+        ("volpkg,v", po::value<std::string>()->required(), "VolumePkg path")
+        ("volume", po::value<std::string>(), "Volume to convert. Default: The "
+           "first volume in the volume package.")
+        ("name,n", po::value<std::string>(), "Name of the new volume. "
+           "Default: The name of the input volume with a \"(chunked)\" suffix.")
+        ("chunk-size", po::value<int>()->default_value(vc::Volume::DEFAULT_CHUNK_SIZE),
+           "Edge length of the cubic chunks in voxels. Peak memory usage "
+           "is roughly chunk-size slices of the input volume.");
+    // clang-format on
+
+    // parsed will hold the values of all parsed options as a Map
+    po::variables_map parsed;
+    po::store(po::command_line_parser(argc, argv).options(all).run(), parsed);
+
+    // Show the help message
+    if (parsed.count("help") || argc < 2) {
+        std::cout << all << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    // Warn of missing options
+    try {
+        po::notify(parsed);
+    } catch (po::error& e) {
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the volume package /////
+    fs::path volpkgPath = parsed["volpkg"].as<std::string>();
+    auto vpkg = vc::VolumePkg::New(volpkgPath);
+    if (vpkg->version() < VOLPKG_MIN_VERSION) {
+        vc::Logger()->error(
+            "Volume Package is version {} but this program requires version "
+            "{}+. ",
+            vpkg->version(), VOLPKG_MIN_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the Volume /////
+    vc::Volume::Pointer input;
+    try {
+        if (parsed.count("volume")) {
+            input = vpkg->volume(parsed["volume"].as<std::string>());
+        } else {
+            input = vpkg->volume();
+        }
+    } catch (const std::exception& e) {
+        vc::Logger()->error(
+            "Cannot load volume. Please check that the Volume Package has "
+            "volumes and that the volume ID is correct.");
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+    if (input->storageFormat() != vc::Volume::StorageFormat::Slices) {
+        vc::Logger()->error("Input volume is not stored as slices");
+        return EXIT_FAILURE;
+    }
+    // Each slice is only read once
+    input->setCacheSlices(false);
+
+    const auto chunkSize = parsed["chunk-size"].as<int>();
+    if (chunkSize <= 0) {
+        vc::Logger()->error("Chunk size must be > 0");
+        return EXIT_FAILURE;
+    }
+
+    ///// Setup the output Volume /////
+    auto name = input->name() + " (chunked)";
+    if (parsed.count("name")) {
+        name = parsed["name"].as<std::string>();
+    }
+    auto output = vpkg->newVolume(name);
+    output->setSliceWidth(input->sliceWidth());
+    output->setSliceHeight(input->sliceHeight());
+    output->setNumberOfSlices(input->numSlices());
+    output->setVoxelSize(input->voxelSize());
+    output->setMin(input->min());
+    output->setMax(input->max());
+    output->setChunkSize(chunkSize);
+    output->setStorageFormat(vc::Volume::StorageFormat::Chunks);
+    output->saveMetadata();
+    vc::Logger()->info(
+        "Converting volume {} to chunked volume {}", input->id(), output->id());
+
+    ///// Convert one layer of chunks at a time /////
+    using vc::ProgressWrap;
+    using vc::range;
+    const auto grid = output->chunkGridExtents();
+    const std::array<int, 3> extents{chunkSize, chunkSize, chunkSize};
+    for (const auto cz : ProgressWrap(range(grid[2]), "Writing chunks")) {
+        // Load the slices covered by this layer
+        const auto z0 = cz * chunkSize;
+        const auto z1 = std::min(z0 + chunkSize, input->numSlices());
+        std::vector<cv::Mat> slices;
+        slices.reserve(z1 - z0);
+        for (const auto z : range(z0, z1)) {
+            slices.emplace_back(input->getSliceData(z));
+        }
+
+        // Split into chunks
+        for (const auto cy : range(grid[1])) {
+            const auto y0 = cy * chunkSize;
+            const auto h = std::min(chunkSize, input->sliceHeight() - y0);
+            for (const auto cx : range(grid[0])) {
+                const auto x0 = cx * chunkSize;
+                const auto w = std::min(chunkSize, input->sliceWidth() - x0);
+                cv::Mat chunk = cv::Mat::zeros(3, extents.data(), CV_16UC1);
+                for (const auto& [z, slice] : vc::enumerate(slices)) {
+                    if (slice.empty()) {
+                        continue;
+                    }
+                    for (const auto y : range(h)) {
+                        const auto* src =
+                            slice.ptr<std::uint16_t>(y0 + y) + x0;
+                        auto* dst = chunk.ptr<std::uint16_t>(
+                            static_cast<int>(z), static_cast<int>(y));
+                        std::copy(src, src + w, dst);
+                    }
+                }
+                output->setChunkData({cx, cy, cz}, chunk);
+            }
+        }
+    }
+
+    vc::Logger()->info("Done.");
+}
@@ -8,6 +8,7 @@
 #include "vc/core/filesystem.hpp"
 #include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/MeshIO.hpp"
+#include "vc/core/io/TiledPPMIO.hpp"
 #include "vc/core/types/ITKMesh.hpp"
 #include "vc/core/types/PerPixelMap.hpp"
 #include "vc/core/util/Iteration.hpp"
@@ -68,8 +69,14 @@ auto main(int argc, char* argv[]) -> int
         ("roi", po::value<std::string>(), "String describing origin, width, "
              "and height of region-of-interest. Format: WxH+X+Y");
 
+    po::options_description tiledOpts("Tiled PPM Options");
+    tiledOpts.add_options()
+        ("tile-size", po::value<std::size_t>()->default_value(1024),
+            "Edge length of the tiles when writing a tiled PPM (.tppm)")
+        ("float32", "Store the mappings of a tiled PPM as 32-bit floats");
+
     po::options_description all("Usage");
-    all.add(required);
+    all.add(required).add(tiledOpts);
     // clang-format on
 
     // Parse the cmd line
@@ -90,34 +97,70 @@ auto main(int argc, char* argv[]) -> int
         return EXIT_FAILURE;
     }
 
-    // Get input file
+    // Get input file. Tiled PPMs are processed one tile at a time.
     const fs::path ppmPath = parsed["ppm"].as<std::string>();
-    Logger()->info("Reading PPM...");
-    auto ppm = PerPixelMap::ReadPPM(ppmPath);
+    io::TiledPPMReader::Pointer tiledPPM;
+    PerPixelMap ppm;
+    if (io::IsTiledPPM(ppmPath)) {
+        Logger()->info("Opening tiled PPM...");
+        tiledPPM = io::TiledPPMReader::New(ppmPath);
+    } else {
+        Logger()->info("Reading PPM...");
+        ppm = PerPixelMap::ReadPPM(ppmPath);
+    }
+    const auto h = tiledPPM ? tiledPPM->height() : ppm.height();
+    const auto w = tiledPPM ? tiledPPM->width() : ppm.width();
+    const auto ms = tiledPPM ? tiledPPM->numMappings() : ppm.numMappings();
+    const cv::Rect bounds(0, 0, static_cast<int>(w), static_cast<int>(h));
+
+    // Get a region of the input PPM
+    auto readRegion = [&](const cv::Rect& r) {
+        if (tiledPPM) {
+            return tiledPPM->readRegion(r);
+        }
+        return PerPixelMap::Crop(ppm, r.y, r.x, r.height, r.width);
+    };
+
+    // Call fn(region, rect) for consecutive regions which cover roi
+    auto forEachRegion = [&](const cv::Rect& roi, auto fn) {
+        if (not tiledPPM) {
+            if (roi == bounds) {
+                fn(ppm, roi);
+            } else {
+                fn(readRegion(roi), roi);
+            }
+            return;
+        }
+        for (const auto tile : range(tiledPPM->numTiles())) {
+            const auto rect = tiledPPM->tileRect(tile) & roi;
+            if (not rect.empty()) {
+                fn(tiledPPM->readRegion(rect), rect);
+            }
+        }
+    };
 
     // Get min/max bound
     std::array<double, 3> min;
     std::fill(min.begin(), min.end(), std::numeric_limits<double>::max());
     std::array<double, 3> max;
     std::fill(max.begin(), max.end(), std::numeric_limits<double>::min());
-    for (const auto [y, x] : ppm.getMappingCoords()) {
-        const auto& m = ppm.getMapping(y, x);
-        min[0] = std::min(min[0], m[0]);
-        min[1] = std::min(min[1], m[1]);
-        min[2] = std::min(min[2], m[2]);
-        max[0] = std::max(max[0], m[0]);
-        max[1] = std::max(max[1], m[1]);
-        max[2] = std::max(max[2], m[2]);
-    }
+    forEachRegion(bounds, [&](const PerPixelMap& region, const cv::Rect&) {
+        for (const auto [y, x] : region.getMappingCoords()) {
+            const auto& m = region.getMapping(y, x);
+            min[0] = std::min(min[0], m[0]);
+            min[1] = std::min(min[1], m[1]);
+            min[2] = std::min(min[2], m[2]);
+            max[0] = std::max(max[0], m[0]);
+            max[1] = std::max(max[1], m[1]);
+            max[2] = std::max(max[2], m[2]);
+        }
+    });
 
     // Set user-preferred locale for temporary text formatting
     auto startLocale = std::locale();
     std::locale::global(std::locale(""));
 
     // Report PPM stats
-    auto h = ppm.height();
-    auto w = ppm.width();
-    auto ms = ppm.numMappings();
     auto p = 100. * static_cast<double>(ms) / static_cast<double>(h * w);
     Logger()->info(
         "Loaded PPM:\n"
@@ -144,8 +187,8 @@ auto main(int argc, char* argv[]) -> int
     // Setup ROI
     std::size_t minX = 0;
     std::size_t minY = 0;
-    std::size_t maxX = ppm.width();
-    std::size_t maxY = ppm.height();
+    std::size_t maxX = w;
+    std::size_t maxY = h;
     if (parsed.count("roi") > 0) {
         auto roi = ::ParseROI(parsed["roi"].as<std::string>());
         minX = std::max(minX, roi.x);
@@ -153,6 +196,13 @@ auto main(int argc, char* argv[]) -> int
         maxX = std::min(maxX, minX + roi.width);
         maxY = std::min(maxY, minY + roi.height);
     }
+    if (minX >= maxX or minY >= maxY) {
+        Logger()->error("ROI does not overlap the PPM");
+        return EXIT_FAILURE;
+    }
+    const cv::Rect roi(
+        static_cast<int>(minX), static_cast<int>(minY),
+        static_cast<int>(maxX - minX), static_cast<int>(maxY - minY));
 
     // Convert to an ITKMesh
     if (writeMesh) {
@@ -163,35 +213,54 @@ auto main(int argc, char* argv[]) -> int
         Logger()->info("Generating point set...");
         ITKPoint pt;
         ITKPixel normal;
-        for (auto [y, x] : range2D(minY, maxY, minX, maxX)) {
-            // Skip unmapped pixels
-            if (!ppm.hasMapping(y, x)) {
-                continue;
-            }
+        forEachRegion(roi, [&](const PerPixelMap& region, const cv::Rect&) {
+            for (auto [y, x] : range2D(region.height(), region.width())) {
+                // Skip unmapped pixels
+                if (!region.hasMapping(y, x)) {
+                    continue;
+                }
 
-            const auto id = mesh->GetNumberOfPoints();
-            const auto& m = ppm.getMapping(y, x);
-            pt[0] = m[0];
-            pt[1] = m[1];
-            pt[2] = m[2];
-            normal[0] = m[3];
-            normal[1] = m[4];
-            normal[2] = m[5];
-            mesh->SetPoint(id, pt);
-            mesh->SetPointData(id, normal);
-        }
+                const auto id = mesh->GetNumberOfPoints();
+                const auto& m = region.getMapping(y, x);
+                pt[0] = m[0];
+                pt[1] = m[1];
+                pt[2] = m[2];
+                normal[0] = m[3];
+                normal[1] = m[4];
+                normal[2] = m[5];
+                mesh->SetPoint(id, pt);
+                mesh->SetPointData(id, normal);
+            }
+        });
 
         // Write the mesh
         Logger()->info("Writing mesh file...");
         WriteMesh(outPath, mesh);
+    } else if (IsFileType(outPath, {"tppm"})) {
+        // Copy the ROI one output tile at a time
+        io::TiledPPMOptions opts;
+        opts.tileSize = parsed["tile-size"].as<std::size_t>();
+        opts.float32 = parsed.count("float32") > 0;
+        if (tiledPPM) {
+            opts.mask = tiledPPM->options().mask;
+            opts.cellMap = tiledPPM->options().cellMap;
+        } else {
+            opts.mask = not ppm.mask().empty();
+            opts.cellMap = not ppm.cellMap().empty();
+        }
+        Logger()->info("Writing tiled PPM...");
+        io::TiledPPMWriter writer(outPath, roi.height, roi.width, opts);
+        for (const auto tile : range(writer.numTiles())) {
+            const auto rect = writer.tileRect(tile) + roi.tl();
+            writer.writeTile(tile, readRegion(rect));
+        }
+        writer.close();
     } else {
         Logger()->info("Cropping PPM...");
-        const auto h = maxY - minY;
-        const auto w = maxX - minX;
-        auto outPPM = PerPixelMap::Crop(ppm, minY, minX, h, w);
+        auto outPPM = readRegion(roi);
         Logger()->info("Writing PPM...");
         PerPixelMap::WritePPM(outPath, outPPM);
     }
 
     Logger()->info("Done.");
-}
\ No newline at end of file
+}
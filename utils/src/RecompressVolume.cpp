@@ -0,0 +1,143 @@
+// vc_recompress_volume: Rewrite the slices of a Volume with a different codec
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "vc/app_support/ProgressIndicator.hpp"
+#include "vc/core/filesystem.hpp"
+#include "vc/core/io/TIFFIO.hpp"
+#include "vc/core/types/VolumePkg.hpp"
+#include "vc/core/util/Logging.hpp"
+#include "vc/core/util/Parallel.hpp"
+
+namespace fs = volcart::filesystem;
+namespace po = boost::program_options;
+namespace vc = volcart;
+namespace tio = volcart::tiffio;
+
+// Volpkg version required by this app
+static constexpr int VOLPKG_MIN_VERSION = 6;
+
+auto main(int argc, char* argv[]) -> int
+{
+    ///// Parse the command line options /////
+    // clang-format off
+    po::options_description all("Usage");
+    all.add_options()
+        ("help,h", "Show this message")
+        ("volpkg,v", po::value<std::string>()->required(), "VolumePkg path")
+        ("volume", po::value<std::string>(), "Volume to process. Default: The "
+           "first volume in the volume package.")
+        ("compression,c", po::value<std::string>()->default_value("zstd"),
+           "Compression scheme: none, lzw, deflate, zstd, lzma")
+        ("no-predictor", "Do not apply a predictor before compressing. "
+           "Predictors usually make CT slices smaller, but slower to decode.")
+        ("threads,t", po::value<std::uint32_t>(), "Maximum number of threads. "
+           "Default: The number of hardware threads.");
+    // clang-format on
+
+    // parsed will hold the values of all parsed options as a Map
+    po::variables_map parsed;
+    po::store(po::command_line_parser(argc, argv).options(all).run(), parsed);
+
+    // Show the help message
+    if (parsed.count("help") || argc < 2) {
+        std::cout << all << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    // Warn of missing options
+    try {
+        po::notify(parsed);
+    } catch (po::error& e) {
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the volume package /////
+    fs::path volpkgPath = parsed["volpkg"].as<std::string>();
+    auto vpkg = vc::VolumePkg::New(volpkgPath);
+    if (vpkg->version() < VOLPKG_MIN_VERSION) {
+        vc::Logger()->error(
+            "Volume Package is version {} but this program requires version "
+            "{}+. ",
+            vpkg->version(), VOLPKG_MIN_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    ///// Load the Volume /////
+    vc::Volume::Pointer volume;
+    try {
+        if (parsed.count("volume")) {
+            volume = vpkg->volume(parsed["volume"].as<std::string>());
+        } else {
+            volume = vpkg->volume();
+        }
+    } catch (const std::exception& e) {
+        vc::Logger()->error(
+            "Cannot load volume. Please check that the Volume Package has "
+            "volumes and that the volume ID is correct.");
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (volume->storageFormat() != vc::Volume::StorageFormat::Slices) {
+        vc::Logger()->error("Only slice volumes can be recompressed");
+        return EXIT_FAILURE;
+    }
+
+    ///// Select the codec /////
+    const auto name = parsed["compression"].as<std::string>();
+    const auto predictor = parsed.count("no-predictor") == 0;
+    try {
+        volume->setSliceCompression(tio::CompressionFromName(name), predictor);
+    } catch (const std::invalid_argument& e) {
+        vc::Logger()->error(e.what());
+        return EXIT_FAILURE;
+    }
+    const auto compress = volume->sliceCompression() != tio::Compression::NONE;
+
+    std::optional<std::uint32_t> threads;
+    if (parsed.count("threads")) {
+        threads = parsed["threads"].as<std::uint32_t>();
+    }
+
+    ///// Rewrite the slices /////
+    // setSliceData() replaces each slice with a new file, so a failed slice
+    // keeps its old data
+    vc::Logger()->info("Recompressing volume {} with {}", volume->id(), name);
+    const auto numSlices = static_cast<std::size_t>(volume->numSlices());
+    vc::ParallelPass pass(numSlices);
+    auto bar = vc::ReportProgress(pass, "Recompressing:");
+    std::vector<int> failed;
+    std::mutex failedMutex;
+    pass.run(vc::NumThreads(threads), [&](std::size_t i) {
+        const auto idx = static_cast<int>(i);
+        try {
+            const auto slice = tio::ReadTIFF(volume->getSlicePath(idx));
+            volume->setSliceData(idx, slice, compress);
+        } catch (const std::exception& e) {
+            vc::Logger()->error(
+                "Failed to recompress slice {}: {}", idx, e.what());
+            std::unique_lock lock(failedMutex);
+            failed.push_back(idx);
+        }
+    });
+
+    // Save the codec once every slice uses it
+    if (not failed.empty()) {
+        vc::Logger()->error(
+            "Failed to recompress {} of {} slices. The failed slices are "
+            "unchanged and the volume metadata was not updated.",
+            failed.size(), numSlices);
+        return EXIT_FAILURE;
+    }
+    volume->saveMetadata();
+    vc::Logger()->info("Done.");
+}
@@ -6,7 +6,9 @@
 
 #include "vc/app_support/ProgressIndicator.hpp"
 #include "vc/core/filesystem.hpp"
+#include "vc/core/io/FileFilters.hpp"
 #include "vc/core/io/PointSetIO.hpp"
+#include "vc/core/io/VolumetricMaskIO.hpp"
 #include "vc/core/types/PointSet.hpp"
 #include "vc/core/types/VolumePkg.hpp"
 #include "vc/core/util/Logging.hpp"
@@ -34,7 +36,10 @@ auto main(int argc, char* argv[]) -> int
         ("input-pts,i", po::value<std::string>()->required(),
             "Path to an input point set representing a segmentation")
         ("output-pts,o", po::value<std::string>()->required(),
-         "Path to a directory to store the output point mask");
+         "Path to the output mask. Writes a binary mask if the extension is "
+         ".vcmask, otherwise writes a point set (.vcps).")
+        ("threads", po::value<std::uint32_t>(), "Maximum number of threads. "
+           "Default: The number of hardware threads.");
 
     // TFF options
     po::options_description tffOptions("Thinned Flood Fill Segmentation Options");
@@ -116,6 +121,9 @@ auto main(int argc, char* argv[]) -> int
         maskGen.setMaxRadius(r);
     }
     maskGen.setMeasureVertical(parsed.count("measure-vert") > 0);
+    if (parsed.count("threads") > 0) {
+        maskGen.setMaxThreads(parsed["threads"].as<std::uint32_t>());
+    }
 
     // Setup progress reporting
     vc::ReportProgress(maskGen, "Generating mask");
@@ -125,7 +133,11 @@ auto main(int argc, char* argv[]) -> int
 
     // Save the mask
     vc::Logger()->info("Saving mask");
-    vc::PointSet<cv::Vec3i> maskPts;
-    maskPts.append(mask->as_vector());
-    vc::PointSetIO<cv::Vec3i>::WritePointSet(outPath, maskPts);
+    if (vc::IsFileType(outPath, {"vcmask"})) {
+        vc::io::WriteVolumetricMask(outPath, *mask);
+    } else {
+        vc::PointSet<cv::Vec3i> maskPts;
+        maskPts.append(mask->as_vector());
+        vc::PointSetIO<cv::Vec3i>::WritePointSet(outPath, maskPts);
+    }
 }
\ No newline at end of file